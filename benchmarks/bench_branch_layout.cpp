@@ -0,0 +1,89 @@
+// benchmarks/bench_branch_layout.cpp
+// Build: g++ -std=c++17 -O2 benchmarks/bench_branch_layout.cpp -o bench_branch_layout
+// CFG simplification (parser/ir_cfg_simplify.cpp) on branchy generated
+// code: nested ifs, while and for loops with breaks. Compares the IR as
+// generated, taken through SSA and back with no passes (which already
+// drops jumps to the next instruction), with jump threading, merging and
+// layout added, and the whole optimizer. For each, the static count of
+// jumps and conditional jumps, and the dynamic counts from running main()
+// on the IR interpreter: jumps, conditional jumps and how many were taken.
+// Usage: bench_branch_layout [functions]
+
+#define PARSER_REUSE_LEXER
+#include "../regex/regex_code.cpp"
+#include "../parser/parser.cpp"
+#define IR_OPTIMIZER_NO_MAIN
+#include "../parser/ir_optimizer.cpp"
+#include "bench_common.hpp"
+
+static vector<Token> program(size_t n)
+{
+    string body =
+        "int FN(int a, int b) { int s = 0; int i = 0;\n"
+        " while (i < a) { if (i < b) { s = s + i; } else { if (s > 20) { s = s - 3; } }\n"
+        "   int j; for (j = 0; j < 3; j = j + 1) { if (j == i) { break; } s = s + 1; }\n"
+        "   if (s > 50) { if (a > 9) { break; } } i = i + 1; }\n"
+        " if (s < 0) { return 0; } return s; }\n";
+    return joinTokens({numberedCopies(body, n), mainCalling(" total = total + FN(8, 5);\n", n)});
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = argc > 1 ? stoul(argv[1]) : 5000;
+    Program prog;
+    {
+        Parser parser(program(n));
+        prog = parser.parseProgram();
+    }
+    TypeChecker checker;
+    checker.check(prog);
+    ScopeChecker resolver;
+    resolver.analyse(prog);
+
+    OptimizerOptions none, layout;
+    none.constants = none.copies = none.deadCode = none.simplifyCFG = false;
+    layout.constants = layout.copies = layout.deadCode = false;
+    struct Variant
+    {
+        string name;
+        OptimizerOptions options;
+        bool optimize;
+    };
+    vector<Variant> variants = {{"as generated", none, false},
+                                {"through SSA, no passes", none, true},
+                                {"CFG simplification", layout, true},
+                                {"all passes", OptimizerOptions(), true}};
+
+    string expected;
+    bool same = true;
+    for (const Variant &v : variants)
+    {
+        IRGenerator gen;
+        gen.generateIR(prog);
+        IRProgram &ir = gen.program();
+        if (v.optimize)
+            optimizeIR(ir, v.options);
+        size_t jumps = 0, branches = 0;
+        for (const IRInstruction &in : ir.code)
+        {
+            jumps += in.op == IROp::JUMP;
+            branches += in.op == IROp::JUMP_TRUE || in.op == IROp::JUMP_FALSE;
+        }
+        IRInterpreter interpreter(ir);
+        string result;
+        double ms = bestOf(3, [&] { result = interpreter.text(interpreter.run()); });
+        if (expected.empty())
+            expected = result;
+        same = same && result == expected;
+        cout << v.name << ": " << ir.code.size() << " instructions, " << jumps << " jumps, " << branches
+             << " conditional jumps\n";
+        cout << "    executed: " << interpreter.steps << " instructions, " << interpreter.jumps << " jumps, "
+             << interpreter.branches << " conditional jumps (" << interpreter.taken << " taken), " << ms << " ms\n";
+    }
+    if (!same)
+    {
+        cout << "MISMATCH: optimized IR computes a different result\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,37 @@
+// benchmarks/bench_calls.cpp
+// Build: g++ -std=c++17 -O2 benchmarks/bench_calls.cpp -o bench_calls
+// Parse time and allocation count on call-dense input: nested calls with
+// zero to five arguments.
+
+#define PARSER_REUSE_LEXER
+#include "../regex/regex_code.cpp"
+#include "../parser/parser.cpp"
+#include "bench_common.hpp"
+
+int main(int argc, char **argv)
+{
+    size_t n = argc > 1 ? stoul(argv[1]) : 50000;
+    auto tokens = repeatTokens("int main() { int a = 1; int b = 2; int x;",
+                               "x = f(a, g(b, 1), h()) + f(g(a, b), 2, h(), k(a, b, 1, 2, 3));\n"
+                               "x = k(f(a), f(b), g(a, f(b)), h(), f(k(1, 2, 3, 4, 5)));\n",
+                               n, "return x; }");
+    size_t calls = n * 15;
+    cout << "statements: " << n * 2 << "  calls: " << calls << "  tokens: " << tokens.size() << "\n";
+
+    size_t allocs = 0, live = 0;
+    double ms = 1e300;
+    for (int rep = 0; rep < 5; rep++)
+    {
+        vector<Token> copy = tokens; // not timed
+        size_t before = g_liveBytes, allocsBefore = g_totalAllocs;
+        BenchTimer t;
+        Parser parser(move(copy));
+        Program prog = parser.parseProgram();
+        ms = min(ms, t.ms());
+        allocs = g_totalAllocs - allocsBefore;
+        live = g_liveBytes - before;
+    }
+    cout << "parse " << ms << " ms (" << ms * 1e6 / calls << " ns/call), "
+         << allocs << " allocations, live AST " << fmtBytes(live) << "\n";
+    return 0;
+}
@@ -0,0 +1,118 @@
+// benchmarks/bench_cfg.cpp
+// Build: g++ -std=c++17 -O2 benchmarks/bench_cfg.cpp -o bench_cfg
+// CFG construction (parser/ir_cfg.cpp) for every function of a large
+// generated program with nested loops and branches: build time next to IR
+// generation time, graph sizes and the heap the graphs take, and a
+// reverse-postorder walk over all of them. Every graph is checked for
+// matching predecessor/successor rows and an RPO that starts at the entry
+// and lists each reachable block once.
+// Usage: bench_cfg [functions]
+
+#define PARSER_REUSE_LEXER
+#include "../regex/regex_code.cpp"
+#include "../parser/parser.cpp"
+#define IR_CFG_NO_MAIN
+#include "../parser/ir_cfg.cpp"
+#include "bench_common.hpp"
+
+static vector<Token> program(size_t n)
+{
+    string body =
+        "int FN(int a, int b) { int s = 0; int i = 0;\n"
+        " while (i < a) { int j = 0; for (j = 0; j < b; j = j + 1) { if (j > i) { s = s + j; } else { s = s - 1; } }\n"
+        "   if (s > 100) { s = s / 2; if (s < 3) { break; } } i = i + 1; }\n"
+        " if (a == b) { return FP(s, a); } return s; }\n";
+    return joinTokens({chainedCopies(body, n)});
+}
+
+static bool consistent(const CFG &g)
+{
+    size_t edges = 0;
+    for (uint32_t b = 0; b < g.blockCount(); b++)
+        for (uint32_t s : g.successors(b))
+        {
+            edges++;
+            auto preds = g.predecessors(s);
+            if (find(preds.begin(), preds.end(), b) == preds.end())
+                return false;
+        }
+    if (edges != g.pred.size() || g.rpo.empty() || g.rpo[0] != 0)
+        return false;
+    // Every reachable block listed once, and nothing reachable left out
+    vector<bool> listed(g.blockCount(), false);
+    for (uint32_t b : g.rpo)
+    {
+        if (listed[b])
+            return false;
+        listed[b] = true;
+    }
+    for (uint32_t b = 0; b < g.blockCount(); b++)
+        if (g.reachable(b))
+            for (uint32_t s : g.successors(b))
+                if (!g.reachable(s))
+                    return false;
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = argc > 1 ? stoul(argv[1]) : 20000;
+    Program prog;
+    {
+        Parser parser(program(n));
+        prog = parser.parseProgram();
+    }
+    TypeChecker checker;
+    checker.check(prog);
+    ScopeChecker resolver;
+    resolver.analyse(prog);
+    IRGenerator gen;
+    double genMs = bestOf(3, [&] { gen.generateIR(prog); });
+    const IRProgram &ir = gen.program();
+
+    vector<CFG> graphs;
+    double buildMs = 1e300;
+    size_t graphBytes = 0;
+    for (int rep = 0; rep < 5; rep++)
+    {
+        graphs.clear();
+        graphs.shrink_to_fit();
+        size_t before = g_liveBytes;
+        BenchTimer t;
+        graphs = buildCFGs(ir);
+        buildMs = min(buildMs, t.ms());
+        graphBytes = g_liveBytes - before;
+    }
+
+    size_t blocks = 0, edges = 0, reachable = 0;
+    for (const CFG &g : graphs)
+    {
+        if (!consistent(g))
+        {
+            cout << "INCONSISTENT CFG for " << ir.operandText(g.function.name) << "\n";
+            return 1;
+        }
+        blocks += g.blockCount();
+        edges += g.edgeCount();
+        reachable += g.rpo.size();
+    }
+
+    // A forward pass over every graph in RPO, summing block lengths, as an
+    // analysis would visit them.
+    size_t visited = 0;
+    double rpoMs = bestOf(5, [&]
+                          {
+                              visited = 0;
+                              for (const CFG &g : graphs)
+                                  for (uint32_t b : g.rpo)
+                                      visited += g.end(b) - g.begin(b);
+                          });
+
+    cout << "functions: " << graphs.size() << "  instructions: " << ir.code.size() << "  blocks: " << blocks
+         << " (" << reachable << " reachable)  edges: " << edges << "\n";
+    cout << "IR generation     " << genMs << " ms\n";
+    cout << "CFG construction  " << buildMs << " ms (" << buildMs * 1e6 / ir.code.size() << " ns/instruction), "
+         << fmtBytes(graphBytes) << " (" << double(graphBytes) / blocks << " bytes/block)\n";
+    cout << "RPO walk          " << rpoMs << " ms (" << visited << " instructions)\n";
+    return 0;
+}
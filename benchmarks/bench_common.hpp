@@ -0,0 +1,216 @@
+#ifndef BENCH_COMMON_HPP
+#define BENCH_COMMON_HPP
+
+// Shared helpers for the benchmark drivers in this directory.
+// Include after the lexer (and parser, if used) so Token/RegexLexer exist.
+// Every benchmark is a single translation unit, so the counting operator
+// new/delete below is defined exactly once per binary.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <initializer_list>
+#include <new>
+#include <string>
+#include <vector>
+
+// ---------- Heap accounting ----------
+// Live and total bytes handed out by operator new. Each block carries a
+// 16-byte header holding its size so delete can subtract it again. The
+// counters are atomic so multi-threaded benchmarks can use them too.
+static std::atomic<size_t> g_liveBytes{0};
+static std::atomic<size_t> g_totalAllocs{0};
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Warray-bounds"
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void *operator new(size_t n)
+{
+    void *p = std::malloc(n + 16);
+    if (!p)
+        throw std::bad_alloc();
+    *static_cast<size_t *>(p) = n;
+    g_liveBytes.fetch_add(n, std::memory_order_relaxed);
+    g_totalAllocs.fetch_add(1, std::memory_order_relaxed);
+    return static_cast<char *>(p) + 16;
+}
+void operator delete(void *p) noexcept
+{
+    if (!p)
+        return;
+    char *base = static_cast<char *>(p) - 16;
+    g_liveBytes.fetch_sub(*reinterpret_cast<size_t *>(base), std::memory_order_relaxed);
+    std::free(base);
+}
+void operator delete(void *p, size_t) noexcept { operator delete(p); }
+void *operator new[](size_t n) { return operator new(n); }
+void operator delete[](void *p) noexcept { operator delete(p); }
+void operator delete[](void *p, size_t) noexcept { operator delete(p); }
+
+// ---------- Timing ----------
+struct BenchTimer
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    double ms() const
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+// Runs fn `reps` times and returns the best wall time in milliseconds.
+template <class Fn>
+double bestOf(int reps, Fn fn)
+{
+    double best = 1e300;
+    for (int i = 0; i < reps; i++)
+    {
+        BenchTimer t;
+        fn();
+        best = std::min(best, t.ms());
+    }
+    return best;
+}
+
+// ---------- Synthetic inputs ----------
+// The regex lexer re-scans the remaining source for every token, so large
+// inputs are built by lexing small snippets once and replicating the tokens.
+inline std::vector<Token> lexSnippet(const std::string &code)
+{
+    RegexLexer lex(code);
+    auto toks = lex.tokenize();
+    toks.pop_back(); // drop T_EOF
+    return toks;
+}
+
+// prefix + n copies of body + suffix, with line numbers shifted per copy.
+inline std::vector<Token> repeatTokens(const std::string &prefix, const std::string &body, size_t n,
+                                       const std::string &suffix)
+{
+    std::vector<Token> out = lexSnippet(prefix);
+    std::vector<Token> b = lexSnippet(body);
+    std::vector<Token> s = lexSnippet(suffix);
+    int bodyLines = 1;
+    for (char c : body)
+        bodyLines += c == '\n';
+    int base = out.empty() ? 0 : out.back().line;
+    out.reserve(out.size() + b.size() * n + s.size() + 1);
+    for (size_t i = 0; i < n; i++)
+        for (Token t : b)
+        {
+            t.line += base + int(i) * bodyLines;
+            out.push_back(std::move(t));
+        }
+    int tail = base + int(n) * bodyLines;
+    for (Token t : s)
+    {
+        t.line += tail;
+        out.push_back(std::move(t));
+    }
+    out.push_back(Token{TokenType::T_EOF, "", tail + 1, 1});
+    return out;
+}
+
+// Generated programs are numbered copies of a function: in copy i an
+// identifier ending in FN names that copy's function, f<i> for FN itself
+// and <prefix><i> otherwise (stepFN becomes step<i>). In chained copies one
+// ending in FP names the previous copy's the same way.
+inline void numberPlaceholder(Token &t, size_t i, bool chained)
+{
+    const std::string &s = t.lexeme;
+    if (t.type != TokenType::T_IDENTIFIER || s.size() < 2)
+        return;
+    std::string tail = s.substr(s.size() - 2), prefix = s.substr(0, s.size() - 2);
+    if (tail == "FN" || (chained && tail == "FP"))
+        t.lexeme = (prefix.empty() ? "f" : prefix) + std::to_string(tail == "FN" ? i : i - 1);
+}
+
+// Appends copies first ... last - 1 of body to out, each on the lines after
+// the one before. Snippets are lexed once and copied, as the lexer is slow
+// on one long input.
+inline void appendCopies(std::vector<Token> &out, const std::vector<Token> &body, size_t first, size_t last,
+                         bool chained)
+{
+    out.reserve(out.size() + body.size() * (last - first));
+    int line = out.empty() ? 0 : out.back().line;
+    for (size_t i = first; i < last; i++)
+    {
+        for (Token t : body)
+        {
+            numberPlaceholder(t, i, chained);
+            t.line += line;
+            out.push_back(std::move(t));
+        }
+        line = out.empty() ? line : out.back().line;
+    }
+}
+
+// Copies 0 ... n - 1 of snippet.
+inline std::vector<Token> numberedCopies(const std::string &snippet, size_t n)
+{
+    std::vector<Token> out;
+    appendCopies(out, lexSnippet(snippet), 0, n, false);
+    return out;
+}
+
+// f0, adding its two int arguments, then copies 1 ... n - 1 of snippet in
+// which FP calls the copy before, so copy 1 calls f0.
+inline std::vector<Token> chainedCopies(const std::string &snippet, size_t n)
+{
+    std::vector<Token> out = lexSnippet("int f0(int a, int b) { return a + b; }\n");
+    appendCopies(out, lexSnippet(snippet), 1, std::max<size_t>(n, 1), true);
+    return out;
+}
+
+// `int main()` adding up what n numbered copies of callSnippet compute,
+// e.g. " total = total + FN(7, 5);\n" calls f0 ... f<n - 1> in turn, and
+// returning `result`.
+inline std::vector<Token> mainCalling(const std::string &callSnippet, size_t n,
+                                      const std::string &result = "total")
+{
+    std::vector<Token> out = lexSnippet("int main() { int total = 0;\n");
+    for (Token t : numberedCopies(callSnippet, n))
+    {
+        t.line += out.back().line;
+        out.push_back(std::move(t));
+    }
+    int line = out.back().line;
+    for (Token t : lexSnippet(" return " + result + "; }\n"))
+    {
+        t.line += line;
+        out.push_back(std::move(t));
+    }
+    return out;
+}
+
+// The parts one after another, each on the lines after the previous one,
+// and T_EOF.
+inline std::vector<Token> joinTokens(std::initializer_list<std::vector<Token>> parts)
+{
+    std::vector<Token> out;
+    for (const std::vector<Token> &part : parts)
+    {
+        int line = out.empty() ? 0 : out.back().line;
+        for (Token t : part)
+        {
+            t.line += line;
+            out.push_back(std::move(t));
+        }
+    }
+    out.push_back(Token{TokenType::T_EOF, "", out.empty() ? 1 : out.back().line + 1, 1});
+    return out;
+}
+
+inline std::string fmtBytes(size_t b)
+{
+    char buf[64];
+    if (b >= (1u << 20))
+        snprintf(buf, sizeof buf, "%.1f MiB", b / 1048576.0);
+    else
+        snprintf(buf, sizeof buf, "%.1f KiB", b / 1024.0);
+    return buf;
+}
+
+#endif
@@ -0,0 +1,144 @@
+// benchmarks/bench_diagnostics.cpp
+// Build: g++ -std=c++17 -O2 benchmarks/bench_diagnostics.cpp -o bench_diagnostics
+// ScopeChecker::analyse and TypeChecker::check on a program where every
+// function is riddled with errors, keeping the diagnostics as structured
+// records (all of them, or capped), or streaming them to a sink as they are
+// found (here one that only hashes the text, standing in for a file). Reports the heap the diagnostics hold once checking is
+// done and the time taken, next to the formatted TypeError list the type
+// checker used to keep. The streamed text must match the kept records, and
+// the cap (per checker) must not change how many errors are counted.
+// Usage: bench_diagnostics [functions] [cap]
+
+#define PARSER_REUSE_LEXER
+#include "../regex/regex_code.cpp"
+#include "../parser/parser.cpp"
+#define SCOPE_CHECKER_NO_MAIN
+#include "../parser/scope_checker.cpp"
+#define TYPE_CHECKER_NO_MAIN
+#include "../parser/type_checker.cpp"
+#include "bench_common.hpp"
+
+static vector<Token> brokenFunctions(size_t n)
+{
+    vector<Token> body = lexSnippet(
+        "int FN(int a, int b) { bool ok = a; int s = ok + missing_value; s = FP(s, ok, a); if (s) { s = nowhere(s); }\n"
+        " while (a) { s = s * ok; s = s << ok; ok = !a; } return ok; }\n");
+    vector<Token> out = lexSnippet("int f0(int a, int b) { return a + b; }\n");
+    int line = out.back().line;
+    for (size_t i = 1; i < n; i++)
+    {
+        for (Token t : body)
+        {
+            if (t.lexeme == "FN")
+                t.lexeme = "function_number_" + to_string(i);
+            else if (t.lexeme == "FP")
+                t.lexeme = i == 1 ? "f0" : "function_number_" + to_string(i - 1);
+            t.line += line;
+            out.push_back(move(t));
+        }
+        line = out.back().line;
+    }
+    out.push_back(Token{TokenType::T_EOF, "", line + 1, 1});
+    return out;
+}
+
+struct Run
+{
+    double ms = 1e300;
+    size_t heldBytes = 0, kept = 0, reported = 0;
+    // FNV-1a over the text that was streamed or kept, and its length
+    uint64_t hash = 1469598103934665603ull;
+    size_t bytes = 0;
+
+    void add(const string &line)
+    {
+        for (unsigned char c : line)
+            hash = (hash ^ c) * 1099511628211ull;
+        bytes += line.size();
+    }
+};
+
+// limit SIZE_MAX keeps everything; `stream` writes instead of keeping.
+static Run runCheckers(const Program &prog, size_t limit, bool stream)
+{
+    Run run;
+    for (int rep = 0; rep < 3; rep++)
+    {
+        run.hash = Run().hash;
+        run.bytes = 0;
+        size_t before = g_liveBytes.load();
+        BenchTimer t;
+        ScopeChecker sc;
+        TypeChecker tc;
+        sc.diagnostics().limit = tc.errors.limit = limit;
+        if (stream)
+        {
+            sc.diagnostics().sink = [&](const DiagnosticEngine::Record &r, const string &message)
+            { run.add(ScopeChecker::format(r, message) + "\n"); };
+            tc.errors.sink = [&](const DiagnosticEngine::Record &r, const string &message)
+            {
+                run.add(errorToString(TypeChkError(r.code)) + " " + to_string(r.line) + ":" + to_string(r.col) + " " +
+                        message + "\n");
+            };
+        }
+        sc.analyse(prog);
+        tc.check(prog);
+        run.ms = min(run.ms, t.ms());
+        run.heldBytes = g_liveBytes.load() - before;
+        run.kept = sc.errorCount() + tc.errorCount();
+        run.reported = sc.diagnostics().reported() + tc.errors.reported();
+        for (size_t i = 0; i < sc.errorCount(); i++)
+            run.add(sc.formatError(i) + "\n");
+        for (size_t i = 0; i < tc.errorCount(); i++)
+        {
+            TypeError e = tc.error(i);
+            run.add(errorToString(e.type) + " " + to_string(e.line) + ":" + to_string(e.col) + " " + e.detail + "\n");
+        }
+    }
+    return run;
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = argc > 1 ? stoul(argv[1]) : 20000;
+    size_t cap = argc > 2 ? stoul(argv[2]) : 100;
+    Program prog;
+    {
+        Parser parser(brokenFunctions(n));
+        prog = parser.parseProgram();
+    }
+
+    // The previous storage: every type error as a TypeError with its text.
+    size_t listBytes;
+    {
+        TypeChecker tc;
+        tc.check(prog);
+        size_t before = g_liveBytes.load();
+        vector<TypeError> list;
+        for (size_t i = 0; i < tc.errorCount(); i++)
+            list.push_back(tc.error(i));
+        listBytes = g_liveBytes.load() - before;
+    }
+
+    // What the checkers hold with no diagnostics at all (interned names and
+    // the like) is subtracted from the others.
+    Run none = runCheckers(prog, 0, false);
+    Run all = runCheckers(prog, SIZE_MAX, false);
+    Run capped = runCheckers(prog, cap, false);
+    Run streamed = runCheckers(prog, SIZE_MAX, true);
+    for (Run *r : {&all, &capped, &streamed})
+        r->heldBytes -= min(r->heldBytes, none.heldBytes);
+    if (streamed.hash != all.hash || capped.kept > 2 * cap || capped.reported != all.reported)
+    {
+        cout << "MISMATCH: streamed or capped diagnostics differ from the kept ones\n";
+        return 1;
+    }
+    cout << "functions: " << n << "  diagnostics: " << all.reported << "\n";
+    cout << "formatted TypeError list    " << fmtBytes(listBytes) << " for the type errors alone\n";
+    cout << "records, all kept           " << fmtBytes(all.heldBytes) << " held, " << all.ms << " ms\n";
+    cout << "records, capped at " << cap << "       " << fmtBytes(capped.heldBytes) << " held, " << capped.ms << " ms ("
+         << capped.kept << " kept of " << capped.reported << ")\n";
+    cout << "streamed as found           " << fmtBytes(streamed.heldBytes) << " held, " << streamed.ms << " ms ("
+         << streamed.bytes / 1024 << " KB written)\n";
+    return 0;
+}
@@ -0,0 +1,258 @@
+// benchmarks/bench_flat_ast.cpp
+// Build: g++ -std=c++17 -O2 benchmarks/bench_flat_ast.cpp -o bench_flat_ast
+// Memory and full-walk time of the pointer AST versus the flat pooled AST
+// (parser/flat_ast.cpp) on a large synthetic program.
+
+#define PARSER_REUSE_LEXER
+#include "../regex/regex_code.cpp"
+#include "../parser/parser.cpp"
+#include "../parser/flat_ast.cpp"
+#include "bench_common.hpp"
+
+// Both walkers visit every node and fold its position into a checksum so
+// the compiler cannot drop the traversal.
+struct WalkStats
+{
+    size_t nodes = 0;
+    size_t sum = 0;
+    void visit(int line, int col)
+    {
+        nodes++;
+        sum = sum * 31 + size_t(line) + size_t(col);
+    }
+};
+
+// ---------- Pointer AST walk (same dispatch style as the checkers) ----------
+static void walkExpr(const ExprPtr &e, WalkStats &w);
+static void walkStmt(const StmtPtr &s, WalkStats &w);
+
+static void walkExpr(const ExprPtr &e, WalkStats &w)
+{
+    if (!e)
+        return;
+    w.visit(e->line, e->col);
+    if (auto n = dynamic_pointer_cast<BinaryExpr>(e))
+    {
+        walkExpr(n->lhs, w);
+        walkExpr(n->rhs, w);
+    }
+    else if (auto n = dynamic_pointer_cast<UnaryExpr>(e))
+        walkExpr(n->rhs, w);
+    else if (auto n = dynamic_pointer_cast<PostfixExpr>(e))
+        walkExpr(n->expr, w);
+    else if (auto n = dynamic_pointer_cast<CallExpr>(e))
+    {
+        if (n->name.empty())
+            walkExpr(n->callee, w);
+        for (auto &a : n->args)
+            walkExpr(a, w);
+    }
+    else if (auto n = dynamic_pointer_cast<IndexExpr>(e))
+    {
+        walkExpr(n->base, w);
+        walkExpr(n->index, w);
+    }
+}
+
+static void walkStmt(const StmtPtr &s, WalkStats &w)
+{
+    if (!s)
+        return;
+    w.visit(s->line, s->col);
+    if (auto n = dynamic_pointer_cast<ExprStmt>(s))
+        walkExpr(n->expr, w);
+    else if (auto n = dynamic_pointer_cast<VarDeclStmt>(s))
+        walkExpr(n->init, w);
+    else if (auto n = dynamic_pointer_cast<ReturnStmt>(s))
+        walkExpr(n->expr, w);
+    else if (auto n = dynamic_pointer_cast<BlockStmt>(s))
+    {
+        for (auto &c : n->stmts)
+            walkStmt(c, w);
+    }
+    else if (auto n = dynamic_pointer_cast<IfStmt>(s))
+    {
+        walkExpr(n->cond, w);
+        walkStmt(n->thenStmt, w);
+        walkStmt(n->elseStmt, w);
+    }
+    else if (auto n = dynamic_pointer_cast<WhileStmt>(s))
+    {
+        walkExpr(n->cond, w);
+        walkStmt(n->body, w);
+    }
+    else if (auto n = dynamic_pointer_cast<DoWhileStmt>(s))
+    {
+        walkStmt(n->body, w);
+        walkExpr(n->cond, w);
+    }
+    else if (auto n = dynamic_pointer_cast<ForStmt>(s))
+    {
+        walkExpr(n->init, w);
+        walkExpr(n->cond, w);
+        walkExpr(n->post, w);
+        walkStmt(n->body, w);
+    }
+}
+
+static void walkProgram(const Program &prog, WalkStats &w)
+{
+    for (auto &it : prog.items)
+    {
+        if (auto fn = dynamic_pointer_cast<FnDecl>(it))
+        {
+            w.visit(fn->line, fn->col);
+            for (auto &s : fn->body)
+                walkStmt(s, w);
+        }
+        else if (auto s = dynamic_pointer_cast<Stmt>(it))
+            walkStmt(s, w);
+    }
+}
+
+// ---------- Flat AST walk ----------
+static void flatExpr(const FlatAST &f, uint32_t id, WalkStats &w)
+{
+    if (id == FlatAST::NONE)
+        return;
+    const FlatAST::Expr &e = f.exprs[id];
+    w.visit(e.line, e.col);
+    switch (e.kind)
+    {
+    case FlatKind::Binary:
+    case FlatKind::Index:
+        flatExpr(f, e.a, w);
+        flatExpr(f, e.b, w);
+        break;
+    case FlatKind::Unary:
+    case FlatKind::Postfix:
+        flatExpr(f, e.a, w);
+        break;
+    case FlatKind::Call:
+    {
+        const uint32_t *args = f.list(e.a);
+        if (e.text == FlatAST::NONE)
+            flatExpr(f, args[-1], w);
+        for (uint32_t i = 0; i < e.b; i++)
+            flatExpr(f, args[i], w);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+static void flatStmt(const FlatAST &f, uint32_t id, WalkStats &w)
+{
+    if (id == FlatAST::NONE)
+        return;
+    const FlatAST::Stmt &s = f.stmts[id];
+    w.visit(s.line, s.col);
+    switch (s.kind)
+    {
+    case FlatKind::ExprS:
+    case FlatKind::VarDecl:
+    case FlatKind::Return:
+        flatExpr(f, s.a, w);
+        break;
+    case FlatKind::Block:
+    {
+        const uint32_t *body = f.list(s.a);
+        for (uint32_t i = 0; i < s.b; i++)
+            flatStmt(f, body[i], w);
+        break;
+    }
+    case FlatKind::If:
+        flatExpr(f, s.a, w);
+        flatStmt(f, s.b, w);
+        flatStmt(f, s.c, w);
+        break;
+    case FlatKind::While:
+        flatExpr(f, s.a, w);
+        flatStmt(f, s.b, w);
+        break;
+    case FlatKind::DoWhile:
+        flatStmt(f, s.a, w);
+        flatExpr(f, s.b, w);
+        break;
+    case FlatKind::For:
+        flatExpr(f, s.a, w);
+        flatExpr(f, s.b, w);
+        flatExpr(f, s.c, w);
+        flatStmt(f, s.d, w);
+        break;
+    default:
+        break;
+    }
+}
+
+static void walkFlat(const FlatAST &f, WalkStats &w)
+{
+    const uint32_t *items = f.list(f.itemsBegin);
+    for (uint32_t i = 0; i < f.itemsCount; i++)
+    {
+        if (items[i] & FlatAST::FN_BIT)
+        {
+            const FlatAST::Fn &fn = f.fns[items[i] & ~FlatAST::FN_BIT];
+            w.visit(fn.line, fn.col);
+            const uint32_t *body = f.list(fn.bodyBegin);
+            for (uint32_t j = 0; j < fn.bodyCount; j++)
+                flatStmt(f, body[j], w);
+        }
+        else
+            flatStmt(f, items[i], w);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    // Each copy of the body is 4 statements: a block, two expression
+    // statements inside it and an if.
+    size_t stmts = argc > 1 ? stoul(argv[1]) : 1000000;
+    size_t n = stmts / 4;
+    size_t before = g_liveBytes; // tokens are freed before the AST is measured
+    auto tokens = repeatTokens("int main() { int a = 1; int b = 2; int x = 0;",
+                               "{ x = a + b * 2; foo(x, a - 1); }\nif (x > b) x = x - 1;\n", n,
+                               "return x; }");
+    cout << "statements: " << n * 4 << "  tokens: " << tokens.size() << "\n";
+
+    size_t allocsBefore = g_totalAllocs;
+    BenchTimer parseTimer;
+    Program prog;
+    {
+        Parser parser(move(tokens));
+        prog = parser.parseProgram();
+    }
+    double parseMs = parseTimer.ms();
+    size_t ptrBytes = g_liveBytes - before;
+    size_t ptrAllocs = g_totalAllocs - allocsBefore;
+
+    WalkStats pw;
+    double ptrWalk = bestOf(5, [&] { pw = WalkStats(); walkProgram(prog, pw); });
+
+    BenchTimer flatTimer;
+    before = g_liveBytes;
+    allocsBefore = g_totalAllocs;
+    FlatAST flat = FlatAST::build(prog);
+    double buildMs = flatTimer.ms();
+    size_t flatBytes = g_liveBytes - before;
+    size_t flatAllocs = g_totalAllocs - allocsBefore;
+
+    WalkStats fw;
+    double flatWalk = bestOf(5, [&] { fw = WalkStats(); walkFlat(flat, fw); });
+
+    if (pw.nodes != fw.nodes || pw.sum != fw.sum)
+    {
+        cout << "MISMATCH: pointer walk " << pw.nodes << " nodes, flat walk " << fw.nodes << " nodes\n";
+        return 1;
+    }
+
+    cout << "nodes visited: " << pw.nodes << "\n";
+    cout << "pointer AST  parse " << parseMs << " ms, live " << fmtBytes(ptrBytes)
+         << " (" << ptrAllocs << " allocations), walk " << ptrWalk << " ms\n";
+    cout << "flat AST     build " << buildMs << " ms, live " << fmtBytes(flatBytes)
+         << " (" << flatAllocs << " allocations incl. build scratch), walk " << flatWalk << " ms\n";
+    cout << "pools: " << flat.exprs.size() << " exprs, " << flat.stmts.size() << " stmts, "
+         << flat.lists.size() << " list slots, " << flat.strings.size() << " strings\n";
+    return 0;
+}
@@ -0,0 +1,36 @@
+// benchmarks/bench_hash_cons.cpp
+// Build: g++ -std=c++17 -O2 benchmarks/bench_hash_cons.cpp -o bench_hash_cons
+// AST memory and parse time with and without hash-consing of pure expressions.
+
+#define PARSER_REUSE_LEXER
+#include "../regex/regex_code.cpp"
+#include "../parser/parser.cpp"
+#include "bench_common.hpp"
+
+int main(int argc, char **argv)
+{
+    size_t n = argc > 1 ? stoul(argv[1]) : 200000;
+    auto tokens = repeatTokens("int main() { int a = 1; int b = 2; int c = 3; int x;",
+                               "x = a + (b * c) + foo(a + (b * c), 4 * 2);\n", n,
+                               "return x; }");
+    cout << "statements: " << n << "  tokens: " << tokens.size() << "\n";
+
+    for (bool cons : {false, true})
+    {
+        size_t before = g_liveBytes;
+        ExprInterner interner;
+        BenchTimer t;
+        Parser parser(tokens, cons ? &interner : nullptr);
+        Program prog = parser.parseProgram();
+        double ms = t.ms();
+        parser.ts.tokens.clear();
+        parser.ts.tokens.shrink_to_fit();
+        size_t live = g_liveBytes - before;
+        cout << (cons ? "hash-consed " : "plain       ")
+             << " parse " << ms << " ms, live AST " << fmtBytes(live);
+        if (cons)
+            cout << ", interned " << interner.requests << " nodes, reused " << interner.reused;
+        cout << "\n";
+    }
+    return 0;
+}
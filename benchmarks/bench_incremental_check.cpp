@@ -0,0 +1,180 @@
+// benchmarks/bench_incremental_check.cpp
+// Build: g++ -std=c++17 -O2 benchmarks/bench_incremental_check.cpp -o bench_incremental_check
+// IncrementalChecker::update after single-function edits to a program of
+// many functions, against ScopeChecker::analyse + TypeChecker::check on the
+// whole edited program. Function i calls f<i-1>. The edited function is
+// re-parsed on its own and swapped into the program, as an editor would.
+// Every update must report exactly the from-scratch diagnostics.
+// Usage: bench_incremental_check [functions] [edits per kind]
+
+#define PARSER_REUSE_LEXER
+#include "../regex/regex_code.cpp"
+#include "../parser/parser.cpp"
+#define INCREMENTAL_CHECKER_NO_MAIN
+#include "../parser/incremental_checker.cpp"
+#include "bench_common.hpp"
+
+static vector<Token> good, bad;
+
+// Tokens of function i, starting on line `line`.
+static vector<Token> functionTokens(size_t i, int line)
+{
+    vector<Token> out;
+    for (Token t : i % 10 == 0 ? bad : good)
+    {
+        if (t.lexeme == "FN")
+            t.lexeme = "f" + to_string(i);
+        else if (t.lexeme == "FP")
+            t.lexeme = "f" + to_string(i - 1);
+        t.line += line;
+        out.push_back(move(t));
+    }
+    return out;
+}
+
+static shared_ptr<ASTNode> parseItem(vector<Token> toks)
+{
+    toks.push_back(Token{TokenType::T_EOF, "", toks.back().line + 1, 1});
+    Parser parser(move(toks));
+    return parser.parseProgram().items.at(0);
+}
+
+static vector<string> typeStrings(const vector<TypeError> &errors)
+{
+    vector<string> out;
+    for (auto &e : errors)
+        out.push_back(errorToString(e.type) + " " + to_string(e.line) + ":" + to_string(e.col) + " " + e.detail);
+    return out;
+}
+
+// Checks the program from scratch; false if the incremental result differs.
+static bool matchesScratch(const Program &prog, const IncrementalChecker &inc, double &ms)
+{
+    BenchTimer t;
+    ScopeChecker sc;
+    sc.analyse(prog);
+    TypeChecker tc;
+    tc.check(prog);
+    ms = t.ms();
+    vector<string> scope;
+    for (size_t i = 0; i < sc.errorCount(); i++)
+        scope.push_back(sc.formatError(i));
+    vector<TypeError> types;
+    for (size_t i = 0; i < tc.errorCount(); i++)
+        types.push_back(tc.error(i));
+    return scope == inc.scopeDiagnostics() && typeStrings(types) == typeStrings(inc.typeDiagnostics());
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = argc > 1 ? stoul(argv[1]) : 10000;
+    size_t edits = argc > 2 ? stoul(argv[2]) : 20;
+    good = lexSnippet(
+        "int FN(int p, int q) { int s = 0; int i; for (i = 0; i < p; i = i + 1) { s = s + q * g; }\n"
+        " if (s > 100) { int t = s - FP(s, p); s = t; } while (s < q) { s = s + 1; } return s + p; }\n");
+    bad = lexSnippet(
+        "int FN(int p, int q) { int s = missing + p; bool b = s; if (s) { s = FP(s, p, q); } return b; }\n");
+
+    Program prog;
+    vector<Token> all = lexSnippet("int g = 3;\nint f0(int p, int q) { return p + q; }\n");
+    vector<int> startLine(n);
+    for (size_t i = 1; i < n; i++)
+    {
+        startLine[i] = all.back().line;
+        vector<Token> fn = functionTokens(i, startLine[i]);
+        all.insert(all.end(), fn.begin(), fn.end());
+    }
+    all.push_back(Token{TokenType::T_EOF, "", all.back().line + 1, 1});
+    {
+        Parser parser(all);
+        prog = parser.parseProgram();
+    }
+
+    IncrementalChecker inc;
+    BenchTimer cold;
+    inc.update(prog);
+    double coldMs = cold.ms(), scratchMs = 0;
+    if (!matchesScratch(prog, inc, scratchMs))
+    {
+        cout << "MISMATCH after the initial check\n";
+        return 1;
+    }
+    cout << "functions: " << n << "  first update " << coldMs << " ms, from scratch " << scratchMs << " ms\n";
+
+    // item k + 1 is f<k>
+    auto bodyEdit = [&](size_t k, size_t round)
+    {
+        vector<Token> toks = functionTokens(k, startLine[k]);
+        for (auto &t : toks)
+            if (t.lexeme == "q" && round % 2 == 0)
+            {
+                t.lexeme = "missing";
+                break;
+            }
+        prog.items[k + 1] = parseItem(toks);
+    };
+    auto signatureEdit = [&](size_t k, size_t round)
+    {
+        vector<Token> toks = functionTokens(k, startLine[k]);
+        if (round % 2 == 0)
+            for (size_t j = 0; j + 1 < toks.size(); j++)
+                if (toks[j + 1].lexeme == "q")
+                {
+                    toks[j].type = TokenType::T_BOOL;
+                    toks[j].lexeme = "bool";
+                    break;
+                }
+        prog.items[k + 1] = parseItem(toks);
+    };
+    auto appendEdit = [&](size_t, size_t round)
+    {
+        if (round % 2 == 0)
+            prog.items.push_back(parseItem(functionTokens(n + round, all.back().line)));
+        else
+            prog.items.pop_back();
+    };
+    auto insertEdit = [&](size_t k, size_t round)
+    {
+        if (round % 2 == 0)
+            prog.items.insert(prog.items.begin() + k + 1, parseItem(lexSnippet("int h(int p) { return p; }\n")));
+        else
+            prog.items.erase(prog.items.begin() + k + 1);
+    };
+
+    struct Kind
+    {
+        const char *name;
+        function<void(size_t, size_t)> apply;
+    };
+    vector<Kind> kinds = {{"body edit", bodyEdit},
+                          {"signature edit", signatureEdit},
+                          {"append function", appendEdit},
+                          {"insert in middle", insertEdit}};
+    for (auto &kind : kinds)
+    {
+        double totalMs = 0, worstMs = 0, scratchTotal = 0;
+        size_t rechecked = 0;
+        for (size_t r = 0; r < edits; r++)
+        {
+            size_t k = 1 + (r / 2 * 7919) % (n - 2);
+            kind.apply(k, r);
+            BenchTimer t;
+            auto stats = inc.update(prog);
+            double ms = t.ms();
+            totalMs += ms;
+            worstMs = max(worstMs, ms);
+            rechecked += stats.rechecked;
+            double s;
+            if (!matchesScratch(prog, inc, s))
+            {
+                cout << "MISMATCH after " << kind.name << " " << r << "\n";
+                return 1;
+            }
+            scratchTotal += s;
+        }
+        cout << kind.name << ": " << totalMs / edits << " ms avg, " << worstMs << " ms worst, "
+             << double(rechecked) / edits << " items re-checked  (from scratch " << scratchTotal / edits << " ms, x"
+             << scratchTotal / totalMs << ")\n";
+    }
+    return 0;
+}
@@ -0,0 +1,86 @@
+// benchmarks/bench_inline.cpp
+// Build: g++ -std=c++17 -O2 benchmarks/bench_inline.cpp -o bench_inline
+// Inlining (parser/ir_inline.cpp) on generated code that calls tiny
+// helpers, such as `int print(int x) { return x; }`, from loops, and a
+// larger step function from one place each. The full optimizer is run
+// without inlining, inlining small callees only, and inlining only call
+// sites as well; for each, the call sites inlined, functions removed, the
+// IR size, and main() run on the IR interpreter (instructions and calls
+// executed, and time). Every variant must return the same result.
+// Usage: bench_inline [functions] [trip count]
+
+#define PARSER_REUSE_LEXER
+#include "../regex/regex_code.cpp"
+#include "../parser/parser.cpp"
+#define IR_OPTIMIZER_NO_MAIN
+#include "../parser/ir_optimizer.cpp"
+#include "bench_common.hpp"
+
+static vector<Token> program(size_t n, int trips)
+{
+    string body =
+        "int stepFN(int s, int i, int k) { int t = s + sq(i) - k * i; if (t > 100000) { t = t - 99991; }\n"
+        " if (t < 0 - 100000) { t = t + 99991; } return clamp(t, 0 - 50000, 50000) + print(i); }\n"
+        "int FN(int n, int k) { int s = 0; int i = 0;\n"
+        " while (i < n) { s = stepFN(s, i, k) + sq(k) - print(k); i = i + 1; }\n"
+        " return print(s); }\n";
+    string prelude = "int print(int x) { return x; }\n"
+                     "int sq(int x) { return x * x; }\n"
+                     "int clamp(int x, int lo, int hi) { if (x < lo) { return lo; } if (x > hi) { return hi; } return x; }\n";
+    string call = " total = total + FN(" + to_string(trips) + ", 3);\n";
+    return joinTokens({lexSnippet(prelude), numberedCopies(body, n), mainCalling(call, n)});
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = argc > 1 ? stoul(argv[1]) : 200;
+    int trips = argc > 2 ? stoi(argv[2]) : 500;
+    Program prog;
+    {
+        Parser parser(program(n, trips));
+        prog = parser.parseProgram();
+    }
+    TypeChecker checker;
+    checker.check(prog);
+    ScopeChecker resolver;
+    resolver.analyse(prog);
+
+    OptimizerOptions none, small, all;
+    none.inlining = false;
+    small.inliner.singleCallSite = false;
+    struct Variant
+    {
+        string name;
+        OptimizerOptions options;
+    };
+    vector<Variant> variants = {{"no inlining", none}, {"small callees", small}, {"+ only call sites", all}};
+
+    string expected;
+    bool same = true;
+    for (const Variant &v : variants)
+    {
+        IRGenerator gen;
+        gen.generateIR(prog);
+        IRProgram &ir = gen.program();
+        BenchTimer t;
+        OptimizerReport report = optimizeIR(ir, v.options);
+        double optMs = t.ms();
+        IRInterpreter interpreter(ir);
+        string result;
+        double runMs = bestOf(3, [&] { result = interpreter.text(interpreter.run()); });
+        if (expected.empty())
+            expected = result;
+        same = same && result == expected;
+        cout << v.name << ": " << report.inlining.inlined.size() << " of " << report.inlining.sites
+             << " call sites inlined, " << report.inlining.removed << " functions removed, " << report.after
+             << " instructions (optimized in " << optMs << " ms)\n";
+        cout << "    main() = " << result << ", " << interpreter.steps << " instructions and " << interpreter.calls
+             << " calls executed in " << runMs << " ms\n";
+    }
+    if (!same)
+    {
+        cout << "MISMATCH: optimized IR computes a different result\n";
+        return 1;
+    }
+    return 0;
+}
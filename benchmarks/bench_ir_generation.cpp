@@ -0,0 +1,257 @@
+// benchmarks/bench_ir_generation.cpp
+// Build: g++ -std=c++17 -O2 benchmarks/bench_ir_generation.cpp -o bench_ir_generation
+// IR generation throughput and memory for a large type-checked program:
+// IRGenerator with its compact IR (tagged 32-bit operands, 16-byte
+// instructions) against the string-operand IR it replaced, reproduced
+// below. Both must print the same three-address code.
+// Usage: bench_ir_generation [functions]
+
+#define PARSER_REUSE_LEXER
+#include "../regex/regex_code.cpp"
+#include "../parser/parser.cpp"
+#define IR_GENERATOR_NO_MAIN
+#include "../parser/irGenerator.cpp"
+#include "bench_common.hpp"
+
+// The previous IR: every operand a string, temps named "t<n>" as they are
+// made. Only the constructs the input below uses are lowered.
+struct StringInstruction
+{
+    IROp op;
+    string result, arg1, arg2;
+    int line;
+    ValueType type;
+};
+
+class StringIRGenerator
+{
+public:
+    vector<StringInstruction> code;
+
+    void generate(const Program &prog)
+    {
+        code.clear();
+        temps = labels = 0;
+        for (const auto &item : prog.items)
+            if (auto fn = dynamic_pointer_cast<FnDecl>(item))
+            {
+                emit(IROp::LABEL, "func_" + fn->name, "", "", fn->line);
+                for (const auto &param : fn->params)
+                    emit(IROp::PARAM, param.second, "", "", fn->line);
+                for (const auto &stmt : fn->body)
+                    statement(stmt);
+            }
+            else if (auto var = dynamic_pointer_cast<VarDeclStmt>(item))
+            {
+                if (var->init)
+                {
+                    string v = expression(var->init);
+                    emit(IROp::ASSIGN, var->name, v, "", var->line);
+                }
+            }
+    }
+
+    string format(const StringInstruction &i) const
+    {
+        static const char *ops[] = {"", "+", "-", "*", "/", "==", "!=", "<", "<=", ">", ">="};
+        static const char suffix[] = {0, 'i', 'f', 'b', 's', 'c'};
+        switch (i.op)
+        {
+        case IROp::ASSIGN:
+            return i.result + " = " + i.arg1;
+        case IROp::JUMP:
+            return "goto " + i.result;
+        case IROp::JUMP_FALSE:
+            return "ifFalse " + i.arg1 + " goto " + i.result;
+        case IROp::CALL:
+            return i.result + " = call " + i.arg1;
+        case IROp::RET:
+            return i.result.empty() ? "return" : "return " + i.result;
+        case IROp::PARAM:
+            return "param " + i.result;
+        case IROp::LABEL:
+            return i.result + ":";
+        default:
+        {
+            string op = ops[int(i.op)];
+            if (suffix[int(i.type)])
+                op += suffix[int(i.type)];
+            return i.result + " = " + i.arg1 + " " + op + " " + i.arg2;
+        }
+        }
+    }
+
+private:
+    int temps = 0, labels = 0;
+
+    string newTemp() { return "t" + to_string(temps++); }
+    string newLabel() { return "L" + to_string(labels++); }
+    void emit(IROp op, const string &r, const string &a, const string &b, int line, ValueType t = ValueType::Unknown)
+    {
+        code.push_back(StringInstruction{op, r, a, b, line, t});
+    }
+
+    void statement(const shared_ptr<Stmt> &s)
+    {
+        if (auto e = dynamic_pointer_cast<ExprStmt>(s))
+            expression(e->expr);
+        else if (auto v = dynamic_pointer_cast<VarDeclStmt>(s))
+        {
+            if (v->init)
+            {
+                string init = expression(v->init);
+                emit(IROp::ASSIGN, v->name, init, "", v->line);
+            }
+        }
+        else if (auto r = dynamic_pointer_cast<ReturnStmt>(s))
+        {
+            string val = r->expr ? expression(r->expr) : "";
+            emit(IROp::RET, val, "", "", r->line);
+        }
+        else if (auto b = dynamic_pointer_cast<BlockStmt>(s))
+        {
+            for (auto &st : b->stmts)
+                statement(st);
+        }
+        else if (auto w = dynamic_pointer_cast<WhileStmt>(s))
+        {
+            string start = newLabel(), body = newLabel(), end = newLabel();
+            emit(IROp::LABEL, start, "", "", w->line);
+            string cond = expression(w->cond);
+            emit(IROp::JUMP_FALSE, end, cond, "", w->line);
+            emit(IROp::JUMP, body, "", "", w->line);
+            emit(IROp::LABEL, body, "", "", w->line);
+            statement(w->body);
+            emit(IROp::JUMP, start, "", "", w->line);
+            emit(IROp::LABEL, end, "", "", w->line);
+        }
+        else if (auto i = dynamic_pointer_cast<IfStmt>(s))
+        {
+            string cond = expression(i->cond);
+            string t = newLabel(), f = newLabel(), end = newLabel();
+            emit(IROp::JUMP_FALSE, f, cond, "", i->line);
+            emit(IROp::JUMP, t, "", "", i->line);
+            emit(IROp::LABEL, t, "", "", i->line);
+            statement(i->thenStmt);
+            if (i->elseStmt)
+                emit(IROp::JUMP, end, "", "", i->line);
+            emit(IROp::LABEL, f, "", "", i->line);
+            if (i->elseStmt)
+            {
+                statement(i->elseStmt);
+                emit(IROp::LABEL, end, "", "", i->line);
+            }
+        }
+    }
+
+    string expression(const shared_ptr<Expr> &e)
+    {
+        if (auto lit = dynamic_pointer_cast<IntLiteral>(e))
+        {
+            string t = newTemp();
+            emit(IROp::ASSIGN, t, lit->val, "", e->line);
+            return t;
+        }
+        if (auto id = dynamic_pointer_cast<IdentifierExpr>(e))
+            return id->name;
+        if (auto bin = dynamic_pointer_cast<BinaryExpr>(e))
+        {
+            string lhs = expression(bin->lhs), rhs = expression(bin->rhs);
+            string t = newTemp();
+            if (bin->op == "=")
+            {
+                emit(IROp::ASSIGN, lhs, rhs, "", e->line);
+                return lhs;
+            }
+            static const pair<const char *, IROp> ops[] = {
+                {"+", IROp::ADD}, {"-", IROp::SUB}, {"*", IROp::MUL}, {"/", IROp::DIV}, {"==", IROp::EQ}, {"!=", IROp::NE}, {"<", IROp::LT}, {"<=", IROp::LE}, {">", IROp::GT}, {">=", IROp::GE}};
+            for (auto &op : ops)
+                if (bin->op == op.first)
+                    emit(op.second, t, lhs, rhs, e->line, bin->lhs->type);
+            return t;
+        }
+        if (auto call = dynamic_pointer_cast<CallExpr>(e))
+        {
+            for (auto &arg : call->args)
+            {
+                string a = expression(arg);
+                emit(IROp::PARAM, a, "", "", e->line);
+            }
+            string t = newTemp();
+            emit(IROp::CALL, t, call->name, "", e->line);
+            return t;
+        }
+        return "";
+    }
+};
+
+static vector<Token> program(size_t n)
+{
+    string body =
+        "int FN(int a, int b) { int s = a + b * 3; int i = 0;\n"
+        " while (i < a) { s = s + i * b - 7; if (s > 1000) { s = s / 2; } else { s = s + FP(i, s); } i = i + 1; }\n"
+        " int u = s * s - a * b + 42; return u + s; }\n";
+    return joinTokens({chainedCopies(body, n)});
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = argc > 1 ? stoul(argv[1]) : 20000;
+    Program prog;
+    {
+        Parser parser(program(n));
+        prog = parser.parseProgram();
+    }
+    TypeChecker checker;
+    checker.check(prog);
+    ScopeChecker resolver;
+    resolver.analyse(prog);
+
+    size_t stringBytes = 0, compactBytes = 0, instructions = 0;
+    double stringMs = 1e300, compactMs = 1e300;
+    string stringText, compactText;
+    for (int rep = 0; rep < 5; rep++)
+    {
+        {
+            size_t before = g_liveBytes;
+            BenchTimer t;
+            StringIRGenerator gen;
+            gen.generate(prog);
+            stringMs = min(stringMs, t.ms());
+            stringBytes = g_liveBytes - before;
+            if (rep == 0)
+            {
+                stringText = "=== THREE-ADDRESS CODE IR ===\n";
+                for (auto &i : gen.code)
+                    stringText += gen.format(i) + "\n";
+            }
+        }
+        {
+            size_t before = g_liveBytes;
+            BenchTimer t;
+            IRGenerator gen;
+            const IRProgram &ir = gen.generateIR(prog);
+            compactMs = min(compactMs, t.ms());
+            compactBytes = g_liveBytes - before;
+            instructions = ir.code.size();
+            if (rep == 0)
+            {
+                ostringstream os;
+                gen.printIR(os);
+                compactText = os.str();
+            }
+        }
+    }
+    if (stringText != compactText)
+    {
+        cout << "MISMATCH: the two IRs print differently\n";
+        return 1;
+    }
+    cout << "functions: " << n << "  instructions: " << instructions << " (identical text)\n";
+    cout << "string operands   " << stringMs << " ms, " << fmtBytes(stringBytes) << " ("
+         << sizeof(StringInstruction) << " bytes/instruction + strings)\n";
+    cout << "compact operands  " << compactMs << " ms, " << fmtBytes(compactBytes) << " ("
+         << sizeof(IRInstruction) << " bytes/instruction), x" << stringMs / compactMs << " faster, "
+         << double(stringBytes) / compactBytes << "x less memory\n";
+    return 0;
+}
@@ -0,0 +1,104 @@
+// benchmarks/bench_ir_optimize.cpp
+// Build: g++ -std=c++17 -O2 benchmarks/bench_ir_optimize.cpp -o bench_ir_optimize
+// The IR optimization stage (parser/ir_optimizer.cpp) on a generated
+// program, pass by pass: constant propagation alone, then adding copy
+// propagation, value numbering, loop optimization, dead code elimination
+// and CFG simplification. For each, the IR size, the time the stage takes,
+// and main() run on the IR interpreter (instructions executed and time).
+// Every variant must return what the unoptimized IR returns.
+// Usage: bench_ir_optimize [functions]
+
+#define PARSER_REUSE_LEXER
+#include "../regex/regex_code.cpp"
+#include "../parser/parser.cpp"
+#define IR_OPTIMIZER_NO_MAIN
+#include "../parser/ir_optimizer.cpp"
+#include "bench_common.hpp"
+
+// Literals, copies through locals, postfix updates whose value is unused,
+// and a loop nest, as lowered code usually has them.
+static vector<Token> program(size_t n)
+{
+    string body =
+        "int FN(int a, int b) { int step = 2; int base = 10 * step; int s = base; int i = 0; int last = 0;\n"
+        " while (i < a) { int j = 0; int t = s; while (j < b) { t = t + j * step; last = j; j++; } s = t - base; i++; }\n"
+        " int unused = s * 3 + last; bool big = s > 1000; if (big) { s = s / 2; } return s + last; }\n";
+    vector<Token> out = joinTokens({numberedCopies(body, n), mainCalling(" total = total + FN(A, 4);\n", n)});
+    // f<i> is called with 3 + i % 5 trips of the outer loop
+    size_t call = 0;
+    for (Token &t : out)
+        if (t.lexeme == "A")
+        {
+            t.type = TokenType::T_INTLIT;
+            t.lexeme = to_string(3 + call++ % 5);
+        }
+    return out;
+}
+
+struct Variant
+{
+    string name;
+    OptimizerOptions options;
+    bool optimize = true;
+};
+
+int main(int argc, char **argv)
+{
+    size_t n = argc > 1 ? stoul(argv[1]) : 5000;
+    Program prog;
+    {
+        Parser parser(program(n));
+        prog = parser.parseProgram();
+    }
+    TypeChecker checker;
+    checker.check(prog);
+    ScopeChecker resolver;
+    resolver.analyse(prog);
+
+    OptimizerOptions sccp, copies, values, loops, dce, all;
+    sccp.copies = sccp.values = sccp.loops = sccp.deadCode = sccp.simplifyCFG = false;
+    copies.values = copies.loops = copies.deadCode = copies.simplifyCFG = false;
+    values.loops = values.deadCode = values.simplifyCFG = false;
+    loops.deadCode = loops.simplifyCFG = false;
+    dce.simplifyCFG = false;
+    vector<Variant> variants = {{"as generated", {}, false},
+                                {"constants", sccp},
+                                {"+ copy propagation", copies},
+                                {"+ value numbering", values},
+                                {"+ loop optimization", loops},
+                                {"+ dead code elimination", dce},
+                                {"+ CFG simplification", all}};
+
+    string expected;
+    bool same = true;
+    for (const Variant &v : variants)
+    {
+        IRGenerator gen;
+        gen.generateIR(prog);
+        IRProgram &ir = gen.program();
+        double optMs = 0;
+        if (v.optimize)
+        {
+            BenchTimer t;
+            optimizeIR(ir, v.options);
+            optMs = t.ms();
+        }
+        IRInterpreter interpreter(ir);
+        string result;
+        double runMs = bestOf(3, [&] { result = interpreter.text(interpreter.run()); });
+        if (expected.empty())
+            expected = result;
+        same = same && result == expected;
+        cout << v.name << ": " << ir.code.size() << " instructions";
+        if (v.optimize)
+            cout << " (optimized in " << optMs << " ms)";
+        cout << "\n    main() = " << result << ", " << interpreter.steps << " instructions executed in " << runMs
+             << " ms\n";
+    }
+    if (!same)
+    {
+        cout << "MISMATCH: optimized IR computes a different result\n";
+        return 1;
+    }
+    return 0;
+}
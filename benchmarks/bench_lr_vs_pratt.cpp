@@ -0,0 +1,109 @@
+// benchmarks/bench_lr_vs_pratt.cpp
+// Build: (cd mini-bison-parser && bison -d parser.y)
+//        g++ -std=c++17 -O2 benchmarks/bench_lr_vs_pratt.cpp -o bench_lr_vs_pratt
+// Table-driven LR parser (mini-bison-parser/parser.y) versus the hand-written
+// Pratt Parser on the same token vector. Both build the same AST; the trees
+// are compared before timing, as are the trees both recover for inputs with
+// a syntax error in a function body.
+
+#define BISON_PARSER_NO_MAIN
+#include "../mini-bison-parser/parser.tab.c"
+#include "bench_common.hpp"
+
+static const char *BODY = R"(
+    x = a + b * c - (a - b) / 2;
+    if (x > 10 && y != 3) { y = y + 1; } else { y = y - 1; }
+    while (z < 4) { z++; total += foo(z, a * 2); }
+    for (int i = 0; i < 8; i++) { arr[i] = i * i; }
+    flag = !flag || x == y;
+    int t = bar(x, y, z) << 2, u = t & 7;
+)";
+
+// Each has a syntax error in a function body; recovery must stay inside
+// that body and keep the declarations after it.
+static const char *RECOVERY[] = {
+    "int main() { x = 1 }\nint k;\nint z() { return 2; }\n",
+    "int main() { int a = 1; a = ; int b = 2; return b; }\nint k;\n",
+    "int main() { int a = 1 int b = 2; } int z() { return 2; }\n",
+};
+
+int main(int argc, char **argv)
+{
+    for (const char *source : RECOVERY)
+    {
+        vector<Token> tokens = RegexLexer(source).tokenize();
+        Parser pratt(tokens);
+        Program a = pratt.parseProgram();
+        Program b;
+        vector<string> errors;
+        bisonParse(tokens, b, errors);
+        ostringstream pa, pb;
+        a.print(pa);
+        b.print(pb);
+        if (errors.empty() || pa.str() != pb.str())
+        {
+            cout << "MISMATCH: backends recover differently from\n" << source;
+            return 1;
+        }
+    }
+
+    size_t n = argc > 1 ? stoul(argv[1]) : 50000;
+    auto tokens = repeatTokens("int foo(int p, int q) { return p + q; }\n"
+                               "int bar(int p, int q, int r) { return p * q - r; }\n"
+                               "int main() { int a = 1; int b = 2; int c = 3; int x; int y = 0; int z = 0;"
+                               " int total = 0; int arr; bool flag = true;",
+                               BODY, n, "return x; }");
+    cout << "statements: " << n * 6 << "  tokens: " << tokens.size() << "\n";
+
+    {
+        Parser pratt(tokens);
+        Program a = pratt.parseProgram();
+        Program b;
+        vector<string> errors;
+        bool ok = bisonParse(tokens, b, errors);
+        ostringstream pa, pb;
+        a.print(pa);
+        b.print(pb);
+        if (!ok || pa.str() != pb.str())
+        {
+            cout << "MISMATCH: backends disagree (" << errors.size() << " LR diagnostics)\n";
+            return 1;
+        }
+        cout << "trees identical, " << size(RECOVERY) << " error recoveries identical\n";
+    }
+
+    struct Result
+    {
+        double ms = 1e300;
+        size_t allocs = 0, live = 0;
+    };
+    Result pratt, lr;
+    for (int rep = 0; rep < 5; rep++)
+    {
+        for (bool useLR : {false, true})
+        {
+            Result &r = useLR ? lr : pratt;
+            Parser parser{useLR ? vector<Token>() : tokens}; // the Pratt parser owns a copy; not timed
+            size_t before = g_liveBytes, allocsBefore = g_totalAllocs;
+            BenchTimer t;
+            Program prog;
+            vector<string> errors;
+            if (useLR)
+                bisonParse(tokens, prog, errors);
+            else
+                prog = parser.parseProgram();
+            r.ms = min(r.ms, t.ms());
+            r.allocs = g_totalAllocs - allocsBefore;
+            r.live = g_liveBytes - before;
+        }
+    }
+
+    auto row = [&](const char *name, const Result &r)
+    {
+        cout << name << r.ms << " ms, " << tokens.size() / r.ms / 1000.0 << " Mtok/s, "
+             << r.allocs << " allocations, live AST " << fmtBytes(r.live) << "\n";
+    };
+    row("Pratt (hand-written)  ", pratt);
+    row("LR (bison tables)     ", lr);
+    return 0;
+}
@@ -0,0 +1,119 @@
+// benchmarks/bench_parallel_check.cpp
+// Build: g++ -std=c++17 -O2 -pthread benchmarks/bench_parallel_check.cpp -o bench_parallel_check
+// ScopeChecker::analyseParallel and TypeChecker::checkParallel against the
+// serial analyse()/check() on a program of many independent functions, some
+// of them with scope and type errors. Every run must report exactly the
+// serial diagnostics in the same order. Usage: bench_parallel_check [functions]
+
+#define PARSER_REUSE_LEXER
+#include "../regex/regex_code.cpp"
+#include "../parser/parser.cpp"
+#define SCOPE_CHECKER_NO_MAIN
+#include "../parser/scope_checker.cpp"
+#define TYPE_CHECKER_NO_MAIN
+#include "../parser/type_checker.cpp"
+#include "bench_common.hpp"
+
+// Function i is named f<i> and calls f<i-1>; every tenth one also has an
+// undeclared name and a type error so the merge order is exercised.
+static vector<Token> manyFunctions(size_t n)
+{
+    vector<Token> good = lexSnippet(
+        "int FN(int p, int q) { int s = 0; int i; for (i = 0; i < p; i = i + 1) { s = s + q * g; }\n"
+        " if (s > 100) { s = s - FP(s, p); } while (s < q) { s = s + 1; } return s + p; }\n");
+    vector<Token> bad = lexSnippet(
+        "int FN(int p, int q) { int s = missing + p; bool b = s; if (s) { s = FP(s, p, q); } return b; }\n");
+    vector<Token> out = lexSnippet("int g = 3;\nint f0(int p, int q) { return p + q; }\n");
+    int line = out.back().line;
+    for (size_t i = 1; i < n; i++)
+    {
+        const vector<Token> &tmpl = i % 10 == 0 ? bad : good;
+        for (Token t : tmpl)
+        {
+            if (t.lexeme == "FN")
+                t.lexeme = "f" + to_string(i);
+            else if (t.lexeme == "FP")
+                t.lexeme = "f" + to_string(i - 1);
+            t.line += line;
+            out.push_back(move(t));
+        }
+        line = out.back().line;
+    }
+    out.push_back(Token{TokenType::T_EOF, "", line + 1, 1});
+    return out;
+}
+
+static vector<string> scopeDiagnostics(const ScopeChecker &c)
+{
+    vector<string> out;
+    for (size_t i = 0; i < c.errorCount(); i++)
+        out.push_back(c.formatError(i));
+    return out;
+}
+
+static vector<string> typeDiagnostics(const TypeChecker &c)
+{
+    vector<string> out;
+    for (size_t i = 0; i < c.errorCount(); i++)
+    {
+        TypeError e = c.error(i);
+        out.push_back(errorToString(e.type) + " " + to_string(e.line) + ":" + to_string(e.col) + " " + e.detail);
+    }
+    return out;
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = argc > 1 ? stoul(argv[1]) : 20000;
+    Program prog;
+    {
+        Parser parser(manyFunctions(n));
+        prog = parser.parseProgram();
+    }
+    unsigned hw = max(1u, thread::hardware_concurrency());
+    cout << "functions: " << n << "  hardware threads: " << hw << "\n";
+
+    vector<string> scopeRef, typeRef;
+    double scopeSerial = bestOf(3, [&]
+                                {
+                                    ScopeChecker c;
+                                    c.analyse(prog);
+                                    scopeRef = scopeDiagnostics(c);
+                                });
+    double typeSerial = bestOf(3, [&]
+                               {
+                                   TypeChecker c;
+                                   c.check(prog);
+                                   typeRef = typeDiagnostics(c);
+                               });
+    cout << "serial: scope " << scopeSerial << " ms (" << scopeRef.size() << " errors), type " << typeSerial
+         << " ms (" << typeRef.size() << " errors)\n";
+
+    vector<unsigned> counts = {1, 2, 4, 8};
+    if (hw > 8)
+        counts.push_back(hw);
+    for (unsigned threads : counts)
+    {
+        bool same = true;
+        double scopeMs = bestOf(3, [&]
+                                {
+                                    ScopeChecker c;
+                                    c.analyseParallel(prog, threads);
+                                    same = same && scopeDiagnostics(c) == scopeRef;
+                                });
+        double typeMs = bestOf(3, [&]
+                               {
+                                   TypeChecker c;
+                                   c.checkParallel(prog, threads);
+                                   same = same && typeDiagnostics(c) == typeRef;
+                               });
+        if (!same)
+        {
+            cout << "MISMATCH: diagnostics differ from the serial run with " << threads << " threads\n";
+            return 1;
+        }
+        cout << threads << " thread(s): scope " << scopeMs << " ms (x" << scopeSerial / scopeMs << "), type "
+             << typeMs << " ms (x" << typeSerial / typeMs << ")\n";
+    }
+    return 0;
+}
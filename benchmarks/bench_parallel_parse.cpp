@@ -0,0 +1,136 @@
+// benchmarks/bench_parallel_parse.cpp
+// Build: (cd mini-bison-parser && bison -d parser.y)
+//        g++ -std=c++17 -O2 -pthread benchmarks/bench_parallel_parse.cpp -o bench_parallel_parse
+// Parses a batch of independent "files" with the pure LR parser on 1..N
+// threads, then frees the trees. Each parse owns one ParseArena, so teardown
+// is a few block frees per file; the Pratt parser's per-node shared_ptr
+// trees are torn down alongside for comparison.
+
+#define BISON_PARSER_NO_MAIN
+#include "../mini-bison-parser/parser.tab.c"
+#include "bench_common.hpp"
+
+#include <atomic>
+#include <thread>
+
+static const char *BODY = R"(
+    x = a + b * c - (a - b) / 2;
+    if (x > 10 && y != 3) { y = y + 1; } else { y = y - 1; }
+    while (z < 4) { z++; total += foo(z, a * 2); }
+    for (int i = 0; i < 8; i++) { arr[i] = i * i; }
+    flag = !flag || x == y;
+    int t = bar(x, y, z) << 2, u = t & 7;
+)";
+
+// Parses every file on `threads` workers pulling from a shared index.
+static void parseAll(const vector<vector<Token>> &files, vector<Program> &out, unsigned threads)
+{
+    out.assign(files.size(), Program());
+    atomic<size_t> next{0};
+    auto worker = [&]
+    {
+        vector<string> errors;
+        for (size_t i; (i = next.fetch_add(1)) < files.size();)
+            bisonParse(files[i], out[i], errors);
+    };
+    vector<thread> pool;
+    for (unsigned t = 1; t < threads; t++)
+        pool.emplace_back(worker);
+    worker();
+    for (auto &th : pool)
+        th.join();
+}
+
+int main(int argc, char **argv)
+{
+    size_t fileCount = argc > 1 ? stoul(argv[1]) : 32;
+    size_t n = argc > 2 ? stoul(argv[2]) : 2000;
+    unsigned hw = max(1u, thread::hardware_concurrency());
+
+    auto tokens = repeatTokens("int foo(int p, int q) { return p + q; }\n"
+                               "int bar(int p, int q, int r) { return p * q - r; }\n"
+                               "int main() { int a = 1; int b = 2; int c = 3; int x; int y = 0; int z = 0;"
+                               " int total = 0; int arr; bool flag = true;",
+                               BODY, n, "return x; }");
+    vector<vector<Token>> files(fileCount, tokens);
+    cout << "files: " << fileCount << "  statements/file: " << n * 6 << "  tokens/file: " << tokens.size()
+         << "  hardware threads: " << hw << "\n";
+
+    // Reference tree from a serial parse; every threaded run must match it.
+    string expected;
+    {
+        Program prog;
+        vector<string> errors;
+        if (!bisonParse(tokens, prog, errors))
+        {
+            cout << "parse failed: " << (errors.empty() ? "" : errors[0]) << "\n";
+            return 1;
+        }
+        ostringstream os;
+        prog.print(os);
+        expected = os.str();
+    }
+
+    {
+        size_t allocsBefore = g_totalAllocs;
+        Program prog;
+        vector<string> errors;
+        bisonParse(tokens, prog, errors);
+        size_t lrAllocs = g_totalAllocs - allocsBefore;
+        allocsBefore = g_totalAllocs;
+        Parser pratt(tokens);
+        Program p2 = pratt.parseProgram();
+        size_t prattAllocs = g_totalAllocs - allocsBefore;
+        cout << "allocations per file: LR arena " << lrAllocs << ", Pratt " << prattAllocs << "\n";
+    }
+
+    vector<unsigned> counts = {1, 2, 4, 8};
+    if (hw > 8)
+        counts.push_back(hw);
+    double serial = 0;
+    for (unsigned threads : counts)
+    {
+        double parseMs = 1e300, freeMs = 1e300;
+        for (int rep = 0; rep < 3; rep++)
+        {
+            vector<Program> out;
+            BenchTimer t;
+            parseAll(files, out, threads);
+            parseMs = min(parseMs, t.ms());
+            for (size_t i : {size_t(0), out.size() - 1})
+            {
+                ostringstream os;
+                out[i].print(os);
+                if (os.str() != expected)
+                {
+                    cout << "MISMATCH: file " << i << " differs with " << threads << " threads\n";
+                    return 1;
+                }
+            }
+            BenchTimer f;
+            out.clear();
+            freeMs = min(freeMs, f.ms());
+        }
+        if (threads == 1)
+            serial = parseMs;
+        cout << "LR  " << threads << " thread(s): parse " << parseMs << " ms (x" << serial / parseMs
+             << "), free " << freeMs << " ms\n";
+    }
+
+    // Pratt trees are freed node by node through their reference counts.
+    double prattFree = 1e300;
+    for (int rep = 0; rep < 3; rep++)
+    {
+        vector<Program> out;
+        for (auto &f : files)
+        {
+            Parser p(f);
+            out.push_back(p.parseProgram());
+        }
+        BenchTimer f;
+        out.clear();
+        prattFree = min(prattFree, f.ms());
+    }
+    cout << "Pratt (per-node shared_ptr) free " << prattFree << " ms\n";
+    return 0;
+}
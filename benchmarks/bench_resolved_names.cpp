@@ -0,0 +1,110 @@
+// benchmarks/bench_resolved_names.cpp
+// Build: g++ -std=c++17 -O2 benchmarks/bench_resolved_names.cpp -o bench_resolved_names
+// TypeChecker::check on an identifier-dense program, once on a tree that
+// has not been resolved (every name is looked up by string through the
+// scope stack) and once on a copy that ScopeChecker::analyse has annotated
+// with SymbolRefs (locals and globals are indexed directly). Both runs must
+// report the same diagnostics. Usage: bench_resolved_names [functions]
+
+#define PARSER_REUSE_LEXER
+#include "../regex/regex_code.cpp"
+#include "../parser/parser.cpp"
+#define SCOPE_CHECKER_NO_MAIN
+#include "../parser/scope_checker.cpp"
+#define TYPE_CHECKER_NO_MAIN
+#include "../parser/type_checker.cpp"
+#include "bench_common.hpp"
+
+// Function i is f<i>; its body reads parameters, globals and locals from
+// two block levels in long expressions and calls f<i-1>. Every tenth one
+// has an undeclared name and a few type errors.
+static vector<Token> denseFunctions(size_t n)
+{
+    vector<Token> good = lexSnippet(
+        "int FN(int a, int b, int c) { int s = a + b * c; int t = s - a; bool ok = s < t;\n"
+        " { int u = s + t + g1 * g2; s = u * a + t * b - c + g1; t = s + u + a + b + c;\n"
+        "   if (ok) { int w = u + s; w = w + t * u - s + a; s = w + FP(s, t, u) + g2; } }\n"
+        " while (s < t) { s = s + a + b + c + g1 + g2; t = t - s + a; }\n"
+        " return s + t + a * b * c + g1 - g2; }\n");
+    vector<Token> bad = lexSnippet(
+        "int FN(int a, int b, int c) { int s = missing + a; bool ok = s; s = s + ok + b;\n"
+        " if (s) { s = FP(s, b); } return ok; }\n");
+    vector<Token> out = lexSnippet("int g1 = 3; int g2 = 4;\nint f0(int a, int b, int c) { return a + b + c; }\n");
+    int line = out.back().line;
+    for (size_t i = 1; i < n; i++)
+    {
+        for (Token t : i % 10 == 0 ? bad : good)
+        {
+            if (t.lexeme == "FN")
+                t.lexeme = "f" + to_string(i);
+            else if (t.lexeme == "FP")
+                t.lexeme = "f" + to_string(i - 1);
+            t.line += line;
+            out.push_back(move(t));
+        }
+        line = out.back().line;
+    }
+    out.push_back(Token{TokenType::T_EOF, "", line + 1, 1});
+    return out;
+}
+
+static string typeDiagnostics(const TypeChecker &c)
+{
+    string out;
+    for (size_t i = 0; i < c.errorCount(); i++)
+    {
+        TypeError e = c.error(i);
+        out += errorToString(e.type) + " " + to_string(e.line) + ":" + to_string(e.col) + " " + e.detail + "\n";
+    }
+    return out;
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = argc > 1 ? stoul(argv[1]) : 20000;
+    vector<Token> tokens = denseFunctions(n);
+    size_t identifiers = 0;
+    for (auto &t : tokens)
+        identifiers += t.type == TokenType::T_IDENTIFIER;
+    Program plain, resolved;
+    {
+        Parser p1(tokens), p2(tokens);
+        plain = p1.parseProgram();
+        resolved = p2.parseProgram();
+    }
+
+    ScopeChecker sc;
+    double scopeMs = bestOf(3, [&] { sc.analyse(resolved); });
+
+    string byName, byRef;
+    double nameMs = 1e300, refMs = 1e300;
+    for (int rep = 0; rep < 5; rep++)
+    {
+        {
+            BenchTimer t;
+            TypeChecker tc;
+            tc.check(plain);
+            nameMs = min(nameMs, t.ms());
+            byName = typeDiagnostics(tc);
+        }
+        {
+            BenchTimer t;
+            TypeChecker tc;
+            tc.check(resolved);
+            refMs = min(refMs, t.ms());
+            byRef = typeDiagnostics(tc);
+        }
+    }
+    if (byName != byRef)
+    {
+        cout << "MISMATCH: diagnostics differ between resolved and unresolved trees\n";
+        return 1;
+    }
+    size_t diagnostics = count(byRef.begin(), byRef.end(), '\n');
+    cout << "functions: " << n << "  identifier tokens: " << identifiers << "  type diagnostics: " << diagnostics
+         << " (identical), scope diagnostics: " << sc.errorCount() << "\n";
+    cout << "scope check + resolution   " << scopeMs << " ms\n";
+    cout << "type check, by name        " << nameMs << " ms\n";
+    cout << "type check, by SymbolRef   " << refMs << " ms (x" << nameMs / refMs << ")\n";
+    return 0;
+}
@@ -0,0 +1,53 @@
+// benchmarks/bench_scope_nesting.cpp
+// Build: g++ -std=c++17 -O2 benchmarks/bench_scope_nesting.cpp -o bench_scope_nesting
+// ScopeChecker::analyse on one function whose body sits under D nested
+// blocks, each declaring a variable. The innermost statements read names
+// from the outermost, middle and innermost levels and open short-lived
+// blocks of their own, so both lookup depth and scope push/pop are
+// exercised. Usage: bench_scope_nesting [statements] [depth...]
+
+#define PARSER_REUSE_LEXER
+#include "../regex/regex_code.cpp"
+#include "../parser/parser.cpp"
+#define SCOPE_CHECKER_NO_MAIN
+#include "../parser/scope_checker.cpp"
+#include "bench_common.hpp"
+
+static vector<Token> nestedProgram(int depth, size_t n)
+{
+    string prefix = "int g = 1; int main() { int x = 0;";
+    for (int d = 0; d < depth; d++)
+        prefix += " { int v" + to_string(d) + " = " + to_string(d) + ";";
+    string mid = "v" + to_string(depth / 2), inner = "v" + to_string(depth - 1);
+    string body = "x = v0 + g + " + mid + " * " + inner + "; { int t = x; t = t + v0; }\n";
+    return repeatTokens(prefix, body, n, string(depth, '}') + " return x; }");
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = argc > 1 ? stoul(argv[1]) : 50000;
+    vector<int> depths;
+    for (int i = 2; i < argc; i++)
+        depths.push_back(stoi(argv[i]));
+    if (depths.empty())
+        depths = {1, 8, 64, 256};
+
+    cout << "statements per program: " << n * 2 << " (" << n * 5 << " identifier lookups)\n";
+    for (int depth : depths)
+    {
+        Program prog;
+        {
+            Parser parser(nestedProgram(depth, n));
+            prog = parser.parseProgram();
+        }
+        ScopeChecker checker;
+        double ms = bestOf(5, [&] { checker.analyse(prog); });
+        if (checker.hasErrors())
+        {
+            cout << "unexpected error: " << checker.formatError(0) << "\n";
+            return 1;
+        }
+        cout << "depth " << depth << ": " << ms << " ms (" << ms * 1e6 / (n * 5) << " ns/lookup incl. walk)\n";
+    }
+    return 0;
+}
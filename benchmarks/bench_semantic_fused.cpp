@@ -0,0 +1,98 @@
+// benchmarks/bench_semantic_fused.cpp
+// Build: g++ -std=c++17 -O2 benchmarks/bench_semantic_fused.cpp -o bench_semantic_fused
+// SemanticChecker (one walk, one table) against ScopeChecker::analyse and
+// TypeChecker::check run back to back, on a program of many functions with
+// a sprinkling of scope and type errors and literals of every type. Both
+// must report the same diagnostics. Usage: bench_semantic_fused [functions]
+
+#define PARSER_REUSE_LEXER
+#include "../regex/regex_code.cpp"
+#include "../parser/parser.cpp"
+#define SEMANTIC_CHECKER_NO_MAIN
+#include "../parser/semantic_checker.cpp"
+#include "bench_common.hpp"
+
+static vector<Token> manyFunctions(size_t n)
+{
+    vector<Token> good = lexSnippet(
+        "int FN(int p, int q) { int s = 0; int i; for (i = 0; i < p; i = i + 1) { s = s + q * g; }\n"
+        " if (s > 100) { int t = s - FP(s, p); s = t; } while (s < q) { s = s + 1; }\n"
+        " float h = half(1.5) * 0.5; if (h < 2.0) { s = s + 1; } return s + p; }\n");
+    vector<Token> bad = lexSnippet(
+        "int FN(int p, int q) { int s = missing + p; bool b = s; if (s) { s = FP(s, p, q); }\n"
+        " string w = 'x'; char c = \"y\"; bool e = name < 1.5; return b; }\n");
+    vector<Token> out = lexSnippet("int g = 3; string name = \"hi\"; char initial = 'h';\n"
+                                   "float half(float x) { return x * 0.5; } float f = 1.5; bool b = f < 2.0;\n"
+                                   "int f0(int p, int q) { return p + q; }\n");
+    int line = out.back().line;
+    for (size_t i = 1; i < n; i++)
+    {
+        for (Token t : i % 10 == 0 ? bad : good)
+        {
+            if (t.lexeme == "FN")
+                t.lexeme = "f" + to_string(i);
+            else if (t.lexeme == "FP")
+                t.lexeme = "f" + to_string(i - 1);
+            t.line += line;
+            out.push_back(move(t));
+        }
+        line = out.back().line;
+    }
+    out.push_back(Token{TokenType::T_EOF, "", line + 1, 1});
+    return out;
+}
+
+static string typeLine(const TypeError &e)
+{
+    return errorToString(e.type) + " " + to_string(e.line) + ":" + to_string(e.col) + " " + e.detail + "\n";
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = argc > 1 ? stoul(argv[1]) : 20000;
+    Program prog;
+    {
+        Parser parser(manyFunctions(n));
+        prog = parser.parseProgram();
+    }
+
+    string separate, fused;
+    double separateMs = 1e300, fusedMs = 1e300;
+    for (int rep = 0; rep < 5; rep++)
+    {
+        {
+            BenchTimer t;
+            ScopeChecker sc;
+            sc.analyse(prog);
+            TypeChecker tc;
+            tc.check(prog);
+            separateMs = min(separateMs, t.ms());
+            separate.clear();
+            for (size_t i = 0; i < sc.errorCount(); i++)
+                separate += sc.formatError(i) + "\n";
+            for (size_t i = 0; i < tc.errorCount(); i++)
+                separate += typeLine(tc.error(i));
+        }
+        {
+            BenchTimer t;
+            SemanticChecker sem;
+            sem.analyse(prog);
+            fusedMs = min(fusedMs, t.ms());
+            fused.clear();
+            for (size_t i = 0; i < sem.scopeErrorCount(); i++)
+                fused += sem.formatScopeError(i) + "\n";
+            for (size_t i = 0; i < sem.typeErrorCount(); i++)
+                fused += typeLine(sem.typeErrorAt(i));
+        }
+    }
+    if (separate != fused)
+    {
+        cout << "MISMATCH: fused diagnostics differ from the two checkers\n";
+        return 1;
+    }
+    size_t diagnostics = count(fused.begin(), fused.end(), '\n');
+    cout << "functions: " << n << "  diagnostics: " << diagnostics << " (identical)\n";
+    cout << "scope + type back to back  " << separateMs << " ms\n";
+    cout << "fused semantic pass        " << fusedMs << " ms (x" << separateMs / fusedMs << ")\n";
+    return 0;
+}
@@ -0,0 +1,75 @@
+// benchmarks/bench_short_circuit.cpp
+// Build: g++ -std=c++17 -O2 benchmarks/bench_short_circuit.cpp -o bench_short_circuit
+// Lowering of && and || (parser/irGenerator.cpp) on condition-heavy
+// generated code: loop and if conditions that combine comparisons with
+// &&, || and !, calls guarded by a cheaper test, and a flag kept in a
+// bool variable. For the IR as generated and after the optimizer, the
+// static count of instructions, conditional jumps and boolean operators
+// (LAND, LOR, LNOT), and from running main() on the IR interpreter the
+// instructions, conditional jumps and calls executed.
+// Usage: bench_short_circuit [functions]
+
+#define PARSER_REUSE_LEXER
+#include "../regex/regex_code.cpp"
+#include "../parser/parser.cpp"
+#define IR_OPTIMIZER_NO_MAIN
+#include "../parser/ir_optimizer.cpp"
+#include "bench_common.hpp"
+
+static vector<Token> program(size_t n)
+{
+    string body =
+        "int FN(int a, int b) { int s = 0; int i = 0;\n"
+        " while (i < a && !(s > 400)) {\n"
+        "   if (i > b && check(i) || i == 3) { s = s + 2; }\n"
+        "   bool odd = i - i / 2 * 2 == 1;\n"
+        "   bool keep = odd || i < 2 && check(s);\n"
+        "   if (!keep && !(s < 10 || check(b))) { s = s - 1; }\n"
+        "   if (keep) { s = s + i; }\n"
+        "   i = i + 1; }\n"
+        " return s; }\n";
+    string prelude = "int seen = 0;\n"
+                     "int check(int x) { seen = seen + 1; return x - x / 3 * 3 == 0; }\n";
+    return joinTokens({lexSnippet(prelude), numberedCopies(body, n),
+                       mainCalling(" total = total + FN(30, 6);\n", n, "total + seen")});
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = argc > 1 ? stoul(argv[1]) : 2000;
+    Program prog;
+    {
+        Parser parser(program(n));
+        prog = parser.parseProgram();
+    }
+    TypeChecker checker;
+    checker.check(prog);
+    ScopeChecker resolver;
+    resolver.analyse(prog);
+
+    for (bool optimize : {false, true})
+    {
+        IRGenerator gen;
+        double genMs = bestOf(3, [&] { gen.generateIR(prog); });
+        IRProgram &ir = gen.program();
+        if (optimize)
+            optimizeIR(ir);
+        size_t branches = 0, logical = 0;
+        for (const IRInstruction &in : ir.code)
+        {
+            branches += in.op == IROp::JUMP_TRUE || in.op == IROp::JUMP_FALSE;
+            logical += in.op == IROp::LAND || in.op == IROp::LOR || in.op == IROp::LNOT;
+        }
+        IRInterpreter interpreter(ir);
+        string result;
+        double ms = bestOf(3, [&] { result = interpreter.text(interpreter.run()); });
+        cout << (optimize ? "optimized" : "as generated") << ": " << ir.code.size() << " instructions, " << branches
+             << " conditional jumps, " << logical << " boolean operators";
+        if (!optimize)
+            cout << ", generated in " << genMs << " ms";
+        cout << "\n    executed: " << interpreter.steps << " instructions, " << interpreter.branches
+             << " conditional jumps, " << interpreter.calls << " calls, " << ms << " ms; main returned " << result
+             << "\n";
+    }
+    return 0;
+}
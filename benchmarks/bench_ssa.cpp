@@ -0,0 +1,149 @@
+// benchmarks/bench_ssa.cpp
+// Build: g++ -std=c++17 -O2 benchmarks/bench_ssa.cpp -o bench_ssa
+// SSA construction and destruction (parser/ir_ssa.cpp) on single functions
+// of growing size, doubling from tens of thousands of blocks, and on a
+// program of many ordinary functions. Times the dominator tree, the whole
+// conversion into SSA (CFG, dominators, frontiers, phis, renaming) and the
+// way back out, per instruction, so the growth with size can be read off
+// directly. Every function is checked with verifySSA.
+// Usage: bench_ssa [statements] [functions]
+
+#define PARSER_REUSE_LEXER
+#include "../regex/regex_code.cpp"
+#include "../parser/parser.cpp"
+#define IR_SSA_NO_MAIN
+#include "../parser/ir_ssa.cpp"
+#include "bench_common.hpp"
+
+// A loop nest with branches, reading and writing a handful of variables
+static const char *STATEMENT =
+    " while (i < a) { int j = 0; for (j = 0; j < b; j = j + 1) { if (j > i) { s = s + j; } else { t = s - t; } }\n"
+    "   if (s > 100) { s = s / 2; if (t < 3) { break; } } i = i + 1; }\n"
+    " if (s == t) { u = u + 1; } else { u = s; s = t; t = u; } i = 0;\n";
+
+static vector<Token> bigFunction(size_t statements)
+{
+    vector<Token> body = lexSnippet(STATEMENT);
+    vector<Token> out = lexSnippet("int big(int a, int b) { int s = 0; int t = 1; int u = 2; int i = 0;\n");
+    int line = out.back().line;
+    for (size_t k = 0; k < statements; k++)
+    {
+        for (Token t : body)
+        {
+            t.line += line;
+            out.push_back(move(t));
+        }
+        line = out.back().line;
+    }
+    for (Token t : lexSnippet(" return s + t + u; }\n"))
+    {
+        t.line += line;
+        out.push_back(move(t));
+    }
+    out.push_back(Token{TokenType::T_EOF, "", out.back().line + 1, 1});
+    return out;
+}
+
+static vector<Token> manyFunctions(size_t n)
+{
+    vector<Token> fn = bigFunction(1);
+    fn.pop_back(); // T_EOF
+    vector<Token> out;
+    int line = 0;
+    for (size_t k = 0; k < n; k++)
+    {
+        for (Token t : fn)
+        {
+            if (t.lexeme == "big")
+                t.lexeme = "f" + to_string(k);
+            t.line += line;
+            out.push_back(move(t));
+        }
+        line = out.back().line;
+    }
+    out.push_back(Token{TokenType::T_EOF, "", line + 1, 1});
+    return out;
+}
+
+struct Result
+{
+    size_t instructions = 0, blocks = 0, phis = 0, after = 0;
+    double domMs = 1e300, toMs = 1e300, fromMs = 1e300;
+    bool valid = true;
+};
+
+static Result measure(const vector<Token> &tokens)
+{
+    Program prog;
+    {
+        Parser parser(tokens);
+        prog = parser.parseProgram();
+    }
+    TypeChecker checker;
+    checker.check(prog);
+    ScopeChecker resolver;
+    resolver.analyse(prog);
+    Result r;
+    for (int rep = 0; rep < 3; rep++)
+    {
+        IRGenerator gen;
+        gen.generateIR(prog);
+        IRProgram &ir = gen.program();
+        r.instructions = ir.code.size();
+
+        BenchTimer t;
+        vector<SSAFunction> fns = toSSA(ir);
+        r.toMs = min(r.toMs, t.ms());
+
+        DominatorTree dt;
+        BenchTimer td;
+        for (const SSAFunction &f : fns)
+            dt.compute(f);
+        r.domMs = min(r.domMs, td.ms());
+
+        r.blocks = r.phis = 0;
+        for (const SSAFunction &f : fns)
+        {
+            r.blocks += f.blockCount();
+            for (const SSABlock &b : f.blocks)
+                r.phis += b.phis.size();
+            string why;
+            if (rep == 0 && !verifySSA(ir, f, why))
+            {
+                cout << "INVALID SSA: " << why << "\n";
+                r.valid = false;
+            }
+        }
+
+        BenchTimer tf;
+        fromSSA(ir, fns);
+        r.fromMs = min(r.fromMs, tf.ms());
+        r.after = ir.code.size();
+    }
+    return r;
+}
+
+static void report(const string &what, const Result &r)
+{
+    cout << what << ": " << r.instructions << " instructions, " << r.blocks << " blocks, " << r.phis << " phis\n";
+    cout << "    dominators  " << r.domMs << " ms (" << r.domMs * 1e6 / r.blocks << " ns/block)\n";
+    cout << "    into SSA    " << r.toMs << " ms (" << r.toMs * 1e6 / r.instructions << " ns/instruction)\n";
+    cout << "    out of SSA  " << r.fromMs << " ms (" << r.fromMs * 1e6 / r.instructions << " ns/instruction), "
+         << r.after << " instructions after\n";
+}
+
+int main(int argc, char **argv)
+{
+    size_t statements = argc > 1 ? stoul(argv[1]) : 2000;
+    size_t functions = argc > 2 ? stoul(argv[2]) : 20000;
+    bool valid = true;
+    for (size_t k = statements; k <= statements * 4; k *= 2)
+    {
+        Result r = measure(bigFunction(k));
+        report("one function, " + to_string(k) + " loop nests", r);
+        valid = valid && r.valid;
+    }
+    Result r = measure(manyFunctions(functions));
+    report(to_string(functions) + " functions", r);
+    return valid && r.valid ? 0 : 1;
+}
@@ -0,0 +1,161 @@
+// benchmarks/bench_symbol_table.cpp
+// Build: (cd mini-bison-parser && bison -d parser.y)
+//        g++ -std=c++17 -O2 benchmarks/bench_symbol_table.cpp -o bench_symbol_table
+// Name resolution in the LR front end on a file with tens of thousands of
+// distinct identifiers: full bisonParse() time, plus the declaration/lookup
+// stream replayed through the scoped hash table and through the flat
+// vector<string> table it replaced.
+
+#define BISON_PARSER_NO_MAIN
+#include "../mini-bison-parser/parser.tab.c"
+#include "bench_common.hpp"
+
+// The table parser.y used before: one unscoped list, linear lookup.
+class LinearSymbolTable
+{
+    vector<string> symbols;
+
+public:
+    bool isDeclared(const string &identifier) const
+    {
+        for (const auto &var : symbols)
+            if (var == identifier)
+                return true;
+        return false;
+    }
+    void declareVariable(const string &identifier)
+    {
+        if (!isDeclared(identifier))
+            symbols.push_back(identifier);
+    }
+};
+
+// Copies `tmpl` n times, renaming each placeholder identifier per copy.
+static void appendRenamed(vector<Token> &out, const vector<Token> &tmpl, size_t n,
+                          const function<string(const string &, size_t)> &rename)
+{
+    int base = out.empty() ? 0 : out.back().line;
+    for (size_t i = 0; i < n; i++)
+        for (Token t : tmpl)
+        {
+            if (t.type == TokenType::T_IDENTIFIER)
+                t.lexeme = rename(t.lexeme, i);
+            t.line += base + int(i);
+            out.push_back(move(t));
+        }
+}
+
+static bool isTypeToken(TokenType t)
+{
+    return t == TokenType::T_INT || t == TokenType::T_FLOAT || t == TokenType::T_STRING ||
+           t == TokenType::T_BOOL || t == TokenType::T_CHAR;
+}
+
+// A lookup stream recovered from the tokens: an identifier right after a
+// type keyword is a declaration, braces open and close scopes, and every
+// other identifier is a use.
+struct Op
+{
+    enum Kind
+    {
+        Declare,
+        Use,
+        Push,
+        Pop
+    } kind;
+    const string *name;
+};
+
+int main(int argc, char **argv)
+{
+    size_t globals = argc > 1 ? stoul(argv[1]) : 20000;
+    size_t fns = argc > 2 ? stoul(argv[2]) : 10000;
+
+    vector<Token> tokens;
+    appendRenamed(tokens, lexSnippet("int GV = 1;\n"), globals,
+                  [](const string &, size_t i) { return "g" + to_string(i); });
+    appendRenamed(tokens,
+                  lexSnippet("int FN(int p) { int l = GA + GB * p; { int m = l - GC; GD = m + FP(l); } return l; }\n"),
+                  fns,
+                  [&](const string &s, size_t i)
+                  {
+                      size_t h = i * 2654435761u;
+                      if (s == "FN")
+                          return "f" + to_string(i);
+                      if (s == "FP")
+                          return i ? "f" + to_string(i - 1) : string("f0");
+                      if (s == "GA")
+                          return "g" + to_string(h % globals);
+                      if (s == "GB")
+                          return "g" + to_string((h >> 7) % globals);
+                      if (s == "GC")
+                          return "g" + to_string((h >> 13) % globals);
+                      if (s == "GD")
+                          return "g" + to_string((h >> 19) % globals);
+                      return s;
+                  });
+    tokens.push_back(Token{TokenType::T_EOF, "", tokens.back().line + 1, 1});
+
+    vector<Op> ops;
+    size_t declares = 0, uses = 0;
+    for (size_t i = 0; i < tokens.size(); i++)
+    {
+        const Token &t = tokens[i];
+        if (t.type == TokenType::T_BRACEL)
+            ops.push_back({Op::Push, nullptr});
+        else if (t.type == TokenType::T_BRACER)
+            ops.push_back({Op::Pop, nullptr});
+        else if (t.type == TokenType::T_IDENTIFIER)
+        {
+            bool decl = i > 0 && isTypeToken(tokens[i - 1].type);
+            ops.push_back({decl ? Op::Declare : Op::Use, &t.lexeme});
+            (decl ? declares : uses)++;
+        }
+    }
+    cout << "globals: " << globals << "  functions: " << fns << "  tokens: " << tokens.size()
+         << "  declarations: " << declares << "  uses: " << uses << "\n";
+
+    // Full parse with the scoped table; the input must resolve cleanly.
+    size_t parseErrors = 0;
+    double parseMs = bestOf(3, [&]
+                            {
+                                Program prog;
+                                vector<string> errors;
+                                bisonParse(tokens, prog, errors);
+                                parseErrors = errors.size();
+                            });
+    if (parseErrors)
+    {
+        cout << "unexpected diagnostics: " << parseErrors << "\n";
+        return 1;
+    }
+    cout << "bisonParse (scoped hash table): " << parseMs << " ms\n";
+
+    size_t hashHits = 0, linearHits = 0;
+    double hashMs = bestOf(3, [&]
+                           {
+                               SymbolTable table;
+                               hashHits = 0;
+                               for (const Op &op : ops)
+                                   switch (op.kind)
+                                   {
+                                   case Op::Declare: table.declareVariable(*op.name); break;
+                                   case Op::Use: hashHits += table.isDeclared(*op.name); break;
+                                   case Op::Push: table.pushScope(); break;
+                                   case Op::Pop: table.popScope(); break;
+                                   }
+                           });
+    double linearMs = bestOf(1, [&]
+                             {
+                                 LinearSymbolTable table;
+                                 linearHits = 0;
+                                 for (const Op &op : ops)
+                                     if (op.kind == Op::Declare)
+                                         table.declareVariable(*op.name);
+                                     else if (op.kind == Op::Use)
+                                         linearHits += table.isDeclared(*op.name);
+                             });
+    cout << "resolution replay: scoped hash " << hashMs << " ms (" << hashHits << " resolved), flat vector "
+         << linearMs << " ms (" << linearHits << " resolved), x" << linearMs / hashMs << "\n";
+    return 0;
+}
@@ -0,0 +1,82 @@
+// benchmarks/bench_value_numbering.cpp
+// Build: g++ -std=c++17 -O2 benchmarks/bench_value_numbering.cpp -o bench_value_numbering
+// Value numbering (parser/ir_gvn.cpp) on generated functions full of
+// repeated subexpressions: `a*b + a*b` in one block, the same products
+// recomputed in both arms of an if and in a loop body below them, and
+// comparisons written both ways round. The full optimizer is run without
+// value numbering, with it per block only, and along the dominator tree;
+// for each, the redundant computations found, the IR size, and main() run
+// on the IR interpreter. Every variant must return the same result.
+// Usage: bench_value_numbering [functions]
+
+#define PARSER_REUSE_LEXER
+#include "../regex/regex_code.cpp"
+#include "../parser/parser.cpp"
+#define IR_OPTIMIZER_NO_MAIN
+#include "../parser/ir_optimizer.cpp"
+#include "bench_common.hpp"
+
+static vector<Token> program(size_t n)
+{
+    string body =
+        "int FN(int a, int b) { int x = a * b + a * b; int y = (a + b) * (b + a);\n"
+        " if (a > b) { y = y + a * b - (a + b); } else { y = y - b * a + (b + a); }\n"
+        " int s = 0; int i = 0;\n"
+        " while (i < b) { s = s + i * a + i * a; if (b < a) { s = s - (a + b); } i = i + 1; }\n"
+        " return x + y + s + (a * b) * (a + b); }\n";
+    return joinTokens({numberedCopies(body, n), mainCalling(" total = total + FN(7, 5);\n", n)});
+}
+
+int main(int argc, char **argv)
+{
+    size_t n = argc > 1 ? stoul(argv[1]) : 5000;
+    Program prog;
+    {
+        Parser parser(program(n));
+        prog = parser.parseProgram();
+    }
+    TypeChecker checker;
+    checker.check(prog);
+    ScopeChecker resolver;
+    resolver.analyse(prog);
+
+    OptimizerOptions none, local, global;
+    none.values = false;
+    local.globalValues = false;
+    struct Variant
+    {
+        string name;
+        OptimizerOptions options;
+    };
+    vector<Variant> variants = {{"no value numbering", none},
+                                {"local (per block)", local},
+                                {"global (dominator tree)", global}};
+
+    string expected;
+    bool same = true;
+    for (const Variant &v : variants)
+    {
+        IRGenerator gen;
+        gen.generateIR(prog);
+        IRProgram &ir = gen.program();
+        BenchTimer t;
+        OptimizerReport report = optimizeIR(ir, v.options);
+        double optMs = t.ms();
+        IRInterpreter interpreter(ir);
+        string result;
+        double runMs = bestOf(3, [&] { result = interpreter.text(interpreter.run()); });
+        if (expected.empty())
+            expected = result;
+        same = same && result == expected;
+        cout << v.name << ": " << report.values.local << " local and " << report.values.global
+             << " global redundancies, " << report.after << " instructions (optimized in " << optMs << " ms)\n";
+        cout << "    main() = " << result << ", " << interpreter.steps << " instructions executed in " << runMs
+             << " ms\n";
+    }
+    if (!same)
+    {
+        cout << "MISMATCH: optimized IR computes a different result\n";
+        return 1;
+    }
+    return 0;
+}
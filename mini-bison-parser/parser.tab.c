@@ -55,7 +55,7 @@
 #define YYSKELETON_NAME "yacc.c"
 
 /* Pure parsers.  */
-#define YYPURE 0
+#define YYPURE 2
 
 /* Push parsers.  */
 #define YYPUSH 0
@@ -66,76 +66,6 @@
 
 
 
-/* First part of user prologue.  */
-#line 1 "parser.y"
-
-#include <iostream>
-#include <string>
-#include <vector>
-#include <memory>
-#include <cstdio>
-#include <cstdlib>
-#include <cstring>
-
-class ASTNode {
-public:
-    std::string type;
-    std::string value;
-    std::vector<std::unique_ptr<ASTNode>> children;
-    
-    ASTNode(const std::string& t, const std::string& v = "") : type(t), value(v) {}
-    
-    void addChild(std::unique_ptr<ASTNode> child) {
-        children.push_back(std::move(child));
-    }
-    
-    void print(int indent = 0) const {
-        for (int i = 0; i < indent; ++i) std::cout << "  ";
-        std::cout << type;
-        if (!value.empty()) std::cout << " [" << value << "]";
-        std::cout << std::endl;
-        
-        for (const auto& child : children) {
-            child->print(indent + 1);
-        }
-    }
-};
-
-class SymbolTable {
-private:
-    std::vector<std::string> symbols;
-    
-public:
-    bool isDeclared(const std::string& identifier) {
-        for (const auto& var : symbols) {
-            if (var == identifier) return true;
-        }
-        return false;
-    }
-    
-    void declareVariable(const std::string& identifier) {
-        if (!isDeclared(identifier)) {
-            symbols.push_back(identifier);
-        }
-    }
-    
-    void addBuiltins() {
-        symbols.insert(symbols.end(), {
-            "cout", "cin", "endl", "main", "printf", "scanf", 
-            "malloc", "free", "true", "false", "NULL", "nullptr",
-            "add", "factorial", "printMessage", "calculate"
-        });
-    }
-};
-
-extern int yylex();
-extern void yyerror(const char* s);
-extern FILE* yyin;
-
-static std::unique_ptr<ASTNode> root;
-static SymbolTable symbolTable;
-
-#line 139 "parser.tab.c"
 
 # ifndef YY_CAST
 #  ifdef __cplusplus
@@ -167,92 +97,113 @@ enum yysymbol_kind_t
   YYSYMBOL_YYerror = 1,                    /* error  */
   YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
   YYSYMBOL_IDENTIFIER = 3,                 /* IDENTIFIER  */
-  YYSYMBOL_STRING_LITERAL = 4,             /* STRING_LITERAL  */
-  YYSYMBOL_CHAR_LITERAL = 5,               /* CHAR_LITERAL  */
-  YYSYMBOL_INTEGER = 6,                    /* INTEGER  */
-  YYSYMBOL_FLOAT = 7,                      /* FLOAT  */
-  YYSYMBOL_INT = 8,                        /* INT  */
-  YYSYMBOL_FLOAT_TYPE = 9,                 /* FLOAT_TYPE  */
-  YYSYMBOL_DOUBLE = 10,                    /* DOUBLE  */
-  YYSYMBOL_CHAR = 11,                      /* CHAR  */
+  YYSYMBOL_INT_LITERAL = 4,                /* INT_LITERAL  */
+  YYSYMBOL_FLOAT_LITERAL = 5,              /* FLOAT_LITERAL  */
+  YYSYMBOL_STRING_LITERAL = 6,             /* STRING_LITERAL  */
+  YYSYMBOL_CHAR_LITERAL = 7,               /* CHAR_LITERAL  */
+  YYSYMBOL_BOOL_LITERAL = 8,               /* BOOL_LITERAL  */
+  YYSYMBOL_INT = 9,                        /* INT  */
+  YYSYMBOL_FLOAT = 10,                     /* FLOAT  */
+  YYSYMBOL_STRING = 11,                    /* STRING  */
   YYSYMBOL_BOOL = 12,                      /* BOOL  */
-  YYSYMBOL_VOID = 13,                      /* VOID  */
-  YYSYMBOL_STRING = 14,                    /* STRING  */
+  YYSYMBOL_CHAR = 13,                      /* CHAR  */
+  YYSYMBOL_FN = 14,                        /* FN  */
   YYSYMBOL_IF = 15,                        /* IF  */
   YYSYMBOL_ELSE = 16,                      /* ELSE  */
   YYSYMBOL_WHILE = 17,                     /* WHILE  */
-  YYSYMBOL_FOR = 18,                       /* FOR  */
-  YYSYMBOL_RETURN = 19,                    /* RETURN  */
-  YYSYMBOL_BREAK = 20,                     /* BREAK  */
-  YYSYMBOL_CONTINUE = 21,                  /* CONTINUE  */
-  YYSYMBOL_COUT = 22,                      /* COUT  */
-  YYSYMBOL_CIN = 23,                       /* CIN  */
-  YYSYMBOL_ENDL = 24,                      /* ENDL  */
-  YYSYMBOL_PLUS = 25,                      /* PLUS  */
-  YYSYMBOL_MINUS = 26,                     /* MINUS  */
-  YYSYMBOL_MULTIPLY = 27,                  /* MULTIPLY  */
-  YYSYMBOL_DIVIDE = 28,                    /* DIVIDE  */
-  YYSYMBOL_MODULO = 29,                    /* MODULO  */
-  YYSYMBOL_ASSIGN = 30,                    /* ASSIGN  */
-  YYSYMBOL_EQ = 31,                        /* EQ  */
-  YYSYMBOL_NE = 32,                        /* NE  */
-  YYSYMBOL_LT = 33,                        /* LT  */
-  YYSYMBOL_LE = 34,                        /* LE  */
-  YYSYMBOL_GT = 35,                        /* GT  */
-  YYSYMBOL_GE = 36,                        /* GE  */
-  YYSYMBOL_AND = 37,                       /* AND  */
-  YYSYMBOL_OR = 38,                        /* OR  */
-  YYSYMBOL_NOT = 39,                       /* NOT  */
-  YYSYMBOL_INCREMENT = 40,                 /* INCREMENT  */
-  YYSYMBOL_DECREMENT = 41,                 /* DECREMENT  */
-  YYSYMBOL_LPAREN = 42,                    /* LPAREN  */
-  YYSYMBOL_RPAREN = 43,                    /* RPAREN  */
-  YYSYMBOL_LBRACE = 44,                    /* LBRACE  */
-  YYSYMBOL_RBRACE = 45,                    /* RBRACE  */
-  YYSYMBOL_LBRACKET = 46,                  /* LBRACKET  */
-  YYSYMBOL_RBRACKET = 47,                  /* RBRACKET  */
-  YYSYMBOL_SEMICOLON = 48,                 /* SEMICOLON  */
-  YYSYMBOL_COMMA = 49,                     /* COMMA  */
-  YYSYMBOL_COLON = 50,                     /* COLON  */
-  YYSYMBOL_OUTPUT = 51,                    /* OUTPUT  */
-  YYSYMBOL_INPUT = 52,                     /* INPUT  */
-  YYSYMBOL_TRUE = 53,                      /* TRUE  */
-  YYSYMBOL_FALSE = 54,                     /* FALSE  */
-  YYSYMBOL_LOWER_THAN_ELSE = 55,           /* LOWER_THAN_ELSE  */
-  YYSYMBOL_YYACCEPT = 56,                  /* $accept  */
-  YYSYMBOL_program = 57,                   /* program  */
-  YYSYMBOL_translation_unit = 58,          /* translation_unit  */
-  YYSYMBOL_external_declaration = 59,      /* external_declaration  */
-  YYSYMBOL_function_definition = 60,       /* function_definition  */
-  YYSYMBOL_parameter_list = 61,            /* parameter_list  */
-  YYSYMBOL_parameter_declaration = 62,     /* parameter_declaration  */
-  YYSYMBOL_declaration = 63,               /* declaration  */
-  YYSYMBOL_init_declarator_list = 64,      /* init_declarator_list  */
-  YYSYMBOL_init_declarator = 65,           /* init_declarator  */
+  YYSYMBOL_DO = 18,                        /* DO  */
+  YYSYMBOL_FOR = 19,                       /* FOR  */
+  YYSYMBOL_RETURN = 20,                    /* RETURN  */
+  YYSYMBOL_BREAK = 21,                     /* BREAK  */
+  YYSYMBOL_PLUS = 22,                      /* PLUS  */
+  YYSYMBOL_MINUS = 23,                     /* MINUS  */
+  YYSYMBOL_MULTIPLY = 24,                  /* MULTIPLY  */
+  YYSYMBOL_DIVIDE = 25,                    /* DIVIDE  */
+  YYSYMBOL_POWER = 26,                     /* POWER  */
+  YYSYMBOL_ASSIGN = 27,                    /* ASSIGN  */
+  YYSYMBOL_PLUS_EQ = 28,                   /* PLUS_EQ  */
+  YYSYMBOL_MINUS_EQ = 29,                  /* MINUS_EQ  */
+  YYSYMBOL_EQ = 30,                        /* EQ  */
+  YYSYMBOL_NE = 31,                        /* NE  */
+  YYSYMBOL_LT = 32,                        /* LT  */
+  YYSYMBOL_LE = 33,                        /* LE  */
+  YYSYMBOL_GT = 34,                        /* GT  */
+  YYSYMBOL_GE = 35,                        /* GE  */
+  YYSYMBOL_AND = 36,                       /* AND  */
+  YYSYMBOL_OR = 37,                        /* OR  */
+  YYSYMBOL_NOT = 38,                       /* NOT  */
+  YYSYMBOL_BITAND = 39,                    /* BITAND  */
+  YYSYMBOL_BITOR = 40,                     /* BITOR  */
+  YYSYMBOL_BITXOR = 41,                    /* BITXOR  */
+  YYSYMBOL_LSHIFT = 42,                    /* LSHIFT  */
+  YYSYMBOL_RSHIFT = 43,                    /* RSHIFT  */
+  YYSYMBOL_INCREMENT = 44,                 /* INCREMENT  */
+  YYSYMBOL_DECREMENT = 45,                 /* DECREMENT  */
+  YYSYMBOL_LPAREN = 46,                    /* LPAREN  */
+  YYSYMBOL_RPAREN = 47,                    /* RPAREN  */
+  YYSYMBOL_LBRACE = 48,                    /* LBRACE  */
+  YYSYMBOL_RBRACE = 49,                    /* RBRACE  */
+  YYSYMBOL_LBRACKET = 50,                  /* LBRACKET  */
+  YYSYMBOL_RBRACKET = 51,                  /* RBRACKET  */
+  YYSYMBOL_SEMICOLON = 52,                 /* SEMICOLON  */
+  YYSYMBOL_COMMA = 53,                     /* COMMA  */
+  YYSYMBOL_LOWER_THAN_ELSE = 54,           /* LOWER_THAN_ELSE  */
+  YYSYMBOL_NAME = 55,                      /* NAME  */
+  YYSYMBOL_PREFIX = 56,                    /* PREFIX  */
+  YYSYMBOL_YYACCEPT = 57,                  /* $accept  */
+  YYSYMBOL_program = 58,                   /* program  */
+  YYSYMBOL_top_decl = 59,                  /* top_decl  */
+  YYSYMBOL_function_head = 60,             /* function_head  */
+  YYSYMBOL_61_1 = 61,                      /* $@1  */
+  YYSYMBOL_62_2 = 62,                      /* $@2  */
+  YYSYMBOL_parameter_list_opt = 63,        /* parameter_list_opt  */
+  YYSYMBOL_parameter_list = 64,            /* parameter_list  */
+  YYSYMBOL_parameter = 65,                 /* parameter  */
   YYSYMBOL_type = 66,                      /* type  */
-  YYSYMBOL_compound_statement = 67,        /* compound_statement  */
+  YYSYMBOL_block_body = 67,                /* block_body  */
   YYSYMBOL_statement_list = 68,            /* statement_list  */
   YYSYMBOL_statement = 69,                 /* statement  */
-  YYSYMBOL_selection_statement = 70,       /* selection_statement  */
-  YYSYMBOL_iteration_statement = 71,       /* iteration_statement  */
-  YYSYMBOL_jump_statement = 72,            /* jump_statement  */
-  YYSYMBOL_expression = 73,                /* expression  */
-  YYSYMBOL_assignment_expression = 74,     /* assignment_expression  */
-  YYSYMBOL_logical_or_expression = 75,     /* logical_or_expression  */
-  YYSYMBOL_logical_and_expression = 76,    /* logical_and_expression  */
-  YYSYMBOL_equality_expression = 77,       /* equality_expression  */
-  YYSYMBOL_relational_expression = 78,     /* relational_expression  */
-  YYSYMBOL_additive_expression = 79,       /* additive_expression  */
-  YYSYMBOL_multiplicative_expression = 80, /* multiplicative_expression  */
-  YYSYMBOL_unary_expression = 81,          /* unary_expression  */
-  YYSYMBOL_postfix_expression = 82,        /* postfix_expression  */
-  YYSYMBOL_primary_expression = 83,        /* primary_expression  */
-  YYSYMBOL_argument_expression_list = 84   /* argument_expression_list  */
+  YYSYMBOL_70_3 = 70,                      /* $@3  */
+  YYSYMBOL_71_4 = 71,                      /* $@4  */
+  YYSYMBOL_declaration = 72,               /* declaration  */
+  YYSYMBOL_declarator_list = 73,           /* declarator_list  */
+  YYSYMBOL_for_init = 74,                  /* for_init  */
+  YYSYMBOL_expression_opt = 75,            /* expression_opt  */
+  YYSYMBOL_expression = 76,                /* expression  */
+  YYSYMBOL_argument_list_opt = 77,         /* argument_list_opt  */
+  YYSYMBOL_argument_list = 78              /* argument_list  */
 };
 typedef enum yysymbol_kind_t yysymbol_kind_t;
 
 
 
+/* Unqualified %code blocks.  */
+#line 194 "parser.y"
+
+#include <iostream>
+
+int yylex(YYSTYPE* lval, YYLTYPE* lloc, ParseContext& ctx);
+void yyerror(YYLTYPE* lloc, ParseContext& ctx, const char* s);
+
+static Expr* binary(ParseContext& ctx, const char* op, Expr* lhs, Expr* rhs, const YYLTYPE& at) {
+    return ctx.make<BinaryExpr>(op, ctx.link(lhs), ctx.link(rhs), at.first_line, at.first_column);
+}
+
+// x += y is desugared to x = x + y, sharing x (as the Pratt parser does).
+static Expr* compound(ParseContext& ctx, const char* op, Expr* lhs, Expr* rhs, const YYLTYPE& at) {
+    ExprPtr target = ctx.link(lhs);
+    auto combined = ctx.make<BinaryExpr>(op, target, ctx.link(rhs), at.first_line, at.first_column);
+    return ctx.make<BinaryExpr>("=", target, ctx.link(combined), at.first_line, at.first_column);
+}
+
+static FnDecl* makeFunction(ParseContext& ctx, const Token* type, const Token* name, ParamList* params,
+                            const YYLTYPE& at) {
+    auto fn = ctx.make<FnDecl>(type->type, name->lexeme, at.first_line, at.first_column);
+    fn->params = std::move(*params);
+    return fn;
+}
+
+#line 207 "parser.tab.c"
 
 #ifdef short
 # undef short
@@ -514,13 +465,15 @@ void free (void *); /* INFRINGES ON USER NAME SPACE */
 
 #if (! defined yyoverflow \
      && (! defined __cplusplus \
-         || (defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
+         || (defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL \
+             && defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
 
 /* A type that is properly aligned for any stack member.  */
 union yyalloc
 {
   yy_state_t yyss_alloc;
   YYSTYPE yyvs_alloc;
+  YYLTYPE yyls_alloc;
 };
 
 /* The size of the maximum gap between one aligned stack and the next.  */
@@ -529,8 +482,9 @@ union yyalloc
 /* The size of an array large to enough to hold all stacks, each with
    N elements.  */
 # define YYSTACK_BYTES(N) \
-     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE)) \
-      + YYSTACK_GAP_MAXIMUM)
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE) \
+             + YYSIZEOF (YYLTYPE)) \
+      + 2 * YYSTACK_GAP_MAXIMUM)
 
 # define YYCOPY_NEEDED 1
 
@@ -573,21 +527,21 @@ union yyalloc
 #endif /* !YYCOPY_NEEDED */
 
 /* YYFINAL -- State number of the termination state.  */
-#define YYFINAL  14
+#define YYFINAL  2
 /* YYLAST -- Last index in YYTABLE.  */
-#define YYLAST   297
+#define YYLAST   731
 
 /* YYNTOKENS -- Number of terminals.  */
-#define YYNTOKENS  56
+#define YYNTOKENS  57
 /* YYNNTS -- Number of nonterminals.  */
-#define YYNNTS  29
+#define YYNNTS  22
 /* YYNRULES -- Number of rules.  */
-#define YYNRULES  85
+#define YYNRULES  94
 /* YYNSTATES -- Number of states.  */
-#define YYNSTATES  151
+#define YYNSTATES  178
 
 /* YYMAXUTOK -- Last valid token kind.  */
-#define YYMAXUTOK   310
+#define YYMAXUTOK   311
 
 
 /* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
@@ -632,22 +586,23 @@ static const yytype_int8 yytranslate[] =
       25,    26,    27,    28,    29,    30,    31,    32,    33,    34,
       35,    36,    37,    38,    39,    40,    41,    42,    43,    44,
       45,    46,    47,    48,    49,    50,    51,    52,    53,    54,
-      55
+      55,    56
 };
 
 #if YYDEBUG
 /* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
 static const yytype_int16 yyrline[] =
 {
-       0,   122,   122,   129,   133,   143,   147,   154,   164,   176,
-     182,   192,   203,   213,   219,   229,   236,   247,   248,   249,
-     250,   251,   252,   253,   257,   263,   270,   276,   286,   290,
-     294,   298,   302,   306,   310,   316,   323,   330,   337,   348,
-     355,   367,   373,   377,   381,   388,   395,   399,   413,   414,
-     424,   425,   435,   436,   443,   453,   454,   461,   468,   475,
-     485,   486,   493,   503,   504,   511,   518,   528,   529,   535,
-     541,   550,   551,   557,   563,   571,   581,   591,   596,   601,
-     607,   613,   617,   621,   630,   636
+       0,   288,   288,   289,   294,   302,   307,   317,   322,   334,
+     333,   343,   342,   354,   355,   359,   364,   372,   377,   384,
+     384,   384,   384,   384,   395,   396,   400,   401,   410,   414,
+     415,   419,   423,   427,   431,   435,   439,   439,   445,   449,
+     449,   456,   460,   469,   486,   491,   496,   502,   512,   513,
+     518,   526,   527,   531,   535,   539,   543,   547,   551,   557,
+     562,   566,   570,   574,   578,   582,   586,   590,   594,   598,
+     602,   603,   604,   605,   606,   607,   608,   609,   610,   611,
+     612,   613,   614,   615,   616,   617,   618,   619,   620,   621,
+     622,   626,   627,   631,   637
 };
 #endif
 
@@ -664,23 +619,18 @@ static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
 static const char *const yytname[] =
 {
   "\"end of file\"", "error", "\"invalid token\"", "IDENTIFIER",
-  "STRING_LITERAL", "CHAR_LITERAL", "INTEGER", "FLOAT", "INT",
-  "FLOAT_TYPE", "DOUBLE", "CHAR", "BOOL", "VOID", "STRING", "IF", "ELSE",
-  "WHILE", "FOR", "RETURN", "BREAK", "CONTINUE", "COUT", "CIN", "ENDL",
-  "PLUS", "MINUS", "MULTIPLY", "DIVIDE", "MODULO", "ASSIGN", "EQ", "NE",
-  "LT", "LE", "GT", "GE", "AND", "OR", "NOT", "INCREMENT", "DECREMENT",
-  "LPAREN", "RPAREN", "LBRACE", "RBRACE", "LBRACKET", "RBRACKET",
-  "SEMICOLON", "COMMA", "COLON", "OUTPUT", "INPUT", "TRUE", "FALSE",
-  "LOWER_THAN_ELSE", "$accept", "program", "translation_unit",
-  "external_declaration", "function_definition", "parameter_list",
-  "parameter_declaration", "declaration", "init_declarator_list",
-  "init_declarator", "type", "compound_statement", "statement_list",
-  "statement", "selection_statement", "iteration_statement",
-  "jump_statement", "expression", "assignment_expression",
-  "logical_or_expression", "logical_and_expression", "equality_expression",
-  "relational_expression", "additive_expression",
-  "multiplicative_expression", "unary_expression", "postfix_expression",
-  "primary_expression", "argument_expression_list", YY_NULLPTR
+  "INT_LITERAL", "FLOAT_LITERAL", "STRING_LITERAL", "CHAR_LITERAL",
+  "BOOL_LITERAL", "INT", "FLOAT", "STRING", "BOOL", "CHAR", "FN", "IF",
+  "ELSE", "WHILE", "DO", "FOR", "RETURN", "BREAK", "PLUS", "MINUS",
+  "MULTIPLY", "DIVIDE", "POWER", "ASSIGN", "PLUS_EQ", "MINUS_EQ", "EQ",
+  "NE", "LT", "LE", "GT", "GE", "AND", "OR", "NOT", "BITAND", "BITOR",
+  "BITXOR", "LSHIFT", "RSHIFT", "INCREMENT", "DECREMENT", "LPAREN",
+  "RPAREN", "LBRACE", "RBRACE", "LBRACKET", "RBRACKET", "SEMICOLON",
+  "COMMA", "LOWER_THAN_ELSE", "NAME", "PREFIX", "$accept", "program",
+  "top_decl", "function_head", "$@1", "$@2", "parameter_list_opt",
+  "parameter_list", "parameter", "type", "block_body", "statement_list",
+  "statement", "$@3", "$@4", "declaration", "declarator_list", "for_init",
+  "expression_opt", "expression", "argument_list_opt", "argument_list", YY_NULLPTR
 };
 
 static const char *
@@ -690,7 +640,7 @@ yysymbol_name (yysymbol_kind_t yysymbol)
 }
 #endif
 
-#define YYPACT_NINF (-50)
+#define YYPACT_NINF (-159)
 
 #define yypact_value_is_default(Yyn) \
   ((Yyn) == YYPACT_NINF)
@@ -704,22 +654,24 @@ yysymbol_name (yysymbol_kind_t yysymbol)
    STATE-NUM.  */
 static const yytype_int16 yypact[] =
 {
-     146,   -50,   -50,   -50,   -50,   -50,   -50,   -50,    46,   146,
-     -50,   -50,   -50,    54,   -50,   -50,   -26,   -29,   -50,    49,
-     254,   -50,    68,   -24,   -50,   -50,   -50,   -50,   207,   207,
-     207,    49,   -50,   -50,   -50,   -50,    24,    39,    11,    59,
-      34,    87,   -50,    25,   -50,    38,   -36,   -50,    81,    55,
-     -50,    49,    44,    62,   -50,   -50,   -50,    53,   207,   207,
-     207,   207,   207,   207,   207,   207,   207,   207,   207,   207,
-     207,   -50,   -50,    19,   -50,    38,   146,   -50,   -50,   -50,
-     -50,   -34,   -50,    39,    11,    59,    59,    34,    34,    34,
-      34,    87,    87,   -50,   -50,   -50,    63,    65,    77,   200,
-      73,    75,    74,   -50,   -50,   -50,    68,   -50,   124,   -50,
-     -50,   -50,   -50,    76,   -50,   -50,   -50,    49,    49,    49,
-      49,   -50,    92,   -50,   -50,    49,   -50,   -50,   -50,   -50,
-      67,   104,   100,   -50,   -37,   176,   176,    49,   -50,    49,
-     145,   -50,   114,   116,   176,    49,   -50,   -50,   122,   176,
-     -50
+    -159,   699,  -159,  -159,  -159,  -159,  -159,  -159,  -159,   167,
+    -159,   -44,     4,    23,  -159,  -159,    47,    -5,  -159,   152,
+     263,  -159,  -159,  -159,   -47,    -4,  -159,  -159,  -159,  -159,
+    -159,     1,     2,   202,    29,    75,    -6,   263,   263,   263,
+     263,   263,   263,  -159,  -159,  -159,    86,  -159,  -159,   288,
+     319,   167,   167,  -159,  -159,   263,   263,   263,    -2,    73,
+    -159,  -159,   350,  -159,   652,   652,   652,   652,   652,   411,
+    -159,    65,   -13,   263,   263,   263,   263,   263,   263,   263,
+     263,   263,   263,   263,   263,   263,   263,   263,   263,   263,
+     263,   263,   263,   263,  -159,  -159,   263,   263,  -159,  -159,
+      49,    41,  -159,    97,    55,   527,    63,    56,   440,   469,
+      69,   252,  -159,  -159,  -159,   263,  -159,   113,    -1,    -1,
+      88,    88,    88,   527,   527,   527,   614,   614,   -12,   -12,
+     -12,   -12,   585,   556,   652,    62,   643,   681,   681,    76,
+     381,  -159,   167,  -159,  -159,  -159,   263,   202,   202,   263,
+     119,    72,  -159,   527,   527,    98,  -159,  -159,  -159,   527,
+     112,  -159,   498,   103,   263,   263,   202,    79,   263,    83,
+     527,  -159,  -159,   527,   263,    90,   202,  -159
 };
 
 /* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
@@ -727,38 +679,40 @@ static const yytype_int16 yypact[] =
    means the default is an error.  */
 static const yytype_int8 yydefact[] =
 {
-       0,    17,    18,    19,    20,    21,    22,    23,     0,     2,
-       3,     5,     6,     0,     1,     4,    15,     0,    13,     0,
-       0,    12,     0,    76,    79,    80,    77,    78,     0,     0,
-       0,     0,    81,    82,    16,    45,    46,    48,    50,    52,
-      55,    60,    63,    67,    71,     0,     0,     9,     0,    15,
-      14,     0,     0,    76,    68,    69,    70,     0,     0,     0,
+       2,     0,     1,     4,    19,    20,    21,    22,    23,     0,
+       3,     0,     0,     0,    26,     5,     0,     0,     6,     0,
+       0,    11,     7,     9,     0,    58,    53,    54,    55,    56,
+      57,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,    39,    24,    28,     0,    27,    29,     0,
+       0,    13,    13,    25,    42,    91,     0,     0,     0,     0,
+      36,    30,     0,    38,    66,    65,    67,    68,    69,     0,
+      26,    44,     0,     0,     0,     0,     0,     0,     0,     0,
        0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,    72,    73,     0,     8,     0,     0,    11,    47,    75,
-      84,     0,    83,    49,    51,    53,    54,    56,    57,    58,
-      59,    61,    62,    64,    65,    66,     0,     0,     0,     0,
-       0,     0,     0,    25,    36,    33,     0,    29,     0,    26,
-      30,    31,    32,     0,     7,    10,    74,     0,     0,     0,
-       0,    42,     0,    43,    44,     0,    24,    27,    28,    85,
-       0,     0,     0,    41,     0,     0,     0,     0,    34,     0,
-      37,    39,     0,     0,     0,     0,    35,    38,     0,     0,
-      40
+       0,     0,     0,     0,    63,    64,    91,     0,    41,     8,
+       0,    14,    15,    18,     0,    93,     0,    92,     0,     0,
+       0,    51,    31,    60,    40,     0,    43,     0,    86,    87,
+      88,    89,    90,    70,    71,    72,    75,    76,    77,    78,
+      79,    80,    74,    73,    83,    81,    82,    84,    85,     0,
+       0,    12,     0,    17,    10,    59,     0,     0,     0,     0,
+       0,     0,    48,    52,    45,    46,    61,    62,    16,    94,
+      32,    34,     0,    49,    51,     0,     0,     0,     0,     0,
+      47,    33,    35,    50,    51,     0,     0,    37
 };
 
 /* YYPGOTO[NTERM-NUM].  */
 static const yytype_int16 yypgoto[] =
 {
-     -50,   -50,   -50,   158,   -50,   -50,    94,     8,   -50,   149,
-       1,   -40,   -50,   -27,   -50,   -50,   -50,   -19,   -49,   -50,
-     134,   140,    18,   111,    23,    83,   -50,   -50,   -50
+    -159,  -159,  -159,  -159,  -159,  -159,    87,  -159,     5,     0,
+      70,  -159,   -30,  -159,  -159,  -159,  -159,  -159,  -158,   -20,
+      45,  -159
 };
 
 /* YYDEFGOTO[NTERM-NUM].  */
-static const yytype_int8 yydefgoto[] =
+static const yytype_uint8 yydefgoto[] =
 {
-       0,     8,     9,    10,    11,    46,    47,   105,    17,    18,
-     106,   107,   108,   109,   110,   111,   112,   113,    35,    36,
-      37,    38,    39,    40,    41,    42,    43,    44,    81
+       0,     1,    10,    11,    52,    51,   100,   101,   102,    46,
+      18,    19,    47,   111,    70,    48,    72,   151,   152,    49,
+     106,   107
 };
 
 /* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
@@ -766,120 +720,212 @@ static const yytype_int8 yydefgoto[] =
    number is the opposite.  If YYTABLE_NINF, syntax error.  */
 static const yytype_uint8 yytable[] =
 {
-      34,    13,    78,    80,    19,    74,    51,    75,    12,   116,
-      13,   138,    57,    76,   139,   117,    20,    12,    52,    21,
-      22,    48,    23,    24,    25,    26,    27,     1,     2,     3,
-       4,     5,     6,     7,    96,   114,    97,    98,    99,   100,
-     101,   102,    60,    61,    28,    29,    14,    23,    24,    25,
-      26,    27,    23,    24,    25,    26,    27,    16,    30,    66,
-      67,    31,    58,    73,   103,    71,    72,   104,   129,    28,
-      29,    49,    32,    33,    28,    29,    59,    48,    85,    86,
-     122,   127,    73,    30,    77,    19,    31,    79,    30,    91,
-      92,    31,    62,    63,    64,    65,    82,    32,    33,   130,
-     131,   132,    32,    33,    52,   118,   134,   119,   140,   141,
-     135,    54,    55,    56,    68,    69,    70,   147,   142,   120,
-     143,   123,   150,   124,   128,   125,   148,    23,    24,    25,
-      26,    27,     1,     2,     3,     4,     5,     6,     7,    96,
-     133,    97,    98,    99,   100,   101,   102,   136,   137,    28,
-      29,    93,    94,    95,     1,     2,     3,     4,     5,     6,
-       7,   144,   145,    30,   146,   149,    31,    15,    73,   126,
-     115,    50,   104,    87,    88,    89,    90,    32,    33,    23,
-      24,    25,    26,    27,     1,     2,     3,     4,     5,     6,
-       7,    96,    83,    97,    98,    99,   100,   101,   102,    84,
-       0,    28,    29,    23,    24,    25,    26,    27,     0,     0,
-      53,    24,    25,    26,    27,    30,     0,     0,    31,     0,
-      73,     0,     0,     0,   104,    28,    29,     0,     0,    32,
-      33,     0,    28,    29,     0,     0,     0,     0,     0,    30,
-       0,     0,    31,     0,     0,     0,    30,     0,   121,    31,
-       0,     0,     0,    32,    33,     0,     0,     0,     0,     0,
-      32,    33,     1,     2,     3,     4,     5,     6,     7,     0,
-       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+      50,    12,    53,    59,    14,    54,   169,    16,    15,    13,
+      73,    74,    75,    76,    77,    62,   175,    64,    65,    66,
+      67,    68,    69,    75,    76,    77,    17,    89,    90,    91,
+      92,    93,    94,    95,    96,   105,   108,   109,    97,   116,
+     117,    23,    55,    94,    95,    96,    63,    56,    57,    97,
+      54,   103,   103,   118,   119,   120,   121,   122,   123,   124,
+     125,   126,   127,   128,   129,   130,   131,   132,   133,   134,
+     135,   136,   137,   138,    20,    60,   105,   140,    25,    26,
+      27,    28,    29,    30,    73,    74,    75,    76,    77,    71,
+     110,   153,   115,    21,   142,   154,   141,    37,    38,    22,
+     143,    89,   144,    91,    92,    93,    94,    95,    96,   146,
+     145,   150,    97,    39,    77,   149,   155,   160,   161,    40,
+      41,    42,   163,   156,   164,   165,   159,    61,   166,   162,
+     168,   172,    94,    95,    96,   174,   171,   176,    97,   104,
+     114,   139,   103,     0,   153,   170,   177,   158,   173,     0,
+       0,     0,     0,    24,   153,    25,    26,    27,    28,    29,
+      30,     4,     5,     6,     7,     8,     0,    31,     0,    32,
+      33,    34,    35,    36,    37,    38,     4,     5,     6,     7,
+       8,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+      39,     0,     0,     0,     0,     0,    40,    41,    42,     0,
+      43,    44,     0,    58,    45,    25,    26,    27,    28,    29,
+      30,     4,     5,     6,     7,     8,     0,    31,     0,    32,
+      33,    34,    35,    36,    37,    38,     0,     0,     0,     0,
        0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,     0,     0,     0,    45
+      39,     0,     0,     0,     0,     0,    40,    41,    42,     0,
+      43,     0,     0,     0,    45,    25,    26,    27,    28,    29,
+      30,     4,     5,     6,     7,     8,    25,    26,    27,    28,
+      29,    30,     0,     0,    37,    38,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,    37,    38,     0,     0,     0,
+      39,     0,     0,     0,     0,     0,    40,    41,    42,     0,
+       0,    39,     0,     0,     0,     0,     0,    40,    41,    42,
+      73,    74,    75,    76,    77,    78,    79,    80,    81,    82,
+      83,    84,    85,    86,    87,    88,     0,    89,    90,    91,
+      92,    93,    94,    95,    96,     0,     0,     0,    97,     0,
+      98,    73,    74,    75,    76,    77,    78,    79,    80,    81,
+      82,    83,    84,    85,    86,    87,    88,     0,    89,    90,
+      91,    92,    93,    94,    95,    96,     0,     0,     0,    97,
+       0,    99,    73,    74,    75,    76,    77,    78,    79,    80,
+      81,    82,    83,    84,    85,    86,    87,    88,     0,    89,
+      90,    91,    92,    93,    94,    95,    96,     0,     0,     0,
+      97,     0,   112,    73,    74,    75,    76,    77,    78,    79,
+      80,    81,    82,    83,    84,    85,    86,    87,    88,     0,
+      89,    90,    91,    92,    93,    94,    95,    96,     0,     0,
+       0,    97,   157,    73,    74,    75,    76,    77,    78,    79,
+      80,    81,    82,    83,    84,    85,    86,    87,    88,     0,
+      89,    90,    91,    92,    93,    94,    95,    96,   113,     0,
+       0,    97,    73,    74,    75,    76,    77,    78,    79,    80,
+      81,    82,    83,    84,    85,    86,    87,    88,     0,    89,
+      90,    91,    92,    93,    94,    95,    96,   147,     0,     0,
+      97,    73,    74,    75,    76,    77,    78,    79,    80,    81,
+      82,    83,    84,    85,    86,    87,    88,     0,    89,    90,
+      91,    92,    93,    94,    95,    96,   148,     0,     0,    97,
+      73,    74,    75,    76,    77,    78,    79,    80,    81,    82,
+      83,    84,    85,    86,    87,    88,     0,    89,    90,    91,
+      92,    93,    94,    95,    96,   167,     0,     0,    97,    73,
+      74,    75,    76,    77,    78,    79,    80,    81,    82,    83,
+      84,    85,    86,    87,    88,     0,    89,    90,    91,    92,
+      93,    94,    95,    96,     0,     0,     0,    97,    73,    74,
+      75,    76,    77,     0,     0,     0,    81,    82,    83,    84,
+      85,    86,    87,     0,     0,    89,    90,    91,    92,    93,
+      94,    95,    96,     0,     0,     0,    97,    73,    74,    75,
+      76,    77,     0,     0,     0,    81,    82,    83,    84,    85,
+      86,     0,     0,     0,    89,    90,    91,    92,    93,    94,
+      95,    96,     0,     0,     0,    97,    73,    74,    75,    76,
+      77,     0,     0,     0,     0,     0,    83,    84,    85,    86,
+       0,     0,     0,    89,    90,    91,    92,    93,    94,    95,
+      96,     0,     0,     0,    97,    73,    74,    75,    76,    77,
+       0,     0,     0,     0,    73,    74,    75,    76,    77,     0,
+       0,     0,    89,     0,     0,    92,    93,    94,    95,    96,
+       0,     0,     0,    97,    92,    93,    94,    95,    96,     2,
+       3,     0,    97,    73,    74,    75,    76,    77,     4,     5,
+       6,     7,     8,     9,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,    94,    95,    96,     0,     0,
+       0,    97
 };
 
 static const yytype_int16 yycheck[] =
 {
-      19,     0,    51,    52,    30,    45,    30,    43,     0,    43,
-       9,    48,    31,    49,    51,    49,    42,     9,    42,    48,
-      49,    20,     3,     4,     5,     6,     7,     8,     9,    10,
-      11,    12,    13,    14,    15,    75,    17,    18,    19,    20,
-      21,    22,    31,    32,    25,    26,     0,     3,     4,     5,
-       6,     7,     3,     4,     5,     6,     7,     3,    39,    25,
-      26,    42,    38,    44,    45,    40,    41,    48,   117,    25,
-      26,     3,    53,    54,    25,    26,    37,    76,    60,    61,
-      99,   108,    44,    39,     3,    30,    42,    43,    39,    66,
-      67,    42,    33,    34,    35,    36,    43,    53,    54,   118,
-     119,   120,    53,    54,    42,    42,   125,    42,   135,   136,
-      43,    28,    29,    30,    27,    28,    29,   144,   137,    42,
-     139,    48,   149,    48,    48,    51,   145,     3,     4,     5,
-       6,     7,     8,     9,    10,    11,    12,    13,    14,    15,
-      48,    17,    18,    19,    20,    21,    22,    43,    48,    25,
-      26,    68,    69,    70,     8,     9,    10,    11,    12,    13,
-      14,    16,    48,    39,    48,    43,    42,     9,    44,    45,
-      76,    22,    48,    62,    63,    64,    65,    53,    54,     3,
-       4,     5,     6,     7,     8,     9,    10,    11,    12,    13,
-      14,    15,    58,    17,    18,    19,    20,    21,    22,    59,
-      -1,    25,    26,     3,     4,     5,     6,     7,    -1,    -1,
-       3,     4,     5,     6,     7,    39,    -1,    -1,    42,    -1,
-      44,    -1,    -1,    -1,    48,    25,    26,    -1,    -1,    53,
-      54,    -1,    25,    26,    -1,    -1,    -1,    -1,    -1,    39,
-      -1,    -1,    42,    -1,    -1,    -1,    39,    -1,    48,    42,
-      -1,    -1,    -1,    53,    54,    -1,    -1,    -1,    -1,    -1,
-      53,    54,     8,     9,    10,    11,    12,    13,    14,    -1,
+      20,     1,    49,    33,    48,    52,   164,     3,    52,     9,
+      22,    23,    24,    25,    26,    35,   174,    37,    38,    39,
+      40,    41,    42,    24,    25,    26,     3,    39,    40,    41,
+      42,    43,    44,    45,    46,    55,    56,    57,    50,    52,
+      53,    46,    46,    44,    45,    46,    52,    46,    46,    50,
+      52,    51,    52,    73,    74,    75,    76,    77,    78,    79,
+      80,    81,    82,    83,    84,    85,    86,    87,    88,    89,
+      90,    91,    92,    93,    27,    46,    96,    97,     3,     4,
+       5,     6,     7,     8,    22,    23,    24,    25,    26,     3,
+      17,   111,    27,    46,    53,   115,    47,    22,    23,    52,
+       3,    39,    47,    41,    42,    43,    44,    45,    46,    53,
+      47,   111,    50,    38,    26,    46,     3,   147,   148,    44,
+      45,    46,     3,    47,    52,    27,   146,    52,    16,   149,
+      27,    52,    44,    45,    46,    52,   166,    47,    50,    52,
+      70,    96,   142,    -1,   164,   165,   176,   142,   168,    -1,
+      -1,    -1,    -1,     1,   174,     3,     4,     5,     6,     7,
+       8,     9,    10,    11,    12,    13,    -1,    15,    -1,    17,
+      18,    19,    20,    21,    22,    23,     9,    10,    11,    12,
+      13,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
+      38,    -1,    -1,    -1,    -1,    -1,    44,    45,    46,    -1,
+      48,    49,    -1,     1,    52,     3,     4,     5,     6,     7,
+       8,     9,    10,    11,    12,    13,    -1,    15,    -1,    17,
+      18,    19,    20,    21,    22,    23,    -1,    -1,    -1,    -1,
       -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
-      -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,    -1,
-      -1,    -1,    -1,    -1,    -1,    -1,    -1,    43
+      38,    -1,    -1,    -1,    -1,    -1,    44,    45,    46,    -1,
+      48,    -1,    -1,    -1,    52,     3,     4,     5,     6,     7,
+       8,     9,    10,    11,    12,    13,     3,     4,     5,     6,
+       7,     8,    -1,    -1,    22,    23,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    22,    23,    -1,    -1,    -1,
+      38,    -1,    -1,    -1,    -1,    -1,    44,    45,    46,    -1,
+      -1,    38,    -1,    -1,    -1,    -1,    -1,    44,    45,    46,
+      22,    23,    24,    25,    26,    27,    28,    29,    30,    31,
+      32,    33,    34,    35,    36,    37,    -1,    39,    40,    41,
+      42,    43,    44,    45,    46,    -1,    -1,    -1,    50,    -1,
+      52,    22,    23,    24,    25,    26,    27,    28,    29,    30,
+      31,    32,    33,    34,    35,    36,    37,    -1,    39,    40,
+      41,    42,    43,    44,    45,    46,    -1,    -1,    -1,    50,
+      -1,    52,    22,    23,    24,    25,    26,    27,    28,    29,
+      30,    31,    32,    33,    34,    35,    36,    37,    -1,    39,
+      40,    41,    42,    43,    44,    45,    46,    -1,    -1,    -1,
+      50,    -1,    52,    22,    23,    24,    25,    26,    27,    28,
+      29,    30,    31,    32,    33,    34,    35,    36,    37,    -1,
+      39,    40,    41,    42,    43,    44,    45,    46,    -1,    -1,
+      -1,    50,    51,    22,    23,    24,    25,    26,    27,    28,
+      29,    30,    31,    32,    33,    34,    35,    36,    37,    -1,
+      39,    40,    41,    42,    43,    44,    45,    46,    47,    -1,
+      -1,    50,    22,    23,    24,    25,    26,    27,    28,    29,
+      30,    31,    32,    33,    34,    35,    36,    37,    -1,    39,
+      40,    41,    42,    43,    44,    45,    46,    47,    -1,    -1,
+      50,    22,    23,    24,    25,    26,    27,    28,    29,    30,
+      31,    32,    33,    34,    35,    36,    37,    -1,    39,    40,
+      41,    42,    43,    44,    45,    46,    47,    -1,    -1,    50,
+      22,    23,    24,    25,    26,    27,    28,    29,    30,    31,
+      32,    33,    34,    35,    36,    37,    -1,    39,    40,    41,
+      42,    43,    44,    45,    46,    47,    -1,    -1,    50,    22,
+      23,    24,    25,    26,    27,    28,    29,    30,    31,    32,
+      33,    34,    35,    36,    37,    -1,    39,    40,    41,    42,
+      43,    44,    45,    46,    -1,    -1,    -1,    50,    22,    23,
+      24,    25,    26,    -1,    -1,    -1,    30,    31,    32,    33,
+      34,    35,    36,    -1,    -1,    39,    40,    41,    42,    43,
+      44,    45,    46,    -1,    -1,    -1,    50,    22,    23,    24,
+      25,    26,    -1,    -1,    -1,    30,    31,    32,    33,    34,
+      35,    -1,    -1,    -1,    39,    40,    41,    42,    43,    44,
+      45,    46,    -1,    -1,    -1,    50,    22,    23,    24,    25,
+      26,    -1,    -1,    -1,    -1,    -1,    32,    33,    34,    35,
+      -1,    -1,    -1,    39,    40,    41,    42,    43,    44,    45,
+      46,    -1,    -1,    -1,    50,    22,    23,    24,    25,    26,
+      -1,    -1,    -1,    -1,    22,    23,    24,    25,    26,    -1,
+      -1,    -1,    39,    -1,    -1,    42,    43,    44,    45,    46,
+      -1,    -1,    -1,    50,    42,    43,    44,    45,    46,     0,
+       1,    -1,    50,    22,    23,    24,    25,    26,     9,    10,
+      11,    12,    13,    14,    -1,    -1,    -1,    -1,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    44,    45,    46,    -1,    -1,
+      -1,    50
 };
 
 /* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
    state STATE-NUM.  */
 static const yytype_int8 yystos[] =
 {
-       0,     8,     9,    10,    11,    12,    13,    14,    57,    58,
-      59,    60,    63,    66,     0,    59,     3,    64,    65,    30,
-      42,    48,    49,     3,     4,     5,     6,     7,    25,    26,
-      39,    42,    53,    54,    73,    74,    75,    76,    77,    78,
-      79,    80,    81,    82,    83,    43,    61,    62,    66,     3,
-      65,    30,    42,     3,    81,    81,    81,    73,    38,    37,
-      31,    32,    33,    34,    35,    36,    25,    26,    27,    28,
-      29,    40,    41,    44,    67,    43,    49,     3,    74,    43,
-      74,    84,    43,    76,    77,    78,    78,    79,    79,    79,
-      79,    80,    80,    81,    81,    81,    15,    17,    18,    19,
-      20,    21,    22,    45,    48,    63,    66,    67,    68,    69,
-      70,    71,    72,    73,    67,    62,    43,    49,    42,    42,
-      42,    48,    73,    48,    48,    51,    45,    69,    48,    74,
-      73,    73,    73,    48,    73,    43,    43,    48,    48,    51,
-      69,    69,    73,    73,    16,    48,    48,    69,    73,    43,
-      69
+       0,    58,     0,     1,     9,    10,    11,    12,    13,    14,
+      59,    60,    66,    66,    48,    52,     3,     3,    67,    68,
+      27,    46,    52,    46,     1,     3,     4,     5,     6,     7,
+       8,    15,    17,    18,    19,    20,    21,    22,    23,    38,
+      44,    45,    46,    48,    49,    52,    66,    69,    72,    76,
+      76,    62,    61,    49,    52,    46,    46,    46,     1,    69,
+      46,    52,    76,    52,    76,    76,    76,    76,    76,    76,
+      71,     3,    73,    22,    23,    24,    25,    26,    27,    28,
+      29,    30,    31,    32,    33,    34,    35,    36,    37,    39,
+      40,    41,    42,    43,    44,    45,    46,    50,    52,    52,
+      63,    64,    65,    66,    63,    76,    77,    78,    76,    76,
+      17,    70,    52,    47,    67,    27,    52,    53,    76,    76,
+      76,    76,    76,    76,    76,    76,    76,    76,    76,    76,
+      76,    76,    76,    76,    76,    76,    76,    76,    76,    77,
+      76,    47,    53,     3,    47,    47,    53,    47,    47,    46,
+      66,    74,    75,    76,    76,     3,    47,    51,    65,    76,
+      69,    69,    76,     3,    52,    27,    16,    47,    27,    75,
+      76,    69,    52,    76,    52,    75,    47,    69
 };
 
 /* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
 static const yytype_int8 yyr1[] =
 {
-       0,    56,    57,    58,    58,    59,    59,    60,    60,    61,
-      61,    62,    63,    64,    64,    65,    65,    66,    66,    66,
+       0,    57,    58,    58,    58,    59,    59,    59,    59,    61,
+      60,    62,    60,    63,    63,    64,    64,    65,    65,    66,
       66,    66,    66,    66,    67,    67,    68,    68,    69,    69,
-      69,    69,    69,    69,    69,    69,    69,    70,    70,    71,
-      71,    72,    72,    72,    72,    73,    74,    74,    75,    75,
-      76,    76,    77,    77,    77,    78,    78,    78,    78,    78,
-      79,    79,    79,    80,    80,    80,    80,    81,    81,    81,
-      81,    82,    82,    82,    82,    82,    83,    83,    83,    83,
-      83,    83,    83,    83,    84,    84
+      69,    69,    69,    69,    69,    69,    70,    69,    69,    71,
+      69,    69,    69,    72,    73,    73,    73,    73,    74,    74,
+      74,    75,    75,    76,    76,    76,    76,    76,    76,    76,
+      76,    76,    76,    76,    76,    76,    76,    76,    76,    76,
+      76,    76,    76,    76,    76,    76,    76,    76,    76,    76,
+      76,    76,    76,    76,    76,    76,    76,    76,    76,    76,
+      76,    77,    77,    78,    78
 };
 
 /* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
 static const yytype_int8 yyr2[] =
 {
-       0,     2,     1,     1,     2,     1,     1,     6,     5,     1,
-       3,     2,     3,     1,     3,     1,     3,     1,     1,     1,
-       1,     1,     1,     1,     3,     2,     1,     2,     2,     1,
-       1,     1,     1,     1,     4,     6,     1,     5,     7,     5,
-       9,     3,     2,     2,     2,     1,     1,     3,     1,     3,
-       1,     3,     1,     3,     3,     1,     3,     3,     3,     3,
-       1,     3,     3,     1,     3,     3,     3,     1,     2,     2,
-       2,     1,     2,     2,     4,     3,     1,     1,     1,     1,
-       1,     1,     1,     3,     1,     3
+       0,     2,     0,     2,     2,     2,     3,     3,     5,     0,
+       7,     0,     6,     0,     1,     1,     3,     2,     1,     1,
+       1,     1,     1,     1,     2,     3,     0,     2,     1,     1,
+       2,     3,     5,     7,     5,     7,     0,    10,     2,     0,
+       3,     2,     2,     3,     1,     3,     3,     5,     1,     2,
+       4,     0,     1,     1,     1,     1,     1,     1,     1,     4,
+       3,     4,     4,     2,     2,     2,     2,     2,     2,     2,
+       3,     3,     3,     3,     3,     3,     3,     3,     3,     3,
+       3,     3,     3,     3,     3,     3,     3,     3,     3,     3,
+       3,     0,     1,     1,     3
 };
 
 
@@ -908,7 +954,7 @@ enum { YYENOMEM = -2 };
       }                                                           \
     else                                                          \
       {                                                           \
-        yyerror (YY_("syntax error: cannot back up")); \
+        yyerror (&yylloc, ctx, YY_("syntax error: cannot back up")); \
         YYERROR;                                                  \
       }                                                           \
   while (0)
@@ -917,6 +963,32 @@ enum { YYENOMEM = -2 };
    Use YYerror or YYUNDEF. */
 #define YYERRCODE YYUNDEF
 
+/* YYLLOC_DEFAULT -- Set CURRENT to span from RHS[1] to RHS[N].
+   If N is 0, then set CURRENT to the empty location which ends
+   the previous symbol: RHS[0] (always defined).  */
+
+#ifndef YYLLOC_DEFAULT
+# define YYLLOC_DEFAULT(Current, Rhs, N)                                \
+    do                                                                  \
+      if (N)                                                            \
+        {                                                               \
+          (Current).first_line   = YYRHSLOC (Rhs, 1).first_line;        \
+          (Current).first_column = YYRHSLOC (Rhs, 1).first_column;      \
+          (Current).last_line    = YYRHSLOC (Rhs, N).last_line;         \
+          (Current).last_column  = YYRHSLOC (Rhs, N).last_column;       \
+        }                                                               \
+      else                                                              \
+        {                                                               \
+          (Current).first_line   = (Current).last_line   =              \
+            YYRHSLOC (Rhs, 0).last_line;                                \
+          (Current).first_column = (Current).last_column =              \
+            YYRHSLOC (Rhs, 0).last_column;                              \
+        }                                                               \
+    while (0)
+#endif
+
+#define YYRHSLOC(Rhs, K) ((Rhs)[K])
+
 
 /* Enable debugging if requested.  */
 #if YYDEBUG
@@ -933,6 +1005,63 @@ do {                                            \
 } while (0)
 
 
+/* YYLOCATION_PRINT -- Print the location on the stream.
+   This macro was not mandated originally: define only if we know
+   we won't break user code: when these are the locations we know.  */
+
+# ifndef YYLOCATION_PRINT
+
+#  if defined YY_LOCATION_PRINT
+
+   /* Temporary convenience wrapper in case some people defined the
+      undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YYLOCATION_PRINT(File, Loc)  YY_LOCATION_PRINT(File, *(Loc))
+
+#  elif defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
+
+/* Print *YYLOCP on YYO.  Private, do not rely on its existence. */
+
+YY_ATTRIBUTE_UNUSED
+static int
+yy_location_print_ (FILE *yyo, YYLTYPE const * const yylocp)
+{
+  int res = 0;
+  int end_col = 0 != yylocp->last_column ? yylocp->last_column - 1 : 0;
+  if (0 <= yylocp->first_line)
+    {
+      res += YYFPRINTF (yyo, "%d", yylocp->first_line);
+      if (0 <= yylocp->first_column)
+        res += YYFPRINTF (yyo, ".%d", yylocp->first_column);
+    }
+  if (0 <= yylocp->last_line)
+    {
+      if (yylocp->first_line < yylocp->last_line)
+        {
+          res += YYFPRINTF (yyo, "-%d", yylocp->last_line);
+          if (0 <= end_col)
+            res += YYFPRINTF (yyo, ".%d", end_col);
+        }
+      else if (0 <= end_col && yylocp->first_column < end_col)
+        res += YYFPRINTF (yyo, "-%d", end_col);
+    }
+  return res;
+}
+
+#   define YYLOCATION_PRINT  yy_location_print_
+
+    /* Temporary convenience wrapper in case some people defined the
+       undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YY_LOCATION_PRINT(File, Loc)  YYLOCATION_PRINT(File, &(Loc))
+
+#  else
+
+#   define YYLOCATION_PRINT(File, Loc) ((void) 0)
+    /* Temporary convenience wrapper in case some people defined the
+       undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YY_LOCATION_PRINT  YYLOCATION_PRINT
+
+#  endif
+# endif /* !defined YYLOCATION_PRINT */
 
 
 # define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
@@ -941,7 +1070,7 @@ do {                                                                      \
     {                                                                     \
       YYFPRINTF (stderr, "%s ", Title);                                   \
       yy_symbol_print (stderr,                                            \
-                  Kind, Value); \
+                  Kind, Value, Location, ctx); \
       YYFPRINTF (stderr, "\n");                                           \
     }                                                                     \
 } while (0)
@@ -953,10 +1082,12 @@ do {                                                                      \
 
 static void
 yy_symbol_value_print (FILE *yyo,
-                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp, ParseContext& ctx)
 {
   FILE *yyoutput = yyo;
   YY_USE (yyoutput);
+  YY_USE (yylocationp);
+  YY_USE (ctx);
   if (!yyvaluep)
     return;
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
@@ -971,12 +1102,14 @@ yy_symbol_value_print (FILE *yyo,
 
 static void
 yy_symbol_print (FILE *yyo,
-                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep)
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp, ParseContext& ctx)
 {
   YYFPRINTF (yyo, "%s %s (",
              yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
 
-  yy_symbol_value_print (yyo, yykind, yyvaluep);
+  YYLOCATION_PRINT (yyo, yylocationp);
+  YYFPRINTF (yyo, ": ");
+  yy_symbol_value_print (yyo, yykind, yyvaluep, yylocationp, ctx);
   YYFPRINTF (yyo, ")");
 }
 
@@ -1009,8 +1142,8 @@ do {                                                            \
 `------------------------------------------------*/
 
 static void
-yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
-                 int yyrule)
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp, YYLTYPE *yylsp,
+                 int yyrule, ParseContext& ctx)
 {
   int yylno = yyrline[yyrule];
   int yynrhs = yyr2[yyrule];
@@ -1023,7 +1156,8 @@ yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
       YYFPRINTF (stderr, "   $%d = ", yyi + 1);
       yy_symbol_print (stderr,
                        YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
-                       &yyvsp[(yyi + 1) - (yynrhs)]);
+                       &yyvsp[(yyi + 1) - (yynrhs)],
+                       &(yylsp[(yyi + 1) - (yynrhs)]), ctx);
       YYFPRINTF (stderr, "\n");
     }
 }
@@ -1031,7 +1165,7 @@ yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
 # define YY_REDUCE_PRINT(Rule)          \
 do {                                    \
   if (yydebug)                          \
-    yy_reduce_print (yyssp, yyvsp, Rule); \
+    yy_reduce_print (yyssp, yyvsp, yylsp, Rule, ctx); \
 } while (0)
 
 /* Nonzero means print parse trace.  It is left uninitialized so that
@@ -1072,9 +1206,11 @@ int yydebug;
 
 static void
 yydestruct (const char *yymsg,
-            yysymbol_kind_t yykind, YYSTYPE *yyvaluep)
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep, YYLTYPE *yylocationp, ParseContext& ctx)
 {
   YY_USE (yyvaluep);
+  YY_USE (yylocationp);
+  YY_USE (ctx);
   if (!yymsg)
     yymsg = "Deleting";
   YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
@@ -1085,13 +1221,6 @@ yydestruct (const char *yymsg,
 }
 
 
-/* Lookahead token kind.  */
-int yychar;
-
-/* The semantic value of the lookahead symbol.  */
-YYSTYPE yylval;
-/* Number of syntax errors so far.  */
-int yynerrs;
 
 
 
@@ -1101,8 +1230,29 @@ int yynerrs;
 `----------*/
 
 int
-yyparse (void)
+yyparse (ParseContext& ctx)
 {
+/* Lookahead token kind.  */
+int yychar;
+
+
+/* The semantic value of the lookahead symbol.  */
+/* Default value used for initialization, for pacifying older GCCs
+   or non-GCC compilers.  */
+YY_INITIAL_VALUE (static YYSTYPE yyval_default;)
+YYSTYPE yylval YY_INITIAL_VALUE (= yyval_default);
+
+/* Location data for the lookahead symbol.  */
+static YYLTYPE yyloc_default
+# if defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
+  = { 1, 1, 1, 1 }
+# endif
+;
+YYLTYPE yylloc = yyloc_default;
+
+    /* Number of syntax errors so far.  */
+    int yynerrs = 0;
+
     yy_state_fast_t yystate = 0;
     /* Number of tokens to shift before error messages enabled.  */
     int yyerrstatus = 0;
@@ -1123,6 +1273,11 @@ yyparse (void)
     YYSTYPE *yyvs = yyvsa;
     YYSTYPE *yyvsp = yyvs;
 
+    /* The location stack: array, bottom, top.  */
+    YYLTYPE yylsa[YYINITDEPTH];
+    YYLTYPE *yyls = yylsa;
+    YYLTYPE *yylsp = yyls;
+
   int yyn;
   /* The return value of yyparse.  */
   int yyresult;
@@ -1131,10 +1286,14 @@ yyparse (void)
   /* The variables used to return semantic value and location from the
      action routines.  */
   YYSTYPE yyval;
+  YYLTYPE yyloc;
+
+  /* The locations where the error started and ended.  */
+  YYLTYPE yyerror_range[3];
 
 
 
-#define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N))
+#define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N), yylsp -= (N))
 
   /* The number of symbols on the RHS of the reduced rule.
      Keep to zero when no symbol should be popped.  */
@@ -1144,6 +1303,7 @@ yyparse (void)
 
   yychar = YYEMPTY; /* Cause a token to be read.  */
 
+  yylsp[0] = yylloc;
   goto yysetstate;
 
 
@@ -1182,6 +1342,7 @@ yysetstate:
            memory.  */
         yy_state_t *yyss1 = yyss;
         YYSTYPE *yyvs1 = yyvs;
+        YYLTYPE *yyls1 = yyls;
 
         /* Each stack pointer address is followed by the size of the
            data in use in that stack, in bytes.  This used to be a
@@ -1190,9 +1351,11 @@ yysetstate:
         yyoverflow (YY_("memory exhausted"),
                     &yyss1, yysize * YYSIZEOF (*yyssp),
                     &yyvs1, yysize * YYSIZEOF (*yyvsp),
+                    &yyls1, yysize * YYSIZEOF (*yylsp),
                     &yystacksize);
         yyss = yyss1;
         yyvs = yyvs1;
+        yyls = yyls1;
       }
 # else /* defined YYSTACK_RELOCATE */
       /* Extend the stack our own way.  */
@@ -1211,6 +1374,7 @@ yysetstate:
           YYNOMEM;
         YYSTACK_RELOCATE (yyss_alloc, yyss);
         YYSTACK_RELOCATE (yyvs_alloc, yyvs);
+        YYSTACK_RELOCATE (yyls_alloc, yyls);
 #  undef YYSTACK_RELOCATE
         if (yyss1 != yyssa)
           YYSTACK_FREE (yyss1);
@@ -1219,6 +1383,7 @@ yysetstate:
 
       yyssp = yyss + yysize - 1;
       yyvsp = yyvs + yysize - 1;
+      yylsp = yyls + yysize - 1;
 
       YY_IGNORE_USELESS_CAST_BEGIN
       YYDPRINTF ((stderr, "Stack size increased to %ld\n",
@@ -1255,7 +1420,7 @@ yybackup:
   if (yychar == YYEMPTY)
     {
       YYDPRINTF ((stderr, "Reading a token\n"));
-      yychar = yylex ();
+      yychar = yylex (&yylval, &yylloc, ctx);
     }
 
   if (yychar <= YYEOF)
@@ -1272,6 +1437,7 @@ yybackup:
          loop in error recovery. */
       yychar = YYUNDEF;
       yytoken = YYSYMBOL_YYerror;
+      yyerror_range[1] = yylloc;
       goto yyerrlab1;
     }
   else
@@ -1305,6 +1471,7 @@ yybackup:
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
   *++yyvsp = yylval;
   YY_IGNORE_MAYBE_UNINITIALIZED_END
+  *++yylsp = yylloc;
 
   /* Discard the shifted token.  */
   yychar = YYEMPTY;
@@ -1338,803 +1505,664 @@ yyreduce:
      GCC warning that YYVAL may be used uninitialized.  */
   yyval = yyvsp[1-yylen];
 
-
+  /* Default location. */
+  YYLLOC_DEFAULT (yyloc, (yylsp - yylen), yylen);
+  yyerror_range[1] = yyloc;
   YY_REDUCE_PRINT (yyn);
   switch (yyn)
     {
-  case 2: /* program: translation_unit  */
-#line 123 "parser.y"
+  case 3: /* program: program top_decl  */
+#line 290 "parser.y"
     {
-        root = std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[0].node_val)));
+        if ((yyvsp[0].node))
+            ctx.root->items.push_back(ctx.own((yyvsp[0].node)));
     }
-#line 1351 "parser.tab.c"
+#line 1521 "parser.tab.c"
     break;
 
-  case 3: /* translation_unit: external_declaration  */
-#line 130 "parser.y"
+  case 4: /* program: program error  */
+#line 295 "parser.y"
     {
-        (yyval.node_val) = (yyvsp[0].node_val);
+        // Recovery may have discarded the ends of open blocks.
+        ctx.symbols.resetToGlobal();
     }
-#line 1359 "parser.tab.c"
+#line 1530 "parser.tab.c"
     break;
 
-  case 4: /* translation_unit: translation_unit external_declaration  */
-#line 134 "parser.y"
+  case 5: /* top_decl: function_head SEMICOLON  */
+#line 303 "parser.y"
     {
-        ASTNode* left = static_cast<ASTNode*>((yyvsp[-1].node_val));
-        ASTNode* right = static_cast<ASTNode*>((yyvsp[0].node_val));
-        left->addChild(std::unique_ptr<ASTNode>(right));
-        (yyval.node_val) = (yyvsp[-1].node_val);
+        ctx.symbols.popScope();
+        (yyval.node) = (yyvsp[-1].fn);
     }
-#line 1370 "parser.tab.c"
+#line 1539 "parser.tab.c"
     break;
 
-  case 5: /* external_declaration: function_definition  */
-#line 144 "parser.y"
+  case 6: /* top_decl: function_head LBRACE block_body  */
+#line 308 "parser.y"
     {
-        (yyval.node_val) = (yyvsp[0].node_val);
+        // The body block is positioned at the first token after '{'.
+        const Token* first = ctx.nextToken((yyvsp[-1].tok));
+        auto block = ctx.make<BlockStmt>(first->line, first->col);
+        block->stmts = std::move(*(yyvsp[0].stmts));
+        (yyvsp[-2].fn)->body.push_back(ctx.link(block));
+        ctx.symbols.popScope();
+        (yyval.node) = (yyvsp[-2].fn);
     }
-#line 1378 "parser.tab.c"
+#line 1553 "parser.tab.c"
     break;
 
-  case 6: /* external_declaration: declaration  */
-#line 148 "parser.y"
+  case 7: /* top_decl: type IDENTIFIER SEMICOLON  */
+#line 318 "parser.y"
     {
-        (yyval.node_val) = (yyvsp[0].node_val);
+        ctx.symbols.declareVariable((yyvsp[-1].tok)->lexeme);
+        (yyval.node) = ctx.make<VarDeclStmt>((yyvsp[-2].tok)->type, (yyvsp[-1].tok)->lexeme, nullptr, (yylsp[-2]).first_line, (yylsp[-2]).first_column);
     }
-#line 1386 "parser.tab.c"
+#line 1562 "parser.tab.c"
     break;
 
-  case 7: /* function_definition: type IDENTIFIER LPAREN parameter_list RPAREN compound_statement  */
-#line 155 "parser.y"
+  case 8: /* top_decl: type IDENTIFIER ASSIGN expression SEMICOLON  */
+#line 323 "parser.y"
     {
-        auto node = new ASTNode("Function", (yyvsp[-4].string_val));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[-5].node_val))));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[-2].node_val))));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[0].node_val))));
-        symbolTable.declareVariable((yyvsp[-4].string_val));
-        free((yyvsp[-4].string_val));
-        (yyval.node_val) = node;
+        ctx.symbols.declareVariable((yyvsp[-3].tok)->lexeme);
+        (yyval.node) = ctx.make<VarDeclStmt>((yyvsp[-4].tok)->type, (yyvsp[-3].tok)->lexeme, ctx.link((yyvsp[-1].expr)), (yylsp[-4]).first_line, (yylsp[-4]).first_column);
     }
-#line 1400 "parser.tab.c"
+#line 1571 "parser.tab.c"
     break;
 
-  case 8: /* function_definition: type IDENTIFIER LPAREN RPAREN compound_statement  */
-#line 165 "parser.y"
+  case 9: /* $@1: %empty  */
+#line 334 "parser.y"
     {
-        auto node = new ASTNode("Function", (yyvsp[-3].string_val));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[-4].node_val))));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[0].node_val))));
-        symbolTable.declareVariable((yyvsp[-3].string_val));
-        free((yyvsp[-3].string_val));
-        (yyval.node_val) = node;
+        ctx.symbols.declareVariable((yyvsp[-1].tok)->lexeme);
+        ctx.symbols.pushScope();
     }
-#line 1413 "parser.tab.c"
+#line 1580 "parser.tab.c"
     break;
 
-  case 9: /* parameter_list: parameter_declaration  */
-#line 177 "parser.y"
+  case 10: /* function_head: FN type IDENTIFIER LPAREN $@1 parameter_list_opt RPAREN  */
+#line 339 "parser.y"
     {
-        auto node = new ASTNode("ParameterList");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[0].node_val))));
-        (yyval.node_val) = node;
+        (yyval.fn) = makeFunction(ctx, (yyvsp[-5].tok), (yyvsp[-4].tok), (yyvsp[-1].params), (yylsp[-6]));
     }
-#line 1423 "parser.tab.c"
+#line 1588 "parser.tab.c"
     break;
 
-  case 10: /* parameter_list: parameter_list COMMA parameter_declaration  */
-#line 183 "parser.y"
+  case 11: /* $@2: %empty  */
+#line 343 "parser.y"
     {
-        ASTNode* list = static_cast<ASTNode*>((yyvsp[-2].node_val));
-        ASTNode* param = static_cast<ASTNode*>((yyvsp[0].node_val));
-        list->addChild(std::unique_ptr<ASTNode>(param));
-        (yyval.node_val) = (yyvsp[-2].node_val);
+        ctx.symbols.declareVariable((yyvsp[-1].tok)->lexeme);
+        ctx.symbols.pushScope();
     }
-#line 1434 "parser.tab.c"
+#line 1597 "parser.tab.c"
     break;
 
-  case 11: /* parameter_declaration: type IDENTIFIER  */
-#line 193 "parser.y"
+  case 12: /* function_head: type IDENTIFIER LPAREN $@2 parameter_list_opt RPAREN  */
+#line 348 "parser.y"
     {
-        auto node = new ASTNode("Parameter", (yyvsp[0].string_val));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[-1].node_val))));
-        symbolTable.declareVariable((yyvsp[0].string_val));
-        free((yyvsp[0].string_val));
-        (yyval.node_val) = node;
+        (yyval.fn) = makeFunction(ctx, (yyvsp[-5].tok), (yyvsp[-4].tok), (yyvsp[-1].params), (yylsp[-5]));
     }
-#line 1446 "parser.tab.c"
+#line 1605 "parser.tab.c"
     break;
 
-  case 12: /* declaration: type init_declarator_list SEMICOLON  */
-#line 204 "parser.y"
-    {
-        auto node = new ASTNode("Declaration");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[-2].node_val))));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[-1].node_val))));
-        (yyval.node_val) = node;
-    }
-#line 1457 "parser.tab.c"
+  case 13: /* parameter_list_opt: %empty  */
+#line 354 "parser.y"
+           { (yyval.params) = ctx.make<ParamList>(); }
+#line 1611 "parser.tab.c"
     break;
 
-  case 13: /* init_declarator_list: init_declarator  */
-#line 214 "parser.y"
-    {
-        auto node = new ASTNode("InitList");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[0].node_val))));
-        (yyval.node_val) = node;
-    }
-#line 1467 "parser.tab.c"
+  case 14: /* parameter_list_opt: parameter_list  */
+#line 355 "parser.y"
+                     { (yyval.params) = (yyvsp[0].params); }
+#line 1617 "parser.tab.c"
     break;
 
-  case 14: /* init_declarator_list: init_declarator_list COMMA init_declarator  */
-#line 220 "parser.y"
+  case 15: /* parameter_list: parameter  */
+#line 360 "parser.y"
     {
-        ASTNode* list = static_cast<ASTNode*>((yyvsp[-2].node_val));
-        ASTNode* init = static_cast<ASTNode*>((yyvsp[0].node_val));
-        list->addChild(std::unique_ptr<ASTNode>(init));
-        (yyval.node_val) = (yyvsp[-2].node_val);
+        (yyval.params) = ctx.make<ParamList>();
+        (yyval.params)->push_back(std::move(*(yyvsp[0].param)));
     }
-#line 1478 "parser.tab.c"
+#line 1626 "parser.tab.c"
     break;
 
-  case 15: /* init_declarator: IDENTIFIER  */
-#line 230 "parser.y"
+  case 16: /* parameter_list: parameter_list COMMA parameter  */
+#line 365 "parser.y"
     {
-        auto node = new ASTNode("Variable", (yyvsp[0].string_val));
-        symbolTable.declareVariable((yyvsp[0].string_val));
-        free((yyvsp[0].string_val));
-        (yyval.node_val) = node;
+        (yyvsp[-2].params)->push_back(std::move(*(yyvsp[0].param)));
+        (yyval.params) = (yyvsp[-2].params);
     }
-#line 1489 "parser.tab.c"
+#line 1635 "parser.tab.c"
     break;
 
-  case 16: /* init_declarator: IDENTIFIER ASSIGN expression  */
-#line 237 "parser.y"
+  case 17: /* parameter: type IDENTIFIER  */
+#line 373 "parser.y"
     {
-        auto node = new ASTNode("InitializedVar", (yyvsp[-2].string_val));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[0].node_val))));
-        symbolTable.declareVariable((yyvsp[-2].string_val));
-        free((yyvsp[-2].string_val));
-        (yyval.node_val) = node;
+        ctx.symbols.declareVariable((yyvsp[0].tok)->lexeme);
+        (yyval.param) = ctx.make<std::pair<TokenType, std::string>>((yyvsp[-1].tok)->type, (yyvsp[0].tok)->lexeme);
     }
-#line 1501 "parser.tab.c"
+#line 1644 "parser.tab.c"
     break;
 
-  case 17: /* type: INT  */
-#line 247 "parser.y"
-        { (yyval.node_val) = new ASTNode("Type", "int"); }
-#line 1507 "parser.tab.c"
-    break;
-
-  case 18: /* type: FLOAT_TYPE  */
-#line 248 "parser.y"
-                 { (yyval.node_val) = new ASTNode("Type", "float"); }
-#line 1513 "parser.tab.c"
-    break;
-
-  case 19: /* type: DOUBLE  */
-#line 249 "parser.y"
-             { (yyval.node_val) = new ASTNode("Type", "double"); }
-#line 1519 "parser.tab.c"
-    break;
-
-  case 20: /* type: CHAR  */
-#line 250 "parser.y"
-           { (yyval.node_val) = new ASTNode("Type", "char"); }
-#line 1525 "parser.tab.c"
-    break;
-
-  case 21: /* type: BOOL  */
-#line 251 "parser.y"
-           { (yyval.node_val) = new ASTNode("Type", "bool"); }
-#line 1531 "parser.tab.c"
+  case 18: /* parameter: type  */
+#line 378 "parser.y"
+    {
+        (yyval.param) = ctx.make<std::pair<TokenType, std::string>>((yyvsp[0].tok)->type, "_arg_" + std::to_string(ctx.dummyCounter++));
+    }
+#line 1652 "parser.tab.c"
     break;
 
-  case 22: /* type: VOID  */
-#line 252 "parser.y"
-           { (yyval.node_val) = new ASTNode("Type", "void"); }
-#line 1537 "parser.tab.c"
+  case 25: /* block_body: statement_list error RBRACE  */
+#line 396 "parser.y"
+                                  { (yyval.stmts) = (yyvsp[-2].stmts); }
+#line 1658 "parser.tab.c"
     break;
 
-  case 23: /* type: STRING  */
-#line 253 "parser.y"
-             { (yyval.node_val) = new ASTNode("Type", "string"); }
-#line 1543 "parser.tab.c"
+  case 26: /* statement_list: %empty  */
+#line 400 "parser.y"
+           { (yyval.stmts) = ctx.make<std::vector<StmtPtr>>(); }
+#line 1664 "parser.tab.c"
     break;
 
-  case 24: /* compound_statement: LBRACE statement_list RBRACE  */
-#line 258 "parser.y"
+  case 27: /* statement_list: statement_list statement  */
+#line 402 "parser.y"
     {
-        auto node = new ASTNode("Block");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[-1].node_val))));
-        (yyval.node_val) = node;
+        if ((yyvsp[0].stmt))
+            (yyvsp[-1].stmts)->push_back(ctx.link((yyvsp[0].stmt)));
+        (yyval.stmts) = (yyvsp[-1].stmts);
     }
-#line 1553 "parser.tab.c"
+#line 1674 "parser.tab.c"
     break;
 
-  case 25: /* compound_statement: LBRACE RBRACE  */
-#line 264 "parser.y"
+  case 28: /* statement: SEMICOLON  */
+#line 411 "parser.y"
     {
-        (yyval.node_val) = new ASTNode("EmptyBlock");
+        (yyval.stmt) = ctx.make<EmptyStmt>((yylsp[0]).first_line, (yylsp[0]).first_column);
     }
-#line 1561 "parser.tab.c"
+#line 1682 "parser.tab.c"
     break;
 
-  case 26: /* statement_list: statement  */
-#line 271 "parser.y"
+  case 30: /* statement: RETURN SEMICOLON  */
+#line 416 "parser.y"
     {
-        auto node = new ASTNode("StatementList");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[0].node_val))));
-        (yyval.node_val) = node;
+        (yyval.stmt) = ctx.make<ReturnStmt>(nullptr, (yylsp[-1]).first_line, (yylsp[-1]).first_column);
     }
-#line 1571 "parser.tab.c"
+#line 1690 "parser.tab.c"
     break;
 
-  case 27: /* statement_list: statement_list statement  */
-#line 277 "parser.y"
+  case 31: /* statement: RETURN expression SEMICOLON  */
+#line 420 "parser.y"
     {
-        ASTNode* list = static_cast<ASTNode*>((yyvsp[-1].node_val));
-        ASTNode* stmt = static_cast<ASTNode*>((yyvsp[0].node_val));
-        list->addChild(std::unique_ptr<ASTNode>(stmt));
-        (yyval.node_val) = (yyvsp[-1].node_val);
+        (yyval.stmt) = ctx.make<ReturnStmt>(ctx.link((yyvsp[-1].expr)), (yylsp[-2]).first_line, (yylsp[-2]).first_column);
     }
-#line 1582 "parser.tab.c"
+#line 1698 "parser.tab.c"
     break;
 
-  case 28: /* statement: expression SEMICOLON  */
-#line 287 "parser.y"
+  case 32: /* statement: IF LPAREN expression RPAREN statement  */
+#line 424 "parser.y"
     {
-        (yyval.node_val) = (yyvsp[-1].node_val);
+        (yyval.stmt) = ctx.make<IfStmt>(ctx.link((yyvsp[-2].expr)), ctx.link((yyvsp[0].stmt)), nullptr, (yylsp[-4]).first_line, (yylsp[-4]).first_column);
     }
-#line 1590 "parser.tab.c"
+#line 1706 "parser.tab.c"
     break;
 
-  case 29: /* statement: compound_statement  */
-#line 291 "parser.y"
+  case 33: /* statement: IF LPAREN expression RPAREN statement ELSE statement  */
+#line 428 "parser.y"
     {
-        (yyval.node_val) = (yyvsp[0].node_val);
+        (yyval.stmt) = ctx.make<IfStmt>(ctx.link((yyvsp[-4].expr)), ctx.link((yyvsp[-2].stmt)), ctx.link((yyvsp[0].stmt)), (yylsp[-6]).first_line, (yylsp[-6]).first_column);
     }
-#line 1598 "parser.tab.c"
+#line 1714 "parser.tab.c"
     break;
 
-  case 30: /* statement: selection_statement  */
-#line 295 "parser.y"
+  case 34: /* statement: WHILE LPAREN expression RPAREN statement  */
+#line 432 "parser.y"
     {
-        (yyval.node_val) = (yyvsp[0].node_val);
+        (yyval.stmt) = ctx.make<WhileStmt>(ctx.link((yyvsp[-2].expr)), ctx.link((yyvsp[0].stmt)), (yylsp[-4]).first_line, (yylsp[-4]).first_column);
     }
-#line 1606 "parser.tab.c"
+#line 1722 "parser.tab.c"
     break;
 
-  case 31: /* statement: iteration_statement  */
-#line 299 "parser.y"
+  case 35: /* statement: DO statement WHILE LPAREN expression RPAREN SEMICOLON  */
+#line 436 "parser.y"
     {
-        (yyval.node_val) = (yyvsp[0].node_val);
+        (yyval.stmt) = ctx.make<DoWhileStmt>(ctx.link((yyvsp[-5].stmt)), ctx.link((yyvsp[-2].expr)), (yylsp[-6]).first_line, (yylsp[-6]).first_column);
     }
-#line 1614 "parser.tab.c"
+#line 1730 "parser.tab.c"
     break;
 
-  case 32: /* statement: jump_statement  */
-#line 303 "parser.y"
-    {
-        (yyval.node_val) = (yyvsp[0].node_val);
-    }
-#line 1622 "parser.tab.c"
+  case 36: /* $@3: %empty  */
+#line 439 "parser.y"
+                 { ctx.symbols.pushScope(); }
+#line 1736 "parser.tab.c"
     break;
 
-  case 33: /* statement: declaration  */
-#line 307 "parser.y"
+  case 37: /* statement: FOR LPAREN $@3 for_init SEMICOLON expression_opt SEMICOLON expression_opt RPAREN statement  */
+#line 441 "parser.y"
     {
-        (yyval.node_val) = (yyvsp[0].node_val);
+        ctx.symbols.popScope();
+        (yyval.stmt) = ctx.make<ForStmt>(ctx.link((yyvsp[-6].expr)), ctx.link((yyvsp[-4].expr)), ctx.link((yyvsp[-2].expr)), ctx.link((yyvsp[0].stmt)), (yylsp[-9]).first_line, (yylsp[-9]).first_column);
     }
-#line 1630 "parser.tab.c"
+#line 1745 "parser.tab.c"
     break;
 
-  case 34: /* statement: COUT OUTPUT expression SEMICOLON  */
-#line 311 "parser.y"
+  case 38: /* statement: BREAK SEMICOLON  */
+#line 446 "parser.y"
     {
-        auto node = new ASTNode("Output");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[-1].node_val))));
-        (yyval.node_val) = node;
+        (yyval.stmt) = ctx.make<BreakStmt>((yylsp[-1]).first_line, (yylsp[-1]).first_column);
     }
-#line 1640 "parser.tab.c"
+#line 1753 "parser.tab.c"
     break;
 
-  case 35: /* statement: COUT OUTPUT expression OUTPUT expression SEMICOLON  */
-#line 317 "parser.y"
-    {
-        auto node = new ASTNode("OutputChain");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[-3].node_val))));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[-1].node_val))));
-        (yyval.node_val) = node;
-    }
-#line 1651 "parser.tab.c"
+  case 39: /* $@4: %empty  */
+#line 449 "parser.y"
+             { ctx.symbols.pushScope(); }
+#line 1759 "parser.tab.c"
     break;
 
-  case 36: /* statement: SEMICOLON  */
-#line 324 "parser.y"
+  case 40: /* statement: LBRACE $@4 block_body  */
+#line 450 "parser.y"
     {
-        (yyval.node_val) = new ASTNode("EmptyStatement");
+        ctx.symbols.popScope();
+        auto block = ctx.make<BlockStmt>((yylsp[-2]).first_line, (yylsp[-2]).first_column);
+        block->stmts = std::move(*(yyvsp[0].stmts));
+        (yyval.stmt) = block;
     }
-#line 1659 "parser.tab.c"
+#line 1770 "parser.tab.c"
     break;
 
-  case 37: /* selection_statement: IF LPAREN expression RPAREN statement  */
-#line 331 "parser.y"
+  case 41: /* statement: expression SEMICOLON  */
+#line 457 "parser.y"
     {
-        auto node = new ASTNode("IfStatement");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[-2].node_val))));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[0].node_val))));
-        (yyval.node_val) = node;
+        (yyval.stmt) = ctx.make<ExprStmt>(ctx.link((yyvsp[-1].expr)), (yylsp[-1]).first_line, (yylsp[-1]).first_column);
     }
-#line 1670 "parser.tab.c"
+#line 1778 "parser.tab.c"
     break;
 
-  case 38: /* selection_statement: IF LPAREN expression RPAREN statement ELSE statement  */
-#line 338 "parser.y"
+  case 42: /* statement: error SEMICOLON  */
+#line 461 "parser.y"
     {
-        auto node = new ASTNode("IfElseStatement");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[-4].node_val))));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[-2].node_val))));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[0].node_val))));
-        (yyval.node_val) = node;
+        (yyval.stmt) = nullptr;
     }
-#line 1682 "parser.tab.c"
+#line 1786 "parser.tab.c"
     break;
 
-  case 39: /* iteration_statement: WHILE LPAREN expression RPAREN statement  */
-#line 349 "parser.y"
+  case 43: /* declaration: type declarator_list SEMICOLON  */
+#line 470 "parser.y"
     {
-        auto node = new ASTNode("WhileLoop");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[-2].node_val))));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[0].node_val))));
-        (yyval.node_val) = node;
+        std::vector<Declarator>& list = *(yyvsp[-1].decls);
+        if (list.size() == 1) {
+            (yyval.stmt) = ctx.make<VarDeclStmt>((yyvsp[-2].tok)->type, list[0].name->lexeme, ctx.link(list[0].init),
+                                       list[0].name->line, list[0].name->col);
+        } else {
+            auto block = ctx.make<BlockStmt>((yylsp[-2]).first_line, (yylsp[-2]).first_column);
+            for (auto& d : list)
+                block->stmts.push_back(ctx.link(ctx.make<VarDeclStmt>((yyvsp[-2].tok)->type, d.name->lexeme, ctx.link(d.init),
+                                                                      d.name->line, d.name->col)));
+            (yyval.stmt) = block;
+        }
     }
-#line 1693 "parser.tab.c"
+#line 1804 "parser.tab.c"
     break;
 
-  case 40: /* iteration_statement: FOR LPAREN expression SEMICOLON expression SEMICOLON expression RPAREN statement  */
-#line 356 "parser.y"
+  case 44: /* declarator_list: IDENTIFIER  */
+#line 487 "parser.y"
     {
-        auto node = new ASTNode("ForLoop");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[-6].node_val))));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[-4].node_val))));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[-2].node_val))));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[0].node_val))));
-        (yyval.node_val) = node;
+        ctx.symbols.declareVariable((yyvsp[0].tok)->lexeme);
+        (yyval.decls) = ctx.make<std::vector<Declarator>>(1, Declarator{(yyvsp[0].tok), nullptr});
     }
-#line 1706 "parser.tab.c"
+#line 1813 "parser.tab.c"
     break;
 
-  case 41: /* jump_statement: RETURN expression SEMICOLON  */
-#line 368 "parser.y"
+  case 45: /* declarator_list: IDENTIFIER ASSIGN expression  */
+#line 492 "parser.y"
     {
-        auto node = new ASTNode("Return");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[-1].node_val))));
-        (yyval.node_val) = node;
+        ctx.symbols.declareVariable((yyvsp[-2].tok)->lexeme);
+        (yyval.decls) = ctx.make<std::vector<Declarator>>(1, Declarator{(yyvsp[-2].tok), (yyvsp[0].expr)});
     }
-#line 1716 "parser.tab.c"
+#line 1822 "parser.tab.c"
     break;
 
-  case 42: /* jump_statement: RETURN SEMICOLON  */
-#line 374 "parser.y"
+  case 46: /* declarator_list: declarator_list COMMA IDENTIFIER  */
+#line 497 "parser.y"
     {
-        (yyval.node_val) = new ASTNode("ReturnVoid");
+        ctx.symbols.declareVariable((yyvsp[0].tok)->lexeme);
+        (yyvsp[-2].decls)->push_back({(yyvsp[0].tok), nullptr});
+        (yyval.decls) = (yyvsp[-2].decls);
     }
-#line 1724 "parser.tab.c"
+#line 1832 "parser.tab.c"
     break;
 
-  case 43: /* jump_statement: BREAK SEMICOLON  */
-#line 378 "parser.y"
+  case 47: /* declarator_list: declarator_list COMMA IDENTIFIER ASSIGN expression  */
+#line 503 "parser.y"
     {
-        (yyval.node_val) = new ASTNode("Break");
+        ctx.symbols.declareVariable((yyvsp[-2].tok)->lexeme);
+        (yyvsp[-4].decls)->push_back({(yyvsp[-2].tok), (yyvsp[0].expr)});
+        (yyval.decls) = (yyvsp[-4].decls);
     }
-#line 1732 "parser.tab.c"
+#line 1842 "parser.tab.c"
     break;
 
-  case 44: /* jump_statement: CONTINUE SEMICOLON  */
-#line 382 "parser.y"
+  case 49: /* for_init: type IDENTIFIER  */
+#line 514 "parser.y"
     {
-        (yyval.node_val) = new ASTNode("Continue");
+        ctx.symbols.declareVariable((yyvsp[0].tok)->lexeme);
+        (yyval.expr) = nullptr;
     }
-#line 1740 "parser.tab.c"
+#line 1851 "parser.tab.c"
     break;
 
-  case 45: /* expression: assignment_expression  */
-#line 389 "parser.y"
+  case 50: /* for_init: type IDENTIFIER ASSIGN expression  */
+#line 519 "parser.y"
     {
-        (yyval.node_val) = (yyvsp[0].node_val);
+        ctx.symbols.declareVariable((yyvsp[-2].tok)->lexeme);
+        (yyval.expr) = (yyvsp[0].expr);
     }
-#line 1748 "parser.tab.c"
+#line 1860 "parser.tab.c"
     break;
 
-  case 46: /* assignment_expression: logical_or_expression  */
-#line 396 "parser.y"
-    {
-        (yyval.node_val) = (yyvsp[0].node_val);
-    }
-#line 1756 "parser.tab.c"
+  case 51: /* expression_opt: %empty  */
+#line 526 "parser.y"
+           { (yyval.expr) = nullptr; }
+#line 1866 "parser.tab.c"
     break;
 
-  case 47: /* assignment_expression: IDENTIFIER ASSIGN assignment_expression  */
-#line 400 "parser.y"
+  case 53: /* expression: INT_LITERAL  */
+#line 532 "parser.y"
     {
-        if (!symbolTable.isDeclared((yyvsp[-2].string_val))) {
-            yyerror("Undeclared variable");
-            YYERROR;
-        }
-        auto node = new ASTNode("Assignment", (yyvsp[-2].string_val));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[0].node_val))));
-        free((yyvsp[-2].string_val));
-        (yyval.node_val) = node;
+        (yyval.expr) = ctx.make<IntLiteral>((yyvsp[0].tok)->lexeme, (yylsp[0]).first_line, (yylsp[0]).first_column);
     }
-#line 1771 "parser.tab.c"
-    break;
-
-  case 48: /* logical_or_expression: logical_and_expression  */
-#line 413 "parser.y"
-                           { (yyval.node_val) = (yyvsp[0].node_val); }
-#line 1777 "parser.tab.c"
+#line 1874 "parser.tab.c"
     break;
 
-  case 49: /* logical_or_expression: logical_or_expression OR logical_and_expression  */
-#line 415 "parser.y"
+  case 54: /* expression: FLOAT_LITERAL  */
+#line 536 "parser.y"
     {
-        auto node = new ASTNode("LogicalOR");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[-2].node_val))));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[0].node_val))));
-        (yyval.node_val) = node;
+        (yyval.expr) = ctx.make<FloatLiteral>((yyvsp[0].tok)->lexeme, (yylsp[0]).first_line, (yylsp[0]).first_column);
     }
-#line 1788 "parser.tab.c"
-    break;
-
-  case 50: /* logical_and_expression: equality_expression  */
-#line 424 "parser.y"
-                        { (yyval.node_val) = (yyvsp[0].node_val); }
-#line 1794 "parser.tab.c"
+#line 1882 "parser.tab.c"
     break;
 
-  case 51: /* logical_and_expression: logical_and_expression AND equality_expression  */
-#line 426 "parser.y"
+  case 55: /* expression: STRING_LITERAL  */
+#line 540 "parser.y"
     {
-        auto node = new ASTNode("LogicalAND");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[-2].node_val))));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[0].node_val))));
-        (yyval.node_val) = node;
+        (yyval.expr) = ctx.make<StringLiteral>((yyvsp[0].tok)->lexeme, (yylsp[0]).first_line, (yylsp[0]).first_column);
     }
-#line 1805 "parser.tab.c"
+#line 1890 "parser.tab.c"
     break;
 
-  case 52: /* equality_expression: relational_expression  */
-#line 435 "parser.y"
-                          { (yyval.node_val) = (yyvsp[0].node_val); }
-#line 1811 "parser.tab.c"
-    break;
-
-  case 53: /* equality_expression: equality_expression EQ relational_expression  */
-#line 437 "parser.y"
+  case 56: /* expression: CHAR_LITERAL  */
+#line 544 "parser.y"
     {
-        auto node = new ASTNode("Equal");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[-2].node_val))));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[0].node_val))));
-        (yyval.node_val) = node;
+        (yyval.expr) = ctx.make<CharLiteral>((yyvsp[0].tok)->lexeme, (yylsp[0]).first_line, (yylsp[0]).first_column);
     }
-#line 1822 "parser.tab.c"
+#line 1898 "parser.tab.c"
     break;
 
-  case 54: /* equality_expression: equality_expression NE relational_expression  */
-#line 444 "parser.y"
+  case 57: /* expression: BOOL_LITERAL  */
+#line 548 "parser.y"
     {
-        auto node = new ASTNode("NotEqual");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[-2].node_val))));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[0].node_val))));
-        (yyval.node_val) = node;
+        (yyval.expr) = ctx.make<BoolLiteral>((yyvsp[0].tok)->lexeme == "true", (yylsp[0]).first_line, (yylsp[0]).first_column);
     }
-#line 1833 "parser.tab.c"
+#line 1906 "parser.tab.c"
     break;
 
-  case 55: /* relational_expression: additive_expression  */
-#line 453 "parser.y"
-                        { (yyval.node_val) = (yyvsp[0].node_val); }
-#line 1839 "parser.tab.c"
-    break;
-
-  case 56: /* relational_expression: relational_expression LT additive_expression  */
-#line 455 "parser.y"
+  case 58: /* expression: IDENTIFIER  */
+#line 552 "parser.y"
     {
-        auto node = new ASTNode("LessThan");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[-2].node_val))));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[0].node_val))));
-        (yyval.node_val) = node;
+        if (!ctx.symbols.isDeclared((yyvsp[0].tok)->lexeme))
+            ctx.diagnose(*(yyvsp[0].tok), "Undeclared identifier '" + (yyvsp[0].tok)->lexeme + "'");
+        (yyval.expr) = ctx.make<IdentifierExpr>((yyvsp[0].tok)->lexeme, (yylsp[0]).first_line, (yylsp[0]).first_column);
     }
-#line 1850 "parser.tab.c"
+#line 1916 "parser.tab.c"
     break;
 
-  case 57: /* relational_expression: relational_expression LE additive_expression  */
-#line 462 "parser.y"
+  case 59: /* expression: IDENTIFIER LPAREN argument_list_opt RPAREN  */
+#line 558 "parser.y"
     {
-        auto node = new ASTNode("LessEqual");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[-2].node_val))));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[0].node_val))));
-        (yyval.node_val) = node;
+        auto callee = ctx.link(ctx.make<IdentifierExpr>((yyvsp[-3].tok)->lexeme, (yylsp[-3]).first_line, (yylsp[-3]).first_column));
+        (yyval.expr) = ctx.make<CallExpr>(std::move(callee), std::move(*(yyvsp[-1].exprs)), (yylsp[-3]).first_line, (yylsp[-3]).first_column);
     }
-#line 1861 "parser.tab.c"
+#line 1925 "parser.tab.c"
     break;
 
-  case 58: /* relational_expression: relational_expression GT additive_expression  */
-#line 469 "parser.y"
+  case 60: /* expression: LPAREN expression RPAREN  */
+#line 563 "parser.y"
     {
-        auto node = new ASTNode("GreaterThan");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[-2].node_val))));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[0].node_val))));
-        (yyval.node_val) = node;
+        (yyval.expr) = (yyvsp[-1].expr);
     }
-#line 1872 "parser.tab.c"
+#line 1933 "parser.tab.c"
     break;
 
-  case 59: /* relational_expression: relational_expression GE additive_expression  */
-#line 476 "parser.y"
+  case 61: /* expression: expression LPAREN argument_list_opt RPAREN  */
+#line 567 "parser.y"
     {
-        auto node = new ASTNode("GreaterEqual");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[-2].node_val))));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[0].node_val))));
-        (yyval.node_val) = node;
+        (yyval.expr) = ctx.make<CallExpr>(ctx.link((yyvsp[-3].expr)), std::move(*(yyvsp[-1].exprs)), (yylsp[-2]).first_line, (yylsp[-2]).first_column);
     }
-#line 1883 "parser.tab.c"
-    break;
-
-  case 60: /* additive_expression: multiplicative_expression  */
-#line 485 "parser.y"
-                              { (yyval.node_val) = (yyvsp[0].node_val); }
-#line 1889 "parser.tab.c"
+#line 1941 "parser.tab.c"
     break;
 
-  case 61: /* additive_expression: additive_expression PLUS multiplicative_expression  */
-#line 487 "parser.y"
+  case 62: /* expression: expression LBRACKET expression RBRACKET  */
+#line 571 "parser.y"
     {
-        auto node = new ASTNode("Add");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[-2].node_val))));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[0].node_val))));
-        (yyval.node_val) = node;
+        (yyval.expr) = ctx.make<IndexExpr>(ctx.link((yyvsp[-3].expr)), ctx.link((yyvsp[-1].expr)), (yylsp[-2]).first_line, (yylsp[-2]).first_column);
     }
-#line 1900 "parser.tab.c"
+#line 1949 "parser.tab.c"
     break;
 
-  case 62: /* additive_expression: additive_expression MINUS multiplicative_expression  */
-#line 494 "parser.y"
+  case 63: /* expression: expression INCREMENT  */
+#line 575 "parser.y"
     {
-        auto node = new ASTNode("Subtract");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[-2].node_val))));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[0].node_val))));
-        (yyval.node_val) = node;
+        (yyval.expr) = ctx.make<PostfixExpr>("++", ctx.link((yyvsp[-1].expr)), (yylsp[0]).first_line, (yylsp[0]).first_column);
     }
-#line 1911 "parser.tab.c"
-    break;
-
-  case 63: /* multiplicative_expression: unary_expression  */
-#line 503 "parser.y"
-                     { (yyval.node_val) = (yyvsp[0].node_val); }
-#line 1917 "parser.tab.c"
+#line 1957 "parser.tab.c"
     break;
 
-  case 64: /* multiplicative_expression: multiplicative_expression MULTIPLY unary_expression  */
-#line 505 "parser.y"
+  case 64: /* expression: expression DECREMENT  */
+#line 579 "parser.y"
     {
-        auto node = new ASTNode("Multiply");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[-2].node_val))));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[0].node_val))));
-        (yyval.node_val) = node;
+        (yyval.expr) = ctx.make<PostfixExpr>("--", ctx.link((yyvsp[-1].expr)), (yylsp[0]).first_line, (yylsp[0]).first_column);
     }
-#line 1928 "parser.tab.c"
+#line 1965 "parser.tab.c"
     break;
 
-  case 65: /* multiplicative_expression: multiplicative_expression DIVIDE unary_expression  */
-#line 512 "parser.y"
+  case 65: /* expression: MINUS expression  */
+#line 583 "parser.y"
     {
-        auto node = new ASTNode("Divide");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[-2].node_val))));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[0].node_val))));
-        (yyval.node_val) = node;
+        (yyval.expr) = ctx.make<UnaryExpr>("-", ctx.link((yyvsp[0].expr)), (yylsp[-1]).first_line, (yylsp[-1]).first_column);
     }
-#line 1939 "parser.tab.c"
+#line 1973 "parser.tab.c"
     break;
 
-  case 66: /* multiplicative_expression: multiplicative_expression MODULO unary_expression  */
-#line 519 "parser.y"
+  case 66: /* expression: PLUS expression  */
+#line 587 "parser.y"
     {
-        auto node = new ASTNode("Modulo");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[-2].node_val))));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[0].node_val))));
-        (yyval.node_val) = node;
+        (yyval.expr) = ctx.make<UnaryExpr>("+", ctx.link((yyvsp[0].expr)), (yylsp[-1]).first_line, (yylsp[-1]).first_column);
     }
-#line 1950 "parser.tab.c"
-    break;
-
-  case 67: /* unary_expression: postfix_expression  */
-#line 528 "parser.y"
-                       { (yyval.node_val) = (yyvsp[0].node_val); }
-#line 1956 "parser.tab.c"
+#line 1981 "parser.tab.c"
     break;
 
-  case 68: /* unary_expression: PLUS unary_expression  */
-#line 530 "parser.y"
+  case 67: /* expression: NOT expression  */
+#line 591 "parser.y"
     {
-        auto node = new ASTNode("UnaryPlus");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[0].node_val))));
-        (yyval.node_val) = node;
+        (yyval.expr) = ctx.make<UnaryExpr>("!", ctx.link((yyvsp[0].expr)), (yylsp[-1]).first_line, (yylsp[-1]).first_column);
     }
-#line 1966 "parser.tab.c"
+#line 1989 "parser.tab.c"
     break;
 
-  case 69: /* unary_expression: MINUS unary_expression  */
-#line 536 "parser.y"
+  case 68: /* expression: INCREMENT expression  */
+#line 595 "parser.y"
     {
-        auto node = new ASTNode("UnaryMinus");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[0].node_val))));
-        (yyval.node_val) = node;
+        (yyval.expr) = ctx.make<UnaryExpr>("++", ctx.link((yyvsp[0].expr)), (yylsp[-1]).first_line, (yylsp[-1]).first_column);
     }
-#line 1976 "parser.tab.c"
+#line 1997 "parser.tab.c"
     break;
 
-  case 70: /* unary_expression: NOT unary_expression  */
-#line 542 "parser.y"
+  case 69: /* expression: DECREMENT expression  */
+#line 599 "parser.y"
     {
-        auto node = new ASTNode("LogicalNOT");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[0].node_val))));
-        (yyval.node_val) = node;
+        (yyval.expr) = ctx.make<UnaryExpr>("--", ctx.link((yyvsp[0].expr)), (yylsp[-1]).first_line, (yylsp[-1]).first_column);
     }
-#line 1986 "parser.tab.c"
+#line 2005 "parser.tab.c"
     break;
 
-  case 71: /* postfix_expression: primary_expression  */
-#line 550 "parser.y"
-                       { (yyval.node_val) = (yyvsp[0].node_val); }
-#line 1992 "parser.tab.c"
+  case 70: /* expression: expression ASSIGN expression  */
+#line 602 "parser.y"
+                                     { (yyval.expr) = binary(ctx, "=", (yyvsp[-2].expr), (yyvsp[0].expr), (yylsp[-1])); }
+#line 2011 "parser.tab.c"
     break;
 
-  case 72: /* postfix_expression: postfix_expression INCREMENT  */
-#line 552 "parser.y"
-    {
-        auto node = new ASTNode("PostfixIncrement");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[-1].node_val))));
-        (yyval.node_val) = node;
-    }
-#line 2002 "parser.tab.c"
+  case 71: /* expression: expression PLUS_EQ expression  */
+#line 603 "parser.y"
+                                     { (yyval.expr) = compound(ctx, "+", (yyvsp[-2].expr), (yyvsp[0].expr), (yylsp[-1])); }
+#line 2017 "parser.tab.c"
     break;
 
-  case 73: /* postfix_expression: postfix_expression DECREMENT  */
-#line 558 "parser.y"
-    {
-        auto node = new ASTNode("PostfixDecrement");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[-1].node_val))));
-        (yyval.node_val) = node;
-    }
-#line 2012 "parser.tab.c"
+  case 72: /* expression: expression MINUS_EQ expression  */
+#line 604 "parser.y"
+                                     { (yyval.expr) = compound(ctx, "-", (yyvsp[-2].expr), (yyvsp[0].expr), (yylsp[-1])); }
+#line 2023 "parser.tab.c"
     break;
 
-  case 74: /* postfix_expression: IDENTIFIER LPAREN argument_expression_list RPAREN  */
-#line 564 "parser.y"
-    {
-        auto node = new ASTNode("FunctionCall", (yyvsp[-3].string_val));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[-1].node_val))));
-        symbolTable.declareVariable((yyvsp[-3].string_val));
-        free((yyvsp[-3].string_val));
-        (yyval.node_val) = node;
-    }
-#line 2024 "parser.tab.c"
+  case 73: /* expression: expression OR expression  */
+#line 605 "parser.y"
+                                     { (yyval.expr) = binary(ctx, "||", (yyvsp[-2].expr), (yyvsp[0].expr), (yylsp[-1])); }
+#line 2029 "parser.tab.c"
     break;
 
-  case 75: /* postfix_expression: IDENTIFIER LPAREN RPAREN  */
-#line 572 "parser.y"
-    {
-        auto node = new ASTNode("FunctionCall", (yyvsp[-2].string_val));
-        symbolTable.declareVariable((yyvsp[-2].string_val));
-        free((yyvsp[-2].string_val));
-        (yyval.node_val) = node;
-    }
+  case 74: /* expression: expression AND expression  */
+#line 606 "parser.y"
+                                     { (yyval.expr) = binary(ctx, "&&", (yyvsp[-2].expr), (yyvsp[0].expr), (yylsp[-1])); }
 #line 2035 "parser.tab.c"
     break;
 
-  case 76: /* primary_expression: IDENTIFIER  */
-#line 582 "parser.y"
-    {
-        if (!symbolTable.isDeclared((yyvsp[0].string_val))) {
-            yyerror("Undeclared variable");
-            YYERROR;
-        }
-        auto node = new ASTNode("Variable", (yyvsp[0].string_val));
-        free((yyvsp[0].string_val));
-        (yyval.node_val) = node;
-    }
-#line 2049 "parser.tab.c"
+  case 75: /* expression: expression EQ expression  */
+#line 607 "parser.y"
+                                     { (yyval.expr) = binary(ctx, "==", (yyvsp[-2].expr), (yyvsp[0].expr), (yylsp[-1])); }
+#line 2041 "parser.tab.c"
     break;
 
-  case 77: /* primary_expression: INTEGER  */
-#line 592 "parser.y"
-    {
-        auto node = new ASTNode("Integer", std::to_string((yyvsp[0].int_val)));
-        (yyval.node_val) = node;
-    }
-#line 2058 "parser.tab.c"
+  case 76: /* expression: expression NE expression  */
+#line 608 "parser.y"
+                                     { (yyval.expr) = binary(ctx, "!=", (yyvsp[-2].expr), (yyvsp[0].expr), (yylsp[-1])); }
+#line 2047 "parser.tab.c"
     break;
 
-  case 78: /* primary_expression: FLOAT  */
-#line 597 "parser.y"
-    {
-        auto node = new ASTNode("Float", std::to_string((yyvsp[0].double_val)));
-        (yyval.node_val) = node;
-    }
-#line 2067 "parser.tab.c"
+  case 77: /* expression: expression LT expression  */
+#line 609 "parser.y"
+                                     { (yyval.expr) = binary(ctx, "<", (yyvsp[-2].expr), (yyvsp[0].expr), (yylsp[-1])); }
+#line 2053 "parser.tab.c"
     break;
 
-  case 79: /* primary_expression: STRING_LITERAL  */
-#line 602 "parser.y"
-    {
-        auto node = new ASTNode("String", (yyvsp[0].string_val));
-        free((yyvsp[0].string_val));
-        (yyval.node_val) = node;
-    }
-#line 2077 "parser.tab.c"
+  case 78: /* expression: expression LE expression  */
+#line 610 "parser.y"
+                                     { (yyval.expr) = binary(ctx, "<=", (yyvsp[-2].expr), (yyvsp[0].expr), (yylsp[-1])); }
+#line 2059 "parser.tab.c"
     break;
 
-  case 80: /* primary_expression: CHAR_LITERAL  */
-#line 608 "parser.y"
-    {
-        auto node = new ASTNode("Char", (yyvsp[0].string_val));
-        free((yyvsp[0].string_val));
-        (yyval.node_val) = node;
-    }
-#line 2087 "parser.tab.c"
+  case 79: /* expression: expression GT expression  */
+#line 611 "parser.y"
+                                     { (yyval.expr) = binary(ctx, ">", (yyvsp[-2].expr), (yyvsp[0].expr), (yylsp[-1])); }
+#line 2065 "parser.tab.c"
     break;
 
-  case 81: /* primary_expression: TRUE  */
+  case 80: /* expression: expression GE expression  */
+#line 612 "parser.y"
+                                     { (yyval.expr) = binary(ctx, ">=", (yyvsp[-2].expr), (yyvsp[0].expr), (yylsp[-1])); }
+#line 2071 "parser.tab.c"
+    break;
+
+  case 81: /* expression: expression BITOR expression  */
+#line 613 "parser.y"
+                                     { (yyval.expr) = binary(ctx, "|", (yyvsp[-2].expr), (yyvsp[0].expr), (yylsp[-1])); }
+#line 2077 "parser.tab.c"
+    break;
+
+  case 82: /* expression: expression BITXOR expression  */
 #line 614 "parser.y"
-    {
-        (yyval.node_val) = new ASTNode("Boolean", "true");
-    }
+                                     { (yyval.expr) = binary(ctx, "^", (yyvsp[-2].expr), (yyvsp[0].expr), (yylsp[-1])); }
+#line 2083 "parser.tab.c"
+    break;
+
+  case 83: /* expression: expression BITAND expression  */
+#line 615 "parser.y"
+                                     { (yyval.expr) = binary(ctx, "&", (yyvsp[-2].expr), (yyvsp[0].expr), (yylsp[-1])); }
+#line 2089 "parser.tab.c"
+    break;
+
+  case 84: /* expression: expression LSHIFT expression  */
+#line 616 "parser.y"
+                                     { (yyval.expr) = binary(ctx, "<<", (yyvsp[-2].expr), (yyvsp[0].expr), (yylsp[-1])); }
 #line 2095 "parser.tab.c"
     break;
 
-  case 82: /* primary_expression: FALSE  */
+  case 85: /* expression: expression RSHIFT expression  */
+#line 617 "parser.y"
+                                     { (yyval.expr) = binary(ctx, ">>", (yyvsp[-2].expr), (yyvsp[0].expr), (yylsp[-1])); }
+#line 2101 "parser.tab.c"
+    break;
+
+  case 86: /* expression: expression PLUS expression  */
 #line 618 "parser.y"
-    {
-        (yyval.node_val) = new ASTNode("Boolean", "false");
-    }
-#line 2103 "parser.tab.c"
+                                     { (yyval.expr) = binary(ctx, "+", (yyvsp[-2].expr), (yyvsp[0].expr), (yylsp[-1])); }
+#line 2107 "parser.tab.c"
     break;
 
-  case 83: /* primary_expression: LPAREN expression RPAREN  */
-#line 622 "parser.y"
-    {
-        auto node = new ASTNode("Parenthesized");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[-1].node_val))));
-        (yyval.node_val) = node;
-    }
+  case 87: /* expression: expression MINUS expression  */
+#line 619 "parser.y"
+                                     { (yyval.expr) = binary(ctx, "-", (yyvsp[-2].expr), (yyvsp[0].expr), (yylsp[-1])); }
 #line 2113 "parser.tab.c"
     break;
 
-  case 84: /* argument_expression_list: assignment_expression  */
-#line 631 "parser.y"
+  case 88: /* expression: expression MULTIPLY expression  */
+#line 620 "parser.y"
+                                     { (yyval.expr) = binary(ctx, "*", (yyvsp[-2].expr), (yyvsp[0].expr), (yylsp[-1])); }
+#line 2119 "parser.tab.c"
+    break;
+
+  case 89: /* expression: expression DIVIDE expression  */
+#line 621 "parser.y"
+                                     { (yyval.expr) = binary(ctx, "/", (yyvsp[-2].expr), (yyvsp[0].expr), (yylsp[-1])); }
+#line 2125 "parser.tab.c"
+    break;
+
+  case 90: /* expression: expression POWER expression  */
+#line 622 "parser.y"
+                                     { (yyval.expr) = binary(ctx, "**", (yyvsp[-2].expr), (yyvsp[0].expr), (yylsp[-1])); }
+#line 2131 "parser.tab.c"
+    break;
+
+  case 91: /* argument_list_opt: %empty  */
+#line 626 "parser.y"
+           { (yyval.exprs) = ctx.make<std::vector<ExprPtr>>(); }
+#line 2137 "parser.tab.c"
+    break;
+
+  case 92: /* argument_list_opt: argument_list  */
+#line 627 "parser.y"
+                    { (yyval.exprs) = (yyvsp[0].exprs); }
+#line 2143 "parser.tab.c"
+    break;
+
+  case 93: /* argument_list: expression  */
+#line 632 "parser.y"
     {
-        auto node = new ASTNode("ArgumentList");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>((yyvsp[0].node_val))));
-        (yyval.node_val) = node;
+        (yyval.exprs) = ctx.make<std::vector<ExprPtr>>();
+        (yyval.exprs)->reserve(4);
+        (yyval.exprs)->push_back(ctx.link((yyvsp[0].expr)));
     }
-#line 2123 "parser.tab.c"
+#line 2153 "parser.tab.c"
     break;
 
-  case 85: /* argument_expression_list: argument_expression_list COMMA assignment_expression  */
-#line 637 "parser.y"
+  case 94: /* argument_list: argument_list COMMA expression  */
+#line 638 "parser.y"
     {
-        ASTNode* list = static_cast<ASTNode*>((yyvsp[-2].node_val));
-        ASTNode* arg = static_cast<ASTNode*>((yyvsp[0].node_val));
-        list->addChild(std::unique_ptr<ASTNode>(arg));
-        (yyval.node_val) = (yyvsp[-2].node_val);
+        (yyvsp[-2].exprs)->push_back(ctx.link((yyvsp[0].expr)));
+        (yyval.exprs) = (yyvsp[-2].exprs);
     }
-#line 2134 "parser.tab.c"
+#line 2162 "parser.tab.c"
     break;
 
 
-#line 2138 "parser.tab.c"
+#line 2166 "parser.tab.c"
 
       default: break;
     }
@@ -2155,6 +2183,7 @@ yyreduce:
   yylen = 0;
 
   *++yyvsp = yyval;
+  *++yylsp = yyloc;
 
   /* Now 'shift' the result of the reduction.  Determine what state
      that goes to, based on the state we popped back to and the rule
@@ -2181,9 +2210,10 @@ yyerrlab:
   if (!yyerrstatus)
     {
       ++yynerrs;
-      yyerror (YY_("syntax error"));
+      yyerror (&yylloc, ctx, YY_("syntax error"));
     }
 
+  yyerror_range[1] = yylloc;
   if (yyerrstatus == 3)
     {
       /* If just tried and failed to reuse lookahead token after an
@@ -2198,7 +2228,7 @@ yyerrlab:
       else
         {
           yydestruct ("Error: discarding",
-                      yytoken, &yylval);
+                      yytoken, &yylval, &yylloc, ctx);
           yychar = YYEMPTY;
         }
     }
@@ -2252,9 +2282,9 @@ yyerrlab1:
       if (yyssp == yyss)
         YYABORT;
 
-
+      yyerror_range[1] = *yylsp;
       yydestruct ("Error: popping",
-                  YY_ACCESSING_SYMBOL (yystate), yyvsp);
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp, yylsp, ctx);
       YYPOPSTACK (1);
       yystate = *yyssp;
       YY_STACK_PRINT (yyss, yyssp);
@@ -2264,6 +2294,9 @@ yyerrlab1:
   *++yyvsp = yylval;
   YY_IGNORE_MAYBE_UNINITIALIZED_END
 
+  yyerror_range[2] = yylloc;
+  ++yylsp;
+  YYLLOC_DEFAULT (*yylsp, yyerror_range, 2);
 
   /* Shift the error token.  */
   YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
@@ -2292,7 +2325,7 @@ yyabortlab:
 | yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
 `-----------------------------------------------------------*/
 yyexhaustedlab:
-  yyerror (YY_("memory exhausted"));
+  yyerror (&yylloc, ctx, YY_("memory exhausted"));
   yyresult = 2;
   goto yyreturnlab;
 
@@ -2307,7 +2340,7 @@ yyreturnlab:
          user semantic actions for why this is necessary.  */
       yytoken = YYTRANSLATE (yychar);
       yydestruct ("Cleanup: discarding lookahead",
-                  yytoken, &yylval);
+                  yytoken, &yylval, &yylloc, ctx);
     }
   /* Do not reclaim the symbols of the rule whose action triggered
      this YYABORT or YYACCEPT.  */
@@ -2316,7 +2349,7 @@ yyreturnlab:
   while (yyssp != yyss)
     {
       yydestruct ("Cleanup: popping",
-                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp);
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp, yylsp, ctx);
       YYPOPSTACK (1);
     }
 #ifndef yyoverflow
@@ -2327,36 +2360,127 @@ yyreturnlab:
   return yyresult;
 }
 
-#line 645 "parser.y"
+#line 644 "parser.y"
+
+
+static int tokenCode(TokenType t) {
+    switch (t) {
+    case TokenType::T_FUNCTION: return FN;
+    case TokenType::T_INT: return INT;
+    case TokenType::T_FLOAT: return FLOAT;
+    case TokenType::T_STRING: return STRING;
+    case TokenType::T_BOOL: return BOOL;
+    case TokenType::T_CHAR: return CHAR;
+    case TokenType::T_BOOLLIT: return BOOL_LITERAL;
+    case TokenType::T_RETURN: return RETURN;
+    case TokenType::T_IF: return IF;
+    case TokenType::T_ELSE: return ELSE;
+    case TokenType::T_WHILE: return WHILE;
+    case TokenType::T_FOR: return FOR;
+    case TokenType::T_DO: return DO;
+    case TokenType::T_BREAK: return BREAK;
+    case TokenType::T_IDENTIFIER: return IDENTIFIER;
+    case TokenType::T_INTLIT: return INT_LITERAL;
+    case TokenType::T_FLOATLIT: return FLOAT_LITERAL;
+    case TokenType::T_STRINGLIT: return STRING_LITERAL;
+    case TokenType::T_CHARLIT: return CHAR_LITERAL;
+    case TokenType::T_PARENL: return LPAREN;
+    case TokenType::T_PARENR: return RPAREN;
+    case TokenType::T_BRACEL: return LBRACE;
+    case TokenType::T_BRACER: return RBRACE;
+    case TokenType::T_BRACKETL: return LBRACKET;
+    case TokenType::T_BRACKETR: return RBRACKET;
+    case TokenType::T_COMMA: return COMMA;
+    case TokenType::T_SEMICOLON: return SEMICOLON;
+    case TokenType::T_LSHIFT: return LSHIFT;
+    case TokenType::T_RSHIFT: return RSHIFT;
+    case TokenType::T_ASSIGNOP: return ASSIGN;
+    case TokenType::T_EQUALSOP: return EQ;
+    case TokenType::T_NOTEQUAL: return NE;
+    case TokenType::T_LESS: return LT;
+    case TokenType::T_LESSEQ: return LE;
+    case TokenType::T_GREATER: return GT;
+    case TokenType::T_GREATEREQ: return GE;
+    case TokenType::T_PLUS: return PLUS;
+    case TokenType::T_MINUS: return MINUS;
+    case TokenType::T_MULTIPLY: return MULTIPLY;
+    case TokenType::T_DIVIDE: return DIVIDE;
+    case TokenType::T_AND: return AND;
+    case TokenType::T_OR: return OR;
+    case TokenType::T_NOT: return NOT;
+    case TokenType::T_BITAND: return BITAND;
+    case TokenType::T_BITOR: return BITOR;
+    case TokenType::T_BITXOR: return BITXOR;
+    case TokenType::T_POWER: return POWER;
+    case TokenType::T_PLUS_EQ: return PLUS_EQ;
+    case TokenType::T_MINUS_EQ: return MINUS_EQ;
+    case TokenType::T_INC: return INCREMENT;
+    case TokenType::T_DEC: return DECREMENT;
+    case TokenType::T_EOF: return YYEOF;
+    default: return YYUNDEF;
+    }
+}
+
+// Feeds the RegexLexer tokens to the parser, skipping comments. The semantic
+// value is a pointer into the token vector, so nothing is copied.
+int yylex(YYSTYPE* lval, YYLTYPE* lloc, ParseContext& ctx) {
+    const std::vector<Token>& tokens = *ctx.tokens;
+    while (ctx.tokenPos < tokens.size() && TokenStream::isTrivia(tokens[ctx.tokenPos].type))
+        ctx.tokenPos++;
+    if (ctx.tokenPos >= tokens.size())
+        return YYEOF;
+    const Token& t = tokens[ctx.tokenPos++];
+    ctx.lastToken = &t;
+    lval->tok = &t;
+    lloc->first_line = lloc->last_line = t.line;
+    lloc->first_column = lloc->last_column = t.col;
+    return tokenCode(t.type);
+}
 
+void yyerror(YYLTYPE*, ParseContext& ctx, const char* s) {
+    if (ctx.lastToken)
+        ctx.diagnose(*ctx.lastToken, std::string("Parse error: ") + s);
+    else if (ctx.diagnostics)
+        ctx.diagnostics->push_back(std::string("Parse error: ") + s);
+}
 
-void yyerror(const char* s) {
-    fprintf(stderr, "Parser Error: %s\n", s);
+// Parses `toks` into `out`. Syntax errors and undeclared identifiers are
+// appended to `errors`; returns true when the whole input was accepted.
+// Reentrant: concurrent calls on different arguments do not share state.
+// The nodes added to `out` live in a fresh arena that is freed with the
+// last of them.
+bool bisonParse(const std::vector<Token>& toks, Program& out, std::vector<std::string>& errors) {
+    ParseContext ctx;
+    ctx.tokens = &toks;
+    ctx.root = &out;
+    ctx.diagnostics = &errors;
+    size_t before = errors.size();
+    int result = yyparse(ctx);
+    return result == 0 && errors.size() == before;
 }
 
+#ifndef BISON_PARSER_NO_MAIN
 int main(int argc, char* argv[]) {
-    if (argc > 1) {
-        yyin = fopen(argv[1], "r");
-        if (!yyin) {
-            fprintf(stderr, "Cannot open file: %s\n", argv[1]);
-            return 1;
-        }
-    }
-    
-    std::cout << "C++ Parser with AST Generation" << std::endl;
-    symbolTable.addBuiltins();
-    
-    int result = yyparse();
-    
-    if (yyin != stdin) {
-        fclose(yyin);
-    }
-    
-    if (result == 0 && root) {
-        std::cout << "\n=== ABSTRACT SYNTAX TREE ===" << std::endl;
-        root->print();
-        std::cout << "============================\n" << std::endl;
-    }
-    
-    return result;
+    const char* path = argc > 1 ? argv[1] : "sample.txt";
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "Cannot open file: " << path << std::endl;
+        return 1;
+    }
+    std::stringstream ss;
+    ss << in.rdbuf();
+
+    RegexLexer lexer(ss.str());
+    std::vector<Token> toks = lexer.tokenize();
+
+    Program prog;
+    std::vector<std::string> errors;
+    bool ok = bisonParse(toks, prog, errors);
+
+    std::cout << "=== ABSTRACT SYNTAX TREE ===" << std::endl;
+    prog.print(std::cout);
+    for (const auto& e : errors)
+        std::cout << e << std::endl;
+    return ok ? 0 : 1;
 }
+#endif
@@ -44,6 +44,180 @@
 #if YYDEBUG
 extern int yydebug;
 #endif
+/* "%code requires" blocks.  */
+#line 22 "parser.y"
+
+#ifndef PARSER_REUSE_LEXER
+#define PARSER_REUSE_LEXER
+#endif
+#include "../regex/regex_code.cpp"
+#include "../parser/parser.cpp"
+
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+using ParamList = std::vector<std::pair<TokenType, std::string>>;
+
+// One declarator of "int a = 1, b;"
+struct Declarator {
+    const Token *name;
+    Expr *init;
+};
+
+// Bump allocator for one parse. Objects are never freed individually; the
+// destructor runs the recorded destructors in reverse order and drops the
+// blocks, so a whole tree costs a handful of frees.
+class ParseArena {
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+    std::vector<std::unique_ptr<char[]>> blocks;
+    char* cur = nullptr;
+    size_t left = 0;
+    size_t reserved = 0;
+    std::vector<std::pair<void*, void (*)(void*)>> dtors;
+
+    void* allocate(size_t size, size_t align) {
+        size_t pad = (align - reinterpret_cast<uintptr_t>(cur) % align) % align;
+        if (!cur || pad + size > left) {
+            size_t n = size > BLOCK_SIZE / 4 ? size : BLOCK_SIZE;
+            blocks.emplace_back(new char[n]);
+            reserved += n;
+            // An oversized object gets its own block and keeps the current one.
+            if (n != BLOCK_SIZE)
+                return blocks.back().get();
+            cur = blocks.back().get();
+            left = n;
+            pad = 0;
+        }
+        void* p = cur + pad;
+        cur += pad + size;
+        left -= pad + size;
+        return p;
+    }
+
+public:
+    ParseArena() { dtors.reserve(1024); }
+    ParseArena(const ParseArena&) = delete;
+    ParseArena& operator=(const ParseArena&) = delete;
+
+    ~ParseArena() {
+        for (auto it = dtors.rbegin(); it != dtors.rend(); ++it)
+            it->second(it->first);
+    }
+
+    template <class T, class... Args>
+    T* make(Args&&... args) {
+        T* p = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        if constexpr (!std::is_trivially_destructible_v<T>)
+            dtors.push_back({p, [](void* q) { static_cast<T*>(q)->~T(); }});
+        return p;
+    }
+
+    size_t bytesReserved() const { return reserved; }
+    size_t objectCount() const { return dtors.size(); }
+};
+
+// Names visible at the current point of the parse. Each distinct name is
+// interned once to a dense id (the key views the token's lexeme, which
+// outlives the parse) and carries a count of live declarations, so lookup is
+// one hash probe regardless of how many names or scopes exist. Declarations
+// are also logged in order; popScope() undoes the ones made since the
+// matching pushScope().
+class SymbolTable {
+private:
+    std::unordered_map<std::string_view, uint32_t> ids;
+    std::vector<uint32_t> live;     // per id: declarations currently in scope
+    std::vector<uint32_t> declared; // undo log of ids, innermost scope last
+    std::vector<size_t> scopes;     // declared.size() at each pushScope()
+
+    uint32_t intern(std::string_view name) {
+        auto [it, inserted] = ids.try_emplace(name, uint32_t(live.size()));
+        if (inserted)
+            live.push_back(0);
+        return it->second;
+    }
+
+public:
+    SymbolTable() { ids.reserve(256); }
+
+    bool isDeclared(std::string_view identifier) const {
+        auto it = ids.find(identifier);
+        return it != ids.end() && live[it->second] != 0;
+    }
+
+    void declareVariable(std::string_view identifier) {
+        uint32_t id = intern(identifier);
+        live[id]++;
+        declared.push_back(id);
+    }
+
+    void pushScope() { scopes.push_back(declared.size()); }
+
+    void popScope() {
+        if (scopes.empty())
+            return;
+        for (size_t i = declared.size(); i > scopes.back(); i--)
+            live[declared[i - 1]]--;
+        declared.resize(scopes.back());
+        scopes.pop_back();
+    }
+
+    // Drops every open scope, e.g. after error recovery skipped their ends.
+    void resetToGlobal() {
+        while (!scopes.empty())
+            popScope();
+    }
+
+    size_t depth() const { return scopes.size(); }
+};
+
+// Everything one parse reads or writes. Links between nodes are non-owning
+// ExprPtr/StmtPtr (an aliasing shared_ptr with no control block); only the
+// Program items own the arena, so there are no per-node reference counts and
+// no cycles. Subtrees are valid for as long as the Program that holds them.
+struct ParseContext {
+    const std::vector<Token>* tokens = nullptr;
+    size_t tokenPos = 0;
+    const Token* lastToken = nullptr;
+
+    Program* root = nullptr;
+    std::vector<std::string>* diagnostics = nullptr;
+    SymbolTable symbols;
+    int dummyCounter = 0;
+    std::shared_ptr<ParseArena> arena = std::make_shared<ParseArena>();
+
+    template <class T, class... Args>
+    T* make(Args&&... args) { return arena->make<T>(std::forward<Args>(args)...); }
+
+    template <class T>
+    std::shared_ptr<T> link(T* p) const { return std::shared_ptr<T>(std::shared_ptr<void>(), p); }
+
+    template <class T>
+    std::shared_ptr<T> own(T* p) const { return std::shared_ptr<T>(arena, p); }
+
+    void diagnose(const Token& at, const std::string& msg) {
+        if (diagnostics)
+            diagnostics->push_back(msg + " (at line " + std::to_string(at.line) +
+                                   ", col " + std::to_string(at.col) + ")");
+    }
+
+    // The next non-comment token after `t`, which points into *tokens.
+    const Token* nextToken(const Token* t) const {
+        const Token* end = tokens->data() + tokens->size();
+        do
+            t++;
+        while (t < end - 1 && TokenStream::isTrivia(t->type));
+        return t;
+    }
+};
+
+#line 221 "parser.tab.h"
 
 /* Token kinds.  */
 #ifndef YYTOKENTYPE
@@ -55,58 +229,59 @@ extern int yydebug;
     YYerror = 256,                 /* error  */
     YYUNDEF = 257,                 /* "invalid token"  */
     IDENTIFIER = 258,              /* IDENTIFIER  */
-    STRING_LITERAL = 259,          /* STRING_LITERAL  */
-    CHAR_LITERAL = 260,            /* CHAR_LITERAL  */
-    INTEGER = 261,                 /* INTEGER  */
-    FLOAT = 262,                   /* FLOAT  */
-    INT = 263,                     /* INT  */
-    FLOAT_TYPE = 264,              /* FLOAT_TYPE  */
-    DOUBLE = 265,                  /* DOUBLE  */
-    CHAR = 266,                    /* CHAR  */
+    INT_LITERAL = 259,             /* INT_LITERAL  */
+    FLOAT_LITERAL = 260,           /* FLOAT_LITERAL  */
+    STRING_LITERAL = 261,          /* STRING_LITERAL  */
+    CHAR_LITERAL = 262,            /* CHAR_LITERAL  */
+    BOOL_LITERAL = 263,            /* BOOL_LITERAL  */
+    INT = 264,                     /* INT  */
+    FLOAT = 265,                   /* FLOAT  */
+    STRING = 266,                  /* STRING  */
     BOOL = 267,                    /* BOOL  */
-    VOID = 268,                    /* VOID  */
-    STRING = 269,                  /* STRING  */
+    CHAR = 268,                    /* CHAR  */
+    FN = 269,                      /* FN  */
     IF = 270,                      /* IF  */
     ELSE = 271,                    /* ELSE  */
     WHILE = 272,                   /* WHILE  */
-    FOR = 273,                     /* FOR  */
-    RETURN = 274,                  /* RETURN  */
-    BREAK = 275,                   /* BREAK  */
-    CONTINUE = 276,                /* CONTINUE  */
-    COUT = 277,                    /* COUT  */
-    CIN = 278,                     /* CIN  */
-    ENDL = 279,                    /* ENDL  */
-    PLUS = 280,                    /* PLUS  */
-    MINUS = 281,                   /* MINUS  */
-    MULTIPLY = 282,                /* MULTIPLY  */
-    DIVIDE = 283,                  /* DIVIDE  */
-    MODULO = 284,                  /* MODULO  */
-    ASSIGN = 285,                  /* ASSIGN  */
-    EQ = 286,                      /* EQ  */
-    NE = 287,                      /* NE  */
-    LT = 288,                      /* LT  */
-    LE = 289,                      /* LE  */
-    GT = 290,                      /* GT  */
-    GE = 291,                      /* GE  */
-    AND = 292,                     /* AND  */
-    OR = 293,                      /* OR  */
-    NOT = 294,                     /* NOT  */
-    INCREMENT = 295,               /* INCREMENT  */
-    DECREMENT = 296,               /* DECREMENT  */
-    LPAREN = 297,                  /* LPAREN  */
-    RPAREN = 298,                  /* RPAREN  */
-    LBRACE = 299,                  /* LBRACE  */
-    RBRACE = 300,                  /* RBRACE  */
-    LBRACKET = 301,                /* LBRACKET  */
-    RBRACKET = 302,                /* RBRACKET  */
-    SEMICOLON = 303,               /* SEMICOLON  */
-    COMMA = 304,                   /* COMMA  */
-    COLON = 305,                   /* COLON  */
-    OUTPUT = 306,                  /* OUTPUT  */
-    INPUT = 307,                   /* INPUT  */
-    TRUE = 308,                    /* TRUE  */
-    FALSE = 309,                   /* FALSE  */
-    LOWER_THAN_ELSE = 310          /* LOWER_THAN_ELSE  */
+    DO = 273,                      /* DO  */
+    FOR = 274,                     /* FOR  */
+    RETURN = 275,                  /* RETURN  */
+    BREAK = 276,                   /* BREAK  */
+    PLUS = 277,                    /* PLUS  */
+    MINUS = 278,                   /* MINUS  */
+    MULTIPLY = 279,                /* MULTIPLY  */
+    DIVIDE = 280,                  /* DIVIDE  */
+    POWER = 281,                   /* POWER  */
+    ASSIGN = 282,                  /* ASSIGN  */
+    PLUS_EQ = 283,                 /* PLUS_EQ  */
+    MINUS_EQ = 284,                /* MINUS_EQ  */
+    EQ = 285,                      /* EQ  */
+    NE = 286,                      /* NE  */
+    LT = 287,                      /* LT  */
+    LE = 288,                      /* LE  */
+    GT = 289,                      /* GT  */
+    GE = 290,                      /* GE  */
+    AND = 291,                     /* AND  */
+    OR = 292,                      /* OR  */
+    NOT = 293,                     /* NOT  */
+    BITAND = 294,                  /* BITAND  */
+    BITOR = 295,                   /* BITOR  */
+    BITXOR = 296,                  /* BITXOR  */
+    LSHIFT = 297,                  /* LSHIFT  */
+    RSHIFT = 298,                  /* RSHIFT  */
+    INCREMENT = 299,               /* INCREMENT  */
+    DECREMENT = 300,               /* DECREMENT  */
+    LPAREN = 301,                  /* LPAREN  */
+    RPAREN = 302,                  /* RPAREN  */
+    LBRACE = 303,                  /* LBRACE  */
+    RBRACE = 304,                  /* RBRACE  */
+    LBRACKET = 305,                /* LBRACKET  */
+    RBRACKET = 306,                /* RBRACKET  */
+    SEMICOLON = 307,               /* SEMICOLON  */
+    COMMA = 308,                   /* COMMA  */
+    LOWER_THAN_ELSE = 309,         /* LOWER_THAN_ELSE  */
+    NAME = 310,                    /* NAME  */
+    PREFIX = 311                   /* PREFIX  */
   };
   typedef enum yytokentype yytoken_kind_t;
 #endif
@@ -115,14 +290,20 @@ extern int yydebug;
 #if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
 union YYSTYPE
 {
-#line 69 "parser.y"
+#line 223 "parser.y"
 
-    char* string_val;
-    int int_val;
-    double double_val;
-    void* node_val;
+    const Token* tok;
+    Expr* expr;
+    Stmt* stmt;
+    FnDecl* fn;
+    ASTNode* node;
+    std::vector<ExprPtr>* exprs;
+    std::vector<StmtPtr>* stmts;
+    ParamList* params;
+    std::pair<TokenType, std::string>* param;
+    std::vector<Declarator>* decls;
 
-#line 126 "parser.tab.h"
+#line 307 "parser.tab.h"
 
 };
 typedef union YYSTYPE YYSTYPE;
@@ -130,11 +311,24 @@ typedef union YYSTYPE YYSTYPE;
 # define YYSTYPE_IS_DECLARED 1
 #endif
 
+/* Location type.  */
+#if ! defined YYLTYPE && ! defined YYLTYPE_IS_DECLARED
+typedef struct YYLTYPE YYLTYPE;
+struct YYLTYPE
+{
+  int first_line;
+  int first_column;
+  int last_line;
+  int last_column;
+};
+# define YYLTYPE_IS_DECLARED 1
+# define YYLTYPE_IS_TRIVIAL 1
+#endif
+
 
-extern YYSTYPE yylval;
 
 
-int yyparse (void);
+int yyparse (ParseContext& ctx);
 
 
 #endif /* !YY_YY_PARSER_TAB_H_INCLUDED  */
@@ -1,676 +1,766 @@
-%{
-#include <iostream>
+/* parser.y - table-driven LR backend for the language in parser/bnf.md
+ *
+ * Builds the same Program/Expr/Stmt nodes as the hand-written Pratt parser
+ * in parser/parser.cpp, from the same RegexLexer token stream, so either
+ * backend can feed the scope checker, type checker and IR generator.
+ *
+ * The parser is pure: all state lives in a ParseContext passed to yyparse()
+ * and yylex(), so independent token streams can be parsed on separate
+ * threads. Every node and semantic value of one parse is placed in that
+ * parse's ParseArena and the whole tree is released at once when the last
+ * Program item referring to it goes away.
+ *
+ * Build (from this directory):
+ *   bison -d parser.y
+ *   g++ -std=c++17 -O2 parser.tab.c -o bison_parser
+ *   ./bison_parser ../parser/sample.txt
+ *
+ * Define BISON_PARSER_NO_MAIN before including parser.tab.c to reuse
+ * bisonParse() in another driver.
+ */
+
+%code requires {
+#ifndef PARSER_REUSE_LEXER
+#define PARSER_REUSE_LEXER
+#endif
+#include "../regex/regex_code.cpp"
+#include "../parser/parser.cpp"
+
+#include <memory>
+#include <new>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
 #include <vector>
-#include <memory>
-#include <cstdio>
-#include <cstdlib>
-#include <cstring>
 
-class ASTNode {
-public:
-    std::string type;
-    std::string value;
-    std::vector<std::unique_ptr<ASTNode>> children;
-    
-    ASTNode(const std::string& t, const std::string& v = "") : type(t), value(v) {}
-    
-    void addChild(std::unique_ptr<ASTNode> child) {
-        children.push_back(std::move(child));
-    }
-    
-    void print(int indent = 0) const {
-        for (int i = 0; i < indent; ++i) std::cout << "  ";
-        std::cout << type;
-        if (!value.empty()) std::cout << " [" << value << "]";
-        std::cout << std::endl;
-        
-        for (const auto& child : children) {
-            child->print(indent + 1);
+using ParamList = std::vector<std::pair<TokenType, std::string>>;
+
+// One declarator of "int a = 1, b;"
+struct Declarator {
+    const Token *name;
+    Expr *init;
+};
+
+// Bump allocator for one parse. Objects are never freed individually; the
+// destructor runs the recorded destructors in reverse order and drops the
+// blocks, so a whole tree costs a handful of frees.
+class ParseArena {
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+    std::vector<std::unique_ptr<char[]>> blocks;
+    char* cur = nullptr;
+    size_t left = 0;
+    size_t reserved = 0;
+    std::vector<std::pair<void*, void (*)(void*)>> dtors;
+
+    void* allocate(size_t size, size_t align) {
+        size_t pad = (align - reinterpret_cast<uintptr_t>(cur) % align) % align;
+        if (!cur || pad + size > left) {
+            size_t n = size > BLOCK_SIZE / 4 ? size : BLOCK_SIZE;
+            blocks.emplace_back(new char[n]);
+            reserved += n;
+            // An oversized object gets its own block and keeps the current one.
+            if (n != BLOCK_SIZE)
+                return blocks.back().get();
+            cur = blocks.back().get();
+            left = n;
+            pad = 0;
         }
+        void* p = cur + pad;
+        cur += pad + size;
+        left -= pad + size;
+        return p;
+    }
+
+public:
+    ParseArena() { dtors.reserve(1024); }
+    ParseArena(const ParseArena&) = delete;
+    ParseArena& operator=(const ParseArena&) = delete;
+
+    ~ParseArena() {
+        for (auto it = dtors.rbegin(); it != dtors.rend(); ++it)
+            it->second(it->first);
     }
+
+    template <class T, class... Args>
+    T* make(Args&&... args) {
+        T* p = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        if constexpr (!std::is_trivially_destructible_v<T>)
+            dtors.push_back({p, [](void* q) { static_cast<T*>(q)->~T(); }});
+        return p;
+    }
+
+    size_t bytesReserved() const { return reserved; }
+    size_t objectCount() const { return dtors.size(); }
 };
 
+// Names visible at the current point of the parse. Each distinct name is
+// interned once to a dense id (the key views the token's lexeme, which
+// outlives the parse) and carries a count of live declarations, so lookup is
+// one hash probe regardless of how many names or scopes exist. Declarations
+// are also logged in order; popScope() undoes the ones made since the
+// matching pushScope().
 class SymbolTable {
 private:
-    std::vector<std::string> symbols;
-    
+    std::unordered_map<std::string_view, uint32_t> ids;
+    std::vector<uint32_t> live;     // per id: declarations currently in scope
+    std::vector<uint32_t> declared; // undo log of ids, innermost scope last
+    std::vector<size_t> scopes;     // declared.size() at each pushScope()
+
+    uint32_t intern(std::string_view name) {
+        auto [it, inserted] = ids.try_emplace(name, uint32_t(live.size()));
+        if (inserted)
+            live.push_back(0);
+        return it->second;
+    }
+
 public:
-    bool isDeclared(const std::string& identifier) {
-        for (const auto& var : symbols) {
-            if (var == identifier) return true;
-        }
-        return false;
+    SymbolTable() { ids.reserve(256); }
+
+    bool isDeclared(std::string_view identifier) const {
+        auto it = ids.find(identifier);
+        return it != ids.end() && live[it->second] != 0;
     }
-    
-    void declareVariable(const std::string& identifier) {
-        if (!isDeclared(identifier)) {
-            symbols.push_back(identifier);
-        }
+
+    void declareVariable(std::string_view identifier) {
+        uint32_t id = intern(identifier);
+        live[id]++;
+        declared.push_back(id);
+    }
+
+    void pushScope() { scopes.push_back(declared.size()); }
+
+    void popScope() {
+        if (scopes.empty())
+            return;
+        for (size_t i = declared.size(); i > scopes.back(); i--)
+            live[declared[i - 1]]--;
+        declared.resize(scopes.back());
+        scopes.pop_back();
     }
-    
-    void addBuiltins() {
-        symbols.insert(symbols.end(), {
-            "cout", "cin", "endl", "main", "printf", "scanf", 
-            "malloc", "free", "true", "false", "NULL", "nullptr",
-            "add", "factorial", "printMessage", "calculate"
-        });
+
+    // Drops every open scope, e.g. after error recovery skipped their ends.
+    void resetToGlobal() {
+        while (!scopes.empty())
+            popScope();
     }
+
+    size_t depth() const { return scopes.size(); }
 };
 
-extern int yylex();
-extern void yyerror(const char* s);
-extern FILE* yyin;
+// Everything one parse reads or writes. Links between nodes are non-owning
+// ExprPtr/StmtPtr (an aliasing shared_ptr with no control block); only the
+// Program items own the arena, so there are no per-node reference counts and
+// no cycles. Subtrees are valid for as long as the Program that holds them.
+struct ParseContext {
+    const std::vector<Token>* tokens = nullptr;
+    size_t tokenPos = 0;
+    const Token* lastToken = nullptr;
 
-static std::unique_ptr<ASTNode> root;
-static SymbolTable symbolTable;
-%}
+    Program* root = nullptr;
+    std::vector<std::string>* diagnostics = nullptr;
+    SymbolTable symbols;
+    int dummyCounter = 0;
+    std::shared_ptr<ParseArena> arena = std::make_shared<ParseArena>();
 
-%union {
-    char* string_val;
-    int int_val;
-    double double_val;
-    void* node_val;
+    template <class T, class... Args>
+    T* make(Args&&... args) { return arena->make<T>(std::forward<Args>(args)...); }
+
+    template <class T>
+    std::shared_ptr<T> link(T* p) const { return std::shared_ptr<T>(std::shared_ptr<void>(), p); }
+
+    template <class T>
+    std::shared_ptr<T> own(T* p) const { return std::shared_ptr<T>(arena, p); }
+
+    void diagnose(const Token& at, const std::string& msg) {
+        if (diagnostics)
+            diagnostics->push_back(msg + " (at line " + std::to_string(at.line) +
+                                   ", col " + std::to_string(at.col) + ")");
+    }
+
+    // The next non-comment token after `t`, which points into *tokens.
+    const Token* nextToken(const Token* t) const {
+        const Token* end = tokens->data() + tokens->size();
+        do
+            t++;
+        while (t < end - 1 && TokenStream::isTrivia(t->type));
+        return t;
+    }
+};
+}
+
+%code {
+#include <iostream>
+
+int yylex(YYSTYPE* lval, YYLTYPE* lloc, ParseContext& ctx);
+void yyerror(YYLTYPE* lloc, ParseContext& ctx, const char* s);
+
+static Expr* binary(ParseContext& ctx, const char* op, Expr* lhs, Expr* rhs, const YYLTYPE& at) {
+    return ctx.make<BinaryExpr>(op, ctx.link(lhs), ctx.link(rhs), at.first_line, at.first_column);
 }
 
-%token <string_val> IDENTIFIER STRING_LITERAL CHAR_LITERAL
-%token <int_val> INTEGER 
-%token <double_val> FLOAT
-%token INT FLOAT_TYPE DOUBLE CHAR BOOL VOID STRING
-%token IF ELSE WHILE FOR RETURN BREAK CONTINUE
-%token COUT CIN ENDL
-%token PLUS MINUS MULTIPLY DIVIDE MODULO
-%token ASSIGN EQ NE LT LE GT GE
-%token AND OR NOT
-%token INCREMENT DECREMENT
-%token LPAREN RPAREN LBRACE RBRACE LBRACKET RBRACKET
-%token SEMICOLON COMMA COLON
-%token OUTPUT INPUT
-%token TRUE FALSE
-
-%type <node_val> program translation_unit external_declaration
-%type <node_val> function_definition declaration
-%type <node_val> init_declarator_list init_declarator
-%type <node_val> type parameter_list parameter_declaration
-%type <node_val> compound_statement statement_list statement
-%type <node_val> selection_statement iteration_statement jump_statement
-%type <node_val> expression assignment_expression logical_or_expression
-%type <node_val> logical_and_expression equality_expression relational_expression
-%type <node_val> additive_expression multiplicative_expression
-%type <node_val> unary_expression postfix_expression primary_expression
-%type <node_val> argument_expression_list
-
-%nonassoc LOWER_THAN_ELSE
-%nonassoc ELSE
+// x += y is desugared to x = x + y, sharing x (as the Pratt parser does).
+static Expr* compound(ParseContext& ctx, const char* op, Expr* lhs, Expr* rhs, const YYLTYPE& at) {
+    ExprPtr target = ctx.link(lhs);
+    auto combined = ctx.make<BinaryExpr>(op, target, ctx.link(rhs), at.first_line, at.first_column);
+    return ctx.make<BinaryExpr>("=", target, ctx.link(combined), at.first_line, at.first_column);
+}
+
+static FnDecl* makeFunction(ParseContext& ctx, const Token* type, const Token* name, ParamList* params,
+                            const YYLTYPE& at) {
+    auto fn = ctx.make<FnDecl>(type->type, name->lexeme, at.first_line, at.first_column);
+    fn->params = std::move(*params);
+    return fn;
+}
+}
+
+%define api.pure full
+%locations
+%param { ParseContext& ctx }
 
+%union {
+    const Token* tok;
+    Expr* expr;
+    Stmt* stmt;
+    FnDecl* fn;
+    ASTNode* node;
+    std::vector<ExprPtr>* exprs;
+    std::vector<StmtPtr>* stmts;
+    ParamList* params;
+    std::pair<TokenType, std::string>* param;
+    std::vector<Declarator>* decls;
+}
+
+%token <tok> IDENTIFIER INT_LITERAL FLOAT_LITERAL STRING_LITERAL CHAR_LITERAL BOOL_LITERAL
+%token <tok> INT FLOAT STRING BOOL CHAR
+%token <tok> FN IF ELSE WHILE DO FOR RETURN BREAK
+%token <tok> PLUS MINUS MULTIPLY DIVIDE POWER
+%token <tok> ASSIGN PLUS_EQ MINUS_EQ
+%token <tok> EQ NE LT LE GT GE
+%token <tok> AND OR NOT BITAND BITOR BITXOR LSHIFT RSHIFT
+%token <tok> INCREMENT DECREMENT
+%token <tok> LPAREN RPAREN LBRACE RBRACE LBRACKET RBRACKET
+%token <tok> SEMICOLON COMMA
+
+%type <tok> type
+%type <node> top_decl
+%type <fn> function_head
+%type <stmt> statement declaration
+%type <stmts> statement_list block_body
+%type <expr> expression expression_opt for_init
+%type <exprs> argument_list argument_list_opt
+%type <params> parameter_list parameter_list_opt
+%type <param> parameter
+%type <decls> declarator_list
+
+/* No %destructor: values discarded during error recovery live in the arena
+ * and are released with it. */
+
+%precedence LOWER_THAN_ELSE
+%precedence ELSE
+
+/* Binding strength follows OP_TABLE in parser/parser.cpp. Prefix operators
+ * parse their operand at PREC_UNARY there, which sits between '&' and the
+ * shifts, so "-a + b" is "-(a + b)" in both backends. */
+%precedence NAME
+%right ASSIGN PLUS_EQ MINUS_EQ
 %left OR
 %left AND
 %left EQ NE
 %left LT LE GT GE
+%left BITOR
+%left BITXOR
+%left BITAND
+%precedence PREFIX
+%left LSHIFT RSHIFT
 %left PLUS MINUS
-%left MULTIPLY DIVIDE MODULO
-%right NOT
-%right INCREMENT DECREMENT
-%right ASSIGN
-%left OUTPUT INPUT
+%left MULTIPLY DIVIDE
+%right POWER
+%precedence INCREMENT DECREMENT LPAREN LBRACKET
 
 %start program
 
 %%
 
 program:
-    translation_unit
-    {
-        root = std::unique_ptr<ASTNode>(static_cast<ASTNode*>($1));
-    }
-    ;
-
-translation_unit:
-    external_declaration
+    %empty
+    | program top_decl
     {
-        $$ = $1;
+        if ($2)
+            ctx.root->items.push_back(ctx.own($2));
     }
-    | translation_unit external_declaration
+    | program error
     {
-        ASTNode* left = static_cast<ASTNode*>($1);
-        ASTNode* right = static_cast<ASTNode*>($2);
-        left->addChild(std::unique_ptr<ASTNode>(right));
-        $$ = $1;
+        // Recovery may have discarded the ends of open blocks.
+        ctx.symbols.resetToGlobal();
     }
     ;
 
-external_declaration:
-    function_definition
+top_decl:
+    function_head SEMICOLON
     {
+        ctx.symbols.popScope();
         $$ = $1;
     }
-    | declaration
+    | function_head LBRACE block_body
     {
+        // The body block is positioned at the first token after '{'.
+        const Token* first = ctx.nextToken($2);
+        auto block = ctx.make<BlockStmt>(first->line, first->col);
+        block->stmts = std::move(*$3);
+        $1->body.push_back(ctx.link(block));
+        ctx.symbols.popScope();
         $$ = $1;
     }
-    ;
-
-function_definition:
-    type IDENTIFIER LPAREN parameter_list RPAREN compound_statement
+    | type IDENTIFIER SEMICOLON
     {
-        auto node = new ASTNode("Function", $2);
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($1)));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($4)));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($6)));
-        symbolTable.declareVariable($2);
-        free($2);
-        $$ = node;
+        ctx.symbols.declareVariable($2->lexeme);
+        $$ = ctx.make<VarDeclStmt>($1->type, $2->lexeme, nullptr, @1.first_line, @1.first_column);
     }
-    | type IDENTIFIER LPAREN RPAREN compound_statement
+    | type IDENTIFIER ASSIGN expression SEMICOLON
     {
-        auto node = new ASTNode("Function", $2);
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($1)));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($5)));
-        symbolTable.declareVariable($2);
-        free($2);
-        $$ = node;
+        ctx.symbols.declareVariable($2->lexeme);
+        $$ = ctx.make<VarDeclStmt>($1->type, $2->lexeme, ctx.link($4), @1.first_line, @1.first_column);
     }
     ;
 
-parameter_list:
-    parameter_declaration
+/* The name is visible from its own parameter list on (for recursion); the
+ * parameters and the body share one scope, opened here and closed by
+ * top_decl. */
+function_head:
+    FN type IDENTIFIER LPAREN
     {
-        auto node = new ASTNode("ParameterList");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($1)));
-        $$ = node;
+        ctx.symbols.declareVariable($3->lexeme);
+        ctx.symbols.pushScope();
     }
-    | parameter_list COMMA parameter_declaration
+    parameter_list_opt RPAREN
     {
-        ASTNode* list = static_cast<ASTNode*>($1);
-        ASTNode* param = static_cast<ASTNode*>($3);
-        list->addChild(std::unique_ptr<ASTNode>(param));
-        $$ = $1;
+        $$ = makeFunction(ctx, $2, $3, $6, @1);
     }
-    ;
-
-parameter_declaration:
-    type IDENTIFIER
+    | type IDENTIFIER LPAREN
     {
-        auto node = new ASTNode("Parameter", $2);
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($1)));
-        symbolTable.declareVariable($2);
-        free($2);
-        $$ = node;
+        ctx.symbols.declareVariable($2->lexeme);
+        ctx.symbols.pushScope();
     }
-    ;
-
-declaration:
-    type init_declarator_list SEMICOLON
+    parameter_list_opt RPAREN
     {
-        auto node = new ASTNode("Declaration");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($1)));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($2)));
-        $$ = node;
+        $$ = makeFunction(ctx, $1, $2, $5, @1);
     }
     ;
 
-init_declarator_list:
-    init_declarator
+parameter_list_opt:
+    %empty { $$ = ctx.make<ParamList>(); }
+    | parameter_list { $$ = $1; }
+    ;
+
+parameter_list:
+    parameter
     {
-        auto node = new ASTNode("InitList");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($1)));
-        $$ = node;
+        $$ = ctx.make<ParamList>();
+        $$->push_back(std::move(*$1));
     }
-    | init_declarator_list COMMA init_declarator
+    | parameter_list COMMA parameter
     {
-        ASTNode* list = static_cast<ASTNode*>($1);
-        ASTNode* init = static_cast<ASTNode*>($3);
-        list->addChild(std::unique_ptr<ASTNode>(init));
+        $1->push_back(std::move(*$3));
         $$ = $1;
     }
     ;
 
-init_declarator:
-    IDENTIFIER
+parameter:
+    type IDENTIFIER
     {
-        auto node = new ASTNode("Variable", $1);
-        symbolTable.declareVariable($1);
-        free($1);
-        $$ = node;
+        ctx.symbols.declareVariable($2->lexeme);
+        $$ = ctx.make<std::pair<TokenType, std::string>>($1->type, $2->lexeme);
     }
-    | IDENTIFIER ASSIGN expression
+    | type
     {
-        auto node = new ASTNode("InitializedVar", $1);
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($3)));
-        symbolTable.declareVariable($1);
-        free($1);
-        $$ = node;
+        $$ = ctx.make<std::pair<TokenType, std::string>>($1->type, "_arg_" + std::to_string(ctx.dummyCounter++));
     }
     ;
 
 type:
-    INT { $$ = new ASTNode("Type", "int"); }
-    | FLOAT_TYPE { $$ = new ASTNode("Type", "float"); }
-    | DOUBLE { $$ = new ASTNode("Type", "double"); }
-    | CHAR { $$ = new ASTNode("Type", "char"); }
-    | BOOL { $$ = new ASTNode("Type", "bool"); }
-    | VOID { $$ = new ASTNode("Type", "void"); }
-    | STRING { $$ = new ASTNode("Type", "string"); }
+    INT | FLOAT | STRING | BOOL | CHAR
     ;
 
-compound_statement:
-    LBRACE statement_list RBRACE
-    {
-        auto node = new ASTNode("Block");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($2)));
-        $$ = node;
-    }
-    | LBRACE RBRACE
-    {
-        $$ = new ASTNode("EmptyBlock");
-    }
+/* The statements of a block and its closing '}'. A syntax error inside a
+ * block drops the rest of the statement it hit and resumes after the next
+ * ';' (statement: error SEMICOLON) or at the block's '}', whichever comes
+ * first, so recovery never runs past the end of the block. The '}' is part
+ * of the error rule so the parser keeps discarding tokens until it sees
+ * one; ending the rule at `error` would let a default reduction close the
+ * block at the bad token. */
+block_body:
+    statement_list RBRACE
+    | statement_list error RBRACE { $$ = $1; }
     ;
 
 statement_list:
-    statement
-    {
-        auto node = new ASTNode("StatementList");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($1)));
-        $$ = node;
-    }
+    %empty { $$ = ctx.make<std::vector<StmtPtr>>(); }
     | statement_list statement
     {
-        ASTNode* list = static_cast<ASTNode*>($1);
-        ASTNode* stmt = static_cast<ASTNode*>($2);
-        list->addChild(std::unique_ptr<ASTNode>(stmt));
+        if ($2)
+            $1->push_back(ctx.link($2));
         $$ = $1;
     }
     ;
 
 statement:
-    expression SEMICOLON
+    SEMICOLON
     {
-        $$ = $1;
-    }
-    | compound_statement
-    {
-        $$ = $1;
-    }
-    | selection_statement
-    {
-        $$ = $1;
-    }
-    | iteration_statement
-    {
-        $$ = $1;
-    }
-    | jump_statement
-    {
-        $$ = $1;
+        $$ = ctx.make<EmptyStmt>(@1.first_line, @1.first_column);
     }
     | declaration
+    | RETURN SEMICOLON
     {
-        $$ = $1;
-    }
-    | COUT OUTPUT expression SEMICOLON
-    {
-        auto node = new ASTNode("Output");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($3)));
-        $$ = node;
-    }
-    | COUT OUTPUT expression OUTPUT expression SEMICOLON
-    {
-        auto node = new ASTNode("OutputChain");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($3)));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($5)));
-        $$ = node;
+        $$ = ctx.make<ReturnStmt>(nullptr, @1.first_line, @1.first_column);
     }
-    | SEMICOLON
+    | RETURN expression SEMICOLON
     {
-        $$ = new ASTNode("EmptyStatement");
+        $$ = ctx.make<ReturnStmt>(ctx.link($2), @1.first_line, @1.first_column);
     }
-    ;
-
-selection_statement:
-    IF LPAREN expression RPAREN statement %prec LOWER_THAN_ELSE
+    | IF LPAREN expression RPAREN statement %prec LOWER_THAN_ELSE
     {
-        auto node = new ASTNode("IfStatement");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($3)));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($5)));
-        $$ = node;
+        $$ = ctx.make<IfStmt>(ctx.link($3), ctx.link($5), nullptr, @1.first_line, @1.first_column);
     }
     | IF LPAREN expression RPAREN statement ELSE statement
     {
-        auto node = new ASTNode("IfElseStatement");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($3)));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($5)));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($7)));
-        $$ = node;
+        $$ = ctx.make<IfStmt>(ctx.link($3), ctx.link($5), ctx.link($7), @1.first_line, @1.first_column);
     }
-    ;
-
-iteration_statement:
-    WHILE LPAREN expression RPAREN statement
+    | WHILE LPAREN expression RPAREN statement
     {
-        auto node = new ASTNode("WhileLoop");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($3)));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($5)));
-        $$ = node;
+        $$ = ctx.make<WhileStmt>(ctx.link($3), ctx.link($5), @1.first_line, @1.first_column);
     }
-    | FOR LPAREN expression SEMICOLON expression SEMICOLON expression RPAREN statement
+    | DO statement WHILE LPAREN expression RPAREN SEMICOLON
     {
-        auto node = new ASTNode("ForLoop");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($3)));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($5)));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($7)));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($9)));
-        $$ = node;
+        $$ = ctx.make<DoWhileStmt>(ctx.link($2), ctx.link($5), @1.first_line, @1.first_column);
     }
-    ;
-
-jump_statement:
-    RETURN expression SEMICOLON
+    | FOR LPAREN { ctx.symbols.pushScope(); }
+      for_init SEMICOLON expression_opt SEMICOLON expression_opt RPAREN statement
     {
-        auto node = new ASTNode("Return");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($2)));
-        $$ = node;
+        ctx.symbols.popScope();
+        $$ = ctx.make<ForStmt>(ctx.link($4), ctx.link($6), ctx.link($8), ctx.link($10), @1.first_line, @1.first_column);
     }
-    | RETURN SEMICOLON
+    | BREAK SEMICOLON
     {
-        $$ = new ASTNode("ReturnVoid");
+        $$ = ctx.make<BreakStmt>(@1.first_line, @1.first_column);
     }
-    | BREAK SEMICOLON
+    | LBRACE { ctx.symbols.pushScope(); } block_body
     {
-        $$ = new ASTNode("Break");
+        ctx.symbols.popScope();
+        auto block = ctx.make<BlockStmt>(@1.first_line, @1.first_column);
+        block->stmts = std::move(*$3);
+        $$ = block;
     }
-    | CONTINUE SEMICOLON
+    | expression SEMICOLON
     {
-        $$ = new ASTNode("Continue");
+        $$ = ctx.make<ExprStmt>(ctx.link($1), @1.first_line, @1.first_column);
     }
-    ;
-
-expression:
-    assignment_expression
+    | error SEMICOLON
     {
-        $$ = $1;
+        $$ = nullptr;
     }
     ;
 
-assignment_expression:
-    logical_or_expression
-    {
-        $$ = $1;
-    }
-    | IDENTIFIER ASSIGN assignment_expression
-    {
-        if (!symbolTable.isDeclared($1)) {
-            yyerror("Undeclared variable");
-            YYERROR;
+/* "int a;" is a VarDeclStmt at the name; "int a, b;" is a block of them at
+ * the type keyword. */
+declaration:
+    type declarator_list SEMICOLON
+    {
+        std::vector<Declarator>& list = *$2;
+        if (list.size() == 1) {
+            $$ = ctx.make<VarDeclStmt>($1->type, list[0].name->lexeme, ctx.link(list[0].init),
+                                       list[0].name->line, list[0].name->col);
+        } else {
+            auto block = ctx.make<BlockStmt>(@1.first_line, @1.first_column);
+            for (auto& d : list)
+                block->stmts.push_back(ctx.link(ctx.make<VarDeclStmt>($1->type, d.name->lexeme, ctx.link(d.init),
+                                                                      d.name->line, d.name->col)));
+            $$ = block;
         }
-        auto node = new ASTNode("Assignment", $1);
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($3)));
-        free($1);
-        $$ = node;
     }
     ;
 
-logical_or_expression:
-    logical_and_expression { $$ = $1; }
-    | logical_or_expression OR logical_and_expression
+declarator_list:
+    IDENTIFIER
     {
-        auto node = new ASTNode("LogicalOR");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($1)));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($3)));
-        $$ = node;
+        ctx.symbols.declareVariable($1->lexeme);
+        $$ = ctx.make<std::vector<Declarator>>(1, Declarator{$1, nullptr});
     }
-    ;
-
-logical_and_expression:
-    equality_expression { $$ = $1; }
-    | logical_and_expression AND equality_expression
+    | IDENTIFIER ASSIGN expression
     {
-        auto node = new ASTNode("LogicalAND");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($1)));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($3)));
-        $$ = node;
+        ctx.symbols.declareVariable($1->lexeme);
+        $$ = ctx.make<std::vector<Declarator>>(1, Declarator{$1, $3});
     }
-    ;
-
-equality_expression:
-    relational_expression { $$ = $1; }
-    | equality_expression EQ relational_expression
+    | declarator_list COMMA IDENTIFIER
     {
-        auto node = new ASTNode("Equal");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($1)));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($3)));
-        $$ = node;
+        ctx.symbols.declareVariable($3->lexeme);
+        $1->push_back({$3, nullptr});
+        $$ = $1;
     }
-    | equality_expression NE relational_expression
+    | declarator_list COMMA IDENTIFIER ASSIGN expression
     {
-        auto node = new ASTNode("NotEqual");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($1)));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($3)));
-        $$ = node;
+        ctx.symbols.declareVariable($3->lexeme);
+        $1->push_back({$3, $5});
+        $$ = $1;
     }
     ;
 
-relational_expression:
-    additive_expression { $$ = $1; }
-    | relational_expression LT additive_expression
-    {
-        auto node = new ASTNode("LessThan");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($1)));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($3)));
-        $$ = node;
-    }
-    | relational_expression LE additive_expression
-    {
-        auto node = new ASTNode("LessEqual");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($1)));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($3)));
-        $$ = node;
-    }
-    | relational_expression GT additive_expression
+/* A typed for-init keeps only its initializer, like the Pratt parser. */
+for_init:
+    expression_opt
+    | type IDENTIFIER
     {
-        auto node = new ASTNode("GreaterThan");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($1)));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($3)));
-        $$ = node;
+        ctx.symbols.declareVariable($2->lexeme);
+        $$ = nullptr;
     }
-    | relational_expression GE additive_expression
+    | type IDENTIFIER ASSIGN expression
     {
-        auto node = new ASTNode("GreaterEqual");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($1)));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($3)));
-        $$ = node;
+        ctx.symbols.declareVariable($2->lexeme);
+        $$ = $4;
     }
     ;
 
-additive_expression:
-    multiplicative_expression { $$ = $1; }
-    | additive_expression PLUS multiplicative_expression
-    {
-        auto node = new ASTNode("Add");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($1)));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($3)));
-        $$ = node;
-    }
-    | additive_expression MINUS multiplicative_expression
-    {
-        auto node = new ASTNode("Subtract");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($1)));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($3)));
-        $$ = node;
-    }
+expression_opt:
+    %empty { $$ = nullptr; }
+    | expression
     ;
 
-multiplicative_expression:
-    unary_expression { $$ = $1; }
-    | multiplicative_expression MULTIPLY unary_expression
+expression:
+    INT_LITERAL
     {
-        auto node = new ASTNode("Multiply");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($1)));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($3)));
-        $$ = node;
+        $$ = ctx.make<IntLiteral>($1->lexeme, @1.first_line, @1.first_column);
     }
-    | multiplicative_expression DIVIDE unary_expression
+    | FLOAT_LITERAL
     {
-        auto node = new ASTNode("Divide");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($1)));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($3)));
-        $$ = node;
+        $$ = ctx.make<FloatLiteral>($1->lexeme, @1.first_line, @1.first_column);
     }
-    | multiplicative_expression MODULO unary_expression
+    | STRING_LITERAL
     {
-        auto node = new ASTNode("Modulo");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($1)));
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($3)));
-        $$ = node;
+        $$ = ctx.make<StringLiteral>($1->lexeme, @1.first_line, @1.first_column);
     }
-    ;
-
-unary_expression:
-    postfix_expression { $$ = $1; }
-    | PLUS unary_expression
+    | CHAR_LITERAL
     {
-        auto node = new ASTNode("UnaryPlus");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($2)));
-        $$ = node;
+        $$ = ctx.make<CharLiteral>($1->lexeme, @1.first_line, @1.first_column);
     }
-    | MINUS unary_expression
+    | BOOL_LITERAL
     {
-        auto node = new ASTNode("UnaryMinus");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($2)));
-        $$ = node;
+        $$ = ctx.make<BoolLiteral>($1->lexeme == "true", @1.first_line, @1.first_column);
     }
-    | NOT unary_expression
+    | IDENTIFIER %prec NAME
     {
-        auto node = new ASTNode("LogicalNOT");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($2)));
-        $$ = node;
+        if (!ctx.symbols.isDeclared($1->lexeme))
+            ctx.diagnose(*$1, "Undeclared identifier '" + $1->lexeme + "'");
+        $$ = ctx.make<IdentifierExpr>($1->lexeme, @1.first_line, @1.first_column);
     }
-    ;
-
-postfix_expression:
-    primary_expression { $$ = $1; }
-    | postfix_expression INCREMENT
+    | IDENTIFIER LPAREN argument_list_opt RPAREN
     {
-        auto node = new ASTNode("PostfixIncrement");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($1)));
-        $$ = node;
+        auto callee = ctx.link(ctx.make<IdentifierExpr>($1->lexeme, @1.first_line, @1.first_column));
+        $$ = ctx.make<CallExpr>(std::move(callee), std::move(*$3), @1.first_line, @1.first_column);
     }
-    | postfix_expression DECREMENT
+    | LPAREN expression RPAREN
     {
-        auto node = new ASTNode("PostfixDecrement");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($1)));
-        $$ = node;
+        $$ = $2;
     }
-    | IDENTIFIER LPAREN argument_expression_list RPAREN
+    | expression LPAREN argument_list_opt RPAREN
     {
-        auto node = new ASTNode("FunctionCall", $1);
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($3)));
-        symbolTable.declareVariable($1);
-        free($1);
-        $$ = node;
+        $$ = ctx.make<CallExpr>(ctx.link($1), std::move(*$3), @2.first_line, @2.first_column);
     }
-    | IDENTIFIER LPAREN RPAREN
+    | expression LBRACKET expression RBRACKET
     {
-        auto node = new ASTNode("FunctionCall", $1);
-        symbolTable.declareVariable($1);
-        free($1);
-        $$ = node;
+        $$ = ctx.make<IndexExpr>(ctx.link($1), ctx.link($3), @2.first_line, @2.first_column);
     }
-    ;
-
-primary_expression:
-    IDENTIFIER
+    | expression INCREMENT
     {
-        if (!symbolTable.isDeclared($1)) {
-            yyerror("Undeclared variable");
-            YYERROR;
-        }
-        auto node = new ASTNode("Variable", $1);
-        free($1);
-        $$ = node;
+        $$ = ctx.make<PostfixExpr>("++", ctx.link($1), @2.first_line, @2.first_column);
     }
-    | INTEGER
+    | expression DECREMENT
     {
-        auto node = new ASTNode("Integer", std::to_string($1));
-        $$ = node;
+        $$ = ctx.make<PostfixExpr>("--", ctx.link($1), @2.first_line, @2.first_column);
     }
-    | FLOAT
-    {
-        auto node = new ASTNode("Float", std::to_string($1));
-        $$ = node;
-    }
-    | STRING_LITERAL
+    | MINUS expression %prec PREFIX
     {
-        auto node = new ASTNode("String", $1);
-        free($1);
-        $$ = node;
+        $$ = ctx.make<UnaryExpr>("-", ctx.link($2), @1.first_line, @1.first_column);
     }
-    | CHAR_LITERAL
+    | PLUS expression %prec PREFIX
     {
-        auto node = new ASTNode("Char", $1);
-        free($1);
-        $$ = node;
+        $$ = ctx.make<UnaryExpr>("+", ctx.link($2), @1.first_line, @1.first_column);
     }
-    | TRUE
+    | NOT expression %prec PREFIX
     {
-        $$ = new ASTNode("Boolean", "true");
+        $$ = ctx.make<UnaryExpr>("!", ctx.link($2), @1.first_line, @1.first_column);
     }
-    | FALSE
+    | INCREMENT expression %prec PREFIX
     {
-        $$ = new ASTNode("Boolean", "false");
+        $$ = ctx.make<UnaryExpr>("++", ctx.link($2), @1.first_line, @1.first_column);
     }
-    | LPAREN expression RPAREN
+    | DECREMENT expression %prec PREFIX
     {
-        auto node = new ASTNode("Parenthesized");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($2)));
-        $$ = node;
+        $$ = ctx.make<UnaryExpr>("--", ctx.link($2), @1.first_line, @1.first_column);
     }
+    | expression ASSIGN expression   { $$ = binary(ctx, "=", $1, $3, @2); }
+    | expression PLUS_EQ expression  { $$ = compound(ctx, "+", $1, $3, @2); }
+    | expression MINUS_EQ expression { $$ = compound(ctx, "-", $1, $3, @2); }
+    | expression OR expression       { $$ = binary(ctx, "||", $1, $3, @2); }
+    | expression AND expression      { $$ = binary(ctx, "&&", $1, $3, @2); }
+    | expression EQ expression       { $$ = binary(ctx, "==", $1, $3, @2); }
+    | expression NE expression       { $$ = binary(ctx, "!=", $1, $3, @2); }
+    | expression LT expression       { $$ = binary(ctx, "<", $1, $3, @2); }
+    | expression LE expression       { $$ = binary(ctx, "<=", $1, $3, @2); }
+    | expression GT expression       { $$ = binary(ctx, ">", $1, $3, @2); }
+    | expression GE expression       { $$ = binary(ctx, ">=", $1, $3, @2); }
+    | expression BITOR expression    { $$ = binary(ctx, "|", $1, $3, @2); }
+    | expression BITXOR expression   { $$ = binary(ctx, "^", $1, $3, @2); }
+    | expression BITAND expression   { $$ = binary(ctx, "&", $1, $3, @2); }
+    | expression LSHIFT expression   { $$ = binary(ctx, "<<", $1, $3, @2); }
+    | expression RSHIFT expression   { $$ = binary(ctx, ">>", $1, $3, @2); }
+    | expression PLUS expression     { $$ = binary(ctx, "+", $1, $3, @2); }
+    | expression MINUS expression    { $$ = binary(ctx, "-", $1, $3, @2); }
+    | expression MULTIPLY expression { $$ = binary(ctx, "*", $1, $3, @2); }
+    | expression DIVIDE expression   { $$ = binary(ctx, "/", $1, $3, @2); }
+    | expression POWER expression    { $$ = binary(ctx, "**", $1, $3, @2); }
     ;
 
-argument_expression_list:
-    assignment_expression
+argument_list_opt:
+    %empty { $$ = ctx.make<std::vector<ExprPtr>>(); }
+    | argument_list { $$ = $1; }
+    ;
+
+argument_list:
+    expression
     {
-        auto node = new ASTNode("ArgumentList");
-        node->addChild(std::unique_ptr<ASTNode>(static_cast<ASTNode*>($1)));
-        $$ = node;
+        $$ = ctx.make<std::vector<ExprPtr>>();
+        $$->reserve(4);
+        $$->push_back(ctx.link($1));
     }
-    | argument_expression_list COMMA assignment_expression
+    | argument_list COMMA expression
     {
-        ASTNode* list = static_cast<ASTNode*>($1);
-        ASTNode* arg = static_cast<ASTNode*>($3);
-        list->addChild(std::unique_ptr<ASTNode>(arg));
+        $1->push_back(ctx.link($3));
         $$ = $1;
     }
     ;
 
 %%
 
-void yyerror(const char* s) {
-    fprintf(stderr, "Parser Error: %s\n", s);
+static int tokenCode(TokenType t) {
+    switch (t) {
+    case TokenType::T_FUNCTION: return FN;
+    case TokenType::T_INT: return INT;
+    case TokenType::T_FLOAT: return FLOAT;
+    case TokenType::T_STRING: return STRING;
+    case TokenType::T_BOOL: return BOOL;
+    case TokenType::T_CHAR: return CHAR;
+    case TokenType::T_BOOLLIT: return BOOL_LITERAL;
+    case TokenType::T_RETURN: return RETURN;
+    case TokenType::T_IF: return IF;
+    case TokenType::T_ELSE: return ELSE;
+    case TokenType::T_WHILE: return WHILE;
+    case TokenType::T_FOR: return FOR;
+    case TokenType::T_DO: return DO;
+    case TokenType::T_BREAK: return BREAK;
+    case TokenType::T_IDENTIFIER: return IDENTIFIER;
+    case TokenType::T_INTLIT: return INT_LITERAL;
+    case TokenType::T_FLOATLIT: return FLOAT_LITERAL;
+    case TokenType::T_STRINGLIT: return STRING_LITERAL;
+    case TokenType::T_CHARLIT: return CHAR_LITERAL;
+    case TokenType::T_PARENL: return LPAREN;
+    case TokenType::T_PARENR: return RPAREN;
+    case TokenType::T_BRACEL: return LBRACE;
+    case TokenType::T_BRACER: return RBRACE;
+    case TokenType::T_BRACKETL: return LBRACKET;
+    case TokenType::T_BRACKETR: return RBRACKET;
+    case TokenType::T_COMMA: return COMMA;
+    case TokenType::T_SEMICOLON: return SEMICOLON;
+    case TokenType::T_LSHIFT: return LSHIFT;
+    case TokenType::T_RSHIFT: return RSHIFT;
+    case TokenType::T_ASSIGNOP: return ASSIGN;
+    case TokenType::T_EQUALSOP: return EQ;
+    case TokenType::T_NOTEQUAL: return NE;
+    case TokenType::T_LESS: return LT;
+    case TokenType::T_LESSEQ: return LE;
+    case TokenType::T_GREATER: return GT;
+    case TokenType::T_GREATEREQ: return GE;
+    case TokenType::T_PLUS: return PLUS;
+    case TokenType::T_MINUS: return MINUS;
+    case TokenType::T_MULTIPLY: return MULTIPLY;
+    case TokenType::T_DIVIDE: return DIVIDE;
+    case TokenType::T_AND: return AND;
+    case TokenType::T_OR: return OR;
+    case TokenType::T_NOT: return NOT;
+    case TokenType::T_BITAND: return BITAND;
+    case TokenType::T_BITOR: return BITOR;
+    case TokenType::T_BITXOR: return BITXOR;
+    case TokenType::T_POWER: return POWER;
+    case TokenType::T_PLUS_EQ: return PLUS_EQ;
+    case TokenType::T_MINUS_EQ: return MINUS_EQ;
+    case TokenType::T_INC: return INCREMENT;
+    case TokenType::T_DEC: return DECREMENT;
+    case TokenType::T_EOF: return YYEOF;
+    default: return YYUNDEF;
+    }
 }
 
+// Feeds the RegexLexer tokens to the parser, skipping comments. The semantic
+// value is a pointer into the token vector, so nothing is copied.
+int yylex(YYSTYPE* lval, YYLTYPE* lloc, ParseContext& ctx) {
+    const std::vector<Token>& tokens = *ctx.tokens;
+    while (ctx.tokenPos < tokens.size() && TokenStream::isTrivia(tokens[ctx.tokenPos].type))
+        ctx.tokenPos++;
+    if (ctx.tokenPos >= tokens.size())
+        return YYEOF;
+    const Token& t = tokens[ctx.tokenPos++];
+    ctx.lastToken = &t;
+    lval->tok = &t;
+    lloc->first_line = lloc->last_line = t.line;
+    lloc->first_column = lloc->last_column = t.col;
+    return tokenCode(t.type);
+}
+
+void yyerror(YYLTYPE*, ParseContext& ctx, const char* s) {
+    if (ctx.lastToken)
+        ctx.diagnose(*ctx.lastToken, std::string("Parse error: ") + s);
+    else if (ctx.diagnostics)
+        ctx.diagnostics->push_back(std::string("Parse error: ") + s);
+}
+
+// Parses `toks` into `out`. Syntax errors and undeclared identifiers are
+// appended to `errors`; returns true when the whole input was accepted.
+// Reentrant: concurrent calls on different arguments do not share state.
+// The nodes added to `out` live in a fresh arena that is freed with the
+// last of them.
+bool bisonParse(const std::vector<Token>& toks, Program& out, std::vector<std::string>& errors) {
+    ParseContext ctx;
+    ctx.tokens = &toks;
+    ctx.root = &out;
+    ctx.diagnostics = &errors;
+    size_t before = errors.size();
+    int result = yyparse(ctx);
+    return result == 0 && errors.size() == before;
+}
+
+#ifndef BISON_PARSER_NO_MAIN
 int main(int argc, char* argv[]) {
-    if (argc > 1) {
-        yyin = fopen(argv[1], "r");
-        if (!yyin) {
-            fprintf(stderr, "Cannot open file: %s\n", argv[1]);
-            return 1;
-        }
-    }
-    
-    std::cout << "C++ Parser with AST Generation" << std::endl;
-    symbolTable.addBuiltins();
-    
-    int result = yyparse();
-    
-    if (yyin != stdin) {
-        fclose(yyin);
-    }
-    
-    if (result == 0 && root) {
-        std::cout << "\n=== ABSTRACT SYNTAX TREE ===" << std::endl;
-        root->print();
-        std::cout << "============================\n" << std::endl;
-    }
-    
-    return result;
-}
\ No newline at end of file
+    const char* path = argc > 1 ? argv[1] : "sample.txt";
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "Cannot open file: " << path << std::endl;
+        return 1;
+    }
+    std::stringstream ss;
+    ss << in.rdbuf();
+
+    RegexLexer lexer(ss.str());
+    std::vector<Token> toks = lexer.tokenize();
+
+    Program prog;
+    std::vector<std::string> errors;
+    bool ok = bisonParse(toks, prog, errors);
+
+    std::cout << "=== ABSTRACT SYNTAX TREE ===" << std::endl;
+    prog.print(std::cout);
+    for (const auto& e : errors)
+        std::cout << e << std::endl;
+    return ok ? 0 : 1;
+}
+#endif
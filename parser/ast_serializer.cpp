@@ -0,0 +1,340 @@
+// ast_serializer.cpp - compact text encoding of AST subtrees
+// Include after parser.cpp. Used by the build cache to store parsed
+// top-level declarations on disk and load them back without re-parsing.
+//
+// Every node is a one-character tag followed by space-separated fields:
+// line, col, then the node's own fields. Strings are written as
+// <length>:<bytes> so they may contain spaces and newlines; '-' is a null
+// child.
+#ifndef AST_SERIALIZER_CPP
+#define AST_SERIALIZER_CPP
+#include "parser.cpp"
+#include <ostream>
+
+class ASTWriter
+{
+public:
+    explicit ASTWriter(ostream &o) : os(o) {}
+
+    void node(const ASTNode *n)
+    {
+        if (!n)
+        {
+            os << "- ";
+            return;
+        }
+        if (auto e = dynamic_cast<const Expr *>(n))
+            expr(e);
+        else if (auto s = dynamic_cast<const Stmt *>(n))
+            stmt(s);
+        else if (auto fn = dynamic_cast<const FnDecl *>(n))
+        {
+            head('D', *fn);
+            num((int)fn->returnType);
+            str(fn->name);
+            num((long long)fn->params.size());
+            for (auto &p : fn->params)
+            {
+                num((int)p.first);
+                str(p.second);
+            }
+            num((long long)fn->body.size());
+            for (auto &s : fn->body)
+                node(s.get());
+        }
+        else
+            throw runtime_error("ASTWriter: unsupported node");
+    }
+
+private:
+    ostream &os;
+
+    void head(char tag, const ASTNode &n) { os << tag << ' ' << n.line << ' ' << n.col << ' '; }
+    void num(long long v) { os << v << ' '; }
+    void str(const string &s) { os << s.size() << ':' << s << ' '; }
+
+    void expr(const Expr *e)
+    {
+        if (auto n = dynamic_cast<const IntLiteral *>(e))
+            head('I', *n), str(n->val);
+        else if (auto n = dynamic_cast<const FloatLiteral *>(e))
+            head('F', *n), str(n->val);
+        else if (auto n = dynamic_cast<const StringLiteral *>(e))
+            head('S', *n), str(n->val);
+        else if (auto n = dynamic_cast<const CharLiteral *>(e))
+            head('C', *n), str(n->val);
+        else if (auto n = dynamic_cast<const BoolLiteral *>(e))
+            head('B', *n), num(n->val);
+        else if (auto n = dynamic_cast<const IdentifierExpr *>(e))
+            head('N', *n), str(n->name);
+        else if (auto n = dynamic_cast<const UnaryExpr *>(e))
+        {
+            head('U', *n), str(n->op);
+            node(n->rhs.get());
+        }
+        else if (auto n = dynamic_cast<const PostfixExpr *>(e))
+        {
+            head('P', *n), str(n->op);
+            node(n->expr.get());
+        }
+        else if (auto n = dynamic_cast<const BinaryExpr *>(e))
+        {
+            head('X', *n), str(n->op);
+            node(n->lhs.get());
+            node(n->rhs.get());
+        }
+        else if (auto n = dynamic_cast<const CallExpr *>(e))
+        {
+            head('L', *n), str(n->name);
+            if (n->name.empty())
+                node(n->callee.get());
+            num((long long)n->args.size());
+            for (auto &a : n->args)
+                node(a.get());
+        }
+        else if (auto n = dynamic_cast<const IndexExpr *>(e))
+        {
+            head('Q', *n);
+            node(n->base.get());
+            node(n->index.get());
+        }
+        else
+            throw runtime_error("ASTWriter: unsupported expression");
+    }
+
+    void stmt(const Stmt *s)
+    {
+        if (auto n = dynamic_cast<const BreakStmt *>(s))
+            head('k', *n);
+        else if (auto n = dynamic_cast<const EmptyStmt *>(s))
+            head('e', *n);
+        else if (auto n = dynamic_cast<const ExprStmt *>(s))
+        {
+            head('x', *n);
+            node(n->expr.get());
+        }
+        else if (auto n = dynamic_cast<const ReturnStmt *>(s))
+        {
+            head('r', *n);
+            node(n->expr.get());
+        }
+        else if (auto n = dynamic_cast<const VarDeclStmt *>(s))
+        {
+            head('v', *n), num((int)n->typeTok), str(n->name);
+            node(n->init.get());
+        }
+        else if (auto n = dynamic_cast<const BlockStmt *>(s))
+        {
+            head('b', *n), num((long long)n->stmts.size());
+            for (auto &c : n->stmts)
+                node(c.get());
+        }
+        else if (auto n = dynamic_cast<const IfStmt *>(s))
+        {
+            head('i', *n);
+            node(n->cond.get());
+            node(n->thenStmt.get());
+            node(n->elseStmt.get());
+        }
+        else if (auto n = dynamic_cast<const WhileStmt *>(s))
+        {
+            head('w', *n);
+            node(n->cond.get());
+            node(n->body.get());
+        }
+        else if (auto n = dynamic_cast<const DoWhileStmt *>(s))
+        {
+            head('d', *n);
+            node(n->body.get());
+            node(n->cond.get());
+        }
+        else if (auto n = dynamic_cast<const ForStmt *>(s))
+        {
+            head('f', *n);
+            node(n->init.get());
+            node(n->cond.get());
+            node(n->post.get());
+            node(n->body.get());
+        }
+        else
+            throw runtime_error("ASTWriter: unsupported statement");
+    }
+};
+
+class ASTReader
+{
+public:
+    // Reads from an in-memory buffer starting at `pos`; the caller keeps
+    // `data` alive and may continue reading its own fields afterwards.
+    explicit ASTReader(const string &d, size_t p = 0) : data(d), pos(p) {}
+
+    shared_ptr<ASTNode> node()
+    {
+        skipSpace();
+        if (pos >= data.size())
+            throw runtime_error("ASTReader: unexpected end of data");
+        char tag = data[pos++];
+        if (tag == '-')
+            return nullptr;
+        int line = (int)num(), col = (int)num();
+        switch (tag)
+        {
+        case 'I':
+            return make_shared<IntLiteral>(str(), line, col);
+        case 'F':
+            return make_shared<FloatLiteral>(str(), line, col);
+        case 'S':
+            return make_shared<StringLiteral>(str(), line, col);
+        case 'C':
+            return make_shared<CharLiteral>(str(), line, col);
+        case 'B':
+            return make_shared<BoolLiteral>(num() != 0, line, col);
+        case 'N':
+            return make_shared<IdentifierExpr>(str(), line, col);
+        case 'U':
+        {
+            string op = str();
+            return make_shared<UnaryExpr>(op, expr(), line, col);
+        }
+        case 'P':
+        {
+            string op = str();
+            return make_shared<PostfixExpr>(op, expr(), line, col);
+        }
+        case 'X':
+        {
+            string op = str();
+            ExprPtr l = expr();
+            return make_shared<BinaryExpr>(op, l, expr(), line, col);
+        }
+        case 'L':
+        {
+            string name = str();
+            ExprPtr callee = name.empty() ? expr() : make_shared<IdentifierExpr>(name, line, col);
+            vector<ExprPtr> args((size_t)num());
+            for (auto &a : args)
+                a = expr();
+            return make_shared<CallExpr>(move(callee), move(args), line, col);
+        }
+        case 'Q':
+        {
+            ExprPtr base = expr();
+            return make_shared<IndexExpr>(base, expr(), line, col);
+        }
+        case 'k':
+            return make_shared<BreakStmt>(line, col);
+        case 'e':
+            return make_shared<EmptyStmt>(line, col);
+        case 'x':
+            return make_shared<ExprStmt>(expr(), line, col);
+        case 'r':
+            return make_shared<ReturnStmt>(expr(), line, col);
+        case 'v':
+        {
+            TokenType t = (TokenType)num();
+            string name = str();
+            return make_shared<VarDeclStmt>(t, name, expr(), line, col);
+        }
+        case 'b':
+        {
+            auto block = make_shared<BlockStmt>(line, col);
+            block->stmts.resize((size_t)num());
+            for (auto &s : block->stmts)
+                s = stmt();
+            return block;
+        }
+        case 'i':
+        {
+            ExprPtr cond = expr();
+            StmtPtr thenStmt = stmt();
+            return make_shared<IfStmt>(cond, thenStmt, stmt(), line, col);
+        }
+        case 'w':
+        {
+            ExprPtr cond = expr();
+            return make_shared<WhileStmt>(cond, stmt(), line, col);
+        }
+        case 'd':
+        {
+            StmtPtr body = stmt();
+            return make_shared<DoWhileStmt>(body, expr(), line, col);
+        }
+        case 'f':
+        {
+            ExprPtr init = expr();
+            ExprPtr cond = expr();
+            ExprPtr post = expr();
+            return make_shared<ForStmt>(init, cond, post, stmt(), line, col);
+        }
+        case 'D':
+        {
+            TokenType rt = (TokenType)num();
+            auto fn = make_shared<FnDecl>(rt, str(), line, col);
+            fn->params.resize((size_t)num());
+            for (auto &p : fn->params)
+            {
+                p.first = (TokenType)num();
+                p.second = str();
+            }
+            fn->body.resize((size_t)num());
+            for (auto &s : fn->body)
+                s = stmt();
+            return fn;
+        }
+        default:
+            throw runtime_error(string("ASTReader: unknown tag '") + tag + "'");
+        }
+    }
+
+    long long num()
+    {
+        skipSpace();
+        bool neg = pos < data.size() && data[pos] == '-';
+        pos += neg;
+        if (pos >= data.size() || !isdigit((unsigned char)data[pos]))
+            throw runtime_error("ASTReader: expected number");
+        unsigned long long v = 0;
+        while (pos < data.size() && isdigit((unsigned char)data[pos]))
+            v = v * 10 + (data[pos++] - '0');
+        return neg ? -(long long)v : (long long)v;
+    }
+    string str()
+    {
+        size_t n = (size_t)num();
+        if (pos >= data.size() || data[pos] != ':')
+            throw runtime_error("ASTReader: expected string");
+        pos++;
+        if (n > data.size() - pos)
+            throw runtime_error("ASTReader: truncated string");
+        string s = data.substr(pos, n);
+        pos += n;
+        return s;
+    }
+
+private:
+    const string &data;
+    size_t pos;
+
+    void skipSpace()
+    {
+        while (pos < data.size() && isspace((unsigned char)data[pos]))
+            pos++;
+    }
+    ExprPtr expr()
+    {
+        auto n = node();
+        auto e = dynamic_pointer_cast<Expr>(n);
+        if (n && !e)
+            throw runtime_error("ASTReader: expected expression");
+        return e;
+    }
+    StmtPtr stmt()
+    {
+        auto n = node();
+        auto s = dynamic_pointer_cast<Stmt>(n);
+        if (n && !s)
+            throw runtime_error("ASTReader: expected statement");
+        return s;
+    }
+};
+#endif // AST_SERIALIZER_CPP
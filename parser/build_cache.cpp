@@ -0,0 +1,491 @@
+// build_cache.cpp - front end driver with a persistent per-declaration cache
+// Build: g++ -std=c++17 -O2 parser/build_cache.cpp -o build_cache
+// Usage: build_cache [--cache DIR] [--clear] file...
+//
+// Each file is lexed and split into top-level declarations by token range.
+// A declaration's cache entry is named by a hash of its tokens (lines taken
+// relative to the declaration's first line), so it survives edits elsewhere
+// in the file. The entry holds:
+//   - the serialized subtree    -> reused whenever the tokens match
+//   - scope/type diagnostics    -> reused only if the declaration still
+//     starts on the same line and every identifier it mentions still has the
+//     same global signature (or is still not a global)
+// Misses are parsed/checked normally and written back.
+#define PARSER_REUSE_LEXER
+#define SCOPE_CHECKER_NO_MAIN
+#define TYPE_CHECKER_NO_MAIN
+#include "../regex/regex_code.cpp"
+#include "parser.cpp"
+#include "ast_serializer.cpp"
+#include "scope_checker.cpp"
+#include "type_checker.cpp"
+#include <chrono>
+#include <filesystem>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+// ---------- Hashing (FNV-1a, stable across runs) ----------
+struct Fnv
+{
+    uint64_t h = 1469598103934665603ULL;
+    void bytes(const void *p, size_t n)
+    {
+        auto c = static_cast<const unsigned char *>(p);
+        for (size_t i = 0; i < n; i++)
+            h = (h ^ c[i]) * 1099511628211ULL;
+    }
+    void num(long long v) { bytes(&v, sizeof v); }
+    void str(const string &s)
+    {
+        num((long long)s.size());
+        bytes(s.data(), s.size());
+    }
+};
+
+static string hex64(uint64_t v)
+{
+    char buf[17];
+    snprintf(buf, sizeof buf, "%016llx", (unsigned long long)v);
+    return buf;
+}
+
+static bool isTypeTok(TokenType t)
+{
+    return t == TokenType::T_INT || t == TokenType::T_FLOAT || t == TokenType::T_STRING ||
+           t == TokenType::T_BOOL || t == TokenType::T_CHAR;
+}
+
+// ---------- Splitting a token stream into top-level declarations ----------
+// Mirrors Parser::parseProgram: a declaration starts at 'fn' or a type
+// keyword and ends at a ';' or the '}' closing its body; anything else is
+// junk up to the next ';'/'}' or declaration start (the parser skips it).
+struct DeclRange
+{
+    size_t begin, end; // token indices, end exclusive
+};
+
+static vector<DeclRange> splitTopLevel(const vector<Token> &toks)
+{
+    vector<DeclRange> out;
+    size_t i = 0, n = toks.size();
+    while (i < n && toks[i].type != TokenType::T_EOF)
+    {
+        if (TokenStream::isTrivia(toks[i].type))
+        {
+            i++;
+            continue;
+        }
+        size_t start = i;
+        bool decl = toks[i].type == TokenType::T_FUNCTION || isTypeTok(toks[i].type);
+        int depth = 0;
+        for (; i < n && toks[i].type != TokenType::T_EOF; i++)
+        {
+            TokenType t = toks[i].type;
+            if (!decl && i > start && depth == 0 && (t == TokenType::T_FUNCTION || isTypeTok(t)))
+                break;
+            if (t == TokenType::T_BRACEL)
+                depth++;
+            else if (t == TokenType::T_BRACER && --depth <= 0)
+            {
+                i++;
+                break;
+            }
+            else if (t == TokenType::T_SEMICOLON && depth == 0)
+            {
+                i++;
+                break;
+            }
+        }
+        out.push_back({start, i});
+    }
+    return out;
+}
+
+// Signature of the global a declaration introduces, read from its header
+// tokens: "f<ret>(<params>)" for functions, "v<type>" for variables.
+static bool scanSignature(const vector<Token> &toks, DeclRange r, string &name, string &sig)
+{
+    size_t i = r.begin;
+    auto at = [&](size_t k)
+    { return k < r.end ? toks[k].type : TokenType::T_EOF; };
+    if (at(i) == TokenType::T_FUNCTION)
+        i++;
+    if (!isTypeTok(at(i)) || at(i + 1) != TokenType::T_IDENTIFIER)
+        return false;
+    TokenType type = at(i);
+    name = toks[i + 1].lexeme;
+    if (at(i + 2) != TokenType::T_PARENL)
+    {
+        sig = string("v") + typeKeywordToString(type);
+        return true;
+    }
+    sig = string("f") + typeKeywordToString(type) + "(";
+    for (size_t k = i + 3; k < r.end && at(k) != TokenType::T_PARENR; k++)
+        if (isTypeTok(at(k)))
+            sig += string(typeKeywordToString(at(k))) + ",";
+    sig += ")";
+    return true;
+}
+
+// ---------- Cache entries ----------
+struct CacheEntry
+{
+    int baseLine = 0;
+    uint64_t sigHash = 0;
+    long long parseUs = 0, scopeUs = 0, typeUs = 0; // cold cost, for "time saved"
+    vector<shared_ptr<ASTNode>> items;
+    vector<string> scopeDiags, typeDiags;
+};
+
+static void writeStr(ostream &os, const string &s) { os << s.size() << ':' << s << ' '; }
+
+static bool loadEntry(const fs::path &p, CacheEntry &e)
+{
+    FILE *f = fopen(p.string().c_str(), "rb");
+    if (!f)
+        return false;
+    string data;
+    char chunk[1 << 14];
+    for (size_t n; (n = fread(chunk, 1, sizeof chunk, f)) > 0;)
+        data.append(chunk, n);
+    fclose(f);
+    if (data.compare(0, 5, "MLC1\n") != 0)
+        return false;
+    try
+    {
+        ASTReader r(data, 5);
+        e.baseLine = (int)r.num();
+        e.sigHash = (uint64_t)stoull(r.str());
+        e.parseUs = r.num();
+        e.scopeUs = r.num();
+        e.typeUs = r.num();
+        e.items.resize((size_t)r.num());
+        for (auto &it : e.items)
+            it = r.node();
+        e.scopeDiags.resize((size_t)r.num());
+        for (auto &d : e.scopeDiags)
+            d = r.str();
+        e.typeDiags.resize((size_t)r.num());
+        for (auto &d : e.typeDiags)
+            d = r.str();
+        return true;
+    }
+    catch (const exception &)
+    {
+        return false; // corrupt entry: treat as a miss
+    }
+}
+
+static void storeEntry(const fs::path &p, const CacheEntry &e)
+{
+    fs::path tmp = p;
+    tmp += ".tmp";
+    {
+        ofstream out(tmp, ios::binary | ios::trunc);
+        out << "MLC1\n"
+            << e.baseLine << ' ';
+        writeStr(out, to_string(e.sigHash)); // unsigned 64-bit, kept out of the signed number path
+        out << e.parseUs << ' ' << e.scopeUs << ' ' << e.typeUs << '\n'
+            << e.items.size() << ' ';
+        ASTWriter writer(out);
+        for (auto &it : e.items)
+            writer.node(it.get());
+        out << '\n'
+            << e.scopeDiags.size() << ' ';
+        for (auto &d : e.scopeDiags)
+            writeStr(out, d);
+        out << '\n'
+            << e.typeDiags.size() << ' ';
+        for (auto &d : e.typeDiags)
+            writeStr(out, d);
+        out << '\n';
+    }
+    fs::rename(tmp, p); // atomic replace so a crashed build never leaves half an entry
+}
+
+// Shift every line number in a loaded subtree (the declaration moved).
+static void rebaseLines(ASTNode *n, int delta)
+{
+    if (!n)
+        return;
+    n->line += delta;
+    if (auto e = dynamic_cast<UnaryExpr *>(n))
+        rebaseLines(e->rhs.get(), delta);
+    else if (auto e = dynamic_cast<PostfixExpr *>(n))
+        rebaseLines(e->expr.get(), delta);
+    else if (auto e = dynamic_cast<BinaryExpr *>(n))
+        rebaseLines(e->lhs.get(), delta), rebaseLines(e->rhs.get(), delta);
+    else if (auto e = dynamic_cast<CallExpr *>(n))
+    {
+        if (e->name.empty()) // named callees are shared, see Parser::calleeNode
+            rebaseLines(e->callee.get(), delta);
+        for (auto &a : e->args)
+            rebaseLines(a.get(), delta);
+    }
+    else if (auto e = dynamic_cast<IndexExpr *>(n))
+        rebaseLines(e->base.get(), delta), rebaseLines(e->index.get(), delta);
+    else if (auto s = dynamic_cast<ExprStmt *>(n))
+        rebaseLines(s->expr.get(), delta);
+    else if (auto s = dynamic_cast<ReturnStmt *>(n))
+        rebaseLines(s->expr.get(), delta);
+    else if (auto s = dynamic_cast<VarDeclStmt *>(n))
+        rebaseLines(s->init.get(), delta);
+    else if (auto s = dynamic_cast<BlockStmt *>(n))
+        for (auto &c : s->stmts)
+            rebaseLines(c.get(), delta);
+    else if (auto s = dynamic_cast<IfStmt *>(n))
+    {
+        rebaseLines(s->cond.get(), delta);
+        rebaseLines(s->thenStmt.get(), delta);
+        rebaseLines(s->elseStmt.get(), delta);
+    }
+    else if (auto s = dynamic_cast<WhileStmt *>(n))
+        rebaseLines(s->cond.get(), delta), rebaseLines(s->body.get(), delta);
+    else if (auto s = dynamic_cast<DoWhileStmt *>(n))
+        rebaseLines(s->body.get(), delta), rebaseLines(s->cond.get(), delta);
+    else if (auto s = dynamic_cast<ForStmt *>(n))
+    {
+        rebaseLines(s->init.get(), delta);
+        rebaseLines(s->cond.get(), delta);
+        rebaseLines(s->post.get(), delta);
+        rebaseLines(s->body.get(), delta);
+    }
+    else if (auto f = dynamic_cast<FnDecl *>(n))
+        for (auto &c : f->body)
+            rebaseLines(c.get(), delta);
+}
+
+// ---------- Per-phase statistics ----------
+struct PhaseStats
+{
+    size_t hits = 0, total = 0;
+    double ms = 0, savedMs = 0;
+};
+
+static double usSince(chrono::steady_clock::time_point t)
+{
+    return chrono::duration<double, micro>(chrono::steady_clock::now() - t).count();
+}
+
+struct BuildCache
+{
+    fs::path dir;
+    PhaseStats lex, parse, scope, type;
+
+    void buildFile(const string &path)
+    {
+        ifstream file(path);
+        if (!file.is_open())
+            throw runtime_error("Cannot open file: " + path);
+        stringstream buffer;
+        buffer << file.rdbuf();
+
+        auto t0 = chrono::steady_clock::now();
+        RegexLexer lexer(buffer.str());
+        vector<Token> toks = lexer.tokenize();
+        lex.ms += usSince(t0) / 1000;
+        lex.total++;
+
+        vector<DeclRange> ranges = splitTopLevel(toks);
+
+        // Global signatures, first definition wins (as in both checkers)
+        unordered_map<string, pair<string, int>> globals; // name -> (sig, count)
+        for (auto r : ranges)
+        {
+            string name, sig;
+            if (scanSignature(toks, r, name, sig))
+            {
+                auto &g = globals[name];
+                if (g.second++ == 0)
+                    g.first = sig;
+            }
+        }
+
+        vector<CacheEntry> entries(ranges.size());
+        vector<fs::path> paths(ranges.size());
+        vector<uint64_t> sigHashes(ranges.size());
+        vector<bool> checkHit(ranges.size());
+        Program prog;
+        for (size_t k = 0; k < ranges.size(); k++)
+        {
+            DeclRange r = ranges[k];
+            int baseLine = toks[r.begin].line;
+            Fnv key, sigs;
+            set<string> idents;
+            for (size_t i = r.begin; i < r.end; i++)
+            {
+                const Token &t = toks[i];
+                if (TokenStream::isTrivia(t.type))
+                    continue;
+                key.num((int)t.type);
+                key.str(t.lexeme);
+                key.num(t.line - baseLine);
+                key.num(t.col);
+                if (t.type == TokenType::T_IDENTIFIER)
+                    idents.insert(t.lexeme);
+            }
+            for (auto &id : idents)
+            {
+                auto g = globals.find(id);
+                sigs.str(id);
+                sigs.str(g == globals.end() ? "~" : g->second.first + "#" + to_string(g->second.second));
+            }
+            sigHashes[k] = sigs.h;
+            paths[k] = dir / (hex64(key.h) + ".mlc");
+
+            CacheEntry &e = entries[k];
+            auto t = chrono::steady_clock::now();
+            parse.total++;
+            if (loadEntry(paths[k], e))
+            {
+                parse.hits++;
+                if (e.baseLine != baseLine)
+                    for (auto &it : e.items)
+                        rebaseLines(it.get(), baseLine - e.baseLine);
+                checkHit[k] = e.baseLine == baseLine && e.sigHash == sigHashes[k];
+                double us = usSince(t);
+                parse.ms += us / 1000;
+                parse.savedMs += (e.parseUs - us) / 1000;
+            }
+            else
+            {
+                vector<Token> slice(toks.begin() + r.begin, toks.begin() + r.end);
+                slice.push_back(Token{TokenType::T_EOF, "", 0, 0});
+                Parser parser(move(slice));
+                e = CacheEntry{};
+                e.items = parser.parseProgram().items;
+                e.parseUs = (long long)usSince(t);
+                parse.ms += e.parseUs / 1000.0;
+            }
+            e.baseLine = baseLine;
+            for (auto &it : e.items)
+                prog.items.push_back(it);
+        }
+
+        // Checking: global registration always runs (it is cheap and its
+        // redefinition diagnostics depend on every declaration); bodies are
+        // only re-checked on a miss.
+        ScopeChecker scopeChecker;
+        TypeChecker typeChecker;
+        scopeChecker.beginProgram(prog);
+        typeChecker.beginProgram(prog);
+        vector<string> scopeOut, typeOut;
+        for (size_t i = 0; i < scopeChecker.errorCount(); i++)
+            scopeOut.push_back(scopeChecker.formatError(i));
+        for (size_t i = 0; i < typeChecker.errorCount(); i++)
+            typeOut.push_back(formatTypeError(typeChecker.error(i)));
+
+        for (size_t k = 0; k < ranges.size(); k++)
+        {
+            CacheEntry &e = entries[k];
+            scope.total++;
+            type.total++;
+            if (checkHit[k])
+            {
+                scope.hits++;
+                type.hits++;
+                scope.savedMs += e.scopeUs / 1000.0;
+                type.savedMs += e.typeUs / 1000.0;
+            }
+            else
+            {
+                e.scopeDiags.clear();
+                e.typeDiags.clear();
+                auto t = chrono::steady_clock::now();
+                size_t before = scopeChecker.errorCount();
+                for (auto &it : e.items)
+                    scopeChecker.checkItem(it);
+                for (size_t i = before; i < scopeChecker.errorCount(); i++)
+                    e.scopeDiags.push_back(scopeChecker.formatError(i));
+                e.scopeUs = (long long)usSince(t);
+                scope.ms += e.scopeUs / 1000.0;
+
+                t = chrono::steady_clock::now();
+                size_t tbefore = typeChecker.errorCount();
+                for (auto &it : e.items)
+                    typeChecker.checkItem(it);
+                for (size_t i = tbefore; i < typeChecker.errorCount(); i++)
+                    e.typeDiags.push_back(formatTypeError(typeChecker.error(i)));
+                e.typeUs = (long long)usSince(t);
+                type.ms += e.typeUs / 1000.0;
+
+                e.sigHash = sigHashes[k];
+                storeEntry(paths[k], e);
+            }
+            scopeOut.insert(scopeOut.end(), e.scopeDiags.begin(), e.scopeDiags.end());
+            typeOut.insert(typeOut.end(), e.typeDiags.begin(), e.typeDiags.end());
+        }
+        scopeChecker.endProgram();
+        typeChecker.endProgram();
+
+        cout << path << ": " << ranges.size() << " declarations\n";
+        for (auto &d : scopeOut)
+            cout << "  scope: " << d << "\n";
+        for (auto &d : typeOut)
+            cout << "  type:  " << d << "\n";
+    }
+
+    static string formatTypeError(const TypeError &err)
+    {
+        return errorToString(err.type) + " at line " + to_string(err.line) + ", col " + to_string(err.col) +
+               " : " + err.detail;
+    }
+
+    void report(ostream &os) const
+    {
+        os << "\nphase    hits/total   hit-rate   time(ms)   saved(ms)\n";
+        auto row = [&](const char *name, const PhaseStats &s, bool cached)
+        {
+            char buf[160];
+            if (cached)
+                snprintf(buf, sizeof buf, "%-8s %5zu/%-6zu %7.1f%%  %9.2f  %10.2f\n", name, s.hits, s.total,
+                         s.total ? 100.0 * s.hits / s.total : 0.0, s.ms, s.savedMs);
+            else
+                snprintf(buf, sizeof buf, "%-8s %12s %9s  %9.2f  %10s\n", name, "-", "-", s.ms, "-");
+            os << buf;
+        };
+        row("lex", lex, false);
+        row("parse", parse, true);
+        row("scope", scope, true);
+        row("type", type, true);
+    }
+};
+
+int main(int argc, char **argv)
+{
+    BuildCache cache;
+    cache.dir = ".mlc_cache";
+    bool clear = false;
+    vector<string> files;
+    for (int i = 1; i < argc; i++)
+    {
+        string a = argv[i];
+        if (a == "--cache" && i + 1 < argc)
+            cache.dir = argv[++i];
+        else if (a == "--clear")
+            clear = true;
+        else
+            files.push_back(a);
+    }
+    if (files.empty())
+    {
+        cerr << "usage: " << argv[0] << " [--cache DIR] [--clear] file...\n";
+        return 2;
+    }
+    try
+    {
+        if (clear)
+            fs::remove_all(cache.dir);
+        fs::create_directories(cache.dir);
+        for (auto &f : files)
+            cache.buildFile(f);
+    }
+    catch (const exception &e)
+    {
+        cout << "ERROR: " << e.what() << "\n";
+        return 1;
+    }
+    cache.report(cout);
+    return 0;
+}
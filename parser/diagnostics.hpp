@@ -0,0 +1,155 @@
+#ifndef DIAGNOSTICS_HPP
+#define DIAGNOSTICS_HPP
+
+// Diagnostic storage shared by the checkers.
+//
+// A diagnostic is recorded as its error code, position, a message template
+// and the template's arguments; the text is only produced when a record is
+// formatted for output. Templates are string literals in which "{0}" and
+// "{1}" stand for the two name arguments and "{n}" for the number, e.g.
+// "Function '{0}' param type mismatch for arg {n}". Names are interned, so
+// a record is a fixed 32 bytes however often the same identifier is named.
+//
+// `limit` caps how many diagnostics are kept (or streamed); later ones are
+// only counted. With a `sink` set, each diagnostic is formatted and passed
+// to it as it is reported and nothing is stored, so memory stays bounded no
+// matter how many errors the input produces.
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+class DiagnosticEngine
+{
+public:
+    static constexpr uint32_t NO_NAME = UINT32_MAX;
+
+    struct Record
+    {
+        const char *format = "";
+        int line = 0, col = 0;
+        uint32_t names[2] = {NO_NAME, NO_NAME};
+        int32_t number = 0;
+        uint8_t code = 0;
+    };
+
+    // Called with each reported record (its names are not interned and read
+    // as empty) and the formatted message.
+    using Sink = std::function<void(const Record &, const std::string &)>;
+
+    size_t limit = SIZE_MAX;
+    Sink sink;
+
+    void report(uint8_t code, int line, int col, const char *format,
+                std::string_view a = {}, std::string_view b = {}, int32_t number = 0)
+    {
+        if (total++ >= limit)
+            return;
+        Record r;
+        r.code = code;
+        r.line = line;
+        r.col = col;
+        r.format = format;
+        r.number = number;
+        if (sink)
+        {
+            sink(r, expand(format, a, b, number));
+            return;
+        }
+        r.names[0] = intern(a);
+        r.names[1] = intern(b);
+        records.push_back(r);
+    }
+
+    // Re-reports everything `other` holds, in order, through this engine's
+    // limit and sink. `other`'s overflow count carries over as well.
+    void append(const DiagnosticEngine &other)
+    {
+        for (const Record &r : other.records)
+            report(r.code, r.line, r.col, r.format, other.name(r.names[0]), other.name(r.names[1]), r.number);
+        total += other.suppressed();
+    }
+
+    // Stored records; empty while a sink is set.
+    size_t size() const { return records.size(); }
+    bool empty() const { return records.empty(); }
+    const Record &operator[](size_t i) const { return records[i]; }
+    std::vector<Record>::const_iterator begin() const { return records.begin(); }
+    std::vector<Record>::const_iterator end() const { return records.end(); }
+
+    // Everything reported, including what was streamed or dropped.
+    size_t reported() const { return total; }
+    // Reported past the limit and neither kept nor streamed.
+    size_t suppressed() const { return total > limit ? total - limit : 0; }
+
+    std::string message(const Record &r) const
+    {
+        return expand(r.format, name(r.names[0]), name(r.names[1]), r.number);
+    }
+    std::string message(size_t i) const { return message(records[i]); }
+
+    std::string_view name(uint32_t id) const
+    {
+        return id == NO_NAME ? std::string_view() : std::string_view(*names[id]);
+    }
+
+    // Drops the records and names; limit and sink stay.
+    void clear()
+    {
+        records.clear();
+        names.clear();
+        ids.clear();
+        total = 0;
+    }
+
+    static std::string expand(const char *format, std::string_view a, std::string_view b, int32_t number)
+    {
+        std::string out;
+        for (const char *p = format; *p; p++)
+        {
+            if (p[0] == '{' && p[1] && p[2] == '}')
+            {
+                if (p[1] == '0' || p[1] == '1')
+                {
+                    out += p[1] == '0' ? a : b;
+                    p += 2;
+                    continue;
+                }
+                if (p[1] == 'n')
+                {
+                    out += std::to_string(number);
+                    p += 2;
+                    continue;
+                }
+            }
+            out += *p;
+        }
+        return out;
+    }
+
+private:
+    std::vector<Record> records;
+    // Interned names; each is a separate allocation, so the views the map
+    // is keyed by stay valid as the vector grows or the engine is moved.
+    std::unordered_map<std::string_view, uint32_t> ids;
+    std::vector<std::unique_ptr<std::string>> names;
+    size_t total = 0;
+
+    uint32_t intern(std::string_view s)
+    {
+        if (s.empty())
+            return NO_NAME;
+        auto it = ids.find(s);
+        if (it != ids.end())
+            return it->second;
+        names.push_back(std::make_unique<std::string>(s));
+        ids.emplace(*names.back(), uint32_t(names.size() - 1));
+        return uint32_t(names.size() - 1);
+    }
+};
+
+#endif // DIAGNOSTICS_HPP
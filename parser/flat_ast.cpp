@@ -0,0 +1,508 @@
+// flat_ast.cpp - flat, pool-based copy of the AST
+// Include after parser.cpp. FlatAST::build() lowers a parsed Program into
+// typed pools (one vector per node family) where children are referred to
+// by 32-bit index and child lists (Program::items, FnDecl::body,
+// BlockStmt::stmts, CallExpr::args) are [begin, begin + count) ranges into a
+// single shared index array. Identifier, operator and literal text is
+// interned once into a string pool.
+//
+// Because every list is appended after its children have been lowered,
+// nodes end up in post-order inside each pool and a full traversal walks
+// memory front to back.
+#ifndef FLAT_AST_CPP
+#define FLAT_AST_CPP
+#include "parser.cpp"
+#include <cstdint>
+
+enum class FlatKind : uint8_t
+{
+    // expressions
+    IntLit,
+    FloatLit,
+    StringLit,
+    CharLit,
+    BoolLit,
+    Ident,
+    Unary,
+    Postfix,
+    Binary,
+    Call,
+    Index,
+    // statements
+    Break,
+    Empty,
+    ExprS,
+    Return,
+    VarDecl,
+    Block,
+    If,
+    While,
+    DoWhile,
+    For,
+};
+
+struct FlatAST
+{
+    static constexpr uint32_t NONE = UINT32_MAX;
+    // Top-level items can be functions or statements; functions are tagged
+    // with FN_BIT in the items range.
+    static constexpr uint32_t FN_BIT = 0x80000000u;
+
+    // Expression fields by kind:
+    //   literals/Ident: text
+    //   Unary/Postfix:  text = op, a = operand
+    //   Binary:         text = op, a = lhs, b = rhs
+    //   Call:           text = callee name, a = args begin, b = args count;
+    //                   a call on any other expression has text = NONE and
+    //                   its callee in the list slot just before the args
+    //   Index:          a = base, b = index
+    struct Expr
+    {
+        FlatKind kind;
+        int line, col;
+        uint32_t text = NONE;
+        uint32_t a = NONE, b = NONE;
+    };
+
+    // Statement fields by kind:
+    //   ExprS/Return:   a = expr (may be NONE)
+    //   VarDecl:        text = name, type = type token, a = init
+    //   Block:          a = stmts begin, b = stmts count
+    //   If:             a = cond, b = then, c = else
+    //   While:          a = cond, b = body
+    //   DoWhile:        a = body, b = cond
+    //   For:            a = init, b = cond, c = post, d = body
+    struct Stmt
+    {
+        FlatKind kind;
+        TokenType type{};
+        int line, col;
+        uint32_t text = NONE;
+        uint32_t a = NONE, b = NONE, c = NONE, d = NONE;
+    };
+
+    struct Param
+    {
+        TokenType type;
+        uint32_t name;
+    };
+
+    struct Fn
+    {
+        TokenType returnType;
+        int line, col;
+        uint32_t name;
+        uint32_t paramsBegin, paramCount;
+        uint32_t bodyBegin, bodyCount;
+    };
+
+    vector<Expr> exprs;
+    vector<Stmt> stmts;
+    vector<Fn> fns;
+    vector<Param> params;
+    vector<uint32_t> lists; // child index ranges
+    vector<string> strings;
+    uint32_t itemsBegin = 0, itemsCount = 0;
+    int line = 0, col = 0;
+
+    static FlatAST build(const Program &prog)
+    {
+        FlatAST f;
+        f.line = prog.line;
+        f.col = prog.col;
+        vector<uint32_t> items;
+        items.reserve(prog.items.size());
+        for (auto &it : prog.items)
+        {
+            if (auto fn = dynamic_pointer_cast<FnDecl>(it))
+                items.push_back(f.lowerFn(*fn) | FN_BIT);
+            else if (auto s = dynamic_pointer_cast<::Stmt>(it))
+                items.push_back(f.lowerStmt(s.get()));
+        }
+        f.itemsBegin = f.appendList(items);
+        f.itemsCount = (uint32_t)items.size();
+        unordered_map<string, uint32_t>().swap(f.stringIds);
+        f.exprs.shrink_to_fit();
+        f.stmts.shrink_to_fit();
+        f.fns.shrink_to_fit();
+        f.params.shrink_to_fit();
+        f.lists.shrink_to_fit();
+        return f;
+    }
+
+    const uint32_t *list(uint32_t begin) const { return lists.data() + begin; }
+
+    size_t bytes() const
+    {
+        size_t n = exprs.capacity() * sizeof(Expr) + stmts.capacity() * sizeof(Stmt) +
+                   fns.capacity() * sizeof(Fn) + params.capacity() * sizeof(Param) +
+                   lists.capacity() * sizeof(uint32_t) + strings.capacity() * sizeof(string);
+        for (auto &s : strings)
+            if (s.capacity() > 15)
+                n += s.capacity() + 1;
+        return n;
+    }
+
+    // Same text as Program::print, so the two layouts can be diffed.
+    void print(ostream &os) const
+    {
+        os << "Program [l:" << line << " c:" << col << "]\n";
+        for (uint32_t i = 0; i < itemsCount; i++)
+        {
+            uint32_t id = lists[itemsBegin + i];
+            if (id & FN_BIT)
+                printFn(os, fns[id & ~FN_BIT], 1);
+            else
+                printStmt(os, id, 1);
+        }
+    }
+
+private:
+    unordered_map<string, uint32_t> stringIds; // only used while building
+
+    uint32_t intern(const string &s)
+    {
+        auto it = stringIds.find(s);
+        if (it != stringIds.end())
+            return it->second;
+        uint32_t id = (uint32_t)strings.size();
+        strings.push_back(s);
+        stringIds.emplace(s, id);
+        return id;
+    }
+
+    uint32_t appendList(const vector<uint32_t> &ids)
+    {
+        uint32_t begin = (uint32_t)lists.size();
+        lists.insert(lists.end(), ids.begin(), ids.end());
+        return begin;
+    }
+
+    uint32_t pushExpr(Expr e)
+    {
+        exprs.push_back(e);
+        return (uint32_t)exprs.size() - 1;
+    }
+    uint32_t pushStmt(Stmt s)
+    {
+        stmts.push_back(s);
+        return (uint32_t)stmts.size() - 1;
+    }
+
+    uint32_t lowerExpr(const ::Expr *e)
+    {
+        if (!e)
+            return NONE;
+        Expr x{};
+        x.line = e->line;
+        x.col = e->col;
+        if (auto n = dynamic_cast<const IntLiteral *>(e))
+            x.kind = FlatKind::IntLit, x.text = intern(n->val);
+        else if (auto n = dynamic_cast<const FloatLiteral *>(e))
+            x.kind = FlatKind::FloatLit, x.text = intern(n->val);
+        else if (auto n = dynamic_cast<const StringLiteral *>(e))
+            x.kind = FlatKind::StringLit, x.text = intern(n->val);
+        else if (auto n = dynamic_cast<const CharLiteral *>(e))
+            x.kind = FlatKind::CharLit, x.text = intern(n->val);
+        else if (auto n = dynamic_cast<const BoolLiteral *>(e))
+            x.kind = FlatKind::BoolLit, x.a = n->val;
+        else if (auto n = dynamic_cast<const IdentifierExpr *>(e))
+            x.kind = FlatKind::Ident, x.text = intern(n->name);
+        else if (auto n = dynamic_cast<const UnaryExpr *>(e))
+            x.kind = FlatKind::Unary, x.text = intern(n->op), x.a = lowerExpr(n->rhs.get());
+        else if (auto n = dynamic_cast<const PostfixExpr *>(e))
+            x.kind = FlatKind::Postfix, x.text = intern(n->op), x.a = lowerExpr(n->expr.get());
+        else if (auto n = dynamic_cast<const BinaryExpr *>(e))
+        {
+            x.kind = FlatKind::Binary;
+            x.text = intern(n->op);
+            x.a = lowerExpr(n->lhs.get());
+            x.b = lowerExpr(n->rhs.get());
+        }
+        else if (auto n = dynamic_cast<const CallExpr *>(e))
+        {
+            vector<uint32_t> args;
+            args.reserve(n->args.size() + 1);
+            if (n->name.empty())
+                args.push_back(lowerExpr(n->callee.get()));
+            for (auto &a : n->args)
+                args.push_back(lowerExpr(a.get()));
+            x.kind = FlatKind::Call;
+            x.text = n->name.empty() ? NONE : intern(n->name);
+            x.a = appendList(args) + (n->name.empty() ? 1 : 0);
+            x.b = (uint32_t)n->args.size();
+        }
+        else if (auto n = dynamic_cast<const IndexExpr *>(e))
+        {
+            x.kind = FlatKind::Index;
+            x.a = lowerExpr(n->base.get());
+            x.b = lowerExpr(n->index.get());
+        }
+        else
+            throw runtime_error("FlatAST: unsupported expression");
+        return pushExpr(x);
+    }
+
+    uint32_t lowerStmt(const ::Stmt *s)
+    {
+        if (!s)
+            return NONE;
+        Stmt x{};
+        x.line = s->line;
+        x.col = s->col;
+        if (dynamic_cast<const BreakStmt *>(s))
+            x.kind = FlatKind::Break;
+        else if (dynamic_cast<const EmptyStmt *>(s))
+            x.kind = FlatKind::Empty;
+        else if (auto n = dynamic_cast<const ExprStmt *>(s))
+            x.kind = FlatKind::ExprS, x.a = lowerExpr(n->expr.get());
+        else if (auto n = dynamic_cast<const ReturnStmt *>(s))
+            x.kind = FlatKind::Return, x.a = lowerExpr(n->expr.get());
+        else if (auto n = dynamic_cast<const VarDeclStmt *>(s))
+        {
+            x.kind = FlatKind::VarDecl;
+            x.type = n->typeTok;
+            x.text = intern(n->name);
+            x.a = lowerExpr(n->init.get());
+        }
+        else if (auto n = dynamic_cast<const BlockStmt *>(s))
+        {
+            vector<uint32_t> body;
+            body.reserve(n->stmts.size());
+            for (auto &c : n->stmts)
+                body.push_back(lowerStmt(c.get()));
+            x.kind = FlatKind::Block;
+            x.a = appendList(body);
+            x.b = (uint32_t)body.size();
+        }
+        else if (auto n = dynamic_cast<const IfStmt *>(s))
+        {
+            x.kind = FlatKind::If;
+            x.a = lowerExpr(n->cond.get());
+            x.b = lowerStmt(n->thenStmt.get());
+            x.c = lowerStmt(n->elseStmt.get());
+        }
+        else if (auto n = dynamic_cast<const WhileStmt *>(s))
+        {
+            x.kind = FlatKind::While;
+            x.a = lowerExpr(n->cond.get());
+            x.b = lowerStmt(n->body.get());
+        }
+        else if (auto n = dynamic_cast<const DoWhileStmt *>(s))
+        {
+            x.kind = FlatKind::DoWhile;
+            x.a = lowerStmt(n->body.get());
+            x.b = lowerExpr(n->cond.get());
+        }
+        else if (auto n = dynamic_cast<const ForStmt *>(s))
+        {
+            x.kind = FlatKind::For;
+            x.a = lowerExpr(n->init.get());
+            x.b = lowerExpr(n->cond.get());
+            x.c = lowerExpr(n->post.get());
+            x.d = lowerStmt(n->body.get());
+        }
+        else
+            throw runtime_error("FlatAST: unsupported statement");
+        return pushStmt(x);
+    }
+
+    uint32_t lowerFn(const FnDecl &fn)
+    {
+        Fn x{};
+        x.returnType = fn.returnType;
+        x.line = fn.line;
+        x.col = fn.col;
+        x.name = intern(fn.name);
+        x.paramsBegin = (uint32_t)params.size();
+        x.paramCount = (uint32_t)fn.params.size();
+        for (auto &p : fn.params)
+            params.push_back({p.first, intern(p.second)});
+        vector<uint32_t> body;
+        body.reserve(fn.body.size());
+        for (auto &s : fn.body)
+            body.push_back(lowerStmt(s.get()));
+        x.bodyBegin = appendList(body);
+        x.bodyCount = (uint32_t)body.size();
+        fns.push_back(x);
+        return (uint32_t)fns.size() - 1;
+    }
+
+    static void at(ostream &os, int line, int col) { os << " [l:" << line << " c:" << col << "]\n"; }
+
+    void printExpr(ostream &os, uint32_t id, int ind) const
+    {
+        const Expr &e = exprs[id];
+        indent(os, ind);
+        switch (e.kind)
+        {
+        case FlatKind::IntLit:
+            os << "Int(" << strings[e.text] << ")";
+            break;
+        case FlatKind::FloatLit:
+            os << "Float(" << strings[e.text] << ")";
+            break;
+        case FlatKind::StringLit:
+            os << "String(\"" << strings[e.text] << "\")";
+            break;
+        case FlatKind::CharLit:
+        {
+            // reuse CharLiteral's escaping
+            ostringstream tmp;
+            CharLiteral(strings[e.text], e.line, e.col).print(tmp, 0);
+            os << tmp.str();
+            return;
+        }
+        case FlatKind::BoolLit:
+            os << "Bool(" << (e.a ? "true" : "false") << ")";
+            break;
+        case FlatKind::Ident:
+            os << "Ident(" << strings[e.text] << ")";
+            break;
+        case FlatKind::Unary:
+            os << "Unary(" << strings[e.text] << ")";
+            break;
+        case FlatKind::Postfix:
+            os << "Postfix(" << strings[e.text] << ")";
+            break;
+        case FlatKind::Binary:
+            os << "Binary(" << strings[e.text] << ")";
+            break;
+        case FlatKind::Call:
+            if (e.text == NONE)
+            {
+                os << "Call";
+                at(os, e.line, e.col);
+                printLabelled(os, "Callee", lists[e.a - 1], true, ind + 1);
+                for (uint32_t i = 0; i < e.b; i++)
+                    printExpr(os, lists[e.a + i], ind + 1);
+                return;
+            }
+            os << "Call(" << strings[e.text] << ")";
+            break;
+        case FlatKind::Index:
+            os << "IndexExpr";
+            break;
+        default:
+            break;
+        }
+        at(os, e.line, e.col);
+        switch (e.kind)
+        {
+        case FlatKind::Unary:
+        case FlatKind::Postfix:
+            printExpr(os, e.a, ind + 1);
+            break;
+        case FlatKind::Binary:
+        case FlatKind::Index:
+            printExpr(os, e.a, ind + 1);
+            printExpr(os, e.b, ind + 1);
+            break;
+        case FlatKind::Call:
+            for (uint32_t i = 0; i < e.b; i++)
+                printExpr(os, lists[e.a + i], ind + 1);
+            break;
+        default:
+            break;
+        }
+    }
+
+    void printLabelled(ostream &os, const char *label, uint32_t id, bool isExpr, int ind) const
+    {
+        indent(os, ind);
+        os << label << ":\n";
+        if (isExpr)
+            printExpr(os, id, ind + 1);
+        else
+            printStmt(os, id, ind + 1);
+    }
+
+    void printStmt(ostream &os, uint32_t id, int ind) const
+    {
+        const Stmt &s = stmts[id];
+        indent(os, ind);
+        switch (s.kind)
+        {
+        case FlatKind::Break:
+            os << "Break";
+            at(os, s.line, s.col);
+            break;
+        case FlatKind::Empty:
+            os << "EmptyStmt";
+            at(os, s.line, s.col);
+            break;
+        case FlatKind::ExprS:
+        case FlatKind::Return:
+            os << (s.kind == FlatKind::ExprS ? "ExprStmt" : "Return");
+            at(os, s.line, s.col);
+            if (s.a != NONE)
+                printExpr(os, s.a, ind + 1);
+            break;
+        case FlatKind::VarDecl:
+            os << "VarDecl(type=" << typeKeywordToString(s.type) << " name=" << strings[s.text] << ")";
+            at(os, s.line, s.col);
+            if (s.a != NONE)
+                printExpr(os, s.a, ind + 1);
+            break;
+        case FlatKind::Block:
+            os << "Block";
+            at(os, s.line, s.col);
+            for (uint32_t i = 0; i < s.b; i++)
+                printStmt(os, lists[s.a + i], ind + 1);
+            break;
+        case FlatKind::If:
+            os << "If";
+            at(os, s.line, s.col);
+            printExpr(os, s.a, ind + 1);
+            printLabelled(os, "Then", s.b, false, ind + 1);
+            if (s.c != NONE)
+                printLabelled(os, "Else", s.c, false, ind + 1);
+            break;
+        case FlatKind::While:
+            os << "While";
+            at(os, s.line, s.col);
+            printExpr(os, s.a, ind + 1);
+            printStmt(os, s.b, ind + 1);
+            break;
+        case FlatKind::DoWhile:
+            os << "DoWhile";
+            at(os, s.line, s.col);
+            printLabelled(os, "Body", s.a, false, ind + 1);
+            printLabelled(os, "Cond", s.b, true, ind + 1);
+            break;
+        case FlatKind::For:
+            os << "For";
+            at(os, s.line, s.col);
+            if (s.a != NONE)
+                printLabelled(os, "Init", s.a, true, ind + 1);
+            if (s.b != NONE)
+                printLabelled(os, "Cond", s.b, true, ind + 1);
+            if (s.c != NONE)
+                printLabelled(os, "Post", s.c, true, ind + 1);
+            printLabelled(os, "Body", s.d, false, ind + 1);
+            break;
+        default:
+            break;
+        }
+    }
+
+    void printFn(ostream &os, const Fn &fn, int ind) const
+    {
+        indent(os, ind);
+        os << "FnDecl(name=" << strings[fn.name] << " type=" << typeKeywordToString(fn.returnType) << ")";
+        at(os, fn.line, fn.col);
+        indent(os, ind + 1);
+        os << "Params:\n";
+        for (uint32_t i = 0; i < fn.paramCount; i++)
+        {
+            const Param &p = params[fn.paramsBegin + i];
+            indent(os, ind + 2);
+            os << "(type=" << typeKeywordToString(p.type) << " name=" << strings[p.name] << ")\n";
+        }
+        indent(os, ind + 1);
+        os << "Body:\n";
+        for (uint32_t i = 0; i < fn.bodyCount; i++)
+            printStmt(os, lists[fn.bodyBegin + i], ind + 2);
+    }
+};
+#endif // FLAT_AST_CPP
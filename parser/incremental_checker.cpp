@@ -0,0 +1,475 @@
+// incremental_checker.cpp
+// Define INCREMENTAL_CHECKER_NO_MAIN before including to reuse IncrementalChecker in another driver.
+#ifndef INCREMENTAL_CHECKER_CPP
+#define INCREMENTAL_CHECKER_CPP
+#define PARSER_REUSE_LEXER
+#include "../regex/regex_code.cpp"
+#include "parser.cpp"
+#ifndef SCOPE_CHECKER_NO_MAIN
+#define SCOPE_CHECKER_NO_MAIN
+#endif
+#include "scope_checker.cpp"
+#ifndef TYPE_CHECKER_NO_MAIN
+#define TYPE_CHECKER_NO_MAIN
+#endif
+#include "type_checker.cpp"
+#include <cstdint>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+using namespace std;
+
+// ---------------------------------------------------------------------
+// IncrementalChecker - scope and type checking that survives edits
+// ---------------------------------------------------------------------
+// Keeps a ScopeChecker and a TypeChecker open on the global scope between
+// runs, with the diagnostics of every top-level item cached. update() takes
+// the program after an edit, where unchanged items are the same nodes as
+// before (an editor re-parses only what changed), and re-checks:
+//   - items that are new or were replaced;
+//   - items that mention a global whose signature, definition count or id
+//     changed, found through the dependency graph (global name -> items).
+// Everything else keeps its cached diagnostics, and the result is exactly
+// what ScopeChecker::analyse and TypeChecker::check report on the whole
+// program.
+//
+// When items were only replaced, each by one declaring the same singly
+// defined global (a body or signature edit), the global pass is not run
+// again: changed signatures are swapped into both checkers' global scopes
+// in place. Adding, removing or renaming a global re-runs the global pass,
+// which is linear but cheap next to the bodies. A program with top-level
+// statements that are not blocks is always checked in full, as those can
+// declare into the global scope.
+class IncrementalChecker
+{
+public:
+    struct UpdateStats
+    {
+        size_t items = 0;
+        size_t rechecked = 0;
+        size_t changedGlobals = 0;
+        bool globalPass = false;
+    };
+
+    UpdateStats update(const Program &prog)
+    {
+        UpdateStats stats;
+        stats.items = prog.items.size();
+        bool full = order.empty() || hasLooseStatements(prog);
+        vector<char> dirty(prog.items.size(), 0);
+
+        if (!full && sameDeclarations(prog))
+        {
+            unordered_set<const ASTNode *> affected;
+            for (size_t i = 0; i < prog.items.size(); i++)
+            {
+                const ASTNode *old = order[i], *item = prog.items[i].get();
+                if (item == old)
+                    continue;
+                dirty[i] = 1;
+                string name, sig = signatureOf(item, name), oldName;
+                if (sig == signatureOf(old, oldName))
+                    copyRef(old, item);
+                else
+                {
+                    stats.changedGlobals++;
+                    globals[name].sig = sig;
+                    scope.redeclareGlobal(*item);
+                    types.redeclareGlobal(*item);
+                    auto it = nameIds.find(name);
+                    if (it != nameIds.end())
+                        affected.insert(users[it->second].begin(), users[it->second].end());
+                }
+                unlink(old, items.at(old));
+                items.erase(old);
+            }
+            for (size_t i = 0; i < prog.items.size(); i++)
+                dirty[i] = dirty[i] || affected.count(prog.items[i].get());
+        }
+        else
+        {
+            stats.globalPass = true;
+            unordered_map<string, Global> previous = move(globals);
+            buildGlobals(prog);
+            // Users of a changed global are re-checked. A global that only
+            // moved (a declaration was added or removed before it) keeps
+            // its diagnostics, and its users just get the new id.
+            unordered_set<const ASTNode *> affected, moved;
+            vector<uint32_t> renumber;
+            auto usersOf = [&](const string &name, unordered_set<const ASTNode *> &into)
+            {
+                auto it = nameIds.find(name);
+                if (it != nameIds.end())
+                    into.insert(users[it->second].begin(), users[it->second].end());
+            };
+            for (auto &[name, g] : globals)
+            {
+                auto old = previous.find(name);
+                if (old == previous.end() || !old->second.sameDeclaration(g))
+                {
+                    stats.changedGlobals++;
+                    usersOf(name, affected);
+                }
+                else if (old->second.id != g.id)
+                {
+                    if (renumber.size() <= old->second.id)
+                        renumber.resize(old->second.id + 1, UINT32_MAX);
+                    renumber[old->second.id] = g.id;
+                    usersOf(name, moved);
+                }
+            }
+            for (auto &[name, g] : previous)
+                if (!globals.count(name))
+                {
+                    stats.changedGlobals++;
+                    usersOf(name, affected);
+                }
+            auto remap = [&](const string &, SymbolRef &ref)
+            {
+                if (ref.kind == SymbolRef::Global && ref.index < renumber.size() && renumber[ref.index] != UINT32_MAX)
+                    ref.index = renumber[ref.index];
+            };
+            for (size_t i = 0; i < prog.items.size(); i++)
+            {
+                const ASTNode *item = prog.items[i].get();
+                dirty[i] = full || !items.count(item) || affected.count(item);
+                if (!dirty[i] && moved.count(item))
+                    forEachName(item, remap);
+            }
+
+            scope.beginProgram(prog);
+            types.beginProgram(prog);
+            globalScopeDiags = move(scope.diagnostics());
+            scope.clearErrors();
+            globalTypeDiags = move(types.errors);
+            types.errors.clear();
+
+            // Forget items that are gone
+            unordered_set<const ASTNode *> present;
+            for (auto &item : prog.items)
+                present.insert(item.get());
+            for (auto it = items.begin(); it != items.end();)
+            {
+                if (!present.count(it->first))
+                {
+                    unlink(it->first, it->second);
+                    it = items.erase(it);
+                }
+                else
+                    ++it;
+            }
+        }
+
+        order.clear();
+        for (size_t i = 0; i < prog.items.size(); i++)
+        {
+            const ASTNode *key = prog.items[i].get();
+            order.push_back(key);
+            if (!dirty[i])
+                continue;
+            stats.rechecked++;
+            ItemState &state = items[key];
+            unlink(key, state);
+            state.node = prog.items[i];
+            checkItem(state);
+        }
+        return stats;
+    }
+
+    // The diagnostics of ScopeChecker::analyse and TypeChecker::check on the
+    // last program, in their order.
+    vector<string> scopeDiagnostics() const
+    {
+        vector<string> out;
+        auto add = [&](const DiagnosticEngine &d)
+        {
+            for (auto &r : d)
+                out.push_back(ScopeChecker::format(r, d.message(r)));
+        };
+        add(globalScopeDiags);
+        for (const ASTNode *key : order)
+            add(items.at(key).scopeDiags);
+        return out;
+    }
+
+    vector<TypeError> typeDiagnostics() const
+    {
+        vector<TypeError> out;
+        auto add = [&](const DiagnosticEngine &d)
+        {
+            for (auto &r : d)
+                out.emplace_back(TypeChkError(r.code), r.line, r.col, d.message(r));
+        };
+        add(globalTypeDiags);
+        for (const ASTNode *key : order)
+            add(items.at(key).typeDiags);
+        return out;
+    }
+
+    void printErrors(ostream &os) const
+    {
+        vector<string> scopeErrors = scopeDiagnostics();
+        vector<TypeError> typeErrors = typeDiagnostics();
+        if (scopeErrors.empty())
+            os << "No scope errors found\n";
+        else
+        {
+            os << "Scope errors:\n";
+            for (auto &e : scopeErrors)
+                os << "  " << e << "\n";
+        }
+        if (typeErrors.empty())
+            os << "No type errors found!\n";
+        for (const auto &err : typeErrors)
+            os << errorToString(err.type) << " at line " << err.line << ", col " << err.col << " : " << err.detail << "\n";
+    }
+
+private:
+    // What the rest of the program can see of a global: its signature, how
+    // many items define it (the checkers report the extra ones) and its
+    // SymbolRef id.
+    struct Global
+    {
+        string sig;
+        uint32_t count = 0;
+        uint32_t id = 0;
+        bool sameDeclaration(const Global &o) const { return sig == o.sig && count == o.count; }
+    };
+
+    struct ItemState
+    {
+        shared_ptr<ASTNode> node; // keeps the address from being reused while cached
+        DiagnosticEngine scopeDiags, typeDiags;
+        vector<uint32_t> uses; // ids of the global names the item mentions
+    };
+
+    ScopeChecker scope;
+    TypeChecker types;
+    DiagnosticEngine globalScopeDiags, globalTypeDiags;
+    unordered_map<string, Global> globals;
+    unordered_map<const ASTNode *, ItemState> items;
+    vector<const ASTNode *> order; // items of the last program
+
+    // Dependency graph: users[id] holds the items mentioning name `id`.
+    unordered_map<string, uint32_t> nameIds;
+    vector<unordered_set<const ASTNode *>> users;
+
+    static bool hasLooseStatements(const Program &prog)
+    {
+        for (auto &item : prog.items)
+            if (dynamic_cast<const Stmt *>(item.get()) && !dynamic_cast<const VarDeclStmt *>(item.get()) &&
+                !dynamic_cast<const BlockStmt *>(item.get()))
+                return true;
+        return false;
+    }
+
+    // "f<ret>(<params>)" for functions, "v<type>" for variables, empty for
+    // anything that declares no global.
+    static string signatureOf(const ASTNode *item, string &name)
+    {
+        if (auto fn = dynamic_cast<const FnDecl *>(item))
+        {
+            name = fn->name;
+            string sig = string("f") + typeKeywordToString(fn->returnType) + "(";
+            for (auto &param : fn->params)
+                sig += string(typeKeywordToString(param.first)) + ",";
+            return sig + ")";
+        }
+        if (auto var = dynamic_cast<const VarDeclStmt *>(item))
+        {
+            name = var->name;
+            return string("v") + typeKeywordToString(var->typeTok);
+        }
+        return "";
+    }
+
+    // True when the items line up with the last program and every replaced
+    // one declares the same singly defined global, possibly with a new
+    // signature.
+    bool sameDeclarations(const Program &prog) const
+    {
+        if (prog.items.size() != order.size())
+            return false;
+        for (size_t i = 0; i < order.size(); i++)
+        {
+            if (prog.items[i].get() == order[i])
+                continue;
+            string oldName, newName;
+            if (signatureOf(order[i], oldName).empty() || signatureOf(prog.items[i].get(), newName).empty() ||
+                oldName != newName)
+                return false;
+            auto g = globals.find(newName);
+            if (g == globals.end() || g->second.count != 1)
+                return false;
+        }
+        return true;
+    }
+
+    void buildGlobals(const Program &prog)
+    {
+        globals.clear();
+        uint32_t nextId = 0;
+        for (auto &item : prog.items)
+        {
+            string name, sig = signatureOf(item.get(), name);
+            if (sig.empty())
+                continue;
+            auto [it, inserted] = globals.try_emplace(name);
+            if (inserted)
+            {
+                it->second.sig = sig;
+                it->second.id = nextId++;
+            }
+            it->second.count++;
+        }
+    }
+
+    static void copyRef(const ASTNode *from, const ASTNode *to)
+    {
+        if (auto fn = dynamic_cast<const FnDecl *>(from))
+            static_cast<const FnDecl *>(to)->ref = fn->ref;
+        else if (auto var = dynamic_cast<const VarDeclStmt *>(from))
+            static_cast<const VarDeclStmt *>(to)->ref = var->ref;
+    }
+
+    void checkItem(ItemState &state)
+    {
+        scope.checkItem(state.node);
+        state.scopeDiags = move(scope.diagnostics());
+        scope.clearErrors();
+
+        types.checkItem(state.node);
+        state.typeDiags = move(types.errors);
+        types.errors.clear();
+
+        // Names the resolver bound to a local cannot change with a global.
+        state.uses.clear();
+        auto use = [&](const string &name, SymbolRef &ref)
+        {
+            if (ref.kind != SymbolRef::Local)
+                state.uses.push_back(nameId(name));
+        };
+        forEachName(state.node.get(), use);
+        sort(state.uses.begin(), state.uses.end());
+        state.uses.erase(unique(state.uses.begin(), state.uses.end()), state.uses.end());
+        for (uint32_t id : state.uses)
+            users[id].insert(state.node.get());
+    }
+
+    void unlink(const ASTNode *key, const ItemState &state)
+    {
+        for (uint32_t id : state.uses)
+            users[id].erase(key);
+    }
+
+    uint32_t nameId(const string &name)
+    {
+        auto [it, inserted] = nameIds.try_emplace(name, uint32_t(users.size()));
+        if (inserted)
+            users.emplace_back();
+        return it->second;
+    }
+
+    // Calls fn(name, ref) for every name an item's code mentions.
+    template <class Fn>
+    static void forEachName(const ASTNode *n, Fn &fn)
+    {
+        if (!n)
+            return;
+        if (auto e = dynamic_cast<const IdentifierExpr *>(n))
+            fn(e->name, e->ref);
+        else if (auto e = dynamic_cast<const CallExpr *>(n))
+        {
+            if (e->name.empty())
+                forEachName(e->callee.get(), fn);
+            else
+                fn(e->name, e->ref);
+            for (auto &a : e->args)
+                forEachName(a.get(), fn);
+        }
+        else if (auto e = dynamic_cast<const UnaryExpr *>(n))
+            forEachName(e->rhs.get(), fn);
+        else if (auto e = dynamic_cast<const PostfixExpr *>(n))
+            forEachName(e->expr.get(), fn);
+        else if (auto e = dynamic_cast<const BinaryExpr *>(n))
+            forEachName(e->lhs.get(), fn), forEachName(e->rhs.get(), fn);
+        else if (auto e = dynamic_cast<const IndexExpr *>(n))
+            forEachName(e->base.get(), fn), forEachName(e->index.get(), fn);
+        else if (auto s = dynamic_cast<const ExprStmt *>(n))
+            forEachName(s->expr.get(), fn);
+        else if (auto s = dynamic_cast<const ReturnStmt *>(n))
+            forEachName(s->expr.get(), fn);
+        else if (auto s = dynamic_cast<const VarDeclStmt *>(n))
+            forEachName(s->init.get(), fn);
+        else if (auto s = dynamic_cast<const BlockStmt *>(n))
+            for (auto &c : s->stmts)
+                forEachName(c.get(), fn);
+        else if (auto s = dynamic_cast<const IfStmt *>(n))
+        {
+            forEachName(s->cond.get(), fn);
+            forEachName(s->thenStmt.get(), fn);
+            forEachName(s->elseStmt.get(), fn);
+        }
+        else if (auto s = dynamic_cast<const WhileStmt *>(n))
+            forEachName(s->cond.get(), fn), forEachName(s->body.get(), fn);
+        else if (auto s = dynamic_cast<const DoWhileStmt *>(n))
+            forEachName(s->body.get(), fn), forEachName(s->cond.get(), fn);
+        else if (auto s = dynamic_cast<const ForStmt *>(n))
+        {
+            forEachName(s->init.get(), fn);
+            forEachName(s->cond.get(), fn);
+            forEachName(s->post.get(), fn);
+            forEachName(s->body.get(), fn);
+        }
+        else if (auto f = dynamic_cast<const FnDecl *>(n))
+            for (auto &c : f->body)
+                forEachName(c.get(), fn);
+    }
+};
+
+#ifndef INCREMENTAL_CHECKER_NO_MAIN
+// ---------------------------------------------------------------------
+// Main Driver
+// ---------------------------------------------------------------------
+int main()
+{
+    ios::sync_with_stdio(false);
+    cin.tie(nullptr);
+    const string inputFile = "sample.txt";
+    cout << "================================================================================\n                          INCREMENTAL SEMANTIC ANALYSIS\n================================================================================\n\n";
+    try
+    {
+        ifstream file(inputFile);
+        if (!file.is_open())
+            throw runtime_error("Cannot open file: " + inputFile);
+        stringstream buffer;
+        buffer << file.rdbuf();
+
+        RegexLexer lexer(buffer.str());
+        Parser parser(lexer.tokenize());
+        Program program = parser.parseProgram();
+
+        IncrementalChecker checker;
+        auto first = checker.update(program);
+        auto again = checker.update(program);
+        cout << "first run: " << first.rechecked << "/" << first.items << " items checked\n"
+             << "unchanged re-run: " << again.rechecked << "/" << again.items << " items checked\n\n";
+        cout << "SEMANTIC ANALYSIS RESULTS:\n------------------------------------------------------------------------\n";
+        checker.printErrors(cout);
+    }
+    catch (const exception &e)
+    {
+        cout << "ERROR: " << e.what() << "\n";
+        return 1;
+    }
+    cout << "\n"
+         << string(80, '=') << "\n";
+    return 0;
+}
+#endif // INCREMENTAL_CHECKER_NO_MAIN
+#endif // INCREMENTAL_CHECKER_CPP
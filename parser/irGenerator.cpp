@@ -1,7 +1,18 @@
 // irGenerator.cpp - Single file IR Generator
+// Define IR_GENERATOR_NO_MAIN before including to reuse IRGenerator in another driver.
+#ifndef IR_GENERATOR_CPP
+#define IR_GENERATOR_CPP
 #define PARSER_REUSE_LEXER
 #include "../regex/regex_code.cpp"
 #include "parser.cpp"
+#ifndef TYPE_CHECKER_NO_MAIN
+#define TYPE_CHECKER_NO_MAIN
+#endif
+#include "type_checker.cpp"
+#ifndef SCOPE_CHECKER_NO_MAIN
+#define SCOPE_CHECKER_NO_MAIN
+#endif
+#include "scope_checker.cpp"
 #include <iostream>
 #include <vector>
 #include <string>
@@ -13,7 +24,7 @@
 using namespace std;
 
 // IR Instruction Types
-enum class IROp {
+enum class IROp : uint8_t {
     ASSIGN, ADD, SUB, MUL, DIV, 
     EQ, NE, LT, LE, GT, GE,
     LAND, LOR, LNOT,
@@ -22,123 +33,301 @@ enum class IROp {
     LABEL
 };
 
+// An operand is a tagged 32-bit value: the top three bits give its kind and
+// the low 29 bits index the matching table of the IRProgram. Temporaries are
+// virtual registers numbered per program, constants index the constant
+// pool, symbols the interned variable and function names, and labels are
+// numbered like temporaries. The all-zero operand is None (no operand).
+struct Operand {
+    enum Kind : uint32_t { None, Temp, Const, Symbol, Label };
+    static constexpr uint32_t INDEX_BITS = 29;
+    static constexpr uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1;
+
+    uint32_t bits = 0;
+
+    Operand() = default;
+    Operand(Kind k, uint32_t index) : bits(uint32_t(k) << INDEX_BITS | index) {}
+    Kind kind() const { return Kind(bits >> INDEX_BITS); }
+    uint32_t index() const { return bits & INDEX_MASK; }
+    bool empty() const { return bits == 0; }
+    bool operator==(Operand o) const { return bits == o.bits; }
+    bool operator!=(Operand o) const { return bits != o.bits; }
+};
+
+// A function's entry is a LABEL whose operand is the function's symbol; it
+// prints as func_<name>. Source lines live beside the code, in
+// IRProgram::lines, to keep an instruction at 16 bytes.
 struct IRInstruction {
     IROp op;
-    string result;
-    string arg1;
-    string arg2;
-    int line;
-    
-    IRInstruction(IROp o, const string& res, const string& a1 = "", 
-                  const string& a2 = "", int ln = 0)
-        : op(o), result(res), arg1(a1), arg2(a2), line(ln) {}
+    // Operand type of arithmetic and comparisons, taken from the checked
+    // AST; Unknown when the tree was not type checked.
+    ValueType type = ValueType::Unknown;
+    Operand result;
+    Operand arg1;
+    Operand arg2;
+
+    IRInstruction(IROp o, Operand res, Operand a1 = Operand(), Operand a2 = Operand(),
+                  ValueType ty = ValueType::Unknown)
+        : op(o), type(ty), result(res), arg1(a1), arg2(a2) {}
 };
+static_assert(sizeof(IRInstruction) == 16, "IRInstruction should stay 16 bytes");
 
-class IRGenerator {
-private:
-    vector<IRInstruction> instructions;
-    int tempCounter = 0;
-    int labelCounter = 0;
-    vector<string> loopEndLabels;
-    
-    // Symbol table for variables
-    unordered_map<string, string> symbolTable;
+// Whether the op writes its result operand. PARAM writes it only in a
+// function's prologue (see IRFunction); elsewhere it passes an argument.
+inline bool definesResult(IROp op) {
+    return op <= IROp::LNOT || op == IROp::CALL;
+}
 
-public:
-    vector<IRInstruction> generateIR(const Program& ast) {
-        instructions.clear();
-        tempCounter = 0;
-        labelCounter = 0;
-        symbolTable.clear();
-        loopEndLabels.clear();
-        
-        visitProgram(ast);
-        return instructions;
+inline bool endsBlock(IROp op) {
+    return op == IROp::JUMP || op == IROp::JUMP_TRUE || op == IROp::JUMP_FALSE || op == IROp::RET;
+}
+
+// A constant-pool entry: a literal as written in the source, with its type.
+struct IRConstant {
+    ValueType type;
+    string text;
+};
+
+// The code of one function: code[begin, end), starting with its entry
+// label and then one PARAM per parameter, which names it.
+struct IRFunction {
+    Operand name;
+    uint32_t begin;
+    uint32_t end;
+    uint32_t paramCount;
+};
+
+// Generated code and the tables its operands index. Text is only produced
+// when the program is printed. Global initialisers sit between the
+// functions, outside every IRFunction.
+//
+// Variables are symbols: a symbol that names a global variable refers to
+// it in every function, any other is a local of the function it appears
+// in. A local keeps its source name unless that names a global or another
+// local of the same function, in which case its frame slot is appended
+// ("x.2").
+struct IRProgram {
+    vector<IRInstruction> code;
+    vector<IRFunction> functions;
+    vector<int> lines; // source line of each instruction
+    vector<IRConstant> constants;
+    vector<string> symbols;
+    vector<bool> globals; // per symbol: names a global variable
+    uint32_t tempCount = 0;
+    uint32_t labelCount = 0;
+    unordered_map<string, uint32_t> constantIds;
+    unordered_map<string, uint32_t> symbolIds;
+
+    void clear() {
+        code.clear();
+        functions.clear();
+        lines.clear();
+        constants.clear();
+        symbols.clear();
+        globals.clear();
+        tempCount = 0;
+        labelCount = 0;
+        constantIds.clear();
+        symbolIds.clear();
+    }
+
+    Operand newTemp() {
+        return Operand(Operand::Temp, tempCount++);
     }
     
-    void printIR(ostream& os) const {
-        os << "=== THREE-ADDRESS CODE IR ===" << endl;
-        for (const auto& instr : instructions) {
-            os << formatInstruction(instr) << endl;
+    Operand newLabel() {
+        return Operand(Operand::Label, labelCount++);
+    }
+    
+    Operand constant(ValueType type, const string& text) {
+        auto [it, added] = constantIds.try_emplace(text, uint32_t(constants.size()));
+        if (added) {
+            constants.push_back(IRConstant{type, text});
+        }
+        return Operand(Operand::Const, it->second);
+    }
+    
+    Operand symbol(const string& name) {
+        auto [it, added] = symbolIds.try_emplace(name, uint32_t(symbols.size()));
+        if (added) {
+            symbols.push_back(name);
+            globals.push_back(false);
         }
+        return Operand(Operand::Symbol, it->second);
+    }
+    
+    // A symbol operand of a local variable
+    bool isLocal(Operand o) const {
+        return o.kind() == Operand::Symbol && !globals[o.index()];
     }
 
-private:
-    string newTemp() {
-        return "t" + to_string(tempCounter++);
+    void print(ostream& os) const {
+        os << "=== THREE-ADDRESS CODE IR ===\n";
+        for (const auto& instr : code) {
+            os << format(instr) << "\n";
+        }
+    }
+
+    string operandText(Operand o) const {
+        switch (o.kind()) {
+            case Operand::Temp: return "t" + to_string(o.index());
+            case Operand::Const: return constants[o.index()].text;
+            case Operand::Symbol: return symbols[o.index()];
+            case Operand::Label: return "L" + to_string(o.index());
+            default: return "";
+        }
     }
     
-    string newLabel() {
-        return "L" + to_string(labelCounter++);
+    // Typed operators print with a suffix naming the operand type: "+i" is
+    // an int add, "<f" a float compare.
+    static string typedOp(const IRInstruction& instr, const string& op) {
+        switch (instr.type) {
+            case ValueType::Int: return op + "i";
+            case ValueType::Float: return op + "f";
+            case ValueType::Bool: return op + "b";
+            case ValueType::String: return op + "s";
+            case ValueType::Char: return op + "c";
+            default: return op;
+        }
     }
     
-    void emit(IROp op, const string& result = "", const string& arg1 = "", 
-              const string& arg2 = "", int line = 0) {
-        instructions.emplace_back(op, result, arg1, arg2, line);
+    string formatBinary(const IRInstruction& instr, const string& op) const {
+        return operandText(instr.result) + " = " + operandText(instr.arg1) + " " + typedOp(instr, op) + " " +
+               operandText(instr.arg2);
     }
     
-    string formatInstruction(const IRInstruction& instr) const {
+    string format(const IRInstruction& instr) const {
         switch (instr.op) {
             case IROp::ASSIGN:
-                return instr.result + " = " + instr.arg1;
+                return operandText(instr.result) + " = " + operandText(instr.arg1);
             case IROp::ADD:
-                return instr.result + " = " + instr.arg1 + " + " + instr.arg2;
+                return formatBinary(instr, "+");
             case IROp::SUB:
-                return instr.result + " = " + instr.arg1 + " - " + instr.arg2;
+                return formatBinary(instr, "-");
             case IROp::MUL:
-                return instr.result + " = " + instr.arg1 + " * " + instr.arg2;
+                return formatBinary(instr, "*");
             case IROp::DIV:
-                return instr.result + " = " + instr.arg1 + " / " + instr.arg2;
+                return formatBinary(instr, "/");
             case IROp::EQ:
-                return instr.result + " = " + instr.arg1 + " == " + instr.arg2;
+                return formatBinary(instr, "==");
             case IROp::NE:
-                return instr.result + " = " + instr.arg1 + " != " + instr.arg2;
+                return formatBinary(instr, "!=");
             case IROp::LT:
-                return instr.result + " = " + instr.arg1 + " < " + instr.arg2;
+                return formatBinary(instr, "<");
             case IROp::LE:
-                return instr.result + " = " + instr.arg1 + " <= " + instr.arg2;
+                return formatBinary(instr, "<=");
             case IROp::GT:
-                return instr.result + " = " + instr.arg1 + " > " + instr.arg2;
+                return formatBinary(instr, ">");
             case IROp::GE:
-                return instr.result + " = " + instr.arg1 + " >= " + instr.arg2;
+                return formatBinary(instr, ">=");
             case IROp::LAND:
-                return instr.result + " = " + instr.arg1 + " && " + instr.arg2;
+                return operandText(instr.result) + " = " + operandText(instr.arg1) + " && " + operandText(instr.arg2);
             case IROp::LOR:
-                return instr.result + " = " + instr.arg1 + " || " + instr.arg2;
+                return operandText(instr.result) + " = " + operandText(instr.arg1) + " || " + operandText(instr.arg2);
             case IROp::LNOT:
-                return instr.result + " = !" + instr.arg1;
+                return operandText(instr.result) + " = !" + operandText(instr.arg1);
             case IROp::JUMP:
-                return "goto " + instr.result;
+                return "goto " + operandText(instr.result);
             case IROp::JUMP_TRUE:
-                return "if " + instr.arg1 + " goto " + instr.result;
+                return "if " + operandText(instr.arg1) + " goto " + operandText(instr.result);
             case IROp::JUMP_FALSE:
-                return "ifFalse " + instr.arg1 + " goto " + instr.result;
+                return "ifFalse " + operandText(instr.arg1) + " goto " + operandText(instr.result);
             case IROp::CALL:
-                return instr.result + " = call " + instr.arg1;
+                return operandText(instr.result) + " = call " + operandText(instr.arg1);
             case IROp::RET:
                 if (instr.result.empty()) 
                     return "return";
                 else
-                    return "return " + instr.result;
+                    return "return " + operandText(instr.result);
             case IROp::PARAM:
-                return "param " + instr.result;
+                return "param " + operandText(instr.result);
             case IROp::LABEL:
-                return instr.result + ":";
+                if (instr.result.kind() == Operand::Symbol)
+                    return "func_" + operandText(instr.result) + ":";
+                return operandText(instr.result) + ":";
             default:
                 return "unknown";
         }
     }
+};
+
+class IRGenerator {
+private:
+    IRProgram ir;
+    vector<Operand> loopEndLabels;
+    vector<Operand> locals; // symbol of each frame slot of the current function
+
+public:
+    // Reads the types TypeChecker::check and the SymbolRefs
+    // ScopeChecker::analyse leave on `ast`; run both first. Unresolved
+    // names fall back to being looked up by name.
+    const IRProgram& generateIR(const Program& ast) {
+        ir.clear();
+        loopEndLabels.clear();
+        
+        visitProgram(ast);
+        return ir;
+    }
+    
+    const IRProgram& program() const { return ir; }
+    // For passes that rewrite the generated code in place
+    IRProgram& program() { return ir; }
+    
+    void printIR(ostream& os) const {
+        ir.print(os);
+    }
+
+private:
+    Operand newTemp() {
+        return ir.newTemp();
+    }
+    
+    Operand newLabel() {
+        return ir.newLabel();
+    }
+    
+    Operand constant(ValueType type, const string& text) {
+        return ir.constant(type, text);
+    }
+    
+    Operand symbol(const string& name) {
+        return ir.symbol(name);
+    }
+    
+    // Symbol of a variable as resolved: locals by frame slot, anything
+    // else (globals, unresolved names) by name
+    Operand variable(const SymbolRef& ref, const string& name) {
+        if (ref.kind != SymbolRef::Local) {
+            return symbol(name);
+        }
+        if (ref.index >= locals.size()) {
+            locals.resize(ref.index + 1);
+        }
+        Operand& slot = locals[ref.index];
+        if (slot.empty()) {
+            slot = symbol(name);
+            if (ir.globals[slot.index()] || count(locals.begin(), locals.end(), slot) > 1) {
+                slot = symbol(name + "." + to_string(ref.index));
+            }
+        }
+        return slot;
+    }
+    
+    void emit(IROp op, Operand result = Operand(), Operand arg1 = Operand(), 
+              Operand arg2 = Operand(), int line = 0, ValueType type = ValueType::Unknown) {
+        ir.code.emplace_back(op, result, arg1, arg2, type);
+        ir.lines.push_back(line);
+    }
     
     // Visitor methods
+    // Globals are marked before any function is generated, so a local
+    // never takes the symbol of a global declared further down.
     void visitProgram(const Program& prog) {
-        // First pass: collect global symbols
         for (const auto& item : prog.items) {
             if (auto var = dynamic_pointer_cast<VarDeclStmt>(item)) {
-                symbolTable[var->name] = typeKeywordToString(var->typeTok);
+                ir.globals[symbol(var->name).index()] = true;
             }
         }
-        
-        // Second pass: generate IR
         for (const auto& item : prog.items) {
             if (auto fn = dynamic_pointer_cast<FnDecl>(item)) {
                 visitFunction(*fn);
@@ -150,12 +339,14 @@ private:
     
     void visitFunction(const FnDecl& fn) {
         // Function header
-        emit(IROp::LABEL, "func_" + fn.name, "", "", fn.line);
+        uint32_t begin = uint32_t(ir.code.size());
+        emit(IROp::LABEL, symbol(fn.name), Operand(), Operand(), fn.line);
+        locals.clear();
         
-        // Parameters
-        for (const auto& param : fn.params) {
-            symbolTable[param.second] = typeKeywordToString(param.first);
-            emit(IROp::PARAM, param.second, "", "", fn.line);
+        // Parameters; parameter i lives in frame slot i
+        for (uint32_t i = 0; i < fn.params.size(); i++) {
+            SymbolRef ref{SymbolRef::Local, 0, i};
+            emit(IROp::PARAM, variable(ref, fn.params[i].second), Operand(), Operand(), fn.line);
         }
         
         // Function body
@@ -170,19 +361,21 @@ private:
         }
         
         // Implicit return if needed
-        if (fn.returnType != TokenType::T_UNKNOWN && instructions.back().op != IROp::RET) {
-            string retVal = "0"; // default return value
-            if (fn.returnType == TokenType::T_BOOL) retVal = "false";
-            else if (fn.returnType == TokenType::T_FLOAT) retVal = "0.0";
-            else if (fn.returnType == TokenType::T_STRING) retVal = "\"\"";
-            emit(IROp::RET, retVal, "", "", fn.line);
-        }
+        if (fn.returnType != TokenType::T_UNKNOWN && ir.code.back().op != IROp::RET) {
+            Operand retVal = constant(ValueType::Int, "0"); // default return value
+            if (fn.returnType == TokenType::T_BOOL) retVal = constant(ValueType::Bool, "false");
+            else if (fn.returnType == TokenType::T_FLOAT) retVal = constant(ValueType::Float, "0.0");
+            else if (fn.returnType == TokenType::T_STRING) retVal = constant(ValueType::String, "\"\"");
+            emit(IROp::RET, retVal, Operand(), Operand(), fn.line);
+        }
+        ir.functions.push_back(IRFunction{ir.code[begin].result, begin, uint32_t(ir.code.size()),
+                                          uint32_t(fn.params.size())});
     }
     
     void visitGlobalVar(const VarDeclStmt& var) {
         if (var.init) {
-            string initVal = visitExpression(var.init);
-            emit(IROp::ASSIGN, var.name, initVal, "", var.line);
+            Operand initVal = visitExpression(var.init);
+            emit(IROp::ASSIGN, symbol(var.name), initVal, Operand(), var.line);
         }
     }
     
@@ -198,8 +391,8 @@ private:
             visitLocalVar(*varDecl);
         }
         else if (auto retStmt = dynamic_pointer_cast<ReturnStmt>(stmt)) {
-            string retVal = retStmt->expr ? visitExpression(retStmt->expr) : "";
-            emit(IROp::RET, retVal, "", "", retStmt->line);
+            Operand retVal = retStmt->expr ? visitExpression(retStmt->expr) : Operand();
+            emit(IROp::RET, retVal, Operand(), Operand(), retStmt->line);
         }
         else if (auto ifStmt = dynamic_pointer_cast<IfStmt>(stmt)) {
             visitIfStatement(*ifStmt);
@@ -217,7 +410,7 @@ private:
         }
         else if (auto breakStmt = dynamic_pointer_cast<BreakStmt>(stmt)) {
             if (!loopEndLabels.empty()) {
-                emit(IROp::JUMP, loopEndLabels.back(), "", "", breakStmt->line);
+                emit(IROp::JUMP, loopEndLabels.back(), Operand(), Operand(), breakStmt->line);
             }
         }
         else if (auto emptyStmt = dynamic_pointer_cast<EmptyStmt>(stmt)) {
@@ -226,63 +419,60 @@ private:
     }
     
     void visitLocalVar(const VarDeclStmt& var) {
-        symbolTable[var.name] = typeKeywordToString(var.typeTok);
         if (var.init) {
-            string initVal = visitExpression(var.init);
-            emit(IROp::ASSIGN, var.name, initVal, "", var.line);
+            Operand initVal = visitExpression(var.init);
+            emit(IROp::ASSIGN, variable(var.ref, var.name), initVal, Operand(), var.line);
         }
     }
     
     void visitIfStatement(const IfStmt& ifStmt) {
-        string cond = visitExpression(ifStmt.cond);
-        string trueLabel = newLabel();
-        string falseLabel = newLabel();
-        string endLabel = newLabel();
+        Operand trueLabel = newLabel();
+        Operand falseLabel = newLabel();
+        Operand endLabel = newLabel();
         
-        emit(IROp::JUMP_FALSE, falseLabel, cond, "", ifStmt.line);
-        emit(IROp::JUMP, trueLabel, "", "", ifStmt.line);
+        branchIfFalse(ifStmt.cond, falseLabel, ifStmt.line);
+        emit(IROp::JUMP, trueLabel, Operand(), Operand(), ifStmt.line);
         
         // True branch
-        emit(IROp::LABEL, trueLabel, "", "", ifStmt.line);
+        emit(IROp::LABEL, trueLabel, Operand(), Operand(), ifStmt.line);
         visitStatement(ifStmt.thenStmt);
         
         if (ifStmt.elseStmt) {
-            emit(IROp::JUMP, endLabel, "", "", ifStmt.line);
+            emit(IROp::JUMP, endLabel, Operand(), Operand(), ifStmt.line);
         }
         
         // False branch
-        emit(IROp::LABEL, falseLabel, "", "", ifStmt.line);
+        emit(IROp::LABEL, falseLabel, Operand(), Operand(), ifStmt.line);
         if (ifStmt.elseStmt) {
             visitStatement(ifStmt.elseStmt);
-            emit(IROp::LABEL, endLabel, "", "", ifStmt.line);
+            emit(IROp::LABEL, endLabel, Operand(), Operand(), ifStmt.line);
         }
     }
     
     void visitWhileStatement(const WhileStmt& whileStmt) {
-        string startLabel = newLabel();
-        string bodyLabel = newLabel();
-        string endLabel = newLabel();
+        Operand startLabel = newLabel();
+        Operand bodyLabel = newLabel();
+        Operand endLabel = newLabel();
         
         loopEndLabels.push_back(endLabel);
         
-        emit(IROp::LABEL, startLabel, "", "", whileStmt.line);
-        string cond = visitExpression(whileStmt.cond);
-        emit(IROp::JUMP_FALSE, endLabel, cond, "", whileStmt.line);
-        emit(IROp::JUMP, bodyLabel, "", "", whileStmt.line);
+        emit(IROp::LABEL, startLabel, Operand(), Operand(), whileStmt.line);
+        branchIfFalse(whileStmt.cond, endLabel, whileStmt.line);
+        emit(IROp::JUMP, bodyLabel, Operand(), Operand(), whileStmt.line);
         
-        emit(IROp::LABEL, bodyLabel, "", "", whileStmt.line);
+        emit(IROp::LABEL, bodyLabel, Operand(), Operand(), whileStmt.line);
         visitStatement(whileStmt.body);
-        emit(IROp::JUMP, startLabel, "", "", whileStmt.line);
+        emit(IROp::JUMP, startLabel, Operand(), Operand(), whileStmt.line);
         
-        emit(IROp::LABEL, endLabel, "", "", whileStmt.line);
+        emit(IROp::LABEL, endLabel, Operand(), Operand(), whileStmt.line);
         loopEndLabels.pop_back();
     }
     
     void visitForStatement(const ForStmt& forStmt) {
-        string startLabel = newLabel();
-        string bodyLabel = newLabel();
-        string postLabel = newLabel();
-        string endLabel = newLabel();
+        Operand startLabel = newLabel();
+        Operand bodyLabel = newLabel();
+        Operand postLabel = newLabel();
+        Operand endLabel = newLabel();
         
         loopEndLabels.push_back(endLabel);
         
@@ -295,171 +485,252 @@ private:
             }
         }
         
-        emit(IROp::LABEL, startLabel, "", "", forStmt.line);
+        emit(IROp::LABEL, startLabel, Operand(), Operand(), forStmt.line);
         
         // Condition
         if (forStmt.cond) {
-            string cond = visitExpression(forStmt.cond);
-            emit(IROp::JUMP_FALSE, endLabel, cond, "", forStmt.line);
+            branchIfFalse(forStmt.cond, endLabel, forStmt.line);
         }
         
-        emit(IROp::JUMP, bodyLabel, "", "", forStmt.line);
+        emit(IROp::JUMP, bodyLabel, Operand(), Operand(), forStmt.line);
         
         // Body
-        emit(IROp::LABEL, bodyLabel, "", "", forStmt.line);
+        emit(IROp::LABEL, bodyLabel, Operand(), Operand(), forStmt.line);
         visitStatement(forStmt.body);
         
         // Post iteration
-        emit(IROp::JUMP, postLabel, "", "", forStmt.line);
-        emit(IROp::LABEL, postLabel, "", "", forStmt.line);
+        emit(IROp::JUMP, postLabel, Operand(), Operand(), forStmt.line);
+        emit(IROp::LABEL, postLabel, Operand(), Operand(), forStmt.line);
         if (forStmt.post) {
             visitExpression(forStmt.post);
         }
         
-        emit(IROp::JUMP, startLabel, "", "", forStmt.line);
-        emit(IROp::LABEL, endLabel, "", "", forStmt.line);
+        emit(IROp::JUMP, startLabel, Operand(), Operand(), forStmt.line);
+        emit(IROp::LABEL, endLabel, Operand(), Operand(), forStmt.line);
         loopEndLabels.pop_back();
     }
     
-    string visitExpression(const shared_ptr<Expr>& expr) {
-        if (!expr) return "";
+    // Conditions are lowered to jumping code: && and || short-circuit
+    // through chains of JUMP_TRUE/JUMP_FALSE, ! swaps the sense of the
+    // jump, and a literal is decided here. Only the leaves are evaluated,
+    // so no boolean is materialized for the operators themselves.
+    void branchIfFalse(const shared_ptr<Expr>& cond, Operand target, int line) {
+        if (auto binary = dynamic_pointer_cast<BinaryExpr>(cond)) {
+            if (binary->op == "&&") {
+                branchIfFalse(binary->lhs, target, line);
+                branchIfFalse(binary->rhs, target, line);
+                return;
+            }
+            if (binary->op == "||") {
+                Operand skip = newLabel();
+                branchIfTrue(binary->lhs, skip, line);
+                branchIfFalse(binary->rhs, target, line);
+                emit(IROp::LABEL, skip, Operand(), Operand(), line);
+                return;
+            }
+        } else if (auto unary = dynamic_pointer_cast<UnaryExpr>(cond)) {
+            if (unary->op == "!") {
+                branchIfTrue(unary->rhs, target, line);
+                return;
+            }
+        } else if (auto boolLit = dynamic_pointer_cast<BoolLiteral>(cond)) {
+            if (!boolLit->val) {
+                emit(IROp::JUMP, target, Operand(), Operand(), line);
+            }
+            return;
+        }
+        emit(IROp::JUMP_FALSE, target, visitExpression(cond), Operand(), line);
+    }
+    
+    void branchIfTrue(const shared_ptr<Expr>& cond, Operand target, int line) {
+        if (auto binary = dynamic_pointer_cast<BinaryExpr>(cond)) {
+            if (binary->op == "||") {
+                branchIfTrue(binary->lhs, target, line);
+                branchIfTrue(binary->rhs, target, line);
+                return;
+            }
+            if (binary->op == "&&") {
+                Operand skip = newLabel();
+                branchIfFalse(binary->lhs, skip, line);
+                branchIfTrue(binary->rhs, target, line);
+                emit(IROp::LABEL, skip, Operand(), Operand(), line);
+                return;
+            }
+        } else if (auto unary = dynamic_pointer_cast<UnaryExpr>(cond)) {
+            if (unary->op == "!") {
+                branchIfFalse(unary->rhs, target, line);
+                return;
+            }
+        } else if (auto boolLit = dynamic_pointer_cast<BoolLiteral>(cond)) {
+            if (boolLit->val) {
+                emit(IROp::JUMP, target, Operand(), Operand(), line);
+            }
+            return;
+        }
+        emit(IROp::JUMP_TRUE, target, visitExpression(cond), Operand(), line);
+    }
+    
+    Operand visitExpression(const shared_ptr<Expr>& expr) {
+        if (!expr) return Operand();
         
         if (auto intLit = dynamic_pointer_cast<IntLiteral>(expr)) {
-            string temp = newTemp();
-            emit(IROp::ASSIGN, temp, intLit->val, "", expr->line);
+            Operand temp = newTemp();
+            emit(IROp::ASSIGN, temp, constant(ValueType::Int, intLit->val), Operand(), expr->line);
             return temp;
         }
         else if (auto floatLit = dynamic_pointer_cast<FloatLiteral>(expr)) {
-            string temp = newTemp();
-            emit(IROp::ASSIGN, temp, floatLit->val, "", expr->line);
+            Operand temp = newTemp();
+            emit(IROp::ASSIGN, temp, constant(ValueType::Float, floatLit->val), Operand(), expr->line);
             return temp;
         }
         else if (auto stringLit = dynamic_pointer_cast<StringLiteral>(expr)) {
-            string temp = newTemp();
-            emit(IROp::ASSIGN, temp, "\"" + stringLit->val + "\"", "", expr->line);
+            Operand temp = newTemp();
+            emit(IROp::ASSIGN, temp, constant(ValueType::String, "\"" + stringLit->val + "\""), Operand(), expr->line);
             return temp;
         }
         else if (auto boolLit = dynamic_pointer_cast<BoolLiteral>(expr)) {
-            string temp = newTemp();
-            emit(IROp::ASSIGN, temp, boolLit->val ? "true" : "false", "", expr->line);
+            Operand temp = newTemp();
+            emit(IROp::ASSIGN, temp, constant(ValueType::Bool, boolLit->val ? "true" : "false"), Operand(), expr->line);
             return temp;
         }
         else if (auto charLit = dynamic_pointer_cast<CharLiteral>(expr)) {
-            string temp = newTemp();
-            emit(IROp::ASSIGN, temp, "'" + charLit->val + "'", "", expr->line);
+            Operand temp = newTemp();
+            emit(IROp::ASSIGN, temp, constant(ValueType::Char, "'" + charLit->val + "'"), Operand(), expr->line);
             return temp;
         }
         else if (auto ident = dynamic_pointer_cast<IdentifierExpr>(expr)) {
-            return ident->name; // Just use the variable name
+            return variable(ident->ref, ident->name);
         }
         else if (auto unary = dynamic_pointer_cast<UnaryExpr>(expr)) {
-            string rhs = visitExpression(unary->rhs);
-            string temp = newTemp();
+            Operand rhs = visitExpression(unary->rhs);
+            Operand temp = newTemp();
+            ValueType type = unary->rhs->type;
             
             if (unary->op == "!") {
-                emit(IROp::LNOT, temp, rhs, "", expr->line);
+                emit(IROp::LNOT, temp, rhs, Operand(), expr->line);
             } else if (unary->op == "-") {
-                emit(IROp::SUB, temp, "0", rhs, expr->line);
+                emit(IROp::SUB, temp, type == ValueType::Float ? constant(type, "0.0") : constant(ValueType::Int, "0"), rhs, expr->line, type);
             } else if (unary->op == "++") {
                 // Prefix increment
-                emit(IROp::ADD, temp, rhs, "1", expr->line);
-                emit(IROp::ASSIGN, rhs, temp, "", expr->line);
+                emit(IROp::ADD, temp, rhs, constant(ValueType::Int, "1"), expr->line, type);
+                emit(IROp::ASSIGN, rhs, temp, Operand(), expr->line);
             } else if (unary->op == "--") {
                 // Prefix decrement
-                emit(IROp::SUB, temp, rhs, "1", expr->line);
-                emit(IROp::ASSIGN, rhs, temp, "", expr->line);
+                emit(IROp::SUB, temp, rhs, constant(ValueType::Int, "1"), expr->line, type);
+                emit(IROp::ASSIGN, rhs, temp, Operand(), expr->line);
             } else {
-                emit(IROp::ASSIGN, temp, rhs, "", expr->line);
+                emit(IROp::ASSIGN, temp, rhs, Operand(), expr->line);
             }
             return temp;
         }
         else if (auto postfix = dynamic_pointer_cast<PostfixExpr>(expr)) {
-            string exprVal = visitExpression(postfix->expr);
-            string temp = newTemp();
+            Operand exprVal = visitExpression(postfix->expr);
+            Operand temp = newTemp();
             
             // Store original value
-            emit(IROp::ASSIGN, temp, exprVal, "", expr->line);
+            emit(IROp::ASSIGN, temp, exprVal, Operand(), expr->line);
             
+            ValueType type = postfix->expr->type;
             if (postfix->op == "++") {
-                string newVal = newTemp();
-                emit(IROp::ADD, newVal, exprVal, "1", expr->line);
-                emit(IROp::ASSIGN, exprVal, newVal, "", expr->line);
+                Operand newVal = newTemp();
+                emit(IROp::ADD, newVal, exprVal, constant(ValueType::Int, "1"), expr->line, type);
+                emit(IROp::ASSIGN, exprVal, newVal, Operand(), expr->line);
             } else if (postfix->op == "--") {
-                string newVal = newTemp();
-                emit(IROp::SUB, newVal, exprVal, "1", expr->line);
-                emit(IROp::ASSIGN, exprVal, newVal, "", expr->line);
+                Operand newVal = newTemp();
+                emit(IROp::SUB, newVal, exprVal, constant(ValueType::Int, "1"), expr->line, type);
+                emit(IROp::ASSIGN, exprVal, newVal, Operand(), expr->line);
             }
             return temp;
         }
         else if (auto binary = dynamic_pointer_cast<BinaryExpr>(expr)) {
-            string lhs = visitExpression(binary->lhs);
-            string rhs = visitExpression(binary->rhs);
-            string temp = newTemp();
+            if (binary->op == "&&" || binary->op == "||") {
+                // A value is only needed outside conditions: the jumping
+                // code picks which constant is stored, and the right
+                // operand runs only when it decides the result.
+                Operand temp = newTemp();
+                Operand falseLabel = newLabel();
+                Operand endLabel = newLabel();
+                branchIfFalse(expr, falseLabel, expr->line);
+                emit(IROp::ASSIGN, temp, constant(ValueType::Bool, "true"), Operand(), expr->line);
+                emit(IROp::JUMP, endLabel, Operand(), Operand(), expr->line);
+                emit(IROp::LABEL, falseLabel, Operand(), Operand(), expr->line);
+                emit(IROp::ASSIGN, temp, constant(ValueType::Bool, "false"), Operand(), expr->line);
+                emit(IROp::LABEL, endLabel, Operand(), Operand(), expr->line);
+                return temp;
+            }
+            Operand lhs = visitExpression(binary->lhs);
+            Operand rhs = visitExpression(binary->rhs);
+            Operand temp = newTemp();
+            // Arithmetic takes the type the checker gave the node, Unknown
+            // when the operand types differ. A comparison's result is Bool,
+            // so it is typed by its operands: Float when either is. A
+            // compound assignment computes in the variable's type.
+            ValueType type = expr->type;
+            ValueType compared = binary->lhs->type == ValueType::Float || binary->rhs->type == ValueType::Float
+                                     ? ValueType::Float : binary->lhs->type;
             
             if (binary->op == "+") {
-                emit(IROp::ADD, temp, lhs, rhs, expr->line);
+                emit(IROp::ADD, temp, lhs, rhs, expr->line, type);
             } else if (binary->op == "-") {
-                emit(IROp::SUB, temp, lhs, rhs, expr->line);
+                emit(IROp::SUB, temp, lhs, rhs, expr->line, type);
             } else if (binary->op == "*") {
-                emit(IROp::MUL, temp, lhs, rhs, expr->line);
+                emit(IROp::MUL, temp, lhs, rhs, expr->line, type);
             } else if (binary->op == "/") {
-                emit(IROp::DIV, temp, lhs, rhs, expr->line);
+                emit(IROp::DIV, temp, lhs, rhs, expr->line, type);
             } else if (binary->op == "==") {
-                emit(IROp::EQ, temp, lhs, rhs, expr->line);
+                emit(IROp::EQ, temp, lhs, rhs, expr->line, compared);
             } else if (binary->op == "!=") {
-                emit(IROp::NE, temp, lhs, rhs, expr->line);
+                emit(IROp::NE, temp, lhs, rhs, expr->line, compared);
             } else if (binary->op == "<") {
-                emit(IROp::LT, temp, lhs, rhs, expr->line);
+                emit(IROp::LT, temp, lhs, rhs, expr->line, compared);
             } else if (binary->op == "<=") {
-                emit(IROp::LE, temp, lhs, rhs, expr->line);
+                emit(IROp::LE, temp, lhs, rhs, expr->line, compared);
             } else if (binary->op == ">") {
-                emit(IROp::GT, temp, lhs, rhs, expr->line);
+                emit(IROp::GT, temp, lhs, rhs, expr->line, compared);
             } else if (binary->op == ">=") {
-                emit(IROp::GE, temp, lhs, rhs, expr->line);
-            } else if (binary->op == "&&") {
-                emit(IROp::LAND, temp, lhs, rhs, expr->line);
-            } else if (binary->op == "||") {
-                emit(IROp::LOR, temp, lhs, rhs, expr->line);
+                emit(IROp::GE, temp, lhs, rhs, expr->line, compared);
             } else if (binary->op == "=") {
-                emit(IROp::ASSIGN, lhs, rhs, "", expr->line);
+                emit(IROp::ASSIGN, lhs, rhs, Operand(), expr->line);
                 return lhs; // Assignment returns the assigned value
             } else if (binary->op == "+=") {
-                string sum = newTemp();
-                emit(IROp::ADD, sum, lhs, rhs, expr->line);
-                emit(IROp::ASSIGN, lhs, sum, "", expr->line);
+                Operand sum = newTemp();
+                emit(IROp::ADD, sum, lhs, rhs, expr->line, binary->lhs->type);
+                emit(IROp::ASSIGN, lhs, sum, Operand(), expr->line);
                 return lhs;
             } else if (binary->op == "-=") {
-                string diff = newTemp();
-                emit(IROp::SUB, diff, lhs, rhs, expr->line);
-                emit(IROp::ASSIGN, lhs, diff, "", expr->line);
+                Operand diff = newTemp();
+                emit(IROp::SUB, diff, lhs, rhs, expr->line, binary->lhs->type);
+                emit(IROp::ASSIGN, lhs, diff, Operand(), expr->line);
                 return lhs;
             }
             return temp;
         }
         else if (auto call = dynamic_pointer_cast<CallExpr>(expr)) {
+            Operand target = call->name.empty() ? visitExpression(call->callee) : symbol(call->name);
             // Push parameters
             for (const auto& arg : call->args) {
-                string argVal = visitExpression(arg);
-                emit(IROp::PARAM, argVal, "", "", expr->line);
+                Operand argVal = visitExpression(arg);
+                emit(IROp::PARAM, argVal, Operand(), Operand(), expr->line);
             }
             
-            string temp = newTemp();
-            emit(IROp::CALL, temp, call->name, "", expr->line);
+            Operand temp = newTemp();
+            emit(IROp::CALL, temp, target, Operand(), expr->line);
             return temp;
         }
         else if (auto index = dynamic_pointer_cast<IndexExpr>(expr)) {
-            string base = visitExpression(index->base);
-            string idx = visitExpression(index->index);
-            string temp = newTemp();
+            Operand base = visitExpression(index->base);
+            Operand idx = visitExpression(index->index);
+            Operand temp = newTemp();
             // For arrays: base[idx] - simplified as base + index for now
             emit(IROp::ADD, temp, base, idx, expr->line);
             return temp;
         }
         
-        return "";
+        return Operand();
     }
 };
 
+#ifndef IR_GENERATOR_NO_MAIN
 // Main driver that integrates with your existing pipeline
 int main() {
     const string inputFile = "sample.txt";
@@ -496,10 +767,17 @@ int main() {
         program.print(cout);
         cout << endl;
 
+        // Type checking and name resolution annotate the tree with the
+        // types and symbol slots IR generation reads
+        TypeChecker checker;
+        checker.check(program);
+        ScopeChecker resolver;
+        resolver.analyse(program);
+
         // IR Generation
         cout << "=== IR GENERATION ===" << endl;
         IRGenerator irGen;
-        auto irCode = irGen.generateIR(program);
+        irGen.generateIR(program);
         irGen.printIR(cout);
 
     } catch (const exception& e) {
@@ -508,4 +786,6 @@ int main() {
     }
     
     return 0;
-}
\ No newline at end of file
+}
+#endif // IR_GENERATOR_NO_MAIN
+#endif // IR_GENERATOR_CPP
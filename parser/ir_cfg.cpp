@@ -0,0 +1,256 @@
+// ir_cfg.cpp
+// Define IR_CFG_NO_MAIN before including to reuse the CFG builder in another driver.
+#ifndef IR_CFG_CPP
+#define IR_CFG_CPP
+#ifndef IR_GENERATOR_NO_MAIN
+#define IR_GENERATOR_NO_MAIN
+#endif
+#include "irGenerator.cpp"
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+// ---------------------------------------------------------------------
+// Control-flow graph of one IR function
+// ---------------------------------------------------------------------
+// Basic blocks are index ranges of IRProgram::code: block b holds
+// code[blockStart[b], blockStart[b + 1]). Block 0 starts with the
+// function's entry label. A block ends at a jump or return, or just before
+// the next label, and falls through to the next block unless its last
+// instruction is a JUMP or RET (falling off the last block leaves the
+// function).
+//
+// Edges are kept in compressed rows: the successors of b are
+// succ[succStart[b], succStart[b + 1]), the predecessors likewise, so the
+// whole graph is six flat vectors. A conditional jump lists its taken
+// target first, then the fall-through block; when both are the same block
+// there is one edge.
+class CFG
+{
+public:
+    // A run of block numbers in one of the edge arrays.
+    struct BlockList
+    {
+        const uint32_t *first, *last;
+        const uint32_t *begin() const { return first; }
+        const uint32_t *end() const { return last; }
+        size_t size() const { return size_t(last - first); }
+        bool empty() const { return first == last; }
+        uint32_t operator[](size_t i) const { return first[i]; }
+    };
+
+    static constexpr uint32_t UNREACHABLE = UINT32_MAX;
+
+    IRFunction function{};
+    vector<uint32_t> blockStart; // blockCount() + 1 entries
+    vector<uint32_t> succStart, succ;
+    vector<uint32_t> predStart, pred;
+    // Blocks reachable from the entry in reverse postorder, and each
+    // block's position in it (UNREACHABLE if it has none).
+    vector<uint32_t> rpo;
+    vector<uint32_t> rpoIndex;
+
+    uint32_t blockCount() const { return uint32_t(blockStart.size() - 1); }
+    uint32_t edgeCount() const { return uint32_t(succ.size()); }
+    uint32_t begin(uint32_t b) const { return blockStart[b]; }
+    uint32_t end(uint32_t b) const { return blockStart[b + 1]; }
+    BlockList successors(uint32_t b) const { return {succ.data() + succStart[b], succ.data() + succStart[b + 1]}; }
+    BlockList predecessors(uint32_t b) const { return {pred.data() + predStart[b], pred.data() + predStart[b + 1]}; }
+    bool reachable(uint32_t b) const { return rpoIndex[b] != UNREACHABLE; }
+
+    void print(ostream &os, const IRProgram &ir) const
+    {
+        os << "=== CFG " << ir.format(ir.code[function.begin]) << " " << blockCount() << " blocks, "
+           << edgeCount() << " edges ===\n";
+        for (uint32_t b = 0; b < blockCount(); b++)
+        {
+            os << "B" << b << (reachable(b) ? "" : " (unreachable)") << "  preds:";
+            for (uint32_t p : predecessors(b))
+                os << " B" << p;
+            os << "  succs:";
+            for (uint32_t s : successors(b))
+                os << " B" << s;
+            os << "\n";
+            for (uint32_t i = begin(b); i < end(b); i++)
+                os << "    " << ir.format(ir.code[i]) << "\n";
+        }
+        os << "RPO:";
+        for (uint32_t b : rpo)
+            os << " B" << b;
+        os << "\n";
+    }
+};
+
+// Builds CFGs one function at a time. The label-to-block table is kept
+// between calls, so building every function of a program allocates little
+// beyond the graphs themselves.
+class CFGBuilder
+{
+public:
+    CFG build(const IRProgram &ir, const IRFunction &fn)
+    {
+        CFG g;
+        g.function = fn;
+        if (labelBlock.size() < ir.labelCount)
+            labelBlock.resize(ir.labelCount, CFG::UNREACHABLE);
+
+        // Leaders: the entry, every label, and whatever follows a jump or
+        // return.
+        for (uint32_t i = fn.begin; i < fn.end; i++)
+        {
+            const IRInstruction &in = ir.code[i];
+            bool leader = i == fn.begin || in.op == IROp::LABEL || endsBlock(ir.code[i - 1].op);
+            if (leader)
+                g.blockStart.push_back(i);
+            if (in.op == IROp::LABEL && in.result.kind() == Operand::Label)
+                labelBlock[in.result.index()] = uint32_t(g.blockStart.size() - 1);
+        }
+        g.blockStart.push_back(fn.end);
+        uint32_t n = g.blockCount();
+
+        // Successors, straight into their rows
+        g.succStart.reserve(n + 1);
+        g.succ.reserve(n * 2);
+        for (uint32_t b = 0; b < n; b++)
+        {
+            g.succStart.push_back(uint32_t(g.succ.size()));
+            const IRInstruction &last = ir.code[g.end(b) - 1];
+            uint32_t fall = b + 1 < n ? b + 1 : CFG::UNREACHABLE;
+            switch (last.op)
+            {
+            case IROp::JUMP:
+                g.succ.push_back(target(last));
+                break;
+            case IROp::JUMP_TRUE:
+            case IROp::JUMP_FALSE:
+                g.succ.push_back(target(last));
+                if (fall != CFG::UNREACHABLE && fall != g.succ.back())
+                    g.succ.push_back(fall);
+                break;
+            case IROp::RET:
+                break;
+            default:
+                if (fall != CFG::UNREACHABLE)
+                    g.succ.push_back(fall);
+            }
+        }
+        g.succStart.push_back(uint32_t(g.succ.size()));
+
+        // Predecessors by counting sort over the successor rows, which
+        // leaves each row in ascending block order.
+        g.predStart.assign(n + 1, 0);
+        for (uint32_t s : g.succ)
+            g.predStart[s + 1]++;
+        for (uint32_t b = 0; b < n; b++)
+            g.predStart[b + 1] += g.predStart[b];
+        g.pred.resize(g.succ.size());
+        vector<uint32_t> fill(g.predStart.begin(), g.predStart.end() - 1);
+        for (uint32_t b = 0; b < n; b++)
+            for (uint32_t s : g.successors(b))
+                g.pred[fill[s]++] = b;
+
+        computeRPO(g);
+
+        for (uint32_t i = fn.begin; i < fn.end; i++)
+            if (ir.code[i].op == IROp::LABEL && ir.code[i].result.kind() == Operand::Label)
+                labelBlock[ir.code[i].result.index()] = CFG::UNREACHABLE;
+        return g;
+    }
+
+private:
+    vector<uint32_t> labelBlock;       // block of each label of the function being built
+    vector<pair<uint32_t, uint32_t>> stack; // DFS: block, next successor to visit
+
+    uint32_t target(const IRInstruction &jump) const
+    {
+        uint32_t b = labelBlock[jump.result.index()];
+        if (b == CFG::UNREACHABLE)
+            throw runtime_error("IR jump to a label outside its function");
+        return b;
+    }
+
+    // Iterative depth-first search from the entry; postorder reversed.
+    void computeRPO(CFG &g)
+    {
+        uint32_t n = g.blockCount();
+        g.rpoIndex.assign(n, CFG::UNREACHABLE);
+        g.rpo.clear();
+        vector<bool> seen(n, false);
+        stack.clear();
+        stack.push_back({0, 0});
+        seen[0] = true;
+        while (!stack.empty())
+        {
+            auto &top = stack.back();
+            CFG::BlockList next = g.successors(top.first);
+            if (top.second < next.size())
+            {
+                uint32_t s = next[top.second++];
+                if (!seen[s])
+                {
+                    seen[s] = true;
+                    stack.push_back({s, 0});
+                }
+                continue;
+            }
+            g.rpo.push_back(top.first);
+            stack.pop_back();
+        }
+        reverse(g.rpo.begin(), g.rpo.end());
+        for (uint32_t i = 0; i < g.rpo.size(); i++)
+            g.rpoIndex[g.rpo[i]] = i;
+    }
+};
+
+// CFGs of every function of a program, in program order.
+inline vector<CFG> buildCFGs(const IRProgram &ir)
+{
+    CFGBuilder builder;
+    vector<CFG> out;
+    out.reserve(ir.functions.size());
+    for (const IRFunction &fn : ir.functions)
+        out.push_back(builder.build(ir, fn));
+    return out;
+}
+
+#ifndef IR_CFG_NO_MAIN
+// ---------------------------------------------------------------------
+// Main Driver: the CFG of every function in sample.txt
+// ---------------------------------------------------------------------
+int main(int argc, char **argv)
+{
+    const string inputFile = argc > 1 ? argv[1] : "sample.txt";
+    try
+    {
+        ifstream file(inputFile);
+        if (!file.is_open())
+            throw runtime_error("Cannot open file: " + inputFile);
+        stringstream buffer;
+        buffer << file.rdbuf();
+
+        RegexLexer lexer(buffer.str());
+        Parser parser(lexer.tokenize());
+        Program program = parser.parseProgram();
+        TypeChecker checker;
+        checker.check(program);
+        ScopeChecker resolver;
+        resolver.analyse(program);
+        IRGenerator irGen;
+        const IRProgram &ir = irGen.generateIR(program);
+        for (const CFG &g : buildCFGs(ir))
+        {
+            g.print(cout, ir);
+            cout << "\n";
+        }
+    }
+    catch (const exception &e)
+    {
+        cout << "ERROR: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+#endif // IR_CFG_NO_MAIN
+#endif // IR_CFG_CPP
@@ -0,0 +1,246 @@
+// ir_cfg_simplify.cpp
+// Jump threading, block merging and branch layout over SSA form; ir_optimizer.cpp runs it.
+#ifndef IR_CFG_SIMPLIFY_CPP
+#define IR_CFG_SIMPLIFY_CPP
+#ifndef IR_SSA_NO_MAIN
+#define IR_SSA_NO_MAIN
+#endif
+#include "ir_ssa.cpp"
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// ---------------------------------------------------------------------
+// CFG simplification
+// ---------------------------------------------------------------------
+// The generator brackets every if and loop body with a jump to the very
+// next label and leaves blocks that only jump on. Until nothing changes:
+//   - a block that only jumps is threaded: its predecessors jump straight
+//     to its target, and it goes once nobody reaches it (a conditional jump
+//     is not threaded into a block with phis, which would need the block
+//     back to hold the copies);
+//   - a block whose only successor has it as only predecessor absorbs that
+//     successor (its phis, each with one argument, become the argument);
+// then blocks the entry cannot reach are dropped and the rest are laid out
+// so each block is followed by the successor it prefers: a JUMP's target,
+// or a conditional jump's not-taken side, falling back to the taken side,
+// which destroySSA then reaches by inverting the condition.
+struct CFGSimplifyStats
+{
+    size_t threaded = 0; // edges redirected past a jump-only block
+    size_t merged = 0;   // blocks merged into their predecessor
+    size_t removed = 0;  // blocks deleted, merged ones included
+};
+
+class CFGSimplifier
+{
+public:
+    CFGSimplifyStats run(IRProgram &ir, SSAFunction &f)
+    {
+        CFGSimplifyStats stats;
+        if (replacement.size() < ir.tempCount)
+            replacement.resize(ir.tempCount);
+        dead.assign(f.blockCount(), 0);
+        for (bool changed = true; changed;)
+        {
+            changed = false;
+            for (uint32_t b = 1; b < f.blockCount(); b++)
+                if (!dead[b] && thread(f, b, stats))
+                    changed = true;
+            for (uint32_t b = 0; b < f.blockCount(); b++)
+                while (!dead[b] && merge(f, b, stats))
+                    changed = true;
+        }
+        if (!touched.empty())
+            for (uint32_t b = 0; b < f.blockCount(); b++)
+            {
+                SSABlock &block = f.blocks[b];
+                for (Phi &phi : block.phis)
+                    for (Operand &a : phi.args)
+                        a = resolve(a);
+                for (size_t i = 0; i < block.code.size(); i++)
+                    forEachUse(block.code[i], f.isPrologue(b, i), [&](Operand &o) { o = resolve(o); });
+            }
+        for (uint32_t t : touched)
+            replacement[t] = Operand();
+        touched.clear();
+        stats.removed += layout(f);
+        return stats;
+    }
+
+private:
+    vector<uint8_t> dead;
+    vector<Operand> replacement; // by temp index: what a merged phi stood for
+    vector<uint32_t> touched;
+
+    Operand resolve(Operand o) const
+    {
+        while (o.kind() == Operand::Temp && o.index() < replacement.size() && !replacement[o.index()].empty())
+            o = replacement[o.index()];
+        return o;
+    }
+
+    static void erasePred(SSABlock &block, uint32_t slot)
+    {
+        block.preds.erase(block.preds.begin() + slot);
+        for (Phi &phi : block.phis)
+            phi.args.erase(phi.args.begin() + slot);
+    }
+
+    // Redirects the predecessors of jump-only block e to its target
+    bool thread(SSAFunction &f, uint32_t e, CFGSimplifyStats &stats)
+    {
+        SSABlock &block = f.blocks[e];
+        if (!block.phis.empty() || block.code.size() != 1 || block.terminator().op != IROp::JUMP)
+            return false;
+        uint32_t t = block.succs[0];
+        if (t == e)
+            return false;
+        SSABlock &target = f.blocks[t];
+        uint32_t slot = target.predIndex(e);
+        bool progress = false;
+        for (size_t k = 0; k < block.preds.size();)
+        {
+            uint32_t p = block.preds[k];
+            SSABlock &pred = f.blocks[p];
+            if (!target.phis.empty() && pred.succs.size() > 1)
+            {
+                // The edge would be critical, and destroySSA would split it
+                // again for the phi copies
+                k++;
+                continue;
+            }
+            bool already = find(target.preds.begin(), target.preds.end(), p) != target.preds.end();
+            replace(pred.succs.begin(), pred.succs.end(), e, t);
+            if (already)
+            {
+                // Both sides of a conditional now reach t
+                pred.succs.erase(unique(pred.succs.begin(), pred.succs.end()), pred.succs.end());
+                pred.terminator() = IRInstruction(IROp::JUMP, pred.terminator().result);
+            }
+            else
+            {
+                target.preds.push_back(p);
+                for (Phi &phi : target.phis)
+                    phi.args.push_back(phi.args[slot]);
+            }
+            block.preds.erase(block.preds.begin() + k);
+            stats.threaded++;
+            progress = true;
+        }
+        if (block.preds.empty())
+        {
+            erasePred(target, target.predIndex(e));
+            block.succs.clear();
+            dead[e] = 1;
+        }
+        return progress;
+    }
+
+    // Appends the only successor of b to it, when b is its only predecessor
+    bool merge(SSAFunction &f, uint32_t b, CFGSimplifyStats &stats)
+    {
+        SSABlock &block = f.blocks[b];
+        if (block.terminator().op != IROp::JUMP)
+            return false;
+        uint32_t s = block.succs[0];
+        SSABlock &succ = f.blocks[s];
+        if (s == b || s == 0 || succ.preds.size() != 1)
+            return false;
+        for (const Phi &phi : succ.phis)
+        {
+            replacement[phi.result.index()] = phi.args[0];
+            touched.push_back(phi.result.index());
+        }
+        block.code.pop_back();
+        block.lines.pop_back();
+        block.code.insert(block.code.end(), succ.code.begin(), succ.code.end());
+        block.lines.insert(block.lines.end(), succ.lines.begin(), succ.lines.end());
+        block.succs = move(succ.succs);
+        for (uint32_t x : block.succs)
+            replace(f.blocks[x].preds.begin(), f.blocks[x].preds.end(), s, b);
+        succ = SSABlock();
+        dead[s] = 1;
+        stats.merged++;
+        return true;
+    }
+
+    // Drops unreachable blocks and orders the rest for fall-through;
+    // returns the number of blocks dropped.
+    size_t layout(SSAFunction &f)
+    {
+        uint32_t n = f.blockCount();
+        const uint32_t NONE = UINT32_MAX;
+        vector<uint8_t> reached(n, 0);
+        vector<uint32_t> stack{0};
+        reached[0] = 1;
+        while (!stack.empty())
+        {
+            uint32_t b = stack.back();
+            stack.pop_back();
+            for (uint32_t s : f.blocks[b].succs)
+                if (!reached[s])
+                {
+                    reached[s] = 1;
+                    stack.push_back(s);
+                }
+        }
+        for (uint32_t b = 0; b < n; b++)
+            if (!reached[b] && !dead[b])
+                for (uint32_t s : f.blocks[b].succs)
+                    if (reached[s])
+                        erasePred(f.blocks[s], f.blocks[s].predIndex(b));
+
+        // Chains of preferred successors, started in the original order
+        vector<uint32_t> order, index(n, NONE);
+        order.reserve(n);
+        for (uint32_t start = 0; start < n; start++)
+            for (uint32_t b = start; reached[b] && index[b] == NONE;)
+            {
+                index[b] = uint32_t(order.size());
+                order.push_back(b);
+                const auto &succs = f.blocks[b].succs;
+                uint32_t next = NONE;
+                if (succs.size() == 1)
+                    next = succs[0];
+                else if (succs.size() == 2)
+                    next = index[succs[1]] == NONE ? succs[1] : succs[0];
+                if (next == NONE)
+                    break;
+                b = next;
+            }
+
+        vector<SSABlock> blocks;
+        blocks.reserve(order.size());
+        for (uint32_t b : order)
+        {
+            SSABlock &block = f.blocks[b];
+            for (uint32_t &p : block.preds)
+                p = index[p];
+            for (uint32_t &s : block.succs)
+                s = index[s];
+            blocks.push_back(move(block));
+        }
+        size_t dropped = n - blocks.size();
+        f.blocks = move(blocks);
+        return dropped;
+    }
+};
+
+// CFG simplification over every function of a program in SSA form.
+inline CFGSimplifyStats simplifyCFGs(IRProgram &ir, vector<SSAFunction> &fns)
+{
+    CFGSimplifier pass;
+    CFGSimplifyStats total;
+    for (SSAFunction &f : fns)
+    {
+        CFGSimplifyStats s = pass.run(ir, f);
+        total.threaded += s.threaded;
+        total.merged += s.merged;
+        total.removed += s.removed;
+    }
+    return total;
+}
+
+#endif // IR_CFG_SIMPLIFY_CPP
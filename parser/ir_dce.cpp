@@ -0,0 +1,302 @@
+// ir_dce.cpp
+// Copy propagation and dead code elimination over SSA form; ir_optimizer.cpp runs them.
+#ifndef IR_DCE_CPP
+#define IR_DCE_CPP
+#ifndef IR_SSA_NO_MAIN
+#define IR_SSA_NO_MAIN
+#endif
+#include "ir_ssa.cpp"
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// ---------------------------------------------------------------------
+// Copy propagation
+// ---------------------------------------------------------------------
+// In SSA form a copy `t = x` of a temporary or constant means t is x
+// everywhere, so every read of t can read x and the copy goes. A phi whose
+// arguments are all one value (or the phi itself, around a loop) is such a
+// copy too. Copies of a global are kept: the global may change before t is
+// read.
+class CopyPropagation
+{
+public:
+    // Returns the number of copies and phis removed
+    size_t run(IRProgram &ir, SSAFunction &f)
+    {
+        if (replacement.size() < ir.tempCount)
+            replacement.resize(ir.tempCount);
+        size_t removed = 0;
+
+        for (uint32_t b = 0; b < f.blockCount(); b++)
+            for (const IRInstruction &in : f.blocks[b].code)
+                if (in.op == IROp::ASSIGN && in.result.kind() == Operand::Temp &&
+                    (in.arg1.kind() == Operand::Temp || in.arg1.kind() == Operand::Const))
+                    replace(in.result, in.arg1);
+
+        // A phi may only become trivial once its arguments are resolved
+        for (bool changed = true; changed;)
+        {
+            changed = false;
+            for (SSABlock &block : f.blocks)
+                for (const Phi &phi : block.phis)
+                {
+                    if (!replacement[phi.result.index()].empty())
+                        continue;
+                    Operand same;
+                    bool trivial = true;
+                    for (Operand a : phi.args)
+                    {
+                        a = resolve(a);
+                        if (a == phi.result || a == same)
+                            continue;
+                        if (!same.empty())
+                        {
+                            trivial = false;
+                            break;
+                        }
+                        same = a;
+                    }
+                    if (trivial && !same.empty())
+                    {
+                        replace(phi.result, same);
+                        changed = true;
+                    }
+                }
+        }
+
+        for (uint32_t b = 0; b < f.blockCount(); b++)
+        {
+            SSABlock &block = f.blocks[b];
+            size_t kept = 0;
+            for (size_t p = 0; p < block.phis.size(); p++)
+            {
+                if (!replacement[block.phis[p].result.index()].empty())
+                    continue;
+                for (Operand &a : block.phis[p].args)
+                    a = resolve(a);
+                if (kept != p)
+                    block.phis[kept] = move(block.phis[p]);
+                kept++;
+            }
+            removed += block.phis.size() - kept;
+            block.phis.resize(kept);
+
+            kept = 0;
+            for (size_t i = 0; i < block.code.size(); i++)
+            {
+                IRInstruction &in = block.code[i];
+                bool prologue = f.isPrologue(b, i);
+                if (in.op == IROp::ASSIGN && in.result.kind() == Operand::Temp &&
+                    !replacement[in.result.index()].empty())
+                    continue;
+                forEachUse(in, prologue, [&](Operand &o) { o = resolve(o); });
+                block.code[kept] = in;
+                block.lines[kept++] = block.lines[i];
+            }
+            removed += block.code.size() - kept;
+            block.code.erase(block.code.begin() + kept, block.code.end());
+            block.lines.resize(kept);
+        }
+        for (uint32_t t : touched)
+            replacement[t] = Operand();
+        touched.clear();
+        return removed;
+    }
+
+private:
+    vector<Operand> replacement; // by temp index; None when not a copy
+    vector<uint32_t> touched;
+
+    void replace(Operand t, Operand with)
+    {
+        replacement[t.index()] = with;
+        touched.push_back(t.index());
+    }
+
+    // The value a temporary copies, through chains of copies
+    Operand resolve(Operand o)
+    {
+        Operand root = o;
+        while (root.kind() == Operand::Temp && root.index() < replacement.size() &&
+               !replacement[root.index()].empty())
+            root = replacement[root.index()];
+        // Point the chain straight at its end for later lookups
+        while (o.kind() == Operand::Temp && o.index() < replacement.size() && !replacement[o.index()].empty() &&
+               replacement[o.index()] != root)
+        {
+            Operand next = replacement[o.index()];
+            replacement[o.index()] = root;
+            o = next;
+        }
+        return root;
+    }
+};
+
+// ---------------------------------------------------------------------
+// Dead code elimination
+// ---------------------------------------------------------------------
+// Mark and sweep over SSA def-use chains. Instructions with an effect are
+// live from the start: jumps, returns, calls and their PARAMs, stores to
+// globals, the prologue, and a DIV that could divide by zero. Then the
+// definition of every temporary a live instruction or phi reads is live.
+// Everything left unmarked computes a value nobody reads and is removed.
+class DeadCodeElimination
+{
+public:
+    // Returns the number of instructions and phis removed
+    size_t run(IRProgram &ir, SSAFunction &f)
+    {
+        if (definition.size() < ir.tempCount)
+            definition.resize(ir.tempCount, Site{NONE, 0});
+        live.clear();
+        work.clear();
+
+        // Where each temporary is defined, and the instructions live as given
+        for (uint32_t b = 0; b < f.blockCount(); b++)
+        {
+            SSABlock &block = f.blocks[b];
+            uint32_t phiCount = uint32_t(block.phis.size());
+            live.push_back(vector<uint8_t>(phiCount + block.code.size(), 0));
+            for (uint32_t p = 0; p < phiCount; p++)
+                define(block.phis[p].result, b, p);
+            for (uint32_t i = 0; i < block.code.size(); i++)
+            {
+                const IRInstruction &in = block.code[i];
+                bool prologue = f.isPrologue(b, i);
+                const Operand *d = defOf(in, prologue);
+                if (d)
+                    define(*d, b, phiCount + i);
+                if (prologue || !d || d->kind() != Operand::Temp || hasEffect(ir, in))
+                    mark(b, phiCount + i);
+            }
+        }
+
+        while (!work.empty())
+        {
+            Site s = work.back();
+            work.pop_back();
+            SSABlock &block = f.blocks[s.block];
+            uint32_t phiCount = uint32_t(block.phis.size());
+            auto need = [&](Operand o)
+            {
+                if (o.kind() != Operand::Temp || o.index() >= definition.size())
+                    return;
+                Site d = definition[o.index()];
+                if (d.block != NONE)
+                    mark(d.block, d.pos);
+            };
+            if (s.pos < phiCount)
+                for (Operand a : block.phis[s.pos].args)
+                    need(a);
+            else
+                forEachUse(block.code[s.pos - phiCount], f.isPrologue(s.block, s.pos - phiCount), need);
+        }
+
+        size_t removed = 0;
+        for (uint32_t b = 0; b < f.blockCount(); b++)
+        {
+            SSABlock &block = f.blocks[b];
+            uint32_t phiCount = uint32_t(block.phis.size());
+            size_t kept = 0;
+            for (uint32_t p = 0; p < phiCount; p++)
+                if (live[b][p])
+                {
+                    if (kept != p)
+                        block.phis[kept] = move(block.phis[p]);
+                    kept++;
+                }
+            block.phis.resize(kept);
+            kept = 0;
+            for (uint32_t i = 0; i < block.code.size(); i++)
+                if (live[b][phiCount + i])
+                {
+                    block.code[kept] = block.code[i];
+                    block.lines[kept++] = block.lines[i];
+                }
+            removed += phiCount + block.code.size() - block.phis.size() - kept;
+            block.code.erase(block.code.begin() + kept, block.code.end());
+            block.lines.resize(kept);
+        }
+        for (uint32_t t : touched)
+            definition[t] = Site{NONE, 0};
+        touched.clear();
+        return removed;
+    }
+
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+    struct Site
+    {
+        uint32_t block, pos; // pos: phi index, or phi count + instruction index
+    };
+
+    vector<Site> definition; // by temp index
+    vector<uint32_t> touched;
+    vector<vector<uint8_t>> live;
+    vector<Site> work;
+
+    static bool hasEffect(const IRProgram &ir, const IRInstruction &in)
+    {
+        switch (in.op)
+        {
+        case IROp::CALL:
+        case IROp::PARAM:
+        case IROp::RET:
+        case IROp::JUMP:
+        case IROp::JUMP_TRUE:
+        case IROp::JUMP_FALSE:
+            return true;
+        case IROp::DIV:
+        {
+            if (in.arg2.kind() != Operand::Const)
+                return true;
+            const string &t = ir.constants[in.arg2.index()].text;
+            return t.find_first_not_of("0.") == string::npos;
+        }
+        default:
+            return false;
+        }
+    }
+
+    void define(Operand o, uint32_t b, uint32_t pos)
+    {
+        if (o.kind() != Operand::Temp)
+            return;
+        definition[o.index()] = Site{b, pos};
+        touched.push_back(o.index());
+    }
+
+    void mark(uint32_t b, uint32_t pos)
+    {
+        if (live[b][pos])
+            return;
+        live[b][pos] = 1;
+        work.push_back(Site{b, pos});
+    }
+};
+
+// Copy propagation over every function of a program in SSA form; returns
+// the copies removed.
+inline size_t propagateCopies(IRProgram &ir, vector<SSAFunction> &fns)
+{
+    CopyPropagation pass;
+    size_t removed = 0;
+    for (SSAFunction &f : fns)
+        removed += pass.run(ir, f);
+    return removed;
+}
+
+// Dead code elimination over every function of a program in SSA form;
+// returns the instructions and phis removed.
+inline size_t eliminateDeadCode(IRProgram &ir, vector<SSAFunction> &fns)
+{
+    DeadCodeElimination pass;
+    size_t removed = 0;
+    for (SSAFunction &f : fns)
+        removed += pass.run(ir, f);
+    return removed;
+}
+
+#endif // IR_DCE_CPP
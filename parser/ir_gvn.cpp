@@ -0,0 +1,266 @@
+// ir_gvn.cpp
+// Local and dominator-based global value numbering over SSA form; ir_optimizer.cpp runs it.
+#ifndef IR_GVN_CPP
+#define IR_GVN_CPP
+#ifndef IR_SSA_NO_MAIN
+#define IR_SSA_NO_MAIN
+#endif
+#include "ir_ssa.cpp"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+// ---------------------------------------------------------------------
+// Value numbering
+// ---------------------------------------------------------------------
+// The generator gives every BinaryExpr (and IndexExpr's address) a fresh
+// temporary, so `a*b + a*b` computes a*b twice. In SSA form a temporary
+// never changes, so an expression over temporaries and constants can be
+// hashed on its operator, type and operands: when the same key was computed
+// in a block that dominates this one (or earlier in this block), this
+// computation is dropped and its result reads the earlier one.
+//
+// The table is scoped along a preorder walk of the dominator tree and what
+// a block added is taken out when its subtree is done. With `global` off the
+// table is emptied at every block instead, which is plain local value
+// numbering. Keys are canonical: the operands of a commutative operator are
+// ordered and a > b is keyed as b < a. Expressions reading a global are not
+// numbered, as a store or a call may change it in between. Two phis of one
+// block with the same arguments are the same value too.
+struct ValueNumberingStats
+{
+    size_t local = 0;  // redundant within their block (phis included)
+    size_t global = 0; // made redundant by a dominating block
+};
+
+class ValueNumbering
+{
+public:
+    bool global = true;
+
+    ValueNumberingStats run(IRProgram &ir, SSAFunction &f)
+    {
+        ValueNumberingStats stats;
+        if (replacement.size() < ir.tempCount)
+            replacement.resize(ir.tempCount);
+        table.clear();
+        if (global)
+        {
+            DominatorTree dt;
+            dt.compute(f);
+            // preorder is depth-first, so a block's scope ends at the first
+            // block after it that it does not dominate
+
+            vector<uint32_t> open;
+            vector<size_t> marks;
+            for (uint32_t b : dt.preorder)
+            {
+                while (!open.empty() && !dt.dominates(open.back(), b))
+                {
+                    closeScope(marks.back());
+                    open.pop_back();
+                    marks.pop_back();
+                }
+                open.push_back(b);
+                marks.push_back(added.size());
+                numberBlock(f, b, stats);
+            }
+        }
+        else
+            for (uint32_t b = 0; b < f.blockCount(); b++)
+            {
+                numberBlock(f, b, stats);
+                closeScope(0);
+            }
+        closeScope(0);
+
+        if (!touched.empty())
+        {
+            // Phi arguments along back edges, and uses the walk did not reach
+            for (uint32_t b = 0; b < f.blockCount(); b++)
+            {
+                SSABlock &block = f.blocks[b];
+                for (Phi &phi : block.phis)
+                    for (Operand &a : phi.args)
+                        a = resolve(a);
+                for (size_t i = 0; i < block.code.size(); i++)
+                    forEachUse(block.code[i], f.isPrologue(b, i), [&](Operand &o) { o = resolve(o); });
+            }
+            for (uint32_t t : touched)
+                replacement[t] = Operand();
+            touched.clear();
+        }
+        return stats;
+    }
+
+private:
+    struct Expr
+    {
+        IROp op;
+        ValueType type;
+        Operand a, b;
+        bool operator==(const Expr &o) const { return op == o.op && type == o.type && a == o.a && b == o.b; }
+    };
+    struct ExprHash
+    {
+        size_t operator()(const Expr &e) const
+        {
+            uint64_t h = uint64_t(e.a.bits) << 32 | e.b.bits;
+            h ^= (uint64_t(e.op) << 8 | uint64_t(e.type)) * 0x9e3779b97f4a7c15ull;
+            h *= 0xff51afd7ed558ccdull;
+            return size_t(h ^ h >> 32);
+        }
+    };
+    struct Value
+    {
+        Operand temp;
+        uint32_t block;
+    };
+
+    unordered_map<Expr, Value, ExprHash> table;
+    vector<Expr> added; // keys in the order entered, for closing scopes
+    vector<Operand> replacement; // by temp index: the earlier temp it repeats
+    vector<uint32_t> touched;
+
+    Operand resolve(Operand o) const
+    {
+        while (o.kind() == Operand::Temp && o.index() < replacement.size() && !replacement[o.index()].empty())
+            o = replacement[o.index()];
+        return o;
+    }
+
+    void replace(Operand t, Operand with)
+    {
+        replacement[t.index()] = with;
+        touched.push_back(t.index());
+    }
+
+    void closeScope(size_t mark)
+    {
+        for (size_t k = added.size(); k > mark; k--)
+            table.erase(added[k - 1]);
+        added.resize(mark);
+    }
+
+    static bool numbered(IROp op)
+    {
+        switch (op)
+        {
+        case IROp::ADD:
+        case IROp::SUB:
+        case IROp::MUL:
+        case IROp::DIV: // a repeat only runs if the first did not throw
+        case IROp::EQ:
+        case IROp::NE:
+        case IROp::LT:
+        case IROp::LE:
+        case IROp::GT:
+        case IROp::GE:
+        case IROp::LAND:
+        case IROp::LOR:
+        case IROp::LNOT:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    static Expr key(const IRInstruction &in)
+    {
+        Expr e{in.op, in.type, in.arg1, in.arg2};
+        switch (e.op)
+        {
+        case IROp::GT:
+            e.op = IROp::LT;
+            swap(e.a, e.b);
+            break;
+        case IROp::GE:
+            e.op = IROp::LE;
+            swap(e.a, e.b);
+            break;
+        case IROp::ADD:
+        case IROp::MUL:
+        case IROp::EQ:
+        case IROp::NE:
+        case IROp::LAND:
+        case IROp::LOR:
+            if (e.b.bits < e.a.bits)
+                swap(e.a, e.b);
+            break;
+        default:
+            break;
+        }
+        return e;
+    }
+
+    void numberBlock(SSAFunction &f, uint32_t b, ValueNumberingStats &stats)
+    {
+        SSABlock &block = f.blocks[b];
+        size_t kept = 0;
+        for (size_t p = 0; p < block.phis.size(); p++)
+        {
+            Phi &phi = block.phis[p];
+            for (Operand &a : phi.args)
+                a = resolve(a);
+            size_t same = 0;
+            while (same < kept && block.phis[same].args != phi.args)
+                same++;
+            if (same < kept)
+            {
+                replace(phi.result, block.phis[same].result);
+                stats.local++;
+                continue;
+            }
+            if (kept != p)
+                block.phis[kept] = move(phi);
+            kept++;
+        }
+        block.phis.resize(kept);
+
+        kept = 0;
+        for (size_t i = 0; i < block.code.size(); i++)
+        {
+            IRInstruction &in = block.code[i];
+            bool prologue = f.isPrologue(b, i);
+            forEachUse(in, prologue, [&](Operand &o) { o = resolve(o); });
+            if (!prologue && numbered(in.op) && in.result.kind() == Operand::Temp &&
+                in.arg1.kind() != Operand::Symbol && in.arg2.kind() != Operand::Symbol)
+            {
+                Expr e = key(in);
+                auto found = table.find(e);
+                if (found != table.end())
+                {
+                    replace(in.result, found->second.temp);
+                    (found->second.block == b ? stats.local : stats.global)++;
+                    continue;
+                }
+                table.emplace(e, Value{in.result, b});
+                added.push_back(e);
+            }
+            block.code[kept] = in;
+            block.lines[kept++] = block.lines[i];
+        }
+        block.code.erase(block.code.begin() + kept, block.code.end());
+        block.lines.resize(kept);
+    }
+};
+
+// Value numbering over every function of a program in SSA form; local
+// only when `global` is false.
+inline ValueNumberingStats numberValues(IRProgram &ir, vector<SSAFunction> &fns, bool global = true)
+{
+    ValueNumbering pass;
+    pass.global = global;
+    ValueNumberingStats total;
+    for (SSAFunction &f : fns)
+    {
+        ValueNumberingStats s = pass.run(ir, f);
+        total.local += s.local;
+        total.global += s.global;
+    }
+    return total;
+}
+
+#endif // IR_GVN_CPP
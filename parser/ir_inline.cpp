@@ -0,0 +1,406 @@
+// ir_inline.cpp
+// Function inlining over SSA form, driven by call-site cost heuristics; ir_optimizer.cpp runs it.
+#ifndef IR_INLINE_CPP
+#define IR_INLINE_CPP
+#ifndef IR_SSA_NO_MAIN
+#define IR_SSA_NO_MAIN
+#endif
+#include "ir_ssa.cpp"
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// ---------------------------------------------------------------------
+// Inlining
+// ---------------------------------------------------------------------
+// A CALL takes the most recent PARAMs, as many as the callee has
+// parameters. Inlining a call site puts a copy of the callee's blocks in
+// the caller, with fresh temporaries (and so fresh labels, given when the
+// blocks are laid out): each PARAM becomes a copy into the parameter it
+// feeds, where it stood, so arguments are still read in order; the CALL
+// ends its block with a jump to the copy of the callee's entry, each RET
+// jumps to a block holding the rest of the caller's block, and a phi there
+// receives the returned values.
+//
+// Callers are visited callees first, along a depth-first walk of the call
+// graph, so a callee is inlined with what was inlined into it. A call back
+// to a function still being walked is recursion and is left alone, as are
+// calls whose PARAMs are not in sight (in another block ahead of a
+// branch) and callees that never return. A call site is inlined when the
+// callee is small, or when it is the callee's only call site; a caller
+// stops taking callees past a size limit, and the whole program past a
+// growth budget (an only call site does not count, as its callee goes).
+// A function whose every call was inlined is removed, unless something
+// else names it; functions never called are kept, whatever they are for.
+struct InlineOptions
+{
+    size_t smallCallee = 12;    // instructions and phis; callees this small are always inlined
+    bool singleCallSite = true; // also inline a callee called from one place only
+    size_t maxCaller = 2000;    // callers at this size take no more callees
+    double growth = 0.5;        // the program may grow by this fraction of its size
+};
+
+struct InlineDecision
+{
+    Operand caller, callee; // function symbols
+    int line;               // of the call
+    size_t size;            // callee instructions and phis copied
+    bool small;             // false when inlined as the only call site
+};
+
+struct InlineReport
+{
+    size_t sites = 0;   // direct calls to functions with code
+    size_t removed = 0; // functions all of whose calls were inlined
+    size_t before = 0, after = 0; // instructions and phis in the functions
+    vector<InlineDecision> inlined;
+};
+
+class Inliner
+{
+public:
+    InlineReport run(IRProgram &ir, vector<SSAFunction> &fns, const InlineOptions &options = InlineOptions())
+    {
+        InlineReport report;
+        uint32_t n = uint32_t(fns.size());
+        functionOf.assign(ir.symbols.size(), NONE);
+        for (uint32_t k = 0; k < n; k++)
+            if (ir.functions[k].name.kind() == Operand::Symbol)
+                functionOf[ir.functions[k].name.index()] = k;
+
+        // Sizes, call sites, and the call graph
+        size.assign(n, 0);
+        callSites.assign(n, 0);
+        vector<vector<uint32_t>> callees(n);
+        for (uint32_t k = 0; k < n; k++)
+            for (const SSABlock &block : fns[k].blocks)
+            {
+                size[k] += block.phis.size() + block.code.size();
+                for (const IRInstruction &in : block.code)
+                    if (uint32_t g = callee(in); g != NONE)
+                    {
+                        callSites[g]++;
+                        callees[k].push_back(g);
+                    }
+            }
+        uint32_t at = 0;
+        for (uint32_t k = 0; k <= n; k++)
+        {
+            // calls from global initializers count, but stay calls
+            uint32_t end = k < n ? ir.functions[k].begin : uint32_t(ir.code.size());
+            for (; at < end; at++)
+                if (uint32_t g = callee(ir.code[at]); g != NONE)
+                    callSites[g]++;
+            if (k < n)
+                at = ir.functions[k].end;
+        }
+        wasCalled.assign(n, 0);
+        for (uint32_t k = 0; k < n; k++)
+        {
+            report.before += size[k];
+            report.sites += callSites[k];
+            wasCalled[k] = callSites[k] > 0;
+        }
+        budget = report.before + size_t(double(report.before) * options.growth);
+        total = report.before;
+
+        // Finishing order of a depth-first walk: callees before callers,
+        // except along the recursive calls
+        finished.assign(n, NONE);
+        vector<uint8_t> started(n, 0);
+        vector<pair<uint32_t, uint32_t>> stack;
+        vector<uint32_t> order;
+        for (uint32_t root = 0; root < n; root++)
+        {
+            if (started[root])
+                continue;
+            started[root] = 1;
+            stack.push_back({root, 0});
+            while (!stack.empty())
+            {
+                auto &[k, next] = stack.back();
+                if (next < callees[k].size())
+                {
+                    uint32_t g = callees[k][next++];
+                    if (!started[g])
+                    {
+                        started[g] = 1;
+                        stack.push_back({g, 0});
+                    }
+                    continue;
+                }
+                finished[k] = uint32_t(order.size());
+                order.push_back(k);
+                stack.pop_back();
+            }
+        }
+
+        for (uint32_t k : order)
+            inlineInto(ir, fns, k, options, report);
+        report.removed = removeInlined(ir, fns);
+        for (const SSAFunction &f : fns)
+            for (const SSABlock &block : f.blocks)
+                report.after += block.phis.size() + block.code.size();
+        return report;
+    }
+
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    vector<uint32_t> functionOf; // by symbol index
+    vector<size_t> size, callSites;
+    vector<uint8_t> wasCalled;
+    vector<uint32_t> finished; // position in the walk's finishing order
+    size_t budget = 0, total = 0;
+    vector<Operand> renamed; // by callee temp index, while copying
+    vector<uint32_t> touched;
+
+    uint32_t callee(const IRInstruction &in) const
+    {
+        if (in.op != IROp::CALL || in.arg1.kind() != Operand::Symbol || in.arg1.index() >= functionOf.size())
+            return NONE;
+        return functionOf[in.arg1.index()];
+    }
+
+    bool inlinable(const vector<SSAFunction> &fns, uint32_t k, uint32_t g) const
+    {
+        // A callee finished after its caller is one the walk came back to
+        if (g == k || finished[g] >= finished[k])
+            return false;
+        const SSAFunction &f = fns[g];
+        if (f.blocks.empty() || !f.blocks[0].preds.empty())
+            return false;
+        for (const SSABlock &block : f.blocks)
+            if (block.terminator().op == IROp::RET)
+                return true;
+        return false;
+    }
+
+    Operand rename(IRProgram &ir, Operand o)
+    {
+        if (o.kind() != Operand::Temp)
+            return o;
+        if (o.index() >= renamed.size())
+            renamed.resize(o.index() + 1);
+        if (renamed[o.index()].empty())
+        {
+            renamed[o.index()] = ir.newTemp();
+            touched.push_back(o.index());
+        }
+        return renamed[o.index()];
+    }
+
+    struct Site
+    {
+        uint32_t block;
+        size_t index;
+    };
+
+    void inlineInto(IRProgram &ir, vector<SSAFunction> &fns, uint32_t k, const InlineOptions &options,
+                    InlineReport &report)
+    {
+        SSAFunction &f = fns[k];
+        uint32_t original = f.blockCount();
+        vector<Site> params;
+        for (uint32_t start = 0; start < original; start++)
+        {
+            // PARAMs pending from other blocks are not visible
+            params.clear();
+            uint32_t b = start;
+            for (size_t i = 0; i < f.blocks[b].code.size(); i++)
+            {
+                const IRInstruction &in = f.blocks[b].code[i];
+                if (in.op == IROp::PARAM && !f.isPrologue(b, i))
+                {
+                    params.push_back({b, i});
+                    continue;
+                }
+                if (in.op != IROp::CALL)
+                    continue;
+                uint32_t g = callee(in);
+                uint32_t count = g == NONE ? 0 : fns[g].source.paramCount;
+                if (g == NONE || params.size() < count)
+                {
+                    // Whatever it takes is out of sight
+                    params.clear();
+                    continue;
+                }
+                vector<Site> args(params.end() - count, params.end());
+                params.resize(params.size() - count);
+                bool small = size[g] <= options.smallCallee;
+                bool single = options.singleCallSite && callSites[g] == 1 &&
+                              ir.operandText(fns[g].source.name) != "main";
+                // The only call site's callee goes away after, so it does
+                // not count against the budget
+                if (!inlinable(fns, k, g) || !(small || single) || size[k] + size[g] > options.maxCaller ||
+                    (!single && total + size[g] > budget))
+                    continue;
+
+                report.inlined.push_back({f.source.name, fns[g].source.name, f.blocks[b].lines[i], size[g], small});
+                size[k] += size[g];
+                if (!single)
+                    total += size[g];
+                callSites[g]--;
+                // The rest of the block moves on; carry on scanning there
+                b = inlineCall(ir, f, fns[g], b, i, args);
+                i = size_t(-1);
+            }
+        }
+    }
+
+    // Inlines the CALL at code[i] of block b; returns the block with the
+    // code that followed the call
+    uint32_t inlineCall(IRProgram &ir, SSAFunction &f, const SSAFunction &g, uint32_t b, size_t i,
+                        const vector<Site> &args)
+    {
+        IRInstruction call = f.blocks[b].code[i];
+        int line = f.blocks[b].lines[i];
+        uint32_t base = f.blockCount();
+        uint32_t rest = base + g.blockCount();
+
+        // Arguments are copied into the callee's parameters where passed
+        for (size_t p = 0; p < args.size(); p++)
+        {
+            IRInstruction &param = f.blocks[args[p].block].code[args[p].index];
+            param = IRInstruction(IROp::ASSIGN, rename(ir, g.blocks[0].code[p].result), param.result, Operand(),
+                                  ValueType::Unknown);
+        }
+
+        Phi returned{call.result, call.result, {}};
+        for (uint32_t cb = 0; cb < g.blockCount(); cb++)
+        {
+            const SSABlock &from = g.blocks[cb];
+            SSABlock to;
+            for (const Phi &phi : from.phis)
+            {
+                Phi copy{rename(ir, phi.result), phi.var, {}};
+                for (Operand a : phi.args)
+                    copy.args.push_back(rename(ir, a));
+                to.phis.push_back(move(copy));
+            }
+            for (size_t j = cb == 0 ? g.source.paramCount : 0; j < from.code.size(); j++)
+            {
+                IRInstruction in = from.code[j];
+                in.result = rename(ir, in.result);
+                in.arg1 = rename(ir, in.arg1);
+                in.arg2 = rename(ir, in.arg2);
+                to.code.push_back(in);
+                to.lines.push_back(from.lines[j]);
+            }
+            for (uint32_t p : from.preds)
+                to.preds.push_back(base + p);
+            for (uint32_t s : from.succs)
+                to.succs.push_back(base + s);
+            if (to.terminator().op == IROp::RET)
+            {
+                returned.args.push_back(to.terminator().result.empty() ? f.undef : to.terminator().result);
+                to.terminator() = IRInstruction(IROp::JUMP, Operand());
+                to.succs.push_back(rest);
+            }
+            f.blocks.push_back(move(to));
+        }
+        f.blocks[base].preds.push_back(b);
+        for (uint32_t t : touched)
+            renamed[t] = Operand();
+        touched.clear();
+
+        SSABlock after;
+        SSABlock &block = f.blocks[b];
+        after.code.assign(block.code.begin() + i + 1, block.code.end());
+        after.lines.assign(block.lines.begin() + i + 1, block.lines.end());
+        after.succs = move(block.succs);
+        for (uint32_t s : after.succs)
+            replace(f.blocks[s].preds.begin(), f.blocks[s].preds.end(), b, rest);
+        for (uint32_t cb = base; cb < rest; cb++)
+            if (!f.blocks[cb].succs.empty() && f.blocks[cb].succs.back() == rest)
+                after.preds.push_back(cb);
+        if (!call.result.empty())
+            after.phis.push_back(move(returned));
+        block.code.erase(block.code.begin() + i, block.code.end());
+        block.lines.resize(i);
+        block.code.emplace_back(IROp::JUMP, Operand());
+        block.lines.push_back(line);
+        block.succs = {base};
+        f.blocks.push_back(move(after));
+        return rest;
+    }
+
+    // Drops the functions all of whose calls were inlined, when no
+    // instruction names them any more; returns how many
+    size_t removeInlined(IRProgram &ir, vector<SSAFunction> &fns)
+    {
+        uint32_t n = uint32_t(fns.size());
+        vector<uint8_t> named(n, 0);
+        for (uint32_t k = 0; k < n; k++)
+            named[k] = !wasCalled[k] || callSites[k] > 0 || ir.operandText(ir.functions[k].name) == "main";
+        auto see = [&](Operand o)
+        {
+            if (o.kind() == Operand::Symbol && o.index() < functionOf.size() && functionOf[o.index()] != NONE)
+                named[functionOf[o.index()]] = 1;
+        };
+        auto scan = [&](const IRInstruction &in)
+        {
+            if (in.op == IROp::LABEL)
+                return;
+            see(in.result);
+            see(in.arg1);
+            see(in.arg2);
+        };
+        uint32_t at = 0;
+        for (uint32_t k = 0; k <= n; k++)
+        {
+            uint32_t end = k < n ? ir.functions[k].begin : uint32_t(ir.code.size());
+            for (; at < end; at++)
+                scan(ir.code[at]);
+            if (k < n)
+                at = ir.functions[k].end;
+        }
+        for (const SSAFunction &f : fns)
+            for (const SSABlock &block : f.blocks)
+                for (const IRInstruction &in : block.code)
+                    scan(in);
+
+        vector<IRInstruction> code;
+        vector<int> lines;
+        vector<IRFunction> functions;
+        vector<SSAFunction> kept;
+        at = 0;
+        for (uint32_t k = 0; k <= n; k++)
+        {
+            uint32_t end = k < n ? ir.functions[k].begin : uint32_t(ir.code.size());
+            code.insert(code.end(), ir.code.begin() + at, ir.code.begin() + end);
+            lines.insert(lines.end(), ir.lines.begin() + at, ir.lines.begin() + end);
+            if (k == n)
+                break;
+            IRFunction fn = ir.functions[k];
+            at = fn.end;
+            if (!named[k])
+                continue;
+            uint32_t begin = uint32_t(code.size());
+            code.insert(code.end(), ir.code.begin() + fn.begin, ir.code.begin() + fn.end);
+            lines.insert(lines.end(), ir.lines.begin() + fn.begin, ir.lines.begin() + fn.end);
+            fn.end = begin + (fn.end - fn.begin);
+            fn.begin = begin;
+            functions.push_back(fn);
+            kept.push_back(move(fns[k]));
+            kept.back().source = fn;
+        }
+        size_t removed = n - kept.size();
+        ir.code = move(code);
+        ir.lines = move(lines);
+        ir.functions = move(functions);
+        fns = move(kept);
+        return removed;
+    }
+};
+
+// Inlining over every function of a program in SSA form.
+inline InlineReport inlineCalls(IRProgram &ir, vector<SSAFunction> &fns,
+                                const InlineOptions &options = InlineOptions())
+{
+    Inliner pass;
+    return pass.run(ir, fns, options);
+}
+
+#endif // IR_INLINE_CPP
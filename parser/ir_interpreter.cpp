@@ -0,0 +1,455 @@
+// ir_interpreter.cpp
+// Define IR_INTERPRETER_NO_MAIN before including to reuse the interpreter in another driver.
+#ifndef IR_INTERPRETER_CPP
+#define IR_INTERPRETER_CPP
+#ifndef IR_GENERATOR_NO_MAIN
+#define IR_GENERATOR_NO_MAIN
+#endif
+#include "irGenerator.cpp"
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// ---------------------------------------------------------------------
+// Values
+// ---------------------------------------------------------------------
+// Ints are 32-bit and wrap; chars and bools are held as integers, strings
+// as the index of their constant. A variable or temporary nobody assigned
+// reads as the int 0.
+struct IRValue
+{
+    ValueType type = ValueType::Int;
+    int64_t i = 0;
+    double f = 0;
+
+    bool truth() const { return type == ValueType::Float ? f != 0 : i != 0; }
+    double asFloat() const { return type == ValueType::Float ? f : double(i); }
+};
+
+// ---------------------------------------------------------------------
+// IR interpreter
+// ---------------------------------------------------------------------
+// Runs an IRProgram as the generator lays it out: the code outside any
+// function initializes the globals, then the entry function is called.
+// PARAMs outside a function's prologue push arguments; a CALL takes as
+// many of the most recent ones as the callee has parameters. Each
+// function's code is decoded once up front: operands are renumbered to
+// frame slots, constants are parsed, labels become instruction indexes and
+// are dropped, so `steps` counts only the instructions that do work.
+class IRInterpreter
+{
+public:
+    uint64_t steps = 0;
+    // Control transfers executed: JUMPs, conditional jumps, and how many of
+    // the conditional ones were taken
+    uint64_t jumps = 0, branches = 0, taken = 0;
+    uint64_t calls = 0;
+    uint64_t stepLimit = UINT64_MAX;
+    size_t depthLimit = 10000;
+
+    explicit IRInterpreter(const IRProgram &ir) : ir(ir)
+    {
+        values.reserve(ir.constants.size());
+        for (const IRConstant &c : ir.constants)
+            values.push_back(parseConstant(c, uint32_t(values.size())));
+        functionIndex.assign(ir.symbols.size(), NONE);
+        for (uint32_t k = 0; k < ir.functions.size(); k++)
+            if (ir.functions[k].name.kind() == Operand::Symbol)
+                functionIndex[ir.functions[k].name.index()] = k;
+        for (const IRFunction &fn : ir.functions)
+            functions.push_back(decode(fn.begin + 1, fn.end, fn.paramCount));
+
+        // Everything between the functions initializes globals
+        vector<pair<uint32_t, uint32_t>> ranges;
+        uint32_t at = 0;
+        for (const IRFunction &fn : ir.functions)
+        {
+            ranges.push_back({at, fn.begin});
+            at = fn.end;
+        }
+        ranges.push_back({at, uint32_t(ir.code.size())});
+        init = decode(ranges, 0);
+    }
+
+    // Initializes the globals and calls `entry` with `args`
+    IRValue run(const string &entry = "main", const vector<IRValue> &args = {})
+    {
+        globals.assign(ir.symbols.size(), IRValue());
+        stack.clear();
+        arguments.clear();
+        steps = jumps = branches = taken = calls = 0;
+        stack.resize(init.slots);
+        execute(init, 0);
+        stack.clear();
+        for (uint32_t k = 0; k < ir.functions.size(); k++)
+            if (ir.operandText(ir.functions[k].name) == entry)
+            {
+                arguments = args;
+                return call(k);
+            }
+        throw runtime_error("IR has no function " + entry);
+    }
+
+    IRValue global(const string &name) const
+    {
+        for (uint32_t s = 0; s < ir.symbols.size(); s++)
+            if (ir.symbols[s] == name && ir.globals[s])
+                return globals[s];
+        return IRValue();
+    }
+
+    string text(const IRValue &v) const
+    {
+        switch (v.type)
+        {
+        case ValueType::Float:
+        {
+            ostringstream os;
+            os << v.f;
+            return os.str();
+        }
+        case ValueType::Bool:
+            return v.i ? "true" : "false";
+        case ValueType::Char:
+            return "'" + string(1, char(v.i)) + "'";
+        case ValueType::String:
+            return ir.constants[v.i].text;
+        default:
+            return to_string(v.i);
+        }
+    }
+
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    // Decoded code: Temp operands are frame slots, Const operands index
+    // `values`, Symbol operands are globals, Label operands instruction
+    // indexes, and a CALL's arg1 is a Label holding the callee's index.
+    struct Function
+    {
+        vector<IRInstruction> code;
+        vector<uint32_t> params; // slots the prologue binds, in order
+        uint32_t slots = 0;
+    };
+
+    const IRProgram &ir;
+    vector<IRValue> values;
+    vector<uint32_t> functionIndex; // by symbol
+    vector<Function> functions;
+    Function init;
+    vector<IRValue> globals, stack, arguments;
+    size_t depth = 0;
+
+    static IRValue parseConstant(const IRConstant &c, uint32_t index)
+    {
+        IRValue v;
+        v.type = c.type == ValueType::Unknown ? ValueType::Int : c.type;
+        switch (v.type)
+        {
+        case ValueType::Float:
+            v.f = strtod(c.text.c_str(), nullptr);
+            break;
+        case ValueType::Bool:
+            v.i = c.text == "true";
+            break;
+        case ValueType::Char:
+            v.i = c.text.size() >= 3 ? (unsigned char)c.text[1] : 0;
+            break;
+        case ValueType::String:
+            v.i = index;
+            break;
+        default:
+            v.i = int32_t(strtoll(c.text.c_str(), nullptr, 10));
+        }
+        return v;
+    }
+
+    Function decode(uint32_t begin, uint32_t end, uint32_t params) { return decode({{begin, end}}, params); }
+
+    Function decode(const vector<pair<uint32_t, uint32_t>> &ranges, uint32_t params)
+    {
+        Function fn;
+        unordered_map<uint32_t, uint32_t> slot, labels; // operand bits -> slot, label bits -> index
+        auto local = [&](Operand o)
+        {
+            auto [it, added] = slot.try_emplace(o.bits, fn.slots);
+            if (added)
+                fn.slots++;
+            return Operand(Operand::Temp, it->second);
+        };
+        auto map = [&](Operand o)
+        {
+            if (o.kind() == Operand::Temp || ir.isLocal(o))
+                return local(o);
+            return o;
+        };
+        for (auto [begin, end] : ranges)
+            for (uint32_t i = begin; i < end; i++)
+            {
+                IRInstruction in = ir.code[i];
+                if (in.op == IROp::LABEL)
+                {
+                    labels[in.result.bits] = uint32_t(fn.code.size());
+                    continue;
+                }
+                if (in.op == IROp::PARAM && fn.params.size() < params)
+                {
+                    fn.params.push_back(map(in.result).index());
+                    continue;
+                }
+                if (in.op == IROp::CALL && in.arg1.kind() == Operand::Symbol)
+                {
+                    uint32_t k = functionIndex[in.arg1.index()];
+                    in.arg1 = k == NONE ? Operand() : Operand(Operand::Label, k);
+                }
+                else
+                    in.arg1 = map(in.arg1);
+                if (in.op != IROp::JUMP && in.op != IROp::JUMP_TRUE && in.op != IROp::JUMP_FALSE)
+                    in.result = map(in.result);
+                in.arg2 = map(in.arg2);
+                fn.code.push_back(in);
+            }
+        for (IRInstruction &in : fn.code)
+            if (in.op == IROp::JUMP || in.op == IROp::JUMP_TRUE || in.op == IROp::JUMP_FALSE)
+            {
+                auto it = labels.find(in.result.bits);
+                if (it == labels.end())
+                    throw runtime_error("IR jump to a label outside its function");
+                in.result = Operand(Operand::Label, it->second);
+            }
+        return fn;
+    }
+
+    IRValue call(uint32_t k)
+    {
+        const Function &fn = functions[k];
+        if (arguments.size() < fn.params.size())
+            throw runtime_error("call to " + ir.operandText(ir.functions[k].name) + " with too few arguments");
+        if (++depth > depthLimit)
+            throw runtime_error("IR call depth limit exceeded");
+        size_t frame = stack.size();
+        stack.resize(frame + fn.slots);
+        size_t first = arguments.size() - fn.params.size();
+        for (size_t p = 0; p < fn.params.size(); p++)
+            stack[frame + fn.params[p]] = arguments[first + p];
+        arguments.resize(first);
+        IRValue result = execute(fn, frame);
+        stack.resize(frame);
+        depth--;
+        return result;
+    }
+
+    IRValue &slot(size_t frame, Operand o) { return o.kind() == Operand::Temp ? stack[frame + o.index()] : globals[o.index()]; }
+
+    IRValue read(size_t frame, Operand o)
+    {
+        switch (o.kind())
+        {
+        case Operand::Const:
+            return values[o.index()];
+        case Operand::Temp:
+            return stack[frame + o.index()];
+        case Operand::Symbol:
+            return globals[o.index()];
+        default:
+            return IRValue();
+        }
+    }
+
+    static IRValue boolean(bool b)
+    {
+        IRValue v;
+        v.type = ValueType::Bool;
+        v.i = b;
+        return v;
+    }
+
+    IRValue arithmetic(const IRInstruction &in, const IRValue &x, const IRValue &y)
+    {
+        IRValue v;
+        if (in.type == ValueType::Float || x.type == ValueType::Float || y.type == ValueType::Float)
+        {
+            double p = x.asFloat(), q = y.asFloat();
+            v.type = ValueType::Float;
+            switch (in.op)
+            {
+            case IROp::ADD:
+                v.f = p + q;
+                break;
+            case IROp::SUB:
+                v.f = p - q;
+                break;
+            case IROp::MUL:
+                v.f = p * q;
+                break;
+            default:
+                if (q == 0)
+                    throw runtime_error("division by zero");
+                v.f = p / q;
+            }
+            return v;
+        }
+        if (x.type == ValueType::String || y.type == ValueType::String)
+            throw runtime_error("arithmetic on a string");
+        int64_t p = x.i, q = y.i, r;
+        switch (in.op)
+        {
+        case IROp::ADD:
+            r = p + q;
+            break;
+        case IROp::SUB:
+            r = p - q;
+            break;
+        case IROp::MUL:
+            r = p * q;
+            break;
+        default:
+            if (q == 0)
+                throw runtime_error("division by zero");
+            r = p / q;
+        }
+        v.i = int32_t(uint32_t(uint64_t(r)));
+        return v;
+    }
+
+    IRValue compare(const IRInstruction &in, const IRValue &x, const IRValue &y)
+    {
+        int c;
+        if (x.type == ValueType::String && y.type == ValueType::String)
+            c = ir.constants[x.i].text.compare(ir.constants[y.i].text);
+        else if (x.type == ValueType::Float || y.type == ValueType::Float)
+            c = x.asFloat() < y.asFloat() ? -1 : x.asFloat() > y.asFloat() ? 1 : 0;
+        else
+            c = x.i < y.i ? -1 : x.i > y.i ? 1 : 0;
+        switch (in.op)
+        {
+        case IROp::EQ:
+            return boolean(c == 0);
+        case IROp::NE:
+            return boolean(c != 0);
+        case IROp::LT:
+            return boolean(c < 0);
+        case IROp::LE:
+            return boolean(c <= 0);
+        case IROp::GT:
+            return boolean(c > 0);
+        default:
+            return boolean(c >= 0);
+        }
+    }
+
+    IRValue execute(const Function &fn, size_t frame)
+    {
+        const IRInstruction *code = fn.code.data();
+        size_t pc = 0, n = fn.code.size();
+        while (pc < n)
+        {
+            if (++steps > stepLimit)
+                throw runtime_error("IR step limit exceeded");
+            const IRInstruction &in = code[pc++];
+            switch (in.op)
+            {
+            case IROp::ASSIGN:
+                slot(frame, in.result) = read(frame, in.arg1);
+                break;
+            case IROp::ADD:
+            case IROp::SUB:
+            case IROp::MUL:
+            case IROp::DIV:
+                slot(frame, in.result) = arithmetic(in, read(frame, in.arg1), read(frame, in.arg2));
+                break;
+            case IROp::EQ:
+            case IROp::NE:
+            case IROp::LT:
+            case IROp::LE:
+            case IROp::GT:
+            case IROp::GE:
+                slot(frame, in.result) = compare(in, read(frame, in.arg1), read(frame, in.arg2));
+                break;
+            case IROp::LAND:
+                slot(frame, in.result) = boolean(read(frame, in.arg1).truth() && read(frame, in.arg2).truth());
+                break;
+            case IROp::LOR:
+                slot(frame, in.result) = boolean(read(frame, in.arg1).truth() || read(frame, in.arg2).truth());
+                break;
+            case IROp::LNOT:
+                slot(frame, in.result) = boolean(!read(frame, in.arg1).truth());
+                break;
+            case IROp::JUMP:
+                jumps++;
+                pc = in.result.index();
+                break;
+            case IROp::JUMP_TRUE:
+            case IROp::JUMP_FALSE:
+                branches++;
+                if (read(frame, in.arg1).truth() == (in.op == IROp::JUMP_TRUE))
+                {
+                    taken++;
+                    pc = in.result.index();
+                }
+                break;
+            case IROp::PARAM:
+                arguments.push_back(read(frame, in.result));
+                break;
+            case IROp::CALL:
+            {
+                if (in.arg1.kind() != Operand::Label)
+                    throw runtime_error("call to a function with no code");
+                calls++;
+                IRValue r = call(in.arg1.index());
+                if (!in.result.empty())
+                    slot(frame, in.result) = r;
+                break;
+            }
+            case IROp::RET:
+                return read(frame, in.result);
+            case IROp::LABEL:
+                break;
+            }
+        }
+        return IRValue();
+    }
+};
+
+#ifndef IR_INTERPRETER_NO_MAIN
+// ---------------------------------------------------------------------
+// Main Driver: runs main() of sample.txt on its IR
+// ---------------------------------------------------------------------
+int main(int argc, char **argv)
+{
+    const string inputFile = argc > 1 ? argv[1] : "sample.txt";
+    try
+    {
+        ifstream file(inputFile);
+        if (!file.is_open())
+            throw runtime_error("Cannot open file: " + inputFile);
+        stringstream buffer;
+        buffer << file.rdbuf();
+
+        RegexLexer lexer(buffer.str());
+        Parser parser(lexer.tokenize());
+        Program program = parser.parseProgram();
+        TypeChecker checker;
+        checker.check(program);
+        ScopeChecker resolver;
+        resolver.analyse(program);
+        IRGenerator irGen;
+        const IRProgram &ir = irGen.generateIR(program);
+        IRInterpreter interpreter(ir);
+        IRValue result = interpreter.run();
+        cout << "main returned " << interpreter.text(result) << " (" << interpreter.steps
+             << " instructions executed)\n";
+    }
+    catch (const exception &e)
+    {
+        cout << "ERROR: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+#endif // IR_INTERPRETER_NO_MAIN
+#endif // IR_INTERPRETER_CPP
@@ -0,0 +1,508 @@
+// ir_loops.cpp
+// Loop-invariant code motion and induction-variable strength reduction over SSA form; ir_optimizer.cpp runs them.
+#ifndef IR_LOOPS_CPP
+#define IR_LOOPS_CPP
+#ifndef IR_SSA_NO_MAIN
+#define IR_SSA_NO_MAIN
+#endif
+#include "ir_ssa.cpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+using namespace std;
+
+// ---------------------------------------------------------------------
+// Natural loops
+// ---------------------------------------------------------------------
+// An edge b -> h where h dominates b is a back edge, and its loop is h
+// plus every block that reaches b without passing through h. Back edges to
+// one header make one loop. The blocks are kept in dominator tree
+// preorder, so a definition comes before the uses it dominates.
+struct Loop
+{
+    uint32_t header = 0;
+    uint32_t preheader = 0;  // set by LoopOptimizer once inserted
+    vector<uint32_t> blocks; // header first
+};
+
+inline vector<Loop> findLoops(const SSAFunction &f, const DominatorTree &dt)
+{
+    uint32_t n = f.blockCount();
+    vector<Loop> loops;
+    vector<uint32_t> mark(n, UINT32_MAX), work;
+    for (uint32_t h : dt.preorder)
+    {
+        work.clear();
+        for (uint32_t p : f.blocks[h].preds)
+            if (dt.dominates(h, p))
+                work.push_back(p);
+        if (work.empty())
+            continue;
+        uint32_t id = uint32_t(loops.size());
+        mark[h] = id;
+        for (uint32_t b : work)
+            mark[b] = id;
+        for (size_t k = 0; k < work.size(); k++)
+            for (uint32_t p : f.blocks[work[k]].preds)
+                if (mark[p] != id && dt.reachable(p))
+                {
+                    mark[p] = id;
+                    work.push_back(p);
+                }
+        Loop loop;
+        loop.header = h;
+        for (uint32_t b : dt.preorder)
+            if (mark[b] == id)
+                loop.blocks.push_back(b);
+        loops.push_back(move(loop));
+    }
+    return loops;
+}
+
+// ---------------------------------------------------------------------
+// Loop optimization
+// ---------------------------------------------------------------------
+// Loops are handled innermost first. Each gets a preheader, a block that
+// every entry into the loop passes through and that only jumps to the
+// header; an existing predecessor serves when it is the only way in and
+// has no other successor. Then:
+//   - an instruction whose operands are constants or temporaries defined
+//     outside the loop computes the same value on every iteration, and is
+//     moved to the end of the preheader. Only the operators value numbering
+//     treats as pure qualify, DIV only by a nonzero constant (the loop may
+//     never have run it), and nothing reading a global, which the loop may
+//     store to. What moves out of an inner loop lands in a block of the
+//     outer one and may move again.
+//   - a header phi i = phi(init, i + c) is a basic induction variable when
+//     every back edge brings the same i + c (or i - c) with c invariant.
+//     An int product j = i * k with k invariant then follows i: a new
+//     header phi j' starts at init * k and adds c * k next to the update of
+//     i, both products computed in the preheader, and j reads j'. The
+//     product becomes an add, and ints wrap, so j' is always exactly i * k.
+//     So does (i + d) * k for an invariant d, the shape of base + i * w
+//     indexing, and j' is an induction variable for the products after it.
+struct LoopStats
+{
+    size_t loops = 0;   // natural loops found
+    size_t hoisted = 0; // instructions moved to a preheader
+    size_t reduced = 0; // multiplications replaced by an induction variable
+};
+
+class LoopOptimizer
+{
+public:
+    bool strengthReduction = true;
+
+    LoopStats run(IRProgram &ir, SSAFunction &f)
+    {
+        LoopStats stats;
+        DominatorTree dt;
+        dt.compute(f);
+        vector<Loop> loops = findLoops(f, dt);
+        if (loops.empty())
+            return stats;
+        stats.loops = loops.size();
+        // Inner loops are strictly smaller than the loops around them
+        stable_sort(loops.begin(), loops.end(),
+                    [](const Loop &a, const Loop &b) { return a.blocks.size() < b.blocks.size(); });
+
+        if (defBlock.size() < ir.tempCount)
+        {
+            defBlock.resize(ir.tempCount, NONE);
+            replacement.resize(ir.tempCount);
+        }
+        for (uint32_t b = 0; b < f.blockCount(); b++)
+        {
+            const SSABlock &block = f.blocks[b];
+            for (const Phi &phi : block.phis)
+                define(phi.result, b);
+            for (size_t i = 0; i < block.code.size(); i++)
+                if (const Operand *d = defOf(block.code[i], f.isPrologue(b, i)))
+                    define(*d, b);
+        }
+
+        for (size_t l = 0; l < loops.size(); l++)
+        {
+            Loop &loop = loops[l];
+            if (loop.header == 0)
+                continue; // the entry has no way in to put a preheader on
+            inLoop.assign(f.blockCount(), 0);
+            for (uint32_t b : loop.blocks)
+                inLoop[b] = 1;
+            insertPreheader(ir, f, loops, l);
+            inLoop.resize(f.blockCount(), 0);
+            stats.hoisted += hoist(ir, f, loop);
+            if (strengthReduction)
+                stats.reduced += reduce(ir, f, loop);
+        }
+
+        if (!touched.empty())
+        {
+            for (uint32_t b = 0; b < f.blockCount(); b++)
+            {
+                SSABlock &block = f.blocks[b];
+                for (Phi &phi : block.phis)
+                    for (Operand &a : phi.args)
+                        a = resolve(a);
+                for (size_t i = 0; i < block.code.size(); i++)
+                    forEachUse(block.code[i], f.isPrologue(b, i), [&](Operand &o) { o = resolve(o); });
+            }
+            for (uint32_t t : touched)
+                replacement[t] = Operand();
+        }
+        for (uint32_t t : touched)
+            defBlock[t] = NONE;
+        touched.clear();
+        return stats;
+    }
+
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    vector<uint32_t> defBlock;   // by temp index
+    vector<Operand> replacement; // by temp index: the induction variable a product became
+    vector<uint32_t> touched;
+    vector<uint8_t> inLoop;
+
+    void define(Operand o, uint32_t b)
+    {
+        if (o.kind() != Operand::Temp)
+            return;
+        if (o.index() >= defBlock.size())
+        {
+            defBlock.resize(o.index() + 1, NONE);
+            replacement.resize(o.index() + 1);
+        }
+        defBlock[o.index()] = b;
+        touched.push_back(o.index());
+    }
+
+    Operand resolve(Operand o) const
+    {
+        while (o.kind() == Operand::Temp && o.index() < replacement.size() && !replacement[o.index()].empty())
+            o = replacement[o.index()];
+        return o;
+    }
+
+    bool invariant(Operand o) const
+    {
+        switch (o.kind())
+        {
+        case Operand::None:
+        case Operand::Const:
+            return true;
+        case Operand::Temp:
+            return defBlock[o.index()] != NONE && !inLoop[defBlock[o.index()]];
+        default:
+            return false;
+        }
+    }
+
+    static bool readInt(const IRProgram &ir, Operand o, long long &value)
+    {
+        if (o.kind() != Operand::Const)
+            return false;
+        const string &text = ir.constants[o.index()].text;
+        char *end = nullptr;
+        value = strtoll(text.c_str(), &end, 10);
+        return !text.empty() && *end == '\0';
+    }
+
+    // x * y at the end of block b: folded when both are int constants, or
+    // one is 0 or 1
+    Operand multiply(IRProgram &ir, SSAFunction &f, uint32_t b, Operand x, Operand y, int line)
+    {
+        long long vx = 0, vy = 0;
+        bool cx = readInt(ir, x, vx), cy = readInt(ir, y, vy);
+        if (cx && cy)
+            return ir.constant(ValueType::Int, to_string(int32_t(uint32_t(vx) * uint32_t(vy))));
+        if ((cx && vx == 0) || (cy && vy == 1))
+            return x;
+        if ((cy && vy == 0) || (cx && vx == 1))
+            return y;
+        Operand t = ir.newTemp();
+        f.blocks[b].insertBeforeTerminator(IRInstruction(IROp::MUL, t, x, y, ValueType::Int), line);
+        define(t, b);
+        return t;
+    }
+
+    void insertPreheader(IRProgram &ir, SSAFunction &f, vector<Loop> &loops, size_t l)
+    {
+        uint32_t h = loops[l].header;
+        auto inside = [&](uint32_t b) { return inLoop[b] != 0; };
+        vector<uint32_t> outside;
+        for (uint32_t p : f.blocks[h].preds)
+            if (!inside(p))
+                outside.push_back(p);
+        if (outside.size() == 1 && f.blocks[outside[0]].succs.size() == 1)
+        {
+            loops[l].preheader = outside[0];
+            return;
+        }
+
+        uint32_t pre = f.blockCount();
+        SSABlock block;
+        block.code.emplace_back(IROp::JUMP, Operand());
+        block.lines.push_back(f.blocks[h].lines.front());
+        block.preds = outside;
+        block.succs.push_back(h);
+        SSABlock &header = f.blocks[h];
+        // The header keeps one slot for the preheader, then its back edges;
+        // phi arguments from outside merge in a phi of the preheader
+        vector<uint32_t> preds{pre};
+        for (Phi &phi : header.phis)
+        {
+            vector<Operand> in, args{Operand()};
+            for (size_t k = 0; k < header.preds.size(); k++)
+                (inside(header.preds[k]) ? args : in).push_back(phi.args[k]);
+            if (all_of(in.begin(), in.end(), [&](Operand a) { return a == in[0]; }))
+                args[0] = in[0];
+            else
+            {
+                args[0] = ir.newTemp();
+                block.phis.push_back(Phi{args[0], phi.var, move(in)});
+                define(args[0], pre);
+            }
+            phi.args = move(args);
+        }
+        for (uint32_t p : header.preds)
+            if (inside(p))
+                preds.push_back(p);
+        header.preds = move(preds);
+        for (uint32_t p : outside)
+            replace(f.blocks[p].succs.begin(), f.blocks[p].succs.end(), h, pre);
+        f.blocks.push_back(move(block));
+        loops[l].preheader = pre;
+
+        // The preheader sits in every loop around this one, before the header
+        for (size_t m = l + 1; m < loops.size(); m++)
+        {
+            vector<uint32_t> &outer = loops[m].blocks;
+            auto at = find(outer.begin(), outer.end(), h);
+            if (at != outer.end() && loops[m].header != h)
+                outer.insert(at, pre);
+        }
+    }
+
+    static bool pure(const IRProgram &ir, const IRInstruction &in)
+    {
+        switch (in.op)
+        {
+        case IROp::ADD:
+        case IROp::SUB:
+        case IROp::MUL:
+        case IROp::EQ:
+        case IROp::NE:
+        case IROp::LT:
+        case IROp::LE:
+        case IROp::GT:
+        case IROp::GE:
+        case IROp::LAND:
+        case IROp::LOR:
+        case IROp::LNOT:
+            return true;
+        case IROp::DIV:
+            return in.arg2.kind() == Operand::Const &&
+                   ir.constants[in.arg2.index()].text.find_first_not_of("0.") != string::npos;
+        default:
+            return false;
+        }
+    }
+
+    size_t hoist(const IRProgram &ir, SSAFunction &f, const Loop &loop)
+    {
+        size_t moved = 0;
+        for (uint32_t b : loop.blocks)
+        {
+            SSABlock &block = f.blocks[b];
+            size_t kept = 0;
+            for (size_t i = 0; i < block.code.size(); i++)
+            {
+                IRInstruction in = block.code[i];
+                int line = block.lines[i];
+                if (pure(ir, in) && in.result.kind() == Operand::Temp && invariant(in.arg1) &&
+                    invariant(in.arg2))
+                {
+                    f.blocks[loop.preheader].insertBeforeTerminator(in, line);
+                    defBlock[in.result.index()] = loop.preheader;
+                    moved++;
+                    continue;
+                }
+                block.code[kept] = in;
+                block.lines[kept++] = line;
+            }
+            block.code.erase(block.code.begin() + kept, block.code.end());
+            block.lines.resize(kept);
+        }
+        return moved;
+    }
+
+    struct Induction
+    {
+        Operand value; // the header phi
+        Operand init;  // its argument from the preheader
+        Operand next;  // i + c, what every back edge brings
+        IROp op;       // ADD or SUB
+        Operand step;  // c
+    };
+    // x = i + d or i - d, with i an induction variable and d invariant
+    struct Derived
+    {
+        size_t iv;
+        IROp op;
+        Operand offset;
+    };
+
+    size_t reduce(IRProgram &ir, SSAFunction &f, const Loop &loop)
+    {
+        uint32_t h = loop.header, pre = loop.preheader;
+        uint32_t slot = f.blocks[h].predIndex(pre);
+        vector<Induction> ivs;
+        for (const Phi &phi : f.blocks[h].phis)
+        {
+            Operand next;
+            bool same = true;
+            for (uint32_t k = 0; k < phi.args.size(); k++)
+                if (k != slot)
+                {
+                    same = same && (next.empty() || phi.args[k] == next);
+                    next = phi.args[k];
+                }
+            if (!same || next.kind() != Operand::Temp || defBlock[next.index()] == NONE ||
+                !inLoop[defBlock[next.index()]])
+                continue;
+            const IRInstruction *update = nullptr;
+            for (const IRInstruction &in : f.blocks[defBlock[next.index()]].code)
+                if (in.result == next)
+                    update = &in;
+            // ++ and -- leave the type Unknown; their step is the int 1
+            long long one;
+            if (!update || (update->type != ValueType::Int &&
+                            !(update->type == ValueType::Unknown && readInt(ir, update->arg2, one))))
+                continue;
+            Operand init = phi.args[slot];
+            if (update->op == IROp::ADD && update->arg1 == phi.result && invariant(update->arg2))
+                ivs.push_back({phi.result, init, next, IROp::ADD, update->arg2});
+            else if (update->op == IROp::ADD && update->arg2 == phi.result && invariant(update->arg1))
+                ivs.push_back({phi.result, init, next, IROp::ADD, update->arg1});
+            else if (update->op == IROp::SUB && update->arg1 == phi.result && invariant(update->arg2))
+                ivs.push_back({phi.result, init, next, IROp::SUB, update->arg2});
+        }
+        if (ivs.empty())
+            return 0;
+
+        size_t reduced = 0;
+        vector<pair<Operand, Derived>> derived;
+        auto find = [&](Operand o, Derived &d)
+        {
+            for (size_t v = 0; v < ivs.size(); v++)
+                if (ivs[v].value == o)
+                {
+                    d = Derived{v, IROp::ADD, Operand()};
+                    return true;
+                }
+            for (const auto &x : derived)
+                if (x.first == o)
+                {
+                    d = x.second;
+                    return true;
+                }
+            return false;
+        };
+        for (uint32_t b : loop.blocks)
+        {
+            for (size_t i = 0; i < f.blocks[b].code.size(); i++)
+            {
+                IRInstruction &in = f.blocks[b].code[i];
+                if (in.type != ValueType::Int || in.result.kind() != Operand::Temp)
+                    continue;
+                in.arg1 = resolve(in.arg1);
+                in.arg2 = resolve(in.arg2);
+                Derived d;
+                if ((in.op == IROp::ADD || in.op == IROp::SUB) && find(in.arg1, d) && d.offset.empty() &&
+                    invariant(in.arg2))
+                {
+                    derived.push_back({in.result, Derived{d.iv, in.op, in.arg2}});
+                    continue;
+                }
+                if (in.op == IROp::ADD && find(in.arg2, d) && d.offset.empty() && invariant(in.arg1))
+                {
+                    derived.push_back({in.result, Derived{d.iv, IROp::ADD, in.arg1}});
+                    continue;
+                }
+                Operand k;
+                if (in.op != IROp::MUL)
+                    continue;
+                if (find(in.arg1, d) && invariant(in.arg2))
+                    k = in.arg2;
+                else if (find(in.arg2, d) && invariant(in.arg1))
+                    k = in.arg1;
+                else
+                    continue;
+
+                // j' = (init op offset) * k, stepping by c * k
+                Operand product = in.result;
+                Induction iv = ivs[d.iv];
+                int line = f.blocks[b].lines[i];
+                Operand start = iv.init;
+                if (!d.offset.empty())
+                {
+                    start = ir.newTemp();
+                    f.blocks[pre].insertBeforeTerminator(IRInstruction(d.op, start, iv.init, d.offset, ValueType::Int),
+                                                         line);
+                    define(start, pre);
+                }
+                Operand init = multiply(ir, f, pre, start, k, line);
+                Operand step = multiply(ir, f, pre, iv.step, k, line);
+                Operand j = ir.newTemp(), jNext = ir.newTemp();
+                Phi phi{j, product, vector<Operand>(f.blocks[h].preds.size(), jNext)};
+                phi.args[slot] = init;
+                f.blocks[h].phis.push_back(move(phi));
+                define(j, h);
+
+                // j' + c*k right after i + c
+                uint32_t u = defBlock[iv.next.index()];
+                SSABlock &update = f.blocks[u];
+                size_t at = 0;
+                while (update.code[at].result != iv.next)
+                    at++;
+                update.code.insert(update.code.begin() + at + 1, IRInstruction(iv.op, jNext, j, step, ValueType::Int));
+                update.lines.insert(update.lines.begin() + at + 1, update.lines[at]);
+                define(jNext, u);
+                if (u == b && at < i)
+                    i++;
+                // which is an induction variable in turn
+                ivs.push_back({j, init, jNext, iv.op, step});
+
+                replacement[product.index()] = j;
+                SSABlock &block = f.blocks[b];
+                block.code.erase(block.code.begin() + i);
+                block.lines.erase(block.lines.begin() + i);
+                i--;
+                reduced++;
+            }
+        }
+        return reduced;
+    }
+};
+
+// Loop optimization over every function of a program in SSA form;
+// invariant code motion only when `strengthReduction` is false.
+inline LoopStats optimizeLoops(IRProgram &ir, vector<SSAFunction> &fns, bool strengthReduction = true)
+{
+    LoopOptimizer pass;
+    pass.strengthReduction = strengthReduction;
+    LoopStats total;
+    for (SSAFunction &f : fns)
+    {
+        LoopStats s = pass.run(ir, f);
+        total.loops += s.loops;
+        total.hoisted += s.hoisted;
+        total.reduced += s.reduced;
+    }
+    return total;
+}
+
+#endif // IR_LOOPS_CPP
@@ -0,0 +1,149 @@
+// ir_optimizer.cpp
+// Define IR_OPTIMIZER_NO_MAIN before including to reuse the optimizer in another driver.
+#ifndef IR_OPTIMIZER_CPP
+#define IR_OPTIMIZER_CPP
+#ifndef IR_SCCP_NO_MAIN
+#define IR_SCCP_NO_MAIN
+#endif
+#include "ir_sccp.cpp"
+#include "ir_inline.cpp"
+#include "ir_dce.cpp"
+#include "ir_gvn.cpp"
+#include "ir_loops.cpp"
+#include "ir_cfg_simplify.cpp"
+#ifndef IR_INTERPRETER_NO_MAIN
+#define IR_INTERPRETER_NO_MAIN
+#endif
+#include "ir_interpreter.cpp"
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+// ---------------------------------------------------------------------
+// Optimization stage after IRGenerator::generateIR
+// ---------------------------------------------------------------------
+// Takes every function into SSA form, runs the enabled passes in order,
+// and rewrites the program from the result. Code outside the functions
+// (global initializers) is left as generated.
+struct OptimizerOptions
+{
+    bool inlining = true;  // inline small and single-call-site callees
+    InlineOptions inliner;
+    bool constants = true; // sparse conditional constant propagation
+    bool copies = true;    // copy propagation
+    bool values = true;    // value numbering: redundant computations reuse earlier ones
+    bool globalValues = true; // across dominating blocks, not only within a block
+    bool loops = true;     // loop-invariant code motion
+    // Induction variables for products in loops. Off by default: the
+    // interpreter charges a multiply like an add, and the add plus the copy
+    // at the back edge only pay off when a chain such as (base + i * w) * k
+    // goes with it.
+    bool strengthReduction = false;
+    bool deadCode = true;  // dead code elimination
+    bool simplifyCFG = true; // jump threading, block merging and layout
+};
+
+struct OptimizerReport
+{
+    size_t before = 0, after = 0; // instructions
+    InlineReport inlining;
+    SCCPStats constants;
+    size_t copies = 0, deadCode = 0;
+    ValueNumberingStats values;
+    LoopStats loops;
+    CFGSimplifyStats cfg;
+};
+
+inline OptimizerReport optimizeIR(IRProgram &ir, const OptimizerOptions &options = OptimizerOptions())
+{
+    OptimizerReport report;
+    report.before = ir.code.size();
+    vector<SSAFunction> fns = toSSA(ir);
+    if (options.inlining)
+        report.inlining = inlineCalls(ir, fns, options.inliner);
+    if (options.constants)
+        report.constants = propagateConstants(ir, fns);
+    if (options.copies)
+        report.copies = propagateCopies(ir, fns);
+    if (options.values)
+        report.values = numberValues(ir, fns, options.globalValues);
+    if (options.loops)
+        report.loops = optimizeLoops(ir, fns, options.strengthReduction);
+    if (options.deadCode)
+        report.deadCode = eliminateDeadCode(ir, fns);
+    if (options.simplifyCFG)
+        report.cfg = simplifyCFGs(ir, fns);
+    fromSSA(ir, fns);
+    report.after = ir.code.size();
+    return report;
+}
+
+inline void printReport(ostream &os, const IRProgram &ir, const OptimizerReport &r)
+{
+    os << "Instructions: " << r.before << " -> " << r.after << "\n";
+    os << "  inlined: " << r.inlining.inlined.size() << " of " << r.inlining.sites << " call sites, "
+       << r.inlining.removed << " functions removed\n";
+    for (const InlineDecision &d : r.inlining.inlined)
+        os << "    " << ir.operandText(d.callee) << " into " << ir.operandText(d.caller) << " at line " << d.line
+           << " (" << d.size << " instructions, " << (d.small ? "small" : "only call site") << ")\n";
+    os << "  constants: " << r.constants.folded << " folded, " << r.constants.branches << " branches decided, "
+       << r.constants.blocks << " blocks removed\n";
+    os << "  copies propagated: " << r.copies << "\n";
+    os << "  redundant computations: " << r.values.local << " local, " << r.values.global << " global\n";
+    os << "  loops: " << r.loops.loops << " found, " << r.loops.hoisted << " instructions hoisted, "
+       << r.loops.reduced << " multiplications strength-reduced\n";
+    os << "  dead code removed: " << r.deadCode << "\n";
+    os << "  CFG: " << r.cfg.threaded << " jumps threaded, " << r.cfg.merged << " blocks merged, " << r.cfg.removed
+       << " blocks removed\n";
+}
+
+#ifndef IR_OPTIMIZER_NO_MAIN
+// ---------------------------------------------------------------------
+// Main Driver: sample.txt's IR optimized, and main() run before and after
+// ---------------------------------------------------------------------
+int main(int argc, char **argv)
+{
+    const string inputFile = argc > 1 ? argv[1] : "sample.txt";
+    try
+    {
+        ifstream file(inputFile);
+        if (!file.is_open())
+            throw runtime_error("Cannot open file: " + inputFile);
+        stringstream buffer;
+        buffer << file.rdbuf();
+
+        RegexLexer lexer(buffer.str());
+        Parser parser(lexer.tokenize());
+        Program program = parser.parseProgram();
+        TypeChecker checker;
+        checker.check(program);
+        ScopeChecker resolver;
+        resolver.analyse(program);
+        IRGenerator irGen;
+        irGen.generateIR(program);
+        IRProgram &ir = irGen.program();
+
+        IRInterpreter before(ir);
+        IRValue expected = before.run();
+        OptimizerReport report = optimizeIR(ir);
+        ir.print(cout);
+        cout << "\n";
+        printReport(cout, ir, report);
+        IRInterpreter after(ir);
+        IRValue result = after.run();
+        cout << "main returned " << after.text(result) << ": " << before.steps << " -> " << after.steps
+             << " instructions executed, " << before.jumps + before.branches << " -> " << after.jumps + after.branches
+             << " jumps and branches, " << before.calls << " -> " << after.calls << " calls\n";
+        if (before.text(expected) != after.text(result))
+            cout << "MISMATCH: main returned " << before.text(expected) << " before optimizing\n";
+    }
+    catch (const exception &e)
+    {
+        cout << "ERROR: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+#endif // IR_OPTIMIZER_NO_MAIN
+#endif // IR_OPTIMIZER_CPP
@@ -0,0 +1,525 @@
+// ir_regalloc.cpp
+// Define IR_REGALLOC_NO_MAIN before including to reuse the register allocator in another driver.
+#ifndef IR_REGALLOC_CPP
+#define IR_REGALLOC_CPP
+#ifndef IR_OPTIMIZER_NO_MAIN
+#define IR_OPTIMIZER_NO_MAIN
+#endif
+#include "ir_optimizer.cpp"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+// ---------------------------------------------------------------------
+// Liveness of temporaries
+// ---------------------------------------------------------------------
+// Backward data flow over the CFG of one stretch of code (a function, or
+// the global initializers between two functions), one bit per temp the
+// stretch mentions:
+//   live-in(b)  = use(b) | (live-out(b) & ~def(b))
+//   live-out(b) = live-in of b's successors, or'ed
+// iterated in postorder until no set changes. use(b) holds the temps b
+// reads before writing them. Each kind of set is one flat word array
+// with a row per block. Variables are symbols that live in the frame and
+// are not tracked.
+class Liveness
+{
+public:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    vector<uint32_t> temps;             // temp index of each tracked number
+    uint32_t words = 0;                 // per set
+    vector<uint64_t> use, def, in, out; // blockCount() rows of `words` each
+    uint32_t prologueEnd = 0;           // code index past the parameters' PARAMs
+    size_t rounds = 0;                  // passes over the blocks
+    size_t maxPressure = 0;             // most temps live at one point
+
+    // Computes the sets for g, forgetting the previous stretch's numbering
+    void compute(const IRProgram &ir, const CFG &g)
+    {
+        for (uint32_t t : temps)
+            numbering[t] = NONE;
+        temps.clear();
+        if (numbering.size() < ir.tempCount)
+            numbering.resize(ir.tempCount, NONE);
+        const IRFunction &fn = g.function;
+        prologueEnd = fn.begin;
+        for (uint32_t i = fn.begin, params = 0; i < fn.end && params < fn.paramCount; i++)
+            if (ir.code[i].op == IROp::PARAM)
+            {
+                params++;
+                prologueEnd = i + 1;
+            }
+        for (uint32_t i = fn.begin; i < fn.end; i++)
+        {
+            IRInstruction in = ir.code[i];
+            forEachUse(in, isPrologue(ir, i), [&](Operand o) { track(o); });
+            if (const Operand *d = defOf(in, isPrologue(ir, i)))
+                track(*d);
+        }
+
+        uint32_t n = g.blockCount();
+        words = uint32_t((temps.size() + 63) / 64);
+        use.assign(size_t(n) * words, 0);
+        def.assign(size_t(n) * words, 0);
+        in.assign(size_t(n) * words, 0);
+        out.assign(size_t(n) * words, 0);
+        for (uint32_t b = 0; b < n; b++)
+            for (uint32_t i = g.begin(b); i < g.end(b); i++)
+            {
+                const IRInstruction &code = ir.code[i];
+                forEachUse(code, isPrologue(ir, i), [&](Operand o)
+                           {
+                               uint32_t v = number(o);
+                               if (v != NONE && !test(def, b, v))
+                                   set(use, b, v);
+                           });
+                if (const Operand *d = defOf(code, isPrologue(ir, i)))
+                    if (number(*d) != NONE)
+                        set(def, b, number(*d));
+            }
+
+        // Postorder visits successors first; unreachable blocks go last
+        vector<uint32_t> order(g.rpo.rbegin(), g.rpo.rend());
+        for (uint32_t b = 0; b < n; b++)
+            if (!g.reachable(b))
+                order.push_back(b);
+        rounds = 0;
+        for (bool changed = true; changed;)
+        {
+            changed = false;
+            rounds++;
+            for (uint32_t b : order)
+            {
+                uint64_t *o = row(out, b), *i = row(in, b);
+                const uint64_t *u = row(use, b), *d = row(def, b);
+                for (uint32_t s : g.successors(b))
+                {
+                    const uint64_t *si = row(in, s);
+                    for (uint32_t w = 0; w < words; w++)
+                        o[w] |= si[w];
+                }
+                for (uint32_t w = 0; w < words; w++)
+                {
+                    uint64_t live = u[w] | (o[w] & ~d[w]);
+                    if (live != i[w])
+                    {
+                        i[w] = live;
+                        changed = true;
+                    }
+                }
+            }
+        }
+
+        // Pressure: walk each block backwards from its live-out set,
+        // counting a dead result as live where it is written
+        maxPressure = 0;
+        vector<uint64_t> live(words);
+        for (uint32_t b = 0; b < n; b++)
+        {
+            copy(row(out, b), row(out, b) + words, live.begin());
+            size_t count = 0;
+            for (uint64_t w : live)
+                count += size_t(__builtin_popcountll(w));
+            maxPressure = max(maxPressure, count);
+            for (uint32_t i = g.end(b); i-- > g.begin(b);)
+            {
+                const IRInstruction &code = ir.code[i];
+                if (const Operand *d = defOf(code, isPrologue(ir, i)))
+                {
+                    uint32_t v = number(*d);
+                    if (v != NONE)
+                    {
+                        if (!flip(live, v, false))
+                            maxPressure = max(maxPressure, count + 1);
+                        else
+                            count--;
+                    }
+                }
+                forEachUse(code, isPrologue(ir, i), [&](Operand o)
+                           {
+                               uint32_t v = number(o);
+                               if (v != NONE && !flip(live, v, true))
+                                   count++;
+                           });
+                maxPressure = max(maxPressure, count);
+            }
+        }
+    }
+
+    uint32_t number(Operand o) const
+    {
+        return o.kind() == Operand::Temp && o.index() < numbering.size() ? numbering[o.index()] : NONE;
+    }
+
+    bool isPrologue(const IRProgram &ir, uint32_t i) const { return i < prologueEnd && ir.code[i].op == IROp::PARAM; }
+
+    uint64_t *row(vector<uint64_t> &sets, uint32_t b) { return sets.data() + size_t(b) * words; }
+    const uint64_t *row(const vector<uint64_t> &sets, uint32_t b) const { return sets.data() + size_t(b) * words; }
+    bool test(const vector<uint64_t> &sets, uint32_t b, uint32_t v) const { return row(sets, b)[v / 64] >> (v % 64) & 1; }
+    void set(vector<uint64_t> &sets, uint32_t b, uint32_t v) { row(sets, b)[v / 64] |= uint64_t(1) << (v % 64); }
+
+private:
+    vector<uint32_t> numbering; // by temp index, NONE outside the stretch
+
+    void track(Operand o)
+    {
+        if (o.kind() != Operand::Temp || numbering[o.index()] != NONE)
+            return;
+        numbering[o.index()] = uint32_t(temps.size());
+        temps.push_back(o.index());
+    }
+
+    // Sets or clears bit v of `live`; returns what it held before
+    static bool flip(vector<uint64_t> &live, uint32_t v, bool value)
+    {
+        uint64_t bit = uint64_t(1) << (v % 64);
+        bool was = live[v / 64] & bit;
+        live[v / 64] = value ? live[v / 64] | bit : live[v / 64] & ~bit;
+        return was;
+    }
+};
+
+// ---------------------------------------------------------------------
+// Linear-scan register allocation
+// ---------------------------------------------------------------------
+// Poletto and Sarkar's allocator over one stretch at a time. Instruction
+// i reads its operands at position 2i and writes its result at 2i + 1;
+// each temp gets one interval from its first to its last position, where
+// live-in extends it to the start of a block and live-out to the end.
+// Intervals are visited by start, and those that ended free their
+// registers. When none is free, whichever of the new interval and the
+// active ones ends last is spilled to a frame slot.
+//
+// Temps are then renumbered: after allocation temp tN is register N of
+// the target machine, and the IR still runs on the interpreter. A spilled
+// temp lives in a local symbol, spill.K; when any temp spills the last two
+// registers are held back from the scan (which runs again) to load a
+// spilled operand before its instruction and to hold a spilled result
+// until it is stored after it. Parameters that spill are bound straight
+// to their slot. A copy whose two temps got the same register is dropped.
+// Registers belong to a frame, so calls save nothing.
+struct FunctionAllocation
+{
+    Operand name;            // None for global initializers
+    uint32_t temps = 0;      // distinct temps before allocation
+    uint32_t pressure = 0;   // most temps live at one point
+    uint32_t registers = 0;  // registers used, the spill ones included
+    uint32_t spilled = 0;    // temps given a frame slot
+    uint32_t loads = 0, stores = 0; // spill code inserted
+    uint32_t moves = 0;      // copies dropped for having one register on both sides
+};
+
+struct RegisterAllocReport
+{
+    uint32_t registers = 0;        // registers available
+    uint32_t tempsBefore = 0;      // IRProgram::tempCount before
+    size_t before = 0, after = 0;  // instructions
+    vector<FunctionAllocation> functions; // in program order, initializers included
+};
+
+class RegisterAllocator
+{
+public:
+    explicit RegisterAllocator(uint32_t registers) : registers(registers)
+    {
+        if (registers < 2)
+            throw runtime_error("register allocation needs at least 2 registers");
+    }
+
+    // Allocates the stretch fn and appends its rewritten code to `code`
+    // and `lines`.
+    FunctionAllocation run(IRProgram &ir, const IRFunction &fn, vector<IRInstruction> &code, vector<int> &lines)
+    {
+        FunctionAllocation result;
+        result.name = fn.name;
+        CFG g = builder.build(ir, fn);
+        liveness.compute(ir, g);
+        result.temps = uint32_t(liveness.temps.size());
+        result.pressure = uint32_t(liveness.maxPressure);
+        buildIntervals(ir, g);
+
+        uint32_t available = registers;
+        bool spills = !scan(available);
+        if (spills)
+        {
+            available = registers - 2;
+            scan(available);
+        }
+        vector<Operand> slot(liveness.temps.size());
+        for (const LiveInterval &iv : intervals)
+            if (iv.reg == NONE)
+                slot[iv.temp] = ir.symbol("spill." + to_string(result.spilled++));
+            else
+                result.registers = max(result.registers, iv.reg + 1);
+        if (spills)
+            result.registers = registers;
+
+        const Operand scratch[2] = {Operand(Operand::Temp, registers - 2), Operand(Operand::Temp, registers - 1)};
+        for (uint32_t i = fn.begin; i < fn.end; i++)
+        {
+            IRInstruction in = ir.code[i];
+            int line = ir.lines[i];
+            bool prologue = liveness.isPrologue(ir, i);
+            Operand loaded[2];
+            int next = 0;
+            forEachUse(in, prologue, [&](Operand &o)
+                       {
+                           uint32_t v = liveness.number(o);
+                           if (v == NONE)
+                               return;
+                           if (!slot[v].empty())
+                           {
+                               Operand from = slot[v];
+                               int k = 0;
+                               while (k < next && loaded[k] != from)
+                                   k++;
+                               if (k == next)
+                               {
+                                   loaded[next++] = from;
+                                   code.emplace_back(IROp::ASSIGN, scratch[k], from, Operand(), ValueType::Unknown);
+                                   lines.push_back(line);
+                                   result.loads++;
+                               }
+                               o = scratch[k];
+                           }
+                           else
+                               o = Operand(Operand::Temp, reg[v]);
+                       });
+            Operand store;
+            if (Operand *d = defOf(in, prologue))
+            {
+                uint32_t v = liveness.number(*d);
+                if (v != NONE && slot[v].empty())
+                    *d = Operand(Operand::Temp, reg[v]);
+                else if (v != NONE && prologue)
+                    *d = slot[v];
+                else if (v != NONE)
+                {
+                    store = slot[v];
+                    *d = scratch[0];
+                }
+            }
+            if (in.op == IROp::ASSIGN && in.result == in.arg1)
+                result.moves++;
+            else
+            {
+                code.push_back(in);
+                lines.push_back(line);
+            }
+            if (!store.empty())
+            {
+                code.emplace_back(IROp::ASSIGN, store, scratch[0], Operand(), ValueType::Unknown);
+                lines.push_back(line);
+                result.stores++;
+            }
+        }
+        return result;
+    }
+
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    struct LiveInterval
+    {
+        uint32_t temp;       // tracked number
+        uint32_t start, end; // positions, both inclusive
+        uint32_t reg;        // NONE when spilled
+    };
+
+    uint32_t registers;
+    CFGBuilder builder;
+    Liveness liveness;
+    vector<LiveInterval> intervals; // by start
+    vector<uint32_t> reg;           // by tracked number, after the scan
+    vector<uint32_t> active;        // intervals holding a register, by end
+    vector<uint8_t> busy;           // by register
+
+    void buildIntervals(const IRProgram &ir, const CFG &g)
+    {
+        size_t n = liveness.temps.size();
+        intervals.clear();
+        intervals.reserve(n);
+        for (uint32_t v = 0; v < n; v++)
+            intervals.push_back(LiveInterval{v, UINT32_MAX, 0, NONE});
+        auto extend = [&](uint32_t v, uint32_t at)
+        {
+            intervals[v].start = min(intervals[v].start, at);
+            intervals[v].end = max(intervals[v].end, at);
+        };
+        auto each = [&](const vector<uint64_t> &sets, uint32_t b, auto fn)
+        {
+            const uint64_t *r = liveness.row(sets, b);
+            for (uint32_t w = 0; w < liveness.words; w++)
+                for (uint64_t bits = r[w]; bits; bits &= bits - 1)
+                    fn(w * 64 + uint32_t(__builtin_ctzll(bits)));
+        };
+        for (uint32_t b = 0; b < g.blockCount(); b++)
+        {
+            each(liveness.in, b, [&](uint32_t v) { extend(v, 2 * g.begin(b)); });
+            each(liveness.out, b, [&](uint32_t v) { extend(v, 2 * (g.end(b) - 1) + 1); });
+            for (uint32_t i = g.begin(b); i < g.end(b); i++)
+            {
+                const IRInstruction &in = ir.code[i];
+                bool prologue = liveness.isPrologue(ir, i);
+                forEachUse(in, prologue, [&](Operand o)
+                           {
+                               if (liveness.number(o) != NONE)
+                                   extend(liveness.number(o), 2 * i);
+                           });
+                if (const Operand *d = defOf(in, prologue))
+                    if (liveness.number(*d) != NONE)
+                        extend(liveness.number(*d), 2 * i + 1);
+            }
+        }
+        sort(intervals.begin(), intervals.end(), [](const LiveInterval &a, const LiveInterval &b)
+             { return a.start != b.start ? a.start < b.start : a.temp < b.temp; });
+    }
+
+    // Assigns `available` registers; returns false if any interval spilled
+    bool scan(uint32_t available)
+    {
+        active.clear();
+        busy.assign(available, 0);
+        reg.assign(intervals.size(), NONE);
+        bool fits = true;
+        auto byEnd = [&](uint32_t a, uint32_t b) { return intervals[a].end < intervals[b].end; };
+        for (uint32_t k = 0; k < intervals.size(); k++)
+        {
+            LiveInterval &iv = intervals[k];
+            iv.reg = NONE;
+            size_t expired = 0;
+            while (expired < active.size() && intervals[active[expired]].end < iv.start)
+                busy[intervals[active[expired++]].reg] = 0;
+            active.erase(active.begin(), active.begin() + expired);
+            if (active.size() == available)
+            {
+                fits = false;
+                if (active.empty() || intervals[active.back()].end <= iv.end)
+                    continue;
+                // The active interval that ends last gives up its register
+                LiveInterval &last = intervals[active.back()];
+                iv.reg = last.reg;
+                last.reg = NONE;
+                reg[last.temp] = NONE;
+                active.pop_back();
+            }
+            else
+            {
+                uint32_t r = 0;
+                while (busy[r])
+                    r++;
+                iv.reg = r;
+                busy[r] = 1;
+            }
+            reg[iv.temp] = iv.reg;
+            active.insert(upper_bound(active.begin(), active.end(), k, byEnd), k);
+        }
+        return fits;
+    }
+};
+
+// Allocates every function and global initializer of a program onto
+// `registers` registers, rewriting the code in place.
+inline RegisterAllocReport allocateRegisters(IRProgram &ir, uint32_t registers = 16)
+{
+    RegisterAllocator allocator(registers);
+    RegisterAllocReport report;
+    report.registers = registers;
+    report.tempsBefore = ir.tempCount;
+    report.before = ir.code.size();
+    vector<IRInstruction> code;
+    vector<int> lines;
+    code.reserve(ir.code.size());
+    lines.reserve(ir.code.size());
+    uint32_t used = 0;
+    auto stretch = [&](const IRFunction &fn)
+    {
+        FunctionAllocation a = allocator.run(ir, fn, code, lines);
+        used = max(used, a.registers);
+        report.functions.push_back(a);
+    };
+    uint32_t at = 0;
+    for (IRFunction &fn : ir.functions)
+    {
+        if (at < fn.begin)
+            stretch(IRFunction{Operand(), at, fn.begin, 0});
+        at = fn.end;
+        uint32_t begin = uint32_t(code.size());
+        stretch(fn);
+        fn.begin = begin;
+        fn.end = uint32_t(code.size());
+    }
+    if (at < ir.code.size())
+        stretch(IRFunction{Operand(), at, uint32_t(ir.code.size()), 0});
+    ir.code = move(code);
+    ir.lines = move(lines);
+    ir.tempCount = used;
+    report.after = ir.code.size();
+    return report;
+}
+
+inline void printReport(ostream &os, const IRProgram &ir, const RegisterAllocReport &r)
+{
+    os << "Registers: " << r.registers << ", " << r.tempsBefore << " temps, instructions " << r.before << " -> "
+       << r.after << "\n";
+    for (const FunctionAllocation &f : r.functions)
+        os << "  " << (f.name.empty() ? "(globals)" : ir.operandText(f.name)) << ": " << f.temps
+           << " temps, max pressure " << f.pressure << ", " << f.registers << " registers, " << f.spilled
+           << " spilled (" << f.loads << " loads, " << f.stores << " stores), " << f.moves << " moves removed\n";
+}
+
+#ifndef IR_REGALLOC_NO_MAIN
+// ---------------------------------------------------------------------
+// Main Driver: sample.txt's optimized IR allocated onto argv[2] registers
+// (16 by default), and main() run before and after
+// ---------------------------------------------------------------------
+int main(int argc, char **argv)
+{
+    const string inputFile = argc > 1 ? argv[1] : "sample.txt";
+    try
+    {
+        uint32_t registers = argc > 2 ? uint32_t(stoul(argv[2])) : 16;
+        ifstream file(inputFile);
+        if (!file.is_open())
+            throw runtime_error("Cannot open file: " + inputFile);
+        stringstream buffer;
+        buffer << file.rdbuf();
+
+        RegexLexer lexer(buffer.str());
+        Parser parser(lexer.tokenize());
+        Program program = parser.parseProgram();
+        TypeChecker checker;
+        checker.check(program);
+        ScopeChecker resolver;
+        resolver.analyse(program);
+        IRGenerator irGen;
+        irGen.generateIR(program);
+        IRProgram &ir = irGen.program();
+        optimizeIR(ir);
+
+        IRInterpreter before(ir);
+        IRValue expected = before.run();
+        RegisterAllocReport report = allocateRegisters(ir, registers);
+        ir.print(cout);
+        cout << "\n";
+        printReport(cout, ir, report);
+        IRInterpreter after(ir);
+        IRValue result = after.run();
+        cout << "main returned " << after.text(result) << ": " << before.steps << " -> " << after.steps
+             << " instructions executed\n";
+        if (before.text(expected) != after.text(result))
+            cout << "MISMATCH: main returned " << before.text(expected) << " before allocating\n";
+    }
+    catch (const exception &e)
+    {
+        cout << "ERROR: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+#endif // IR_REGALLOC_NO_MAIN
+#endif // IR_REGALLOC_CPP
@@ -0,0 +1,614 @@
+// ir_sccp.cpp
+// Define IR_SCCP_NO_MAIN before including to reuse the constant propagation pass in another driver.
+#ifndef IR_SCCP_CPP
+#define IR_SCCP_CPP
+#ifndef IR_SSA_NO_MAIN
+#define IR_SSA_NO_MAIN
+#endif
+#include "ir_ssa.cpp"
+#include <cerrno>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// ---------------------------------------------------------------------
+// Folding constants
+// ---------------------------------------------------------------------
+// A constant operand read as a number: ints, chars and bools as integers,
+// floats as doubles. Strings are never folded. Ints are 32-bit; a fold
+// that would overflow, or divide by zero, is left for run time.
+struct ConstantValue
+{
+    bool isFloat = false;
+    int64_t i = 0;
+    double f = 0;
+
+    double asFloat() const { return isFloat ? f : double(i); }
+    bool truth() const { return isFloat ? f != 0 : i != 0; }
+};
+
+inline bool readConstant(const IRProgram &ir, Operand o, ConstantValue &v)
+{
+    if (o.kind() != Operand::Const)
+        return false;
+    const IRConstant &c = ir.constants[o.index()];
+    const string &t = c.text;
+    v = ConstantValue();
+    switch (c.type)
+    {
+    case ValueType::Int:
+    {
+        char *end;
+        errno = 0;
+        long long n = strtoll(t.c_str(), &end, 10);
+        if (t.empty() || *end || errno || n < INT_MIN || n > INT_MAX)
+            return false;
+        v.i = n;
+        return true;
+    }
+    case ValueType::Float:
+    {
+        char *end;
+        v.f = strtod(t.c_str(), &end);
+        v.isFloat = true;
+        return !t.empty() && !*end && isfinite(v.f);
+    }
+    case ValueType::Bool:
+        v.i = t == "true";
+        return t == "true" || t == "false";
+    case ValueType::Char:
+        v.i = t.size() == 3 ? (unsigned char)t[1] : 0;
+        return t.size() == 3 && t[1] != '\\';
+    default:
+        return false;
+    }
+}
+
+inline Operand intConstant(IRProgram &ir, int64_t n)
+{
+    if (n < INT_MIN || n > INT_MAX)
+        return Operand();
+    return ir.constant(ValueType::Int, to_string(n));
+}
+
+inline Operand boolConstant(IRProgram &ir, bool b) { return ir.constant(ValueType::Bool, b ? "true" : "false"); }
+
+// Shortest text that reads back as the same double, always with a point or
+// exponent so it stays a float literal.
+inline Operand floatConstant(IRProgram &ir, double d)
+{
+    if (!isfinite(d))
+        return Operand();
+    char text[32];
+    for (int precision = 1; precision <= 17; precision++)
+    {
+        snprintf(text, sizeof text, "%.*g", precision, d);
+        if (strtod(text, nullptr) == d)
+            break;
+    }
+    string s = text;
+    if (s.find_first_of(".en") == string::npos)
+        s += ".0";
+    return ir.constant(ValueType::Float, s);
+}
+
+// The constant `in` computes from constant operands a and b, or None when it
+// cannot be folded. LAND and LOR fold with one operand unknown (None) when
+// the other decides them.
+inline Operand foldConstant(IRProgram &ir, const IRInstruction &in, Operand a, Operand b)
+{
+    ConstantValue x, y;
+    bool hasX = readConstant(ir, a, x), hasY = readConstant(ir, b, y);
+    switch (in.op)
+    {
+    case IROp::ASSIGN:
+        return a.kind() == Operand::Const ? a : Operand();
+    case IROp::LNOT:
+        return hasX ? boolConstant(ir, !x.truth()) : Operand();
+    case IROp::LAND:
+        if ((hasX && !x.truth()) || (hasY && !y.truth()))
+            return boolConstant(ir, false);
+        return hasX && hasY ? boolConstant(ir, true) : Operand();
+    case IROp::LOR:
+        if ((hasX && x.truth()) || (hasY && y.truth()))
+            return boolConstant(ir, true);
+        return hasX && hasY ? boolConstant(ir, false) : Operand();
+    default:
+        break;
+    }
+    if (!hasX || !hasY)
+        return Operand();
+    bool useFloat = in.type == ValueType::Float || x.isFloat || y.isFloat;
+    if (useFloat)
+    {
+        double p = x.asFloat(), q = y.asFloat();
+        switch (in.op)
+        {
+        case IROp::ADD:
+            return floatConstant(ir, p + q);
+        case IROp::SUB:
+            return floatConstant(ir, p - q);
+        case IROp::MUL:
+            return floatConstant(ir, p * q);
+        case IROp::DIV:
+            return q == 0 ? Operand() : floatConstant(ir, p / q);
+        case IROp::EQ:
+            return boolConstant(ir, p == q);
+        case IROp::NE:
+            return boolConstant(ir, p != q);
+        case IROp::LT:
+            return boolConstant(ir, p < q);
+        case IROp::LE:
+            return boolConstant(ir, p <= q);
+        case IROp::GT:
+            return boolConstant(ir, p > q);
+        case IROp::GE:
+            return boolConstant(ir, p >= q);
+        default:
+            return Operand();
+        }
+    }
+    // Arithmetic only on ints; chars and bools only compare
+    bool arithmetic = in.type == ValueType::Int || in.type == ValueType::Unknown;
+    int64_t p = x.i, q = y.i;
+    switch (in.op)
+    {
+    case IROp::ADD:
+        return arithmetic ? intConstant(ir, p + q) : Operand();
+    case IROp::SUB:
+        return arithmetic ? intConstant(ir, p - q) : Operand();
+    case IROp::MUL:
+        return arithmetic ? intConstant(ir, p * q) : Operand();
+    case IROp::DIV:
+        return arithmetic && q != 0 ? intConstant(ir, p / q) : Operand();
+    case IROp::EQ:
+        return boolConstant(ir, p == q);
+    case IROp::NE:
+        return boolConstant(ir, p != q);
+    case IROp::LT:
+        return boolConstant(ir, p < q);
+    case IROp::LE:
+        return boolConstant(ir, p <= q);
+    case IROp::GT:
+        return boolConstant(ir, p > q);
+    case IROp::GE:
+        return boolConstant(ir, p >= q);
+    default:
+        return Operand();
+    }
+}
+
+// ---------------------------------------------------------------------
+// Sparse conditional constant propagation (Wegman-Zadeck)
+// ---------------------------------------------------------------------
+// Runs on SSA form. Each temporary starts unknown (Top), may become one
+// constant, and drops to varying (Bottom) once two different values or a
+// run-time value reach it; only edges found executable feed phis, so a
+// constant branch condition keeps the values on its dead side out. Then:
+// uses of constant temporaries read the constant, the instructions and phis
+// that computed them go, decided conditional jumps become JUMPs, and blocks
+// never reached are deleted.
+struct SCCPStats
+{
+    size_t folded = 0;   // instructions and phis replaced by a constant
+    size_t branches = 0; // conditional jumps decided
+    size_t blocks = 0;   // blocks found unreachable and deleted
+};
+
+class SCCP
+{
+public:
+    SCCPStats run(IRProgram &ir, SSAFunction &f)
+    {
+        SCCPStats stats;
+        this->ir = &ir;
+        this->f = &f;
+        if (cell.size() < ir.tempCount)
+            cell.resize(ir.tempCount);
+        collectUses();
+        propagate();
+        rewrite(stats);
+        for (uint32_t t : touched)
+            cell[t] = Cell();
+        touched.clear();
+        return stats;
+    }
+
+private:
+    enum State : uint8_t
+    {
+        Top,
+        Constant,
+        Bottom
+    };
+    struct Value
+    {
+        State state = Top;
+        Operand constant;
+    };
+    // Where a temporary is read: a phi of a block, or an instruction
+    struct Site
+    {
+        uint32_t block;
+        uint32_t pos; // phi index, or phis.size() + instruction index
+    };
+    struct Cell
+    {
+        Value value;
+        uint32_t useBegin = 0, useEnd = 0;
+    };
+
+    IRProgram *ir = nullptr;
+    SSAFunction *f = nullptr;
+    vector<Cell> cell; // by temp index
+    vector<uint32_t> touched;
+    vector<pair<uint32_t, Site>> uses;
+    vector<Site> useSites;
+    vector<uint8_t> seen, edges; // per block: visited, and executable successors as a bit mask
+    vector<pair<uint32_t, uint32_t>> flowWork; // block, successor index
+    vector<uint32_t> ssaWork;
+
+    void collectUses()
+    {
+        uses.clear();
+        for (uint32_t b = 0; b < f->blockCount(); b++)
+        {
+            SSABlock &block = f->blocks[b];
+            uint32_t phiCount = uint32_t(block.phis.size());
+            for (uint32_t p = 0; p < phiCount; p++)
+            {
+                touch(block.phis[p].result);
+                for (Operand a : block.phis[p].args)
+                    if (a.kind() == Operand::Temp)
+                        uses.push_back({a.index(), Site{b, p}});
+            }
+            for (uint32_t i = 0; i < block.code.size(); i++)
+            {
+                forEachUse(block.code[i], f->isPrologue(b, i), [&](Operand o)
+                           {
+                               if (o.kind() == Operand::Temp)
+                                   uses.push_back({o.index(), Site{b, phiCount + i}});
+                           });
+                if (const Operand *d = defOf(block.code[i], f->isPrologue(b, i)))
+                    touch(*d);
+            }
+        }
+        sort(uses.begin(), uses.end(),
+             [](const pair<uint32_t, Site> &x, const pair<uint32_t, Site> &y) { return x.first < y.first; });
+        useSites.resize(uses.size());
+        for (uint32_t k = 0; k < uses.size(); k++)
+        {
+            useSites[k] = uses[k].second;
+            Cell &c = cell[uses[k].first];
+            if (k == 0 || uses[k - 1].first != uses[k].first)
+                c.useBegin = k;
+            c.useEnd = k + 1;
+        }
+    }
+
+    void touch(Operand o)
+    {
+        if (o.kind() == Operand::Temp)
+            touched.push_back(o.index());
+    }
+
+    Value valueOf(Operand o) const
+    {
+        if (o.kind() == Operand::Const)
+            return Value{Constant, o};
+        if (o.kind() == Operand::Temp)
+            return cell[o.index()].value;
+        return Value{Bottom, Operand()}; // globals
+    }
+
+    void lower(Operand result, Value v)
+    {
+        if (result.kind() != Operand::Temp)
+            return;
+        Value &old = cell[result.index()].value;
+        if (v.state == Constant && old.state == Constant && v.constant != old.constant)
+            v.state = Bottom;
+        if (v.state <= old.state)
+            return;
+        old = v;
+        ssaWork.push_back(result.index());
+    }
+
+    void propagate()
+    {
+        uint32_t n = f->blockCount();
+        seen.assign(n, 0);
+        edges.assign(n, 0);
+        flowWork.clear();
+        ssaWork.clear();
+        seen[0] = 1;
+        visitBlock(0);
+        while (!flowWork.empty() || !ssaWork.empty())
+        {
+            while (!flowWork.empty())
+            {
+                auto [from, k] = flowWork.back();
+                flowWork.pop_back();
+                uint32_t to = f->blocks[from].succs[k];
+                if (!seen[to])
+                {
+                    seen[to] = 1;
+                    visitBlock(to);
+                }
+                else
+                    for (uint32_t p = 0; p < f->blocks[to].phis.size(); p++)
+                        visitPhi(to, p);
+            }
+            while (!ssaWork.empty())
+            {
+                const Cell &c = cell[ssaWork.back()];
+                ssaWork.pop_back();
+                for (uint32_t u = c.useBegin; u < c.useEnd; u++)
+                {
+                    Site s = useSites[u];
+                    if (!seen[s.block])
+                        continue;
+                    uint32_t phiCount = uint32_t(f->blocks[s.block].phis.size());
+                    if (s.pos < phiCount)
+                        visitPhi(s.block, s.pos);
+                    else
+                        visitInstruction(s.block, s.pos - phiCount);
+                }
+            }
+        }
+    }
+
+    void visitBlock(uint32_t b)
+    {
+        for (uint32_t p = 0; p < f->blocks[b].phis.size(); p++)
+            visitPhi(b, p);
+        for (uint32_t i = 0; i < f->blocks[b].code.size(); i++)
+            visitInstruction(b, i);
+    }
+
+    bool executable(uint32_t from, uint32_t to) const
+    {
+        const auto &succs = f->blocks[from].succs;
+        for (uint32_t k = 0; k < succs.size(); k++)
+            if (succs[k] == to)
+                return edges[from] >> k & 1;
+        return false;
+    }
+
+    void markEdge(uint32_t from, uint32_t k)
+    {
+        if (edges[from] >> k & 1)
+            return;
+        edges[from] |= uint8_t(1u << k);
+        flowWork.push_back({from, k});
+    }
+
+    void visitPhi(uint32_t b, uint32_t p)
+    {
+        const SSABlock &block = f->blocks[b];
+        const Phi &phi = block.phis[p];
+        Value v;
+        for (size_t k = 0; k < phi.args.size() && v.state != Bottom; k++)
+        {
+            if (!executable(block.preds[k], b))
+                continue;
+            Value a = valueOf(phi.args[k]);
+            if (a.state == Top)
+                continue;
+            if (v.state == Top || a.state == Bottom)
+                v = a;
+            else if (a.constant != v.constant)
+                v.state = Bottom;
+        }
+        lower(phi.result, v);
+    }
+
+    void visitInstruction(uint32_t b, uint32_t i)
+    {
+        const IRInstruction &in = f->blocks[b].code[i];
+        switch (in.op)
+        {
+        case IROp::JUMP:
+            markEdge(b, 0);
+            return;
+        case IROp::JUMP_TRUE:
+        case IROp::JUMP_FALSE:
+        {
+            Value c = valueOf(in.arg1);
+            ConstantValue cv;
+            if (c.state == Constant && readConstant(*ir, c.constant, cv))
+                markEdge(b, cv.truth() == (in.op == IROp::JUMP_TRUE) ? 0 : 1);
+            else if (c.state != Top)
+            {
+                markEdge(b, 0);
+                markEdge(b, 1);
+            }
+            return;
+        }
+        case IROp::CALL:
+        case IROp::PARAM:
+            if (defOf(in, f->isPrologue(b, i)))
+                lower(in.result, Value{Bottom, Operand()});
+            return;
+        default:
+            break;
+        }
+        if (!definesResult(in.op))
+            return;
+        Value x = valueOf(in.arg1), y = in.arg2.empty() ? Value{Constant, Operand()} : valueOf(in.arg2);
+        if (in.op == IROp::ASSIGN)
+        {
+            lower(in.result, x);
+            return;
+        }
+        Operand folded = foldConstant(*ir, in, x.state == Constant ? x.constant : Operand(),
+                                      y.state == Constant ? y.constant : Operand());
+        if (!folded.empty())
+            lower(in.result, Value{Constant, folded});
+        else if (x.state == Top || y.state == Top)
+            return; // may still fold once the operands are known
+        else
+            lower(in.result, Value{Bottom, Operand()});
+    }
+
+    Operand constantOf(Operand o) const
+    {
+        if (o.kind() != Operand::Temp)
+            return o;
+        const Value &v = cell[o.index()].value;
+        return v.state == Constant ? v.constant : o;
+    }
+
+    void rewrite(SCCPStats &stats)
+    {
+        uint32_t n = f->blockCount();
+        const uint32_t NONE = UINT32_MAX;
+        vector<uint32_t> index(n, NONE);
+        uint32_t kept = 0;
+        for (uint32_t b = 0; b < n; b++)
+            if (seen[b])
+                index[b] = kept++;
+        stats.blocks += n - kept;
+
+        // Only the executable incoming edges remain, found before any block
+        // is rewritten.
+        vector<vector<uint32_t>> livePreds(n);
+        for (uint32_t b = 0; b < n; b++)
+            if (seen[b])
+                for (uint32_t k = 0; k < f->blocks[b].preds.size(); k++)
+                    if (executable(f->blocks[b].preds[k], b))
+                        livePreds[b].push_back(k);
+
+        vector<SSABlock> blocks;
+        blocks.reserve(kept);
+        for (uint32_t b = 0; b < n; b++)
+        {
+            if (!seen[b])
+                continue;
+            SSABlock &block = f->blocks[b];
+            const vector<uint32_t> &live = livePreds[b];
+            vector<Phi> phis;
+            vector<IRInstruction> copies;
+            for (Phi &phi : block.phis)
+            {
+                if (cell[phi.result.index()].value.state == Constant)
+                {
+                    stats.folded++;
+                    continue;
+                }
+                vector<Operand> args;
+                for (uint32_t k : live)
+                    args.push_back(constantOf(phi.args[k]));
+                if (args.size() == 1)
+                    copies.emplace_back(IROp::ASSIGN, phi.result, args[0]);
+                else
+                    phis.push_back(Phi{phi.result, phi.var, move(args)});
+            }
+            vector<uint32_t> preds;
+            for (uint32_t k : live)
+                preds.push_back(index[block.preds[k]]);
+
+            vector<IRInstruction> code = move(copies);
+            vector<int> lines(code.size(), block.lines.front());
+            for (uint32_t i = 0; i < block.code.size(); i++)
+            {
+                IRInstruction in = block.code[i];
+                bool prologue = f->isPrologue(b, i);
+                const Operand *d = defOf(in, prologue);
+                if (d && !prologue && d->kind() == Operand::Temp && cell[d->index()].value.state == Constant)
+                {
+                    stats.folded++;
+                    continue;
+                }
+                forEachUse(in, prologue, [&](Operand &o) { o = constantOf(o); });
+                code.push_back(in);
+                lines.push_back(block.lines[i]);
+            }
+
+            // Successors along executable edges; a decided branch is a JUMP
+            vector<uint32_t> succs;
+            for (uint32_t k = 0; k < block.succs.size(); k++)
+                if (edges[b] >> k & 1)
+                    succs.push_back(index[block.succs[k]]);
+            IRInstruction &t = code.back();
+            if ((t.op == IROp::JUMP_TRUE || t.op == IROp::JUMP_FALSE) && succs.size() == 1)
+            {
+                t = IRInstruction(IROp::JUMP, t.result);
+                stats.branches++;
+            }
+            block.phis = move(phis);
+            block.code = move(code);
+            block.lines = move(lines);
+            block.preds = move(preds);
+            block.succs = move(succs);
+            blocks.push_back(move(block));
+        }
+        f->blocks = move(blocks);
+    }
+};
+
+// Constant propagation over every function of a program in SSA form.
+inline SCCPStats propagateConstants(IRProgram &ir, vector<SSAFunction> &fns)
+{
+    SCCP pass;
+    SCCPStats total;
+    for (SSAFunction &f : fns)
+    {
+        SCCPStats s = pass.run(ir, f);
+        total.folded += s.folded;
+        total.branches += s.branches;
+        total.blocks += s.blocks;
+    }
+    return total;
+}
+
+#ifndef IR_SCCP_NO_MAIN
+// ---------------------------------------------------------------------
+// Main Driver: sample.txt's IR before and after constant propagation
+// ---------------------------------------------------------------------
+int main(int argc, char **argv)
+{
+    const string inputFile = argc > 1 ? argv[1] : "sample.txt";
+    try
+    {
+        ifstream file(inputFile);
+        if (!file.is_open())
+            throw runtime_error("Cannot open file: " + inputFile);
+        stringstream buffer;
+        buffer << file.rdbuf();
+
+        RegexLexer lexer(buffer.str());
+        Parser parser(lexer.tokenize());
+        Program program = parser.parseProgram();
+        TypeChecker checker;
+        checker.check(program);
+        ScopeChecker resolver;
+        resolver.analyse(program);
+        IRGenerator irGen;
+        irGen.generateIR(program);
+        IRProgram &ir = irGen.program();
+        size_t before = ir.code.size();
+        ir.print(cout);
+
+        vector<SSAFunction> fns = toSSA(ir);
+        SCCPStats stats = propagateConstants(ir, fns);
+        fromSSA(ir, fns);
+        cout << "\n";
+        ir.print(cout);
+        cout << "\nInstructions: " << before << " -> " << ir.code.size() << " (" << stats.folded
+             << " folded, " << stats.branches << " branches decided, " << stats.blocks << " blocks removed)\n";
+    }
+    catch (const exception &e)
+    {
+        cout << "ERROR: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+#endif // IR_SCCP_NO_MAIN
+#endif // IR_SCCP_CPP
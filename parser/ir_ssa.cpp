@@ -0,0 +1,944 @@
+// ir_ssa.cpp
+// Define IR_SSA_NO_MAIN before including to reuse the SSA passes in another driver.
+#ifndef IR_SSA_CPP
+#define IR_SSA_CPP
+#ifndef IR_CFG_NO_MAIN
+#define IR_CFG_NO_MAIN
+#endif
+#include "ir_cfg.cpp"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// ---------------------------------------------------------------------
+// Operands an instruction reads and writes
+// ---------------------------------------------------------------------
+// `prologue` is true for the PARAMs that open a function, which name its
+// parameters (write them) rather than pass an argument. A CALL's symbol
+// operand is the callee, not a variable, and labels are never values.
+template <class Instr, class Fn>
+void forEachUse(Instr &in, bool prologue, Fn fn)
+{
+    auto use = [&](auto &o)
+    {
+        if (!o.empty())
+            fn(o);
+    };
+    switch (in.op)
+    {
+    case IROp::LABEL:
+    case IROp::JUMP:
+        return;
+    case IROp::PARAM:
+        if (!prologue)
+            use(in.result);
+        return;
+    case IROp::RET:
+        use(in.result);
+        return;
+    case IROp::CALL:
+        if (in.arg1.kind() != Operand::Symbol)
+            use(in.arg1);
+        return;
+    case IROp::JUMP_TRUE:
+    case IROp::JUMP_FALSE:
+        use(in.arg1);
+        return;
+    default:
+        use(in.arg1);
+        use(in.arg2);
+    }
+}
+
+template <class Instr>
+auto defOf(Instr &in, bool prologue) -> decltype(&in.result)
+{
+    return definesResult(in.op) || (prologue && in.op == IROp::PARAM) ? &in.result : nullptr;
+}
+
+// ---------------------------------------------------------------------
+// SSA form of one IR function
+// ---------------------------------------------------------------------
+// Every local variable and temporary is renamed so that each value is
+// written exactly once, to a fresh temporary, and a phi at the top of a
+// block picks among the values that reach it. Global variables stay
+// symbols that are read and written in place. A variable read before any
+// assignment on some path reads `undef`, the int constant 0.
+//
+// Blocks own their code, which always ends with a terminator whose
+// targets are the block's successors rather than labels: JUMP goes to
+// succs[0], JUMP_TRUE/JUMP_FALSE to succs[0] when taken and succs[1]
+// otherwise, and RET ends the function. Block 0 is the entry and opens
+// with the function's parameter PARAMs.
+struct Phi
+{
+    Operand result;
+    Operand var;          // the variable it merges, as named in the source code
+    vector<Operand> args; // one per predecessor, in preds order
+};
+
+struct SSABlock
+{
+    Operand label; // label the block started with in the source code, if any
+    vector<Phi> phis;
+    vector<IRInstruction> code;
+    vector<int> lines;
+    vector<uint32_t> preds, succs;
+
+    IRInstruction &terminator() { return code.back(); }
+    const IRInstruction &terminator() const { return code.back(); }
+    void insertBeforeTerminator(const IRInstruction &in, int line)
+    {
+        code.insert(code.end() - 1, in);
+        lines.insert(lines.end() - 1, line);
+    }
+    // Position of p among the predecessors, which is the phi argument slot
+    uint32_t predIndex(uint32_t p) const { return uint32_t(find(preds.begin(), preds.end(), p) - preds.begin()); }
+};
+
+struct SSAFunction
+{
+    IRFunction source;
+    vector<SSABlock> blocks;
+    Operand undef;
+
+    uint32_t blockCount() const { return uint32_t(blocks.size()); }
+    bool isPrologue(uint32_t block, size_t i) const { return block == 0 && i < source.paramCount; }
+};
+
+// ---------------------------------------------------------------------
+// Dominator tree (Lengauer-Tarjan, with path compression)
+// ---------------------------------------------------------------------
+// Blocks unreachable from the entry have no immediate dominator and are
+// left out of the tree. dominates() is O(1) through the pre/post numbers
+// of a walk of the tree.
+class DominatorTree
+{
+public:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    vector<uint32_t> idom;
+    vector<uint32_t> childStart, child;
+    vector<uint32_t> preorder; // reachable blocks, parents before children
+    vector<uint32_t> pre, post;
+
+    CFG::BlockList children(uint32_t b) const { return {child.data() + childStart[b], child.data() + childStart[b + 1]}; }
+    bool reachable(uint32_t b) const { return pre[b] != NONE; }
+    bool dominates(uint32_t a, uint32_t b) const
+    {
+        return pre[a] != NONE && pre[b] != NONE && pre[a] <= pre[b] && post[b] <= post[a];
+    }
+
+    void compute(const SSAFunction &f)
+    {
+        uint32_t n = f.blockCount();
+        idom.assign(n, NONE);
+
+        // Depth-first numbering from the entry; everything below is indexed
+        // by those numbers.
+        dfnum.assign(n, NONE);
+        vertex.clear();
+        parent.clear();
+        stack.clear();
+        dfnum[0] = 0;
+        vertex.push_back(0);
+        parent.push_back(NONE);
+        stack.push_back({0, 0});
+        while (!stack.empty())
+        {
+            auto &top = stack.back();
+            const auto &succs = f.blocks[top.first].succs;
+            if (top.second == succs.size())
+            {
+                stack.pop_back();
+                continue;
+            }
+            uint32_t s = succs[top.second++];
+            if (dfnum[s] != NONE)
+                continue;
+            uint32_t from = dfnum[top.first];
+            dfnum[s] = uint32_t(vertex.size());
+            vertex.push_back(s);
+            parent.push_back(from);
+            stack.push_back({s, 0});
+        }
+        uint32_t m = uint32_t(vertex.size());
+        semi.resize(m);
+        label.resize(m);
+        ancestor.assign(m, NONE);
+        dom.assign(m, NONE);
+        bucketHead.assign(m, NONE);
+        bucketNext.resize(m);
+        for (uint32_t i = 0; i < m; i++)
+            semi[i] = label[i] = i;
+
+        for (uint32_t w = m - 1; w > 0; w--)
+        {
+            for (uint32_t p : f.blocks[vertex[w]].preds)
+            {
+                if (dfnum[p] == NONE)
+                    continue;
+                uint32_t u = eval(dfnum[p]);
+                semi[w] = min(semi[w], semi[u]);
+            }
+            bucketNext[w] = bucketHead[semi[w]];
+            bucketHead[semi[w]] = w;
+            uint32_t p = parent[w];
+            ancestor[w] = p;
+            for (uint32_t v = bucketHead[p]; v != NONE; v = bucketNext[v])
+            {
+                uint32_t u = eval(v);
+                dom[v] = semi[u] < semi[v] ? u : p;
+            }
+            bucketHead[p] = NONE;
+        }
+        for (uint32_t w = 1; w < m; w++)
+        {
+            if (dom[w] != semi[w])
+                dom[w] = dom[dom[w]];
+            idom[vertex[w]] = vertex[dom[w]];
+        }
+
+        // Children rows, then a preorder walk for the numbering
+        childStart.assign(n + 1, 0);
+        for (uint32_t b = 0; b < n; b++)
+            if (idom[b] != NONE)
+                childStart[idom[b] + 1]++;
+        for (uint32_t b = 0; b < n; b++)
+            childStart[b + 1] += childStart[b];
+        child.resize(childStart[n]);
+        vector<uint32_t> fill(childStart.begin(), childStart.end() - 1);
+        for (uint32_t b = 0; b < n; b++)
+            if (idom[b] != NONE)
+                child[fill[idom[b]]++] = b;
+
+        pre.assign(n, NONE);
+        post.assign(n, NONE);
+        preorder.clear();
+        uint32_t clock = 0;
+        stack.clear();
+        stack.push_back({0, 0});
+        pre[0] = clock++;
+        preorder.push_back(0);
+        while (!stack.empty())
+        {
+            auto &top = stack.back();
+            CFG::BlockList kids = children(top.first);
+            if (top.second == kids.size())
+            {
+                post[top.first] = clock++;
+                stack.pop_back();
+                continue;
+            }
+            uint32_t c = kids[top.second++];
+            pre[c] = clock++;
+            preorder.push_back(c);
+            stack.push_back({c, 0});
+        }
+    }
+
+private:
+    // Scratch, indexed by depth-first number
+    vector<uint32_t> dfnum, vertex, parent, semi, label, ancestor, dom, bucketHead, bucketNext, path;
+    vector<pair<uint32_t, uint32_t>> stack;
+
+    uint32_t eval(uint32_t v)
+    {
+        if (ancestor[v] == NONE)
+            return v;
+        // Path compression, iteratively: the recursive form would go as deep
+        // as the longest path of the depth-first tree.
+        path.clear();
+        for (uint32_t x = v; ancestor[ancestor[x]] != NONE; x = ancestor[x])
+            path.push_back(x);
+        while (!path.empty())
+        {
+            uint32_t x = path.back();
+            path.pop_back();
+            uint32_t a = ancestor[x];
+            if (semi[label[a]] < semi[label[x]])
+                label[x] = label[a];
+            ancestor[x] = ancestor[a];
+        }
+        return label[v];
+    }
+};
+
+// Dominance frontier of every block: the blocks where its dominance ends.
+inline vector<vector<uint32_t>> dominanceFrontiers(const SSAFunction &f, const DominatorTree &dt)
+{
+    vector<vector<uint32_t>> df(f.blockCount());
+    for (uint32_t b = 0; b < f.blockCount(); b++)
+    {
+        const auto &preds = f.blocks[b].preds;
+        if (preds.size() < 2 || !dt.reachable(b))
+            continue;
+        for (uint32_t p : preds)
+            for (uint32_t runner = p; runner != dt.idom[b] && dt.reachable(runner); runner = dt.idom[runner])
+            {
+                if (!df[runner].empty() && df[runner].back() == b)
+                    break;
+                df[runner].push_back(b);
+            }
+    }
+    return df;
+}
+
+// ---------------------------------------------------------------------
+// SSA construction
+// ---------------------------------------------------------------------
+// Phis are placed on the iterated dominance frontiers of each variable's
+// assignments, for variables read in some block before being written there
+// (semi-pruned form: a temporary that lives inside one block gets none).
+// Renaming walks the dominator tree with one current-value slot per
+// variable and an undo log. Blocks the entry cannot reach are dropped.
+class SSABuilder
+{
+public:
+    SSAFunction build(IRProgram &ir, const CFG &g)
+    {
+        SSAFunction f;
+        f.source = g.function;
+        f.undef = ir.constant(ValueType::Int, "0");
+        makeBlocks(ir, g, f);
+        collectVariables(ir, f);
+        DominatorTree dt;
+        dt.compute(f);
+        placePhis(f, dt);
+        rename(ir, f, dt);
+        for (Operand o : varOperand)
+            varId[key(ir, o)] = NO_VAR;
+        return f;
+    }
+
+private:
+    static constexpr uint32_t NO_VAR = UINT32_MAX;
+
+    // Variables of the function being built: varId by key(), dense ids.
+    vector<uint32_t> varId;
+    vector<Operand> varOperand;
+    vector<uint8_t> upwardExposed;
+    vector<pair<uint32_t, uint32_t>> defSites; // variable, block
+    uint32_t symbolCount = 0;
+
+    // Symbols first, then temporaries, as the temp count grows while building
+    size_t key(const IRProgram &ir, Operand o) const
+    {
+        return o.kind() == Operand::Symbol ? o.index() : ir.symbols.size() + o.index();
+    }
+
+    uint32_t variable(const IRProgram &ir, Operand o) const
+    {
+        if (o.kind() != Operand::Temp && !ir.isLocal(o))
+            return NO_VAR;
+        size_t k = key(ir, o);
+        return k < varId.size() ? varId[k] : NO_VAR;
+    }
+
+    void makeBlocks(const IRProgram &ir, const CFG &g, SSAFunction &f)
+    {
+        vector<uint32_t> index(g.blockCount(), NO_VAR);
+        uint32_t n = 0;
+        for (uint32_t b = 0; b < g.blockCount(); b++)
+            if (g.reachable(b))
+                index[b] = n++;
+        f.blocks.resize(n);
+        uint32_t exitBlock = NO_VAR; // shared block for falling off the end
+        for (uint32_t b = 0; b < g.blockCount(); b++)
+        {
+            if (index[b] == NO_VAR)
+                continue;
+            SSABlock &nb = f.blocks[index[b]];
+            uint32_t i = g.begin(b);
+            if (ir.code[i].op == IROp::LABEL)
+            {
+                if (b != 0)
+                    nb.label = ir.code[i].result;
+                i++;
+            }
+            for (; i < g.end(b); i++)
+            {
+                nb.code.push_back(ir.code[i]);
+                nb.lines.push_back(ir.lines[i]);
+            }
+            for (uint32_t s : g.successors(b))
+                nb.succs.push_back(index[s]);
+            for (uint32_t p : g.predecessors(b))
+                if (index[p] != NO_VAR)
+                    nb.preds.push_back(index[p]);
+
+            // Make every block end in a terminator that names all its
+            // successors.
+            int line = nb.lines.empty() ? ir.lines[g.begin(b)] : nb.lines.back();
+            IROp last = nb.code.empty() ? IROp::LABEL : nb.code.back().op;
+            bool conditional = last == IROp::JUMP_TRUE || last == IROp::JUMP_FALSE;
+            if (conditional && nb.succs.size() == 1)
+            {
+                // Taken and not taken reach the same block, or nothing follows
+                if (b + 1 < g.blockCount())
+                    nb.code.back() = IRInstruction(IROp::JUMP, nb.code.back().result);
+                else
+                {
+                    // Not taken falls off the end of the function
+                    if (exitBlock == NO_VAR)
+                        exitBlock = addExitBlock(f, line);
+                    nb.succs.push_back(exitBlock);
+                    f.blocks[exitBlock].preds.push_back(index[b]);
+                }
+            }
+            else if (!endsBlock(last))
+            {
+                if (nb.succs.empty())
+                    nb.code.emplace_back(IROp::RET, Operand());
+                else
+                    nb.code.emplace_back(IROp::JUMP, Operand());
+                nb.lines.push_back(line);
+            }
+        }
+    }
+
+    static uint32_t addExitBlock(SSAFunction &f, int line)
+    {
+        f.blocks.emplace_back();
+        f.blocks.back().code.emplace_back(IROp::RET, Operand());
+        f.blocks.back().lines.push_back(line);
+        return f.blockCount() - 1;
+    }
+
+    void collectVariables(const IRProgram &ir, SSAFunction &f)
+    {
+        varOperand.clear();
+        defSites.clear();
+        upwardExposed.clear();
+        if (varId.size() < ir.symbols.size() + ir.tempCount)
+            varId.resize(ir.symbols.size() + ir.tempCount, NO_VAR);
+        auto declare = [&](Operand o)
+        {
+            if (o.kind() != Operand::Temp && !ir.isLocal(o))
+                return NO_VAR;
+            uint32_t &id = varId[key(ir, o)];
+            if (id == NO_VAR)
+            {
+                id = uint32_t(varOperand.size());
+                varOperand.push_back(o);
+                upwardExposed.push_back(0);
+            }
+            return id;
+        };
+        // Per variable, the last block that wrote it, to tell reads of a
+        // value from an earlier block.
+        vector<uint32_t> writtenIn;
+        for (uint32_t b = 0; b < f.blockCount(); b++)
+        {
+            auto &code = f.blocks[b].code;
+            for (size_t i = 0; i < code.size(); i++)
+            {
+                bool prologue = f.isPrologue(b, i);
+                forEachUse(code[i], prologue, [&](Operand o)
+                           {
+                               uint32_t v = declare(o);
+                               if (v == NO_VAR)
+                                   return;
+                               if (v >= writtenIn.size())
+                                   writtenIn.resize(v + 1, NO_VAR);
+                               if (writtenIn[v] != b)
+                                   upwardExposed[v] = 1;
+                           });
+                if (const Operand *d = defOf(code[i], prologue))
+                {
+                    uint32_t v = declare(*d);
+                    if (v == NO_VAR)
+                        continue;
+                    if (v >= writtenIn.size())
+                        writtenIn.resize(v + 1, NO_VAR);
+                    if (writtenIn[v] != b)
+                        defSites.push_back({v, b});
+                    writtenIn[v] = b;
+                }
+            }
+        }
+    }
+
+    void placePhis(SSAFunction &f, const DominatorTree &dt)
+    {
+        vector<vector<uint32_t>> df = dominanceFrontiers(f, dt);
+        stable_sort(defSites.begin(), defSites.end(),
+                    [](const pair<uint32_t, uint32_t> &a, const pair<uint32_t, uint32_t> &b)
+                    { return a.first < b.first; });
+        vector<uint32_t> hasPhi(f.blockCount(), NO_VAR), queued(f.blockCount(), NO_VAR);
+        vector<uint32_t> work;
+        for (size_t i = 0; i < defSites.size();)
+        {
+            uint32_t v = defSites[i].first;
+            size_t j = i;
+            for (; j < defSites.size() && defSites[j].first == v; j++)
+                if (upwardExposed[v])
+                {
+                    queued[defSites[j].second] = v;
+                    work.push_back(defSites[j].second);
+                }
+            i = j;
+            while (!work.empty())
+            {
+                uint32_t x = work.back();
+                work.pop_back();
+                for (uint32_t y : df[x])
+                {
+                    if (hasPhi[y] == v)
+                        continue;
+                    hasPhi[y] = v;
+                    f.blocks[y].phis.push_back(Phi{Operand(), varOperand[v], vector<Operand>(f.blocks[y].preds.size())});
+                    if (queued[y] != v)
+                    {
+                        queued[y] = v;
+                        work.push_back(y);
+                    }
+                }
+            }
+        }
+    }
+
+    void rename(IRProgram &ir, SSAFunction &f, const DominatorTree &dt)
+    {
+        vector<Operand> current(varOperand.size(), f.undef);
+        vector<pair<uint32_t, Operand>> undo;
+        auto define = [&](uint32_t v, Operand &o)
+        {
+            undo.push_back({v, current[v]});
+            o = current[v] = ir.newTemp();
+        };
+        struct Frame
+        {
+            uint32_t block;
+            size_t undoMark;
+            uint32_t nextChild;
+        };
+        vector<Frame> stack{{0, 0, 0}};
+        enterBlock(ir, f, 0, current, define);
+        while (!stack.empty())
+        {
+            Frame &top = stack.back();
+            CFG::BlockList kids = dt.children(top.block);
+            if (top.nextChild < kids.size())
+            {
+                uint32_t c = kids[top.nextChild++];
+                stack.push_back({c, undo.size(), 0});
+                enterBlock(ir, f, c, current, define);
+                continue;
+            }
+            for (size_t k = undo.size(); k > top.undoMark; k--)
+                current[undo[k - 1].first] = undo[k - 1].second;
+            undo.resize(top.undoMark);
+            stack.pop_back();
+        }
+    }
+
+    template <class Define>
+    void enterBlock(const IRProgram &ir, SSAFunction &f, uint32_t b, vector<Operand> &current, Define &define)
+    {
+        SSABlock &block = f.blocks[b];
+        for (Phi &phi : block.phis)
+            define(variable(ir, phi.var), phi.result);
+        for (size_t i = 0; i < block.code.size(); i++)
+        {
+            IRInstruction &in = block.code[i];
+            bool prologue = f.isPrologue(b, i);
+            forEachUse(in, prologue, [&](Operand &o)
+                       {
+                           uint32_t v = variable(ir, o);
+                           if (v != NO_VAR)
+                               o = current[v];
+                       });
+            if (Operand *d = defOf(in, prologue))
+            {
+                uint32_t v = variable(ir, *d);
+                if (v != NO_VAR)
+                    define(v, *d);
+            }
+        }
+        for (uint32_t s : block.succs)
+        {
+            SSABlock &succ = f.blocks[s];
+            uint32_t slot = succ.predIndex(b);
+            for (Phi &phi : succ.phis)
+                phi.args[slot] = current[variable(ir, phi.var)];
+        }
+    }
+};
+
+// ---------------------------------------------------------------------
+// Out of SSA
+// ---------------------------------------------------------------------
+// Each phi becomes a copy at the end of every predecessor. Edges from a
+// block with several successors into a block with phis are split first, so
+// the copies run only on their own edge, and the copies of one edge are
+// ordered as a parallel copy (a cycle such as a swap goes through a
+// temporary). The blocks are then laid out in order, with jumps to the
+// next block left out and labels only where something jumps.
+inline void splitCriticalEdges(SSAFunction &f)
+{
+    for (uint32_t b = 0; b < f.blockCount(); b++)
+    {
+        if (f.blocks[b].phis.empty())
+            continue;
+        for (uint32_t &p : f.blocks[b].preds)
+        {
+            if (f.blocks[p].succs.size() < 2)
+                continue;
+            SSABlock edge;
+            edge.code.emplace_back(IROp::JUMP, Operand());
+            edge.lines.push_back(f.blocks[p].lines.back());
+            edge.preds.push_back(p);
+            edge.succs.push_back(b);
+            uint32_t e = f.blockCount();
+            replace(f.blocks[p].succs.begin(), f.blocks[p].succs.end(), b, e);
+            p = e;
+            f.blocks.push_back(move(edge)); // may move blocks[b]; p is not used after
+        }
+    }
+}
+
+// Appends copies doing dst[i] = src[i] for all i at once.
+inline void sequentializeCopies(IRProgram &ir, vector<pair<Operand, Operand>> copies, SSABlock &at, int line)
+{
+    copies.erase(remove_if(copies.begin(), copies.end(),
+                           [](const pair<Operand, Operand> &c) { return c.first == c.second; }),
+                 copies.end());
+    while (!copies.empty())
+    {
+        // A copy whose destination no other pending copy reads can go now
+        bool progress = false;
+        for (size_t i = 0; i < copies.size(); i++)
+        {
+            Operand dst = copies[i].first;
+            bool read = false;
+            for (size_t j = 0; j < copies.size() && !read; j++)
+                read = j != i && copies[j].second == dst;
+            if (read)
+                continue;
+            at.insertBeforeTerminator(IRInstruction(IROp::ASSIGN, dst, copies[i].second), line);
+            copies.erase(copies.begin() + i);
+            progress = true;
+            break;
+        }
+        if (progress)
+            continue;
+        // Only cycles are left: save one source and read the copy instead
+        Operand saved = ir.newTemp();
+        Operand src = copies[0].second;
+        at.insertBeforeTerminator(IRInstruction(IROp::ASSIGN, saved, src), line);
+        for (auto &c : copies)
+            if (c.second == src)
+                c.second = saved;
+    }
+}
+
+inline void destroySSA(IRProgram &ir, SSAFunction &f, vector<IRInstruction> &code, vector<int> &lines)
+{
+    splitCriticalEdges(f);
+    vector<pair<Operand, Operand>> copies;
+    for (uint32_t b = 0; b < f.blockCount(); b++)
+    {
+        SSABlock &block = f.blocks[b];
+        for (uint32_t k = 0; k < block.preds.size(); k++)
+        {
+            copies.clear();
+            for (const Phi &phi : block.phis)
+                copies.push_back({phi.result, phi.args[k]});
+            SSABlock &pred = f.blocks[block.preds[k]];
+            sequentializeCopies(ir, copies, pred, pred.lines.back());
+        }
+        block.phis.clear();
+    }
+
+    // Which blocks are jumped to, and their labels
+    uint32_t n = f.blockCount();
+    vector<bool> target(n, false);
+    for (uint32_t b = 0; b < n; b++)
+    {
+        const SSABlock &block = f.blocks[b];
+        const IRInstruction &t = block.terminator();
+        uint32_t next = b + 1;
+        if (t.op == IROp::JUMP && block.succs[0] != next)
+            target[block.succs[0]] = true;
+        else if (t.op == IROp::JUMP_TRUE || t.op == IROp::JUMP_FALSE)
+        {
+            if (block.succs[1] == next)
+                target[block.succs[0]] = true;
+            else if (block.succs[0] == next)
+                target[block.succs[1]] = true;
+            else
+                target[block.succs[0]] = target[block.succs[1]] = true;
+        }
+    }
+    for (uint32_t b = 1; b < n; b++)
+        if (target[b] && f.blocks[b].label.empty())
+            f.blocks[b].label = ir.newLabel();
+
+    code.push_back(ir.code.size() > f.source.begin ? ir.code[f.source.begin] : IRInstruction(IROp::LABEL, f.source.name));
+    lines.push_back(ir.lines.size() > f.source.begin ? ir.lines[f.source.begin] : 0);
+    for (uint32_t b = 0; b < n; b++)
+    {
+        const SSABlock &block = f.blocks[b];
+        int line = block.lines.back();
+        if (b > 0 && target[b])
+        {
+            code.emplace_back(IROp::LABEL, block.label);
+            lines.push_back(block.lines.front());
+        }
+        code.insert(code.end(), block.code.begin(), block.code.end() - 1);
+        lines.insert(lines.end(), block.lines.begin(), block.lines.end() - 1);
+        IRInstruction t = block.terminator();
+        uint32_t next = b + 1;
+        auto label = [&](uint32_t s) { return f.blocks[s].label; };
+        if (t.op == IROp::JUMP)
+        {
+            if (block.succs[0] != next)
+            {
+                code.emplace_back(IROp::JUMP, label(block.succs[0]));
+                lines.push_back(line);
+            }
+        }
+        else if (t.op == IROp::JUMP_TRUE || t.op == IROp::JUMP_FALSE)
+        {
+            IROp inverse = t.op == IROp::JUMP_TRUE ? IROp::JUMP_FALSE : IROp::JUMP_TRUE;
+            if (block.succs[1] == next)
+                code.emplace_back(t.op, label(block.succs[0]), t.arg1);
+            else if (block.succs[0] == next)
+                code.emplace_back(inverse, label(block.succs[1]), t.arg1);
+            else
+            {
+                code.emplace_back(t.op, label(block.succs[0]), t.arg1);
+                lines.push_back(line);
+                code.emplace_back(IROp::JUMP, label(block.succs[1]));
+            }
+            lines.push_back(line);
+        }
+        else
+        {
+            code.push_back(t);
+            lines.push_back(line);
+        }
+    }
+}
+
+// Every function of the program in SSA form, in program order.
+inline vector<SSAFunction> toSSA(IRProgram &ir)
+{
+    vector<CFG> graphs = buildCFGs(ir);
+    SSABuilder builder;
+    vector<SSAFunction> out;
+    out.reserve(graphs.size());
+    for (const CFG &g : graphs)
+        out.push_back(builder.build(ir, g));
+    return out;
+}
+
+// Replaces the code of every function by its SSA form taken back out of
+// SSA. Code outside the functions is kept as it is.
+inline void fromSSA(IRProgram &ir, vector<SSAFunction> &fns)
+{
+    vector<IRInstruction> code;
+    vector<int> lines;
+    code.reserve(ir.code.size());
+    lines.reserve(ir.code.size());
+    uint32_t at = 0;
+    for (size_t k = 0; k < fns.size(); k++)
+    {
+        IRFunction &fn = ir.functions[k];
+        code.insert(code.end(), ir.code.begin() + at, ir.code.begin() + fn.begin);
+        lines.insert(lines.end(), ir.lines.begin() + at, ir.lines.begin() + fn.begin);
+        at = fn.end;
+        uint32_t begin = uint32_t(code.size());
+        destroySSA(ir, fns[k], code, lines);
+        fn.begin = begin;
+        fn.end = uint32_t(code.size());
+        fns[k].source = fn;
+    }
+    code.insert(code.end(), ir.code.begin() + at, ir.code.end());
+    lines.insert(lines.end(), ir.lines.begin() + at, ir.lines.end());
+    ir.code = move(code);
+    ir.lines = move(lines);
+}
+
+// ---------------------------------------------------------------------
+// Printing and checking
+// ---------------------------------------------------------------------
+inline void printSSA(ostream &os, const IRProgram &ir, const SSAFunction &f)
+{
+    os << "=== SSA " << ir.format(IRInstruction(IROp::LABEL, f.source.name)) << " " << f.blockCount() << " blocks ===\n";
+    for (uint32_t b = 0; b < f.blockCount(); b++)
+    {
+        const SSABlock &block = f.blocks[b];
+        os << "B" << b;
+        if (!block.label.empty())
+            os << " (" << ir.operandText(block.label) << ")";
+        os << "  preds:";
+        for (uint32_t p : block.preds)
+            os << " B" << p;
+        os << "\n";
+        for (const Phi &phi : block.phis)
+        {
+            os << "    " << ir.operandText(phi.result) << " = phi(";
+            for (size_t k = 0; k < phi.args.size(); k++)
+                os << (k ? ", " : "") << ir.operandText(phi.args[k]) << " B" << block.preds[k];
+            os << ")  ; " << ir.operandText(phi.var) << "\n";
+        }
+        for (size_t i = 0; i + 1 < block.code.size(); i++)
+            os << "    " << ir.format(block.code[i]) << "\n";
+        const IRInstruction &t = block.terminator();
+        if (t.op == IROp::JUMP)
+            os << "    goto B" << block.succs[0] << "\n";
+        else if (t.op == IROp::JUMP_TRUE || t.op == IROp::JUMP_FALSE)
+            os << "    " << (t.op == IROp::JUMP_TRUE ? "if " : "ifFalse ") << ir.operandText(t.arg1) << " goto B"
+               << block.succs[0] << " else B" << block.succs[1] << "\n";
+        else
+            os << "    " << ir.format(t) << "\n";
+    }
+}
+
+// Checks that f is well-formed SSA: edges agree, every block ends in a
+// terminator matching its successors, no local symbol is left, each
+// temporary is written once, and every read is dominated by its write (a
+// phi's argument by the end of the matching predecessor). On failure
+// `why` says what is wrong.
+inline bool verifySSA(const IRProgram &ir, const SSAFunction &f, string &why)
+{
+    DominatorTree dt;
+    dt.compute(f);
+    const uint32_t NONE = DominatorTree::NONE;
+    uint32_t n = f.blockCount();
+    // Where each temp is written: block, and position (phis are -1)
+    unordered_map<uint32_t, pair<uint32_t, int>> defs;
+    auto fail = [&](uint32_t b, const string &msg)
+    {
+        why = "B" + to_string(b) + ": " + msg;
+        return false;
+    };
+    for (uint32_t b = 0; b < n; b++)
+    {
+        const SSABlock &block = f.blocks[b];
+        for (uint32_t s : block.succs)
+        {
+            const auto &p = f.blocks[s].preds;
+            if (count(p.begin(), p.end(), b) != 1)
+                return fail(b, "successor B" + to_string(s) + " does not list it once");
+        }
+        for (uint32_t p : block.preds)
+        {
+            const auto &s = f.blocks[p].succs;
+            if (find(s.begin(), s.end(), b) == s.end())
+                return fail(b, "predecessor B" + to_string(p) + " does not list it");
+        }
+        if (block.code.empty() || !endsBlock(block.terminator().op))
+            return fail(b, "no terminator");
+        IROp t = block.terminator().op;
+        size_t want = t == IROp::RET ? 0 : t == IROp::JUMP ? 1 : 2;
+        if (block.succs.size() != want)
+            return fail(b, "terminator does not match its successors");
+        for (size_t i = 0; i + 1 < block.code.size(); i++)
+            if (endsBlock(block.code[i].op) || block.code[i].op == IROp::LABEL)
+                return fail(b, "control flow inside the block");
+        for (const Phi &phi : block.phis)
+        {
+            if (phi.args.size() != block.preds.size())
+                return fail(b, "phi arity");
+            if (!defs.emplace(phi.result.bits, make_pair(b, -1)).second)
+                return fail(b, ir.operandText(phi.result) + " written twice");
+        }
+        for (size_t i = 0; i < block.code.size(); i++)
+        {
+            const IRInstruction &in = block.code[i];
+            const Operand *d = defOf(in, f.isPrologue(b, i));
+            if (d && ir.isLocal(*d))
+                return fail(b, "local symbol " + ir.operandText(*d) + " left");
+            if (d && d->kind() == Operand::Temp && !defs.emplace(d->bits, make_pair(b, int(i))).second)
+                return fail(b, ir.operandText(*d) + " written twice");
+        }
+    }
+    auto dominated = [&](Operand o, uint32_t b, int i)
+    {
+        if (ir.isLocal(o))
+            return false;
+        if (o.kind() != Operand::Temp)
+            return true;
+        auto it = defs.find(o.bits);
+        if (it == defs.end())
+            return false;
+        auto [db, di] = it->second;
+        return db == b ? di < i : dt.dominates(db, b);
+    };
+    for (uint32_t b = 0; b < n; b++)
+    {
+        if (dt.pre[b] == NONE)
+            continue;
+        const SSABlock &block = f.blocks[b];
+        for (const Phi &phi : block.phis)
+            for (size_t k = 0; k < phi.args.size(); k++)
+                if (dt.reachable(block.preds[k]) &&
+                    !dominated(phi.args[k], block.preds[k], int(f.blocks[block.preds[k]].code.size())))
+                    return fail(b, "phi argument " + ir.operandText(phi.args[k]) + " not available");
+        for (size_t i = 0; i < block.code.size(); i++)
+        {
+            bool ok = true;
+            forEachUse(block.code[i], f.isPrologue(b, i), [&](Operand o)
+                       { ok = ok && dominated(o, b, int(i)); });
+            if (!ok)
+                return fail(b, "read before write in " + ir.format(block.code[i]));
+        }
+    }
+    return true;
+}
+
+#ifndef IR_SSA_NO_MAIN
+// ---------------------------------------------------------------------
+// Main Driver: SSA form of every function in sample.txt, and the code
+// after translating out of SSA
+// ---------------------------------------------------------------------
+int main(int argc, char **argv)
+{
+    const string inputFile = argc > 1 ? argv[1] : "sample.txt";
+    try
+    {
+        ifstream file(inputFile);
+        if (!file.is_open())
+            throw runtime_error("Cannot open file: " + inputFile);
+        stringstream buffer;
+        buffer << file.rdbuf();
+
+        RegexLexer lexer(buffer.str());
+        Parser parser(lexer.tokenize());
+        Program program = parser.parseProgram();
+        TypeChecker checker;
+        checker.check(program);
+        ScopeChecker resolver;
+        resolver.analyse(program);
+        IRGenerator irGen;
+        irGen.generateIR(program);
+        IRProgram &ir = irGen.program();
+
+        vector<SSAFunction> fns = toSSA(ir);
+        for (const SSAFunction &f : fns)
+        {
+            printSSA(cout, ir, f);
+            string why;
+            if (!verifySSA(ir, f, why))
+                cout << "INVALID SSA: " << why << "\n";
+            cout << "\n";
+        }
+        fromSSA(ir, fns);
+        ir.print(cout);
+    }
+    catch (const exception &e)
+    {
+        cout << "ERROR: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
+#endif // IR_SSA_NO_MAIN
+#endif // IR_SSA_CPP
@@ -0,0 +1,41 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+// Fork-join helper for the checkers' parallel modes.
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Number of workers to use for `tasks` tasks; 0 asks for one per hardware
+// thread.
+inline unsigned resolveThreads(unsigned requested, size_t tasks)
+{
+    unsigned n = requested ? requested : std::max(1u, std::thread::hardware_concurrency());
+    return unsigned(std::max<size_t>(1, std::min<size_t>(n, tasks)));
+}
+
+// Calls fn(task, worker) for every task in [0, n) on `threads` workers; the
+// calling thread is worker 0. Tasks are claimed one at a time from a shared
+// counter, so a worker that draws cheap tasks simply takes more of them and
+// uneven task sizes balance out without a per-worker queue.
+template <class Fn>
+void parallelFor(size_t n, unsigned threads, Fn &&fn)
+{
+    std::atomic<size_t> next{0};
+    auto run = [&](unsigned worker)
+    {
+        for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < n;)
+            fn(i, worker);
+    };
+    std::vector<std::thread> pool;
+    for (unsigned w = 1; w < threads; w++)
+        pool.emplace_back(run, w);
+    run(0);
+    for (auto &t : pool)
+        t.join();
+}
+
+#endif
@@ -1,3 +1,5 @@
+#ifndef PARSER_CPP
+#define PARSER_CPP
 #include <bits/stdc++.h> // or whatever your header includes are // if you include the lexer this way
 #include "debug.hpp"
 
@@ -228,8 +230,47 @@ struct ASTNode
     virtual void print(ostream &os, int indent = 0) const = 0;
 };
 
+// Type of a checked expression. One byte per node, unlike TokenType, which
+// the checkers use for declared types.
+enum class ValueType : uint8_t
+{
+    Unknown,
+    Int,
+    Float,
+    Bool,
+    String,
+    Char
+};
+
+inline ValueType valueTypeOf(TokenType t)
+{
+    switch (t)
+    {
+    case TokenType::T_INT:
+        return ValueType::Int;
+    case TokenType::T_FLOAT:
+        return ValueType::Float;
+    case TokenType::T_BOOL:
+        return ValueType::Bool;
+    case TokenType::T_STRING:
+        return ValueType::String;
+    case TokenType::T_CHAR:
+        return ValueType::Char;
+    default:
+        return ValueType::Unknown;
+    }
+}
+
 struct Expr : ASTNode
 {
+    // Written by the type checker for every expression it types, so later
+    // passes read it instead of inferring again; Unknown until then, and
+    // always on a shared node.
+    mutable ValueType type = ValueType::Unknown;
+    // Set on nodes built through ExprInterner. One such node stands for
+    // many occurrences, possibly in functions checked on different threads,
+    // so checkers never annotate it.
+    bool shared = false;
     Expr(int l = 0, int c = 0) : ASTNode(l, c) {}
     virtual ~Expr() = default;
     // no extra methods unless you want
@@ -323,9 +364,30 @@ struct BoolLiteral : Expr
     }
 };
 
+// What a name refers to, written by the name-resolution pass
+// (ScopeChecker::analyse) so later passes can index instead of hashing.
+// Globals are numbered in declaration order. Locals get a slot in their
+// function's frame, parameters first and then locals in the order they are
+// declared, plus the scope depth of the declaration. A reference stays
+// Unresolved until resolution runs or when the name is undeclared, and
+// always on a node shared through ExprInterner (see Expr::shared).
+struct SymbolRef
+{
+    enum Kind : uint8_t
+    {
+        Unresolved,
+        Global,
+        Local
+    };
+    Kind kind = Unresolved;
+    uint16_t depth = 0;
+    uint32_t index = 0;
+};
+
 struct IdentifierExpr : Expr
 {
     string name;
+    mutable SymbolRef ref;
     IdentifierExpr(string n, int l = 0, int c = 0) : name(move(n))
     {
         line = l;
@@ -388,17 +450,41 @@ struct BinaryExpr : Expr
 };
 struct CallExpr : Expr
 {
-    string name;
+    ExprPtr callee;
+    // Callee identifier, referring to the name held by the callee node, which
+    // this call keeps alive and nothing renames; empty when the callee is any
+    // other expression
+    const string &name;
     vector<ExprPtr> args;
-    CallExpr(string n, vector<ExprPtr> a, int l = 0, int c = 0) : name(move(n)), args(move(a))
+    mutable SymbolRef ref; // resolution of `name`
+    CallExpr(ExprPtr f, vector<ExprPtr> a, int l = 0, int c = 0)
+        : callee(move(f)), name(calleeName(callee.get())), args(move(a))
     {
         line = l;
         col = c;
     }
+    CallExpr(string n, vector<ExprPtr> a, int l = 0, int c = 0)
+        : CallExpr(make_shared<IdentifierExpr>(n, l, c), move(a), l, c) {}
+    static const string &calleeName(const Expr *callee)
+    {
+        static const string none;
+        auto id = dynamic_cast<const IdentifierExpr *>(callee);
+        return id ? id->name : none;
+    }
     void print(ostream &os, int ind = 0) const override
     {
         indent(os, ind);
-        os << "Call(" << name << ") [l:" << line << " c:" << col << "]\n";
+        if (!name.empty())
+        {
+            os << "Call(" << name << ") [l:" << line << " c:" << col << "]\n";
+        }
+        else
+        {
+            os << "Call [l:" << line << " c:" << col << "]\n";
+            indent(os, ind + 1);
+            os << "Callee:\n";
+            callee->print(os, ind + 2);
+        }
         for (auto &a : args)
             a->print(os, ind + 1);
     }
@@ -489,6 +575,7 @@ struct VarDeclStmt : Stmt
     TokenType typeTok;
     string name;
     ExprPtr init;
+    mutable SymbolRef ref; // the symbol this declaration introduced
     VarDeclStmt(TokenType t, string n, ExprPtr i, int l = 0, int c = 0) : typeTok(t), name(move(n)), init(i)
     {
         line = l;
@@ -627,6 +714,7 @@ struct FnDecl : ASTNode
     string name;
     vector<pair<TokenType, string>> params;
     vector<StmtPtr> body;
+    mutable SymbolRef ref; // global id, once resolved
     FnDecl(TokenType rt, string n, int l = 0, int c = 0) : returnType(rt), name(move(n))
     {
         line = l;
@@ -668,6 +756,98 @@ struct Program : ASTNode
     }
 };
 
+// ---------- Hash-consing (optional) ----------
+// When a Parser is given an ExprInterner, structurally identical pure
+// expressions (literals, identifiers, and non-assigning unary/binary operators
+// over them) are built once and shared. Children are interned before their
+// parent, so a node is identified by (kind, text, child pointers) and the
+// structural hash is O(1) per node. Shared nodes are marked (Expr::shared)
+// and immutable: checkers leave their type and SymbolRef unset, so no two
+// checks ever write one concurrently. They keep the line/col of their first
+// occurrence; pointer equality is a free CSE hint.
+struct ExprInterner
+{
+    enum Kind
+    {
+        K_INT,
+        K_FLOAT,
+        K_STRING,
+        K_CHAR,
+        K_BOOL,
+        K_IDENT,
+        K_UNARY,
+        K_BINARY
+    };
+
+    struct Key
+    {
+        Kind kind;
+        string text;
+        const Expr *lhs;
+        const Expr *rhs;
+        bool operator==(const Key &o) const
+        {
+            return kind == o.kind && lhs == o.lhs && rhs == o.rhs && text == o.text;
+        }
+    };
+    struct KeyHash
+    {
+        size_t operator()(const Key &k) const
+        {
+            size_t h = hash<string>()(k.text) ^ (size_t(k.kind) * 0x9e3779b97f4a7c15ULL);
+            h ^= hash<const void *>()(k.lhs) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+            h ^= hash<const void *>()(k.rhs) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+            return h;
+        }
+    };
+
+    // Literal-only subtrees mean the same thing everywhere and live for the
+    // whole parse. Anything that mentions an identifier is only shared while
+    // the set of visible bindings is unchanged (see newBindingEpoch), so a
+    // shared IdentifierExpr always denotes a single declaration.
+    unordered_map<Key, ExprPtr, KeyHash> constants;
+    unordered_map<Key, ExprPtr, KeyHash> bound;
+    unordered_set<const Expr *> constantNodes;
+    unordered_set<const Expr *> boundNodes;
+    size_t requests = 0;
+    size_t reused = 0;
+
+    bool isShared(const Expr *e) const
+    {
+        return constantNodes.count(e) || boundNodes.count(e);
+    }
+
+    template <class Make>
+    ExprPtr intern(Kind kind, const string &text, const ExprPtr &lhs, const ExprPtr &rhs, Make make)
+    {
+        requests++;
+        bool constant = kind != K_IDENT &&
+                        (!lhs || constantNodes.count(lhs.get())) &&
+                        (!rhs || constantNodes.count(rhs.get()));
+        auto &table = constant ? constants : bound;
+        Key key{kind, text, lhs.get(), rhs.get()};
+        auto it = table.find(key);
+        if (it != table.end())
+        {
+            reused++;
+            return it->second;
+        }
+        ExprPtr node = make();
+        node->shared = true;
+        (constant ? constantNodes : boundNodes).insert(node.get());
+        table.emplace(move(key), node);
+        return node;
+    }
+
+    // Called by the parser whenever a declaration or scope exit changes what
+    // an identifier refers to.
+    void newBindingEpoch()
+    {
+        bound.clear();
+        boundNodes.clear();
+    }
+};
+
 // ---------- TokenStream (skips trivia: comments and quotes) ----------
 struct TokenStream
 {
@@ -796,10 +976,28 @@ static std::string tokToOp(const Token &tok)
 struct Parser
 {
     TokenStream ts;
-    int fnDepth = 0; // 0 = top-level, >0 = inside a function body
+    int fnDepth = 0;                  // 0 = top-level, >0 = inside a function body
+    ExprInterner *interner = nullptr; // non-null = hash-cons pure expressions
+    unordered_map<string, ExprPtr> calleeNodes;
 
     Parser() = default;
-    Parser(vector<Token> tokens) : ts(move(tokens)) {}
+    Parser(vector<Token> tokens, ExprInterner *in = nullptr) : ts(move(tokens)), interner(in) {}
+
+    // Build a pure expression node, sharing it through the interner when
+    // hash-consing is on and all of its children are shared nodes too.
+    template <class Make>
+    ExprPtr pure(ExprInterner::Kind kind, const string &text, const ExprPtr &lhs, const ExprPtr &rhs, Make make)
+    {
+        if (!interner || (lhs && !interner->isShared(lhs.get())) || (rhs && !interner->isShared(rhs.get())))
+            return make();
+        return interner->intern(kind, text, lhs, rhs, make);
+    }
+
+    void bindingsChanged()
+    {
+        if (interner)
+            interner->newBindingEpoch();
+    }
     // Skip tokens until we reach a statement boundary.
     // If consumeBracer==true (top-level), swallow a stray '}' so we make progress.
     // If consumeBracer==false (inside a block), stop at '}' and let the caller handle it.
@@ -1058,6 +1256,7 @@ struct Parser
 
             // Parse Body
             fnDepth++;
+            bindingsChanged(); // parameters now in scope
             auto bodyBlock = make_shared<BlockStmt>(ts.peek().line, ts.peek().col);
             while (!ts.eof())
             {
@@ -1080,6 +1279,7 @@ struct Parser
                 throw ParseError(ParseErrorKind::UnexpectedToken, ts.peek(), "Expected '}'");
 
             fnDepth--;
+            bindingsChanged();
             return fn;
         }
 
@@ -1149,6 +1349,7 @@ struct Parser
                 throw ParseError(ParseErrorKind::UnexpectedToken, ts.peek(), "Expected '{' or ';'");
 
             fnDepth++;
+            bindingsChanged(); // parameters now in scope
             auto bodyBlock = make_shared<BlockStmt>(ts.peek().line, ts.peek().col);
             while (!ts.eof() && ts.peek().type != TokenType::T_BRACER)
             {
@@ -1168,6 +1369,7 @@ struct Parser
             if (!ts.match(TokenType::T_BRACER))
                 throw ParseError(ParseErrorKind::UnexpectedToken, ts.peek(), "Expected '}'");
             fnDepth--;
+            bindingsChanged();
             return fn;
         }
         else
@@ -1181,6 +1383,7 @@ struct Parser
             if (!ts.match(TokenType::T_SEMICOLON))
                 throw ParseError(ParseErrorKind::UnexpectedToken, ts.peek(), "Expected ';'");
 
+            bindingsChanged();
             return make_shared<VarDeclStmt>(typeTok.type, id.lexeme, init, typeTok.line, typeTok.col);
         }
     }
@@ -1230,6 +1433,7 @@ struct Parser
                 auto block = make_shared<BlockStmt>(typeTok.line, typeTok.col);
                 block->stmts.push_back(
                     make_shared<VarDeclStmt>(typeTok.type, name.lexeme, init, name.line, name.col));
+                bindingsChanged();
                 do
                 {
                     Token n2 = ts.peek();
@@ -1243,6 +1447,7 @@ struct Parser
                     }
                     block->stmts.push_back(
                         make_shared<VarDeclStmt>(typeTok.type, n2.lexeme, i2, n2.line, n2.col));
+                    bindingsChanged();
                 } while (ts.match(TokenType::T_COMMA));
 
                 if (!ts.match(TokenType::T_SEMICOLON))
@@ -1255,6 +1460,7 @@ struct Parser
                 if (!ts.match(TokenType::T_SEMICOLON))
                     throw ParseError(ParseErrorKind::UnexpectedToken, ts.peek(), "Expected ';' after variable declaration");
 
+                bindingsChanged();
                 return make_shared<VarDeclStmt>(typeTok.type, name.lexeme, init, name.line, name.col);
             }
         }
@@ -1347,6 +1553,7 @@ struct Parser
                         init = parseExpression();
                     else
                         init = nullptr;
+                    bindingsChanged();
                 }
                 else
                 {
@@ -1389,6 +1596,7 @@ struct Parser
                 if (next.type == TokenType::T_BRACER)
                 {
                     ts.advance(); // consume '}'
+                    bindingsChanged();
                     break;
                 }
 
@@ -1469,50 +1677,69 @@ struct Parser
             if (opTok.type == TokenType::T_PLUS_EQ || opTok.type == TokenType::T_MINUS_EQ)
             {
                 const std::string bop = (opTok.type == TokenType::T_PLUS_EQ) ? "+" : "-";
-                auto combined = std::make_shared<BinaryExpr>(bop, left, right, opTok.line, opTok.col);
+                ExprPtr combined = pure(ExprInterner::K_BINARY, bop, left, right, [&]
+                                        { return std::make_shared<BinaryExpr>(bop, left, right, opTok.line, opTok.col); });
                 left = std::make_shared<BinaryExpr>("=", left, combined, opTok.line, opTok.col);
                 continue;
             }
 
-            left = std::make_shared<BinaryExpr>(tokToOp(opTok), left, right, opTok.line, opTok.col);
+            const std::string bop = tokToOp(opTok);
+            if (bop == "=")
+                left = std::make_shared<BinaryExpr>(bop, left, right, opTok.line, opTok.col);
+            else
+                left = pure(ExprInterner::K_BINARY, bop, left, right, [&]
+                            { return std::make_shared<BinaryExpr>(bop, left, right, opTok.line, opTok.col); });
         }
 
         return left;
     }
 
+    // Parses the argument list after '(' and moves it into the node trimmed
+    // to its exact size, as most calls take one or two arguments. The single
+    // path for every call, named or not.
+    ExprPtr parseCallArgs(ExprPtr callee, int callLine, int callCol)
+    {
+        vector<ExprPtr> args;
+        if (!ts.match(TokenType::T_PARENR))
+        {
+            while (true)
+            {
+                args.push_back(parseExpression());
+                if (ts.match(TokenType::T_COMMA))
+                    continue;
+                if (ts.match(TokenType::T_PARENR))
+                    break;
+                throw ParseError(ParseErrorKind::UnexpectedToken, ts.peek(),
+                                 "Expected ',' or ')' in argument list");
+            }
+            args.shrink_to_fit();
+        }
+        return make_shared<CallExpr>(move(callee), move(args), callLine, callCol);
+    }
+
+    // Function names are global, so one immutable callee node per name is
+    // shared by all of its calls (like ExprInterner, it keeps the position of
+    // the first call; each CallExpr carries its own).
+    ExprPtr calleeNode(const Token &t)
+    {
+        ExprPtr &node = calleeNodes[t.lexeme];
+        if (!node)
+            node = make_shared<IdentifierExpr>(t.lexeme, t.line, t.col);
+        return node;
+    }
+
     ExprPtr parsePostfixTrail(ExprPtr left)
     {
         while (true)
         {
             Token t = ts.peek();
 
-            // function call: foo(...), also supports zero args foo()
+            // function call: foo(...), also supports zero args foo() and
+            // calls on any other expression, e.g. f(1)(2)
             if (t.type == TokenType::T_PARENL)
             {
-                int callLine = t.line, callCol = t.col;
                 ts.advance(); // '('
-                vector<ExprPtr> args;
-                if (!ts.match(TokenType::T_PARENR))
-                {
-                    while (true)
-                    {
-                        ExprPtr arg = parseExpression();
-                        args.push_back(arg);
-                        if (ts.match(TokenType::T_COMMA))
-                            continue;
-                        if (ts.match(TokenType::T_PARENR))
-                            break;
-                        throw ParseError(ParseErrorKind::UnexpectedToken, ts.peek(),
-                                         "Expected ',' or ')' in argument list");
-                    }
-                }
-                string fnName;
-                if (auto id = dynamic_pointer_cast<IdentifierExpr>(left))
-                    fnName = id->name;
-                else
-                    fnName = "<unknown_fn>";
-
-                left = make_shared<CallExpr>(fnName, args, callLine, callCol);
+                left = parseCallArgs(left, t.line, t.col);
                 continue;
             }
 
@@ -1560,25 +1787,29 @@ struct Parser
         if (t.type == TokenType::T_INTLIT)
         {
             ts.advance();
-            auto node = make_shared<IntLiteral>(t.lexeme, t.line, t.col);
+            ExprPtr node = pure(ExprInterner::K_INT, t.lexeme, nullptr, nullptr, [&]
+                                { return make_shared<IntLiteral>(t.lexeme, t.line, t.col); });
             return parsePostfixTrail(node);
         }
         if (t.type == TokenType::T_FLOATLIT)
         {
             ts.advance();
-            auto node = make_shared<FloatLiteral>(t.lexeme, t.line, t.col);
+            ExprPtr node = pure(ExprInterner::K_FLOAT, t.lexeme, nullptr, nullptr, [&]
+                                { return make_shared<FloatLiteral>(t.lexeme, t.line, t.col); });
             return parsePostfixTrail(node);
         }
         if (t.type == TokenType::T_STRINGLIT)
         {
             ts.advance();
-            auto node = make_shared<StringLiteral>(t.lexeme, t.line, t.col);
+            ExprPtr node = pure(ExprInterner::K_STRING, t.lexeme, nullptr, nullptr, [&]
+                                { return make_shared<StringLiteral>(t.lexeme, t.line, t.col); });
             return parsePostfixTrail(node);
         }
         if (t.type == TokenType::T_CHARLIT)
         {
             ts.advance();
-            auto node = make_shared<CharLiteral>(t.lexeme, t.line, t.col);
+            ExprPtr node = pure(ExprInterner::K_CHAR, t.lexeme, nullptr, nullptr, [&]
+                                { return make_shared<CharLiteral>(t.lexeme, t.line, t.col); });
             return parsePostfixTrail(node);
         }
 
@@ -1586,7 +1817,8 @@ struct Parser
         {
             ts.advance();
             bool val = (t.lexeme == "true");
-            auto node = make_shared<BoolLiteral>(val, t.line, t.col);
+            ExprPtr node = pure(ExprInterner::K_BOOL, t.lexeme, nullptr, nullptr, [&]
+                                { return make_shared<BoolLiteral>(val, t.line, t.col); });
             return parsePostfixTrail(node);
         }
 
@@ -1594,29 +1826,12 @@ struct Parser
         if (t.type == TokenType::T_IDENTIFIER)
         {
             ts.advance();
-            auto id = make_shared<IdentifierExpr>(t.lexeme, t.line, t.col);
 
-            // ✅ function call detection
+            // A named call is positioned at its identifier.
             if (ts.match(TokenType::T_PARENL))
-            {
-                int callLine = t.line, callCol = t.col;
-                vector<ExprPtr> args;
-                if (!ts.match(TokenType::T_PARENR))
-                {
-                    while (true)
-                    {
-                        ExprPtr arg = parseExpression();
-                        args.push_back(arg);
-                        if (ts.match(TokenType::T_COMMA))
-                            continue;
-                        if (ts.match(TokenType::T_PARENR))
-                            break;
-                        throw ParseError(ParseErrorKind::UnexpectedToken, ts.peek(), "Expected ',' or ')'");
-                    }
-                }
-                auto call = make_shared<CallExpr>(t.lexeme, args, callLine, callCol);
-                return parsePostfixTrail(call);
-            }
+                return parsePostfixTrail(parseCallArgs(calleeNode(t), t.line, t.col));
+            ExprPtr id = pure(ExprInterner::K_IDENT, t.lexeme, nullptr, nullptr, [&]
+                              { return make_shared<IdentifierExpr>(t.lexeme, t.line, t.col); });
             return parsePostfixTrail(id);
         }
 
@@ -1647,7 +1862,11 @@ struct Parser
             if (!rhs)
                 throw ParseError(ParseErrorKind::ExpectedExpr, ts.peek(),
                                  "Expected expression after unary operator");
-            return make_shared<UnaryExpr>(tokToOp(t), rhs, unLine, unCol);
+            const string uop = tokToOp(t);
+            if (uop == "++" || uop == "--")
+                return make_shared<UnaryExpr>(uop, rhs, unLine, unCol);
+            return pure(ExprInterner::K_UNARY, uop, rhs, nullptr, [&]
+                        { return make_shared<UnaryExpr>(uop, rhs, unLine, unCol); });
         }
 
         DBG("[DBG] parsePrefix() - not a valid prefix expression");
@@ -1665,4 +1884,5 @@ struct Parser
         auto it = OP_TABLE.find(t);
         return (it != OP_TABLE.end() && it->second.assoc == RIGHT);
     }
-};
\ No newline at end of file
+};
+#endif // PARSER_CPP
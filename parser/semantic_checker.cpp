@@ -0,0 +1,632 @@
+// semantic_checker.cpp
+// Define SEMANTIC_CHECKER_NO_MAIN before including to reuse SemanticChecker in another driver.
+#ifndef SEMANTIC_CHECKER_CPP
+#define SEMANTIC_CHECKER_CPP
+#define PARSER_REUSE_LEXER
+#include "../regex/regex_code.cpp"
+#include "parser.cpp"
+#ifndef SCOPE_CHECKER_NO_MAIN
+#define SCOPE_CHECKER_NO_MAIN
+#endif
+#include "scope_checker.cpp"
+#ifndef TYPE_CHECKER_NO_MAIN
+#define TYPE_CHECKER_NO_MAIN
+#endif
+#include "type_checker.cpp"
+#include <cstdint>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+// ---------------------------------------------------------------------
+// SemanticChecker - scope and type checking in one walk
+// ---------------------------------------------------------------------
+// Produces exactly the diagnostics of ScopeChecker::analyse followed by
+// TypeChecker::check, each list in its own checker's order, from a single
+// traversal over a single symbol table.
+//
+// The two checkers do not see scopes the same way: the type checker gives
+// a function body block a scope of its own and none to loops, declares a
+// variable before checking its initialiser, and skips do-while entirely on
+// the scope side. So every table entry records whether it is visible to the
+// scope rules, the type rules or both, and every frame records which of the
+// two it opens. The walk carries the same two switches, so a subtree one
+// checker would not visit is still walked for the other without reporting
+// on its behalf.
+class SemanticChecker
+{
+public:
+    using ScopeError = ScopeChecker::ScopeError;
+
+    // Codes are ScopeError and TypeChkError respectively
+    DiagnosticEngine scopeErrors;
+    DiagnosticEngine typeErrors;
+
+    void analyse(const Program &prog)
+    {
+        scopeErrors.clear();
+        typeErrors.clear();
+        entries.clear();
+        frames.clear();
+        head.assign(head.size(), NO_ENTRY);
+        scopeDepth = typeDepth = -1;
+        scopeFunctionDepth = scopeLoopDepth = typeLoopDepth = 0;
+        returnType = TokenType::T_UNKNOWN;
+
+        pushFrame(true, true);
+        registerGlobals(prog);
+        for (const auto &item : prog.items)
+            checkItem(item);
+        popFrame();
+    }
+
+    size_t scopeErrorCount() const { return scopeErrors.size(); }
+    string formatScopeError(size_t i) const { return ScopeChecker::format(scopeErrors[i], scopeErrors.message(i)); }
+    size_t typeErrorCount() const { return typeErrors.size(); }
+    TypeError typeErrorAt(size_t i) const
+    {
+        const auto &r = typeErrors[i];
+        return TypeError(TypeChkError(r.code), r.line, r.col, typeErrors.message(r));
+    }
+
+    void printErrors(ostream &os) const
+    {
+        if (scopeErrors.reported() == 0)
+            os << "No scope errors found\n";
+        else
+        {
+            os << "Scope errors:\n";
+            for (size_t i = 0; i < scopeErrors.size(); ++i)
+                os << "  " << formatScopeError(i) << "\n";
+        }
+        if (typeErrors.reported() == 0)
+            os << "No type errors found!\n";
+        for (size_t i = 0; i < typeErrors.size(); ++i)
+        {
+            TypeError err = typeErrorAt(i);
+            os << errorToString(err.type) << " at line " << err.line << ", col " << err.col << " : " << err.detail << "\n";
+        }
+    }
+
+private:
+    static constexpr uint32_t NO_ENTRY = UINT32_MAX;
+
+    // Which checker's rules a frame, entry or walk applies to.
+    struct Views
+    {
+        bool scope, type;
+    };
+
+    struct Entry
+    {
+        uint32_t nameId;
+        uint32_t prev; // next older entry for the same name, or NO_ENTRY
+        int scopeDepth, typeDepth;
+        bool inScope, inType;
+        bool isFunc;
+        TokenType type;
+        uint32_t params; // index into fnParams for functions
+    };
+
+    struct Frame
+    {
+        size_t mark;
+        Views views;
+    };
+
+    unordered_map<string, uint32_t> nameIds;
+    vector<uint32_t> head;
+    vector<Entry> entries;
+    vector<Frame> frames;
+    vector<vector<TokenType>> fnParams;
+    int scopeDepth = -1, typeDepth = -1;
+    int scopeFunctionDepth = 0, scopeLoopDepth = 0, typeLoopDepth = 0;
+    TokenType returnType = TokenType::T_UNKNOWN;
+    bool sawReturn = false;
+
+    // ---------- Symbol table ----------
+    void pushFrame(bool scope, bool type)
+    {
+        frames.push_back(Frame{entries.size(), {scope, type}});
+        scopeDepth += scope;
+        typeDepth += type;
+    }
+
+    // Entries still visible to the view the frame did not open belong to an
+    // enclosing scope of that view; they are kept, restricted to it.
+    void popFrame()
+    {
+        Frame f = frames.back();
+        frames.pop_back();
+        vector<Entry> keep;
+        while (entries.size() > f.mark)
+        {
+            Entry &e = entries.back();
+            if ((!f.views.scope && e.inScope) || (!f.views.type && e.inType))
+            {
+                keep.push_back(e);
+                keep.back().inScope = !f.views.scope && e.inScope;
+                keep.back().inType = !f.views.type && e.inType;
+            }
+            head[e.nameId] = e.prev;
+            entries.pop_back();
+        }
+        scopeDepth -= f.views.scope;
+        typeDepth -= f.views.type;
+        for (auto it = keep.rbegin(); it != keep.rend(); ++it)
+        {
+            it->prev = head[it->nameId];
+            entries.push_back(*it);
+            head[it->nameId] = uint32_t(entries.size() - 1);
+        }
+    }
+
+    uint32_t declare(const string &name, TokenType type, bool inScope, bool inType,
+                     bool isFunc = false, uint32_t params = 0)
+    {
+        auto [it, inserted] = nameIds.try_emplace(name, uint32_t(head.size()));
+        if (inserted)
+            head.push_back(NO_ENTRY);
+        uint32_t id = it->second;
+        entries.push_back(Entry{id, head[id], scopeDepth, typeDepth, inScope, inType, isFunc, type, params});
+        head[id] = uint32_t(entries.size() - 1);
+        return head[id];
+    }
+
+    // Innermost entry for `name` visible to the scope (or type) rules.
+    uint32_t find(const string &name, bool scopeView) const
+    {
+        auto it = nameIds.find(name);
+        if (it == nameIds.end())
+            return NO_ENTRY;
+        uint32_t e = head[it->second];
+        while (e != NO_ENTRY && !(scopeView ? entries[e].inScope : entries[e].inType))
+            e = entries[e].prev;
+        return e;
+    }
+
+    bool declaredHere(const string &name, bool scopeView) const
+    {
+        uint32_t e = find(name, scopeView);
+        return e != NO_ENTRY && (scopeView ? entries[e].scopeDepth == scopeDepth : entries[e].typeDepth == typeDepth);
+    }
+
+    void scopeError(ScopeError kind, const ASTNode &at, const char *format,
+                    string_view a = {}, string_view b = {}, int32_t number = 0)
+    {
+        scopeErrors.report(uint8_t(kind), at.line, at.col, format, a, b, number);
+    }
+    void typeError(TypeChkError kind, const ASTNode &at, const char *format,
+                   string_view a = {}, string_view b = {}, int32_t number = 0)
+    {
+        typeErrors.report(uint8_t(kind), at.line, at.col, format, a, b, number);
+    }
+
+    // ---------- Globals ----------
+    void registerGlobals(const Program &prog)
+    {
+        for (const auto &item : prog.items)
+        {
+            if (auto fn = dynamic_cast<const FnDecl *>(item.get()))
+            {
+                uint32_t e = find(fn->name, true);
+                if (e != NO_ENTRY)
+                {
+                    const Entry &existing = entries[e];
+                    if (!existing.isFunc)
+                        scopeError(ScopeError::VariableRedefinition, *fn, "Function '{0}' conflicts with variable.", fn->name);
+                    else
+                        scopeError(ScopeError::FunctionPrototypeRedefinition, *fn, "Function '{0}' redefined.", fn->name);
+                    if (!existing.isFunc || fnParams[existing.params].size() != fn->params.size())
+                        typeError(TypeChkError::ErroneousVarDecl, *fn, "Function '{0}' redefined with different signature", fn->name);
+                    continue;
+                }
+                vector<TokenType> pts;
+                for (auto &pr : fn->params)
+                    pts.push_back(pr.first);
+                fnParams.push_back(move(pts));
+                declare(fn->name, fn->returnType, true, true, true, uint32_t(fnParams.size() - 1));
+            }
+            else if (auto var = dynamic_cast<const VarDeclStmt *>(item.get()))
+            {
+                if (declaredHere(var->name, true))
+                {
+                    scopeError(ScopeError::VariableRedefinition, *var, "Identifier '{0}' redefined in the same scope at line {n}", var->name, {}, int32_t(var->line));
+                    typeError(TypeChkError::ErroneousVarDecl, *var, "Global variable '{0}' redefined", var->name);
+                }
+                else
+                    declare(var->name, var->typeTok, true, true);
+            }
+        }
+    }
+
+    void checkItem(const shared_ptr<ASTNode> &item)
+    {
+        if (auto fn = dynamic_cast<const FnDecl *>(item.get()))
+            checkFunction(*fn);
+        else if (auto var = dynamic_cast<const VarDeclStmt *>(item.get()))
+        {
+            if (!isTypeValid(var->typeTok))
+                typeError(TypeChkError::ErroneousVarDecl, *var, "Invalid type for variable '{0}'", var->name);
+            if (var->init && visitExpr(var->init.get(), {true, true}) != var->typeTok)
+                typeError(TypeChkError::ExpressionTypeMismatch, *var, "Initializer for '{0}' type mismatch", var->name);
+        }
+        else if (auto stmt = dynamic_cast<const Stmt *>(item.get()))
+        {
+            returnType = TokenType::T_UNKNOWN;
+            visitStmt(stmt, true);
+        }
+    }
+
+    void checkFunction(const FnDecl &f)
+    {
+        if (scopeFunctionDepth > 0)
+            scopeError(ScopeError::LocalFunctionDefinition, f, "Nested function '{0}' not allowed.", f.name);
+        scopeFunctionDepth++;
+        pushFrame(true, true);
+
+        vector<const string *> seen;
+        for (auto &param : f.params)
+        {
+            bool duplicate = declaredHere(param.second, true);
+            if (duplicate)
+            {
+                scopeError(ScopeError::VariableRedefinition, f, "Identifier '{0}' redefined in the same scope at line {n}", param.second, {}, int32_t(f.line));
+                typeError(TypeChkError::ErroneousVarDecl, f, "Parameter '{0}' redefined in function '{1}'", param.second, f.name);
+                typeError(TypeChkError::FnCallParamType, f, "Duplicate function parameter name: {0}", param.second);
+            }
+            else
+                declare(param.second, param.first, true, true);
+        }
+
+        // The scope rules keep the body in the parameters' scope; the type
+        // rules open one for the body block.
+        returnType = f.returnType;
+        sawReturn = false;
+        for (auto &stmt : f.body)
+        {
+            if (auto block = dynamic_cast<const BlockStmt *>(stmt.get()))
+            {
+                pushFrame(false, true);
+                for (auto &inner : block->stmts)
+                    visitStmt(inner.get(), true);
+                popFrame();
+            }
+            else
+                visitStmt(stmt.get(), true);
+        }
+        if (f.returnType != TokenType::T_UNKNOWN && !sawReturn)
+            typeError(TypeChkError::ReturnStmtNotFound, f, "Function '{0}' missing return statement", f.name);
+
+        popFrame();
+        scopeFunctionDepth--;
+    }
+
+    // ---------- Statements ----------
+    // `scope` is false inside statements ScopeChecker does not visit.
+    void visitStmt(const Stmt *s, bool scope)
+    {
+        if (!s)
+            return;
+        Views both{scope, true};
+        if (auto block = dynamic_cast<const BlockStmt *>(s))
+        {
+            pushFrame(scope, true);
+            for (auto &stmt : block->stmts)
+                visitStmt(stmt.get(), scope);
+            popFrame();
+        }
+        else if (auto var = dynamic_cast<const VarDeclStmt *>(s))
+            visitVarDecl(*var, scope);
+        else if (auto ifStmt = dynamic_cast<const IfStmt *>(s))
+        {
+            if (visitExpr(ifStmt->cond.get(), both) != TokenType::T_BOOL)
+                typeError(TypeChkError::ExpectedBooleanExpression, *ifStmt, "Condition of if is not boolean");
+            visitStmt(ifStmt->thenStmt.get(), scope);
+            visitStmt(ifStmt->elseStmt.get(), scope);
+        }
+        else if (auto whileStmt = dynamic_cast<const WhileStmt *>(s))
+        {
+            pushFrame(scope, false);
+            scopeLoopDepth += scope;
+            typeLoopDepth++;
+            if (visitExpr(whileStmt->cond.get(), both) != TokenType::T_BOOL)
+                typeError(TypeChkError::NonBooleanCondStmt, *whileStmt, "While condition not boolean");
+            visitStmt(whileStmt->body.get(), scope);
+            typeLoopDepth--;
+            scopeLoopDepth -= scope;
+            popFrame();
+        }
+        else if (auto doWhile = dynamic_cast<const DoWhileStmt *>(s))
+        {
+            // Type rules only.
+            typeLoopDepth++;
+            visitStmt(doWhile->body.get(), false);
+            if (visitExpr(doWhile->cond.get(), {false, true}) != TokenType::T_BOOL)
+                typeError(TypeChkError::NonBooleanCondStmt, *doWhile, "Do-while condition not boolean");
+            typeLoopDepth--;
+        }
+        else if (auto forStmt = dynamic_cast<const ForStmt *>(s))
+        {
+            pushFrame(scope, false);
+            scopeLoopDepth += scope;
+            typeLoopDepth++;
+            if (forStmt->init)
+                checkExprStmt(forStmt->init.get(), scope);
+            if (forStmt->cond && visitExpr(forStmt->cond.get(), both) != TokenType::T_BOOL)
+                typeError(TypeChkError::NonBooleanCondStmt, *forStmt, "For condition not boolean");
+            if (forStmt->post)
+                checkExprStmt(forStmt->post.get(), scope);
+            visitStmt(forStmt->body.get(), scope);
+            typeLoopDepth--;
+            scopeLoopDepth -= scope;
+            popFrame();
+        }
+        else if (auto ret = dynamic_cast<const ReturnStmt *>(s))
+        {
+            sawReturn = true;
+            if (scope && scopeFunctionDepth == 0)
+                scopeError(ScopeError::ReturnOutsideFunction, *ret, "Return statement outside function.");
+            if (!ret->expr)
+                typeError(TypeChkError::EmptyExpression, *ret, "Return statement missing expression");
+            else if (visitExpr(ret->expr.get(), both) != returnType)
+                typeError(TypeChkError::ErroneousReturnType, *ret, "Return type mismatch");
+        }
+        else if (dynamic_cast<const BreakStmt *>(s))
+        {
+            if (scope && scopeLoopDepth == 0)
+                scopeError(ScopeError::BreakOutsideLoop, *s, "Break statement outside loop.");
+            if (typeLoopDepth <= 0)
+                typeError(TypeChkError::ErroneousBreak, *s, "break outside of loop");
+        }
+        else if (auto exprStmt = dynamic_cast<const ExprStmt *>(s))
+        {
+            if (exprStmt->expr)
+                checkExprStmt(exprStmt->expr.get(), scope);
+        }
+    }
+
+    // The type rules declare the name before checking the initialiser, the
+    // scope rules after; each side reports its own redefinitions.
+    void visitVarDecl(const VarDeclStmt &v, bool scope)
+    {
+        if (!isTypeValid(v.typeTok))
+            typeError(TypeChkError::ErroneousVarDecl, v, "Invalid type for variable '{0}'", v.name);
+        uint32_t typed = NO_ENTRY;
+        if (declaredHere(v.name, false))
+            typeError(TypeChkError::ErroneousVarDecl, v, "Variable '{0}' redefined in local scope", v.name);
+        else
+            typed = declare(v.name, v.typeTok, false, true);
+
+        if (v.init && visitExpr(v.init.get(), {scope, true}) != v.typeTok)
+            typeError(TypeChkError::ExpressionTypeMismatch, v, "Initializer for '{0}' type mismatch", v.name);
+
+        if (!scope)
+            return;
+        if (declaredHere(v.name, true))
+            scopeError(ScopeError::VariableRedefinition, v, "Identifier '{0}' redefined in the same scope at line {n}", v.name, {}, int32_t(v.line));
+        else if (typed != NO_ENTRY)
+            entries[typed].inScope = true;
+        else
+            declare(v.name, v.typeTok, true, false);
+    }
+
+    // An expression used as a statement must resolve to a type.
+    void checkExprStmt(const Expr *e, bool scope)
+    {
+        if (visitExpr(e, {scope, true}) == TokenType::T_UNKNOWN)
+            typeError(TypeChkError::EmptyExpression, *e, "Expression could not be resolved");
+    }
+
+    // ---------- Expressions ----------
+    // Resolves names under the rules in `on` and returns the expression's
+    // type (meaningful only when on.type is set, and then recorded on the
+    // node as TypeChecker does).
+    TokenType visitExpr(const Expr *expr, Views on)
+    {
+        TokenType t = inferExpr(expr, on);
+        if (expr && on.type && !expr->shared)
+            expr->type = valueTypeOf(t);
+        return t;
+    }
+
+    TokenType inferExpr(const Expr *expr, Views on)
+    {
+        if (!expr)
+            return TokenType::T_UNKNOWN;
+        if (auto id = dynamic_cast<const IdentifierExpr *>(expr))
+        {
+            if (on.scope && find(id->name, true) == NO_ENTRY)
+                scopeError(ScopeError::UndeclaredVariableAccessed, *id, "Variable '{0}' used but not declared.", id->name);
+            if (!on.type)
+                return TokenType::T_UNKNOWN;
+            uint32_t e = find(id->name, false);
+            return e != NO_ENTRY ? entries[e].type : TokenType::T_UNKNOWN;
+        }
+        if (dynamic_cast<const IntLiteral *>(expr))
+            return TokenType::T_INT;
+        if (dynamic_cast<const FloatLiteral *>(expr))
+            return TokenType::T_FLOAT;
+        if (dynamic_cast<const StringLiteral *>(expr))
+            return TokenType::T_STRING;
+        if (dynamic_cast<const CharLiteral *>(expr))
+            return TokenType::T_CHAR;
+        if (dynamic_cast<const BoolLiteral *>(expr))
+            return TokenType::T_BOOL;
+        if (auto bin = dynamic_cast<const BinaryExpr *>(expr))
+        {
+            TokenType lt = visitExpr(bin->lhs.get(), on);
+            TokenType rt = visitExpr(bin->rhs.get(), on);
+            return on.type ? binaryType(*bin, lt, rt) : TokenType::T_UNKNOWN;
+        }
+        if (auto call = dynamic_cast<const CallExpr *>(expr))
+            return visitCall(*call, on);
+        if (auto unary = dynamic_cast<const UnaryExpr *>(expr))
+        {
+            TokenType sub = visitExpr(unary->rhs.get(), on);
+            if (!on.type)
+                return TokenType::T_UNKNOWN;
+            if (unary->op == "!")
+            {
+                if (sub != TokenType::T_BOOL)
+                    typeError(TypeChkError::AttemptedBoolOpOnNonBools, *unary, "Logical NOT on non-bool type");
+                return TokenType::T_BOOL;
+            }
+            if (unary->op == "-")
+            {
+                if (!isNumericType(sub))
+                    typeError(TypeChkError::AttemptedAddOpOnNonNumeric, *unary, "Unary minus on non-numeric type");
+                return sub;
+            }
+        }
+        return TokenType::T_UNKNOWN;
+    }
+
+    // Arguments the type rules would not look at (unknown callee, wrong
+    // count) are still walked for the scope rules.
+    TokenType visitCall(const CallExpr &call, Views on)
+    {
+        Views scopeOnly{on.scope, false};
+        if (call.name.empty())
+        {
+            visitExpr(call.callee.get(), on);
+            if (on.type)
+                typeError(TypeChkError::FnCallParamType, call, "Called expression is not a function");
+            for (auto &arg : call.args)
+                visitExpr(arg.get(), scopeOnly);
+            return TokenType::T_UNKNOWN;
+        }
+        if (on.scope && find(call.name, true) == NO_ENTRY)
+            scopeError(ScopeError::UndefinedFunctionCalled, call, "Function '{0}' called but not defined.", call.name);
+
+        uint32_t e = on.type ? find(call.name, false) : NO_ENTRY;
+        if (on.type && (e == NO_ENTRY || !entries[e].isFunc))
+        {
+            typeError(TypeChkError::FnCallParamType, call, "Call to undefined function '{0}'", call.name);
+            on.type = false;
+        }
+        else if (on.type && call.args.size() != fnParams[entries[e].params].size())
+        {
+            typeError(TypeChkError::FnCallParamCount, call, "Function '{0}' parameter count mismatch", call.name);
+            on.type = false;
+        }
+        if (!on.type)
+        {
+            for (auto &arg : call.args)
+                visitExpr(arg.get(), scopeOnly);
+            return e == NO_ENTRY || !entries[e].isFunc ? TokenType::T_UNKNOWN : entries[e].type;
+        }
+        // fnParams is only appended to while globals are registered, so the
+        // reference stays valid across the argument walks.
+        const vector<TokenType> &params = fnParams[entries[e].params];
+        TokenType result = entries[e].type;
+        for (size_t i = 0; i < call.args.size(); ++i)
+            if (visitExpr(call.args[i].get(), on) != params[i])
+                typeError(TypeChkError::FnCallParamType, call, "Function '{0}' param type mismatch for arg {n}", call.name, {}, int32_t(i));
+        return result;
+    }
+
+    TokenType binaryType(const BinaryExpr &bin, TokenType lt, TokenType rt)
+    {
+        const string &op = bin.op;
+        if (op == "+" || op == "-")
+        {
+            if (!isNumericType(lt) || !isNumericType(rt))
+                typeError(TypeChkError::AttemptedAddOpOnNonNumeric, bin, "Add/Sub on non-numeric types");
+            return lt == rt ? lt : TokenType::T_UNKNOWN;
+        }
+        if (op == "*" || op == "/")
+        {
+            if (!isNumericType(lt) || !isNumericType(rt))
+                typeError(TypeChkError::AttemptedBitOpOnNonNumeric, bin, "Mul/Div on non-numeric types");
+            return lt == rt ? lt : TokenType::T_UNKNOWN;
+        }
+        if (op == "&&" || op == "||")
+        {
+            if (lt != TokenType::T_BOOL || rt != TokenType::T_BOOL)
+                typeError(TypeChkError::AttemptedBoolOpOnNonBools, bin, "Boolean operations on non-bool types");
+            return TokenType::T_BOOL;
+        }
+        if (op == "&" || op == "|" || op == "^")
+        {
+            if (!isNumericType(lt) || !isNumericType(rt))
+                typeError(TypeChkError::AttemptedBitOpOnNonNumeric, bin, "Bitwise on non-numeric");
+            return lt == rt ? lt : TokenType::T_UNKNOWN;
+        }
+        if (op == "<<" || op == ">>")
+        {
+            if (lt != TokenType::T_INT || rt != TokenType::T_INT)
+                typeError(TypeChkError::AttemptedShiftOnNonInt, bin, "Shift operator on non-int");
+            return TokenType::T_INT;
+        }
+        if (op == "==" || op == "!=" || op == "<" || op == "<=" || op == ">" || op == ">=")
+        {
+            if (lt == TokenType::T_UNKNOWN || rt == TokenType::T_UNKNOWN)
+                typeError(TypeChkError::ExpressionTypeMismatch, bin, "Comparison between unknown types");
+            return TokenType::T_BOOL;
+        }
+        if (op == "**")
+        {
+            if (!isNumericType(lt) || !isNumericType(rt))
+                typeError(TypeChkError::AttemptedExponentiationOfNonNumeric, bin, "Exponentiation on non-numeric types");
+            return lt == rt ? lt : TokenType::T_UNKNOWN;
+        }
+        if (op == "=")
+        {
+            if (lt != rt)
+                typeError(TypeChkError::ExpressionTypeMismatch, bin, "Assignment of different types");
+            return lt;
+        }
+        return TokenType::T_UNKNOWN;
+    }
+
+    static bool isNumericType(TokenType t) { return t == TokenType::T_INT || t == TokenType::T_FLOAT; }
+    static bool isTypeValid(TokenType t)
+    {
+        return t == TokenType::T_INT || t == TokenType::T_BOOL || t == TokenType::T_FLOAT || t == TokenType::T_STRING;
+    }
+};
+
+#ifndef SEMANTIC_CHECKER_NO_MAIN
+// ---------------------------------------------------------------------
+// Main Driver
+// ---------------------------------------------------------------------
+int main()
+{
+    ios::sync_with_stdio(false);
+    cin.tie(nullptr);
+    const string inputFile = "sample.txt";
+    cout << "================================================================================\n                          SEMANTIC ANALYSIS (SCOPE + TYPE)\n================================================================================\n\n";
+    try
+    {
+        ifstream file(inputFile);
+        if (!file.is_open())
+            throw runtime_error("Cannot open file: " + inputFile);
+        stringstream buffer;
+        buffer << file.rdbuf();
+
+        RegexLexer lexer(buffer.str());
+        Parser parser(lexer.tokenize());
+        Program program = parser.parseProgram();
+
+        SemanticChecker checker;
+        checker.analyse(program);
+        cout << "SEMANTIC ANALYSIS RESULTS:\n------------------------------------------------------------------------\n";
+        checker.printErrors(cout);
+    }
+    catch (const exception &e)
+    {
+        cout << "ERROR: " << e.what() << "\n";
+        return 1;
+    }
+    cout << "\n"
+         << string(80, '=') << "\n";
+    return 0;
+}
+#endif // SEMANTIC_CHECKER_NO_MAIN
+#endif // SEMANTIC_CHECKER_CPP
@@ -1,7 +1,12 @@
 // type_checker.cpp
+// Define TYPE_CHECKER_NO_MAIN before including to reuse TypeChecker in another driver.
+#ifndef TYPE_CHECKER_CPP
+#define TYPE_CHECKER_CPP
 #define PARSER_REUSE_LEXER
 #include "../regex/regex_code.cpp"
 #include "parser.cpp"
+#include "parallel.hpp"
+#include "diagnostics.hpp"
 #include <iostream>
 #include <vector>
 #include <unordered_map>
@@ -71,6 +76,7 @@ string errorToString(TypeChkError e)
     }
 }
 
+// A diagnostic with its message formatted, as TypeChecker::error returns it.
 struct TypeError
 {
     TypeChkError type;
@@ -90,15 +96,65 @@ struct TypeScopeSymbol
 class TypeChecker
 {
 public:
-    vector<TypeError> errors;
+    DiagnosticEngine errors; // codes are TypeChkError
     vector<unordered_map<string, TypeScopeSymbol>> stack;
     int functionDepth = 0;
     int loopDepth = 0;
+    // Set on the workers of checkParallel: the checker holding the global
+    // scope, consulted after the worker's own scopes and never written.
+    const TypeChecker *frozen = nullptr;
+    // Symbols by SymbolRef, for trees the ScopeChecker has resolved: globals
+    // by id (pointing into the global scope) and the current function's
+    // locals by slot. Names without a usable reference fall back to lookup().
+    vector<const TypeScopeSymbol *> globals;
+    vector<TypeScopeSymbol> locals;
+    // Cleared for the rest of a function once one of its declarations was
+    // accepted here but rejected by the resolver or the other way round, as
+    // local references may then name a different variable than lookup().
+    bool localRefs = false;
 
     void check(const Program &prog)
+    {
+        beginProgram(prog);
+        for (const auto &item : prog.items)
+            checkItem(item);
+        endProgram();
+    }
+
+    // Same errors as check(), in the same order, with the top-level items
+    // checked on `threads` workers (0: one per hardware thread) against the
+    // read-only global scope registered by this checker.
+    void checkParallel(const Program &prog, unsigned threads = 0)
+    {
+        beginProgram(prog);
+        size_t n = prog.items.size();
+        threads = resolveThreads(threads, n);
+        vector<TypeChecker> workers(threads);
+        for (auto &w : workers)
+        {
+            w.frozen = this;
+            w.pushScope();
+        }
+        vector<DiagnosticEngine> itemErrors(n);
+        parallelFor(n, threads, [&](size_t i, unsigned t)
+                    {
+                        TypeChecker &w = workers[t];
+                        w.checkItem(prog.items[i]);
+                        swap(itemErrors[i], w.errors);
+                    });
+        for (auto &list : itemErrors)
+            errors.append(list);
+        endProgram();
+    }
+
+    // Global registration on its own; items are then checked one at a time
+    // with checkItem and the global scope closed with endProgram.
+    void beginProgram(const Program &prog)
     {
         errors.clear();
         stack.clear();
+        globals.clear();
+        locals.clear();
         functionDepth = 0;
         loopDepth = 0;
         pushScope();
@@ -115,29 +171,69 @@ public:
                 declareVariable(var);
             }
         }
+    }
 
-        // Now type-check all items (full walk)
-        for (const auto &item : prog.items)
+    // Replaces the global symbol of a function or variable declared once
+    // by beginProgram with the signature of `item`, which declares the same
+    // name. References to it (globals[]) stay valid.
+    void redeclareGlobal(const ASTNode &item)
+    {
+        TypeScopeSymbol sym;
+        const string *name = nullptr;
+        if (auto fn = dynamic_cast<const FnDecl *>(&item))
         {
-            if (auto fn = dynamic_pointer_cast<FnDecl>(item))
-            {
-                checkFunction(fn);
-            }
-            else if (auto var = dynamic_pointer_cast<VarDeclStmt>(item))
-            {
-                checkVarDecl(var, true);
-            }
-            else if (auto stmt = dynamic_pointer_cast<Stmt>(item))
-            {
-                checkStmt(stmt, TokenType::T_UNKNOWN);
-            }
+            name = &fn->name;
+            sym = TypeScopeSymbol{fn->returnType, true, {}};
+            for (auto &pr : fn->params)
+                sym.paramTypes.push_back(pr.first);
         }
+        else if (auto var = dynamic_cast<const VarDeclStmt *>(&item))
+        {
+            name = &var->name;
+            sym = TypeScopeSymbol{var->typeTok, false, {}};
+        }
+        if (!name || stack.empty())
+            return;
+        auto it = stack.front().find(*name);
+        if (it != stack.front().end())
+            it->second = move(sym);
+    }
 
-        popScope();
+    // Type-check one top-level item (full walk)
+    void checkItem(const shared_ptr<ASTNode> &item)
+    {
+        if (auto fn = dynamic_pointer_cast<FnDecl>(item))
+        {
+            checkFunction(fn);
+        }
+        else if (auto var = dynamic_pointer_cast<VarDeclStmt>(item))
+        {
+            checkVarDecl(var, true);
+        }
+        else if (auto stmt = dynamic_pointer_cast<Stmt>(item))
+        {
+            checkStmt(stmt, TokenType::T_UNKNOWN);
+        }
+    }
+
+    void endProgram() { popScope(); }
+
+    // Stored errors; fewer than were reported once errors.limit or
+    // errors.sink is set.
+    size_t errorCount() const { return errors.size(); }
+    TypeError error(size_t i) const
+    {
+        const auto &r = errors[i];
+        return TypeError(TypeChkError(r.code), r.line, r.col, errors.message(r));
     }
 
 private:
     void pushScope() { stack.push_back({}); }
+    void report(TypeChkError kind, const ASTNode &at, const char *format,
+                string_view a = {}, string_view b = {}, int32_t number = 0)
+    {
+        errors.report(uint8_t(kind), at.line, at.col, format, a, b, number);
+    }
     void popScope()
     {
         if (!stack.empty())
@@ -146,63 +242,98 @@ private:
 
     void declareVariable(shared_ptr<VarDeclStmt> var)
     {
-        auto &current = stack.back();
-        if (current.count(var->name))
+        auto [it, inserted] = stack.back().try_emplace(var->name, TypeScopeSymbol{var->typeTok, false, {}});
+        if (!inserted)
         {
-            errors.emplace_back(TypeChkError::ErroneousVarDecl, var->line, var->col, "Global variable '" + var->name + "' redefined");
+            report(TypeChkError::ErroneousVarDecl, *var, "Global variable '{0}' redefined", var->name);
         }
         else
         {
-            current[var->name] = TypeScopeSymbol{var->typeTok, false, {}};
+            bindGlobal(var->ref, &it->second);
         }
     }
 
     void declareFunction(shared_ptr<FnDecl> fn)
     {
-        auto &current = stack.back();
-        if (current.count(fn->name))
+        auto [it, inserted] = stack.back().try_emplace(fn->name);
+        auto &sym = it->second;
+        if (!inserted)
         {
-            auto &sym = current[fn->name];
             if (!sym.isFunc || sym.paramTypes.size() != fn->params.size())
-                errors.emplace_back(TypeChkError::ErroneousVarDecl, fn->line, fn->col, "Function '" + fn->name + "' redefined with different signature");
+                report(TypeChkError::ErroneousVarDecl, *fn, "Function '{0}' redefined with different signature", fn->name);
         }
         else
         {
             vector<TokenType> pts;
             for (auto &pr : fn->params)
                 pts.push_back(pr.first);
-            current[fn->name] = TypeScopeSymbol{fn->returnType, true, pts};
+            sym = TypeScopeSymbol{fn->returnType, true, pts};
+            bindGlobal(fn->ref, &sym);
         }
     }
 
-    TypeScopeSymbol *lookup(const string &name)
+    void bindGlobal(const SymbolRef &ref, const TypeScopeSymbol *sym)
+    {
+        if (ref.kind != SymbolRef::Global)
+            return;
+        if (ref.index >= globals.size())
+            globals.resize(ref.index + 1, nullptr);
+        globals[ref.index] = sym;
+    }
+
+    void bindLocal(const SymbolRef &ref, TokenType type)
+    {
+        if (ref.kind != SymbolRef::Local)
+            return;
+        if (ref.index >= locals.size())
+            locals.resize(ref.index + 1);
+        locals[ref.index] = TypeScopeSymbol{type, false, {}};
+    }
+
+    const TypeScopeSymbol *lookup(const string &name) const
     {
         for (int i = stack.size() - 1; i >= 0; --i)
-            if (stack[i].count(name))
-                return &stack[i][name];
-        return nullptr;
+        {
+            auto it = stack[i].find(name);
+            if (it != stack[i].end())
+                return &it->second;
+        }
+        return frozen ? frozen->lookup(name) : nullptr;
+    }
+
+    // Direct index when the resolver left a reference, lookup() otherwise.
+    const TypeScopeSymbol *resolve(const SymbolRef &ref, const string &name) const
+    {
+        if (ref.kind == SymbolRef::Local && localRefs && ref.index < locals.size())
+            return &locals[ref.index];
+        const TypeChecker *global = frozen ? frozen : this;
+        if (ref.kind == SymbolRef::Global && ref.index < global->globals.size() && global->globals[ref.index])
+            return global->globals[ref.index];
+        return lookup(name);
     }
 
     void checkVarDecl(shared_ptr<VarDeclStmt> var, bool global)
     {
         if (!isTypeValid(var->typeTok))
         {
-            errors.emplace_back(TypeChkError::ErroneousVarDecl, var->line, var->col, "Invalid type for variable '" + var->name + "'");
+            report(TypeChkError::ErroneousVarDecl, *var, "Invalid type for variable '{0}'", var->name);
         }
-        if (!global && stack.back().count(var->name))
+        if (!global)
         {
-            errors.emplace_back(TypeChkError::ErroneousVarDecl, var->line, var->col, "Variable '" + var->name + "' redefined in local scope");
-        }
-        else if (!global)
-        {
-            stack.back()[var->name] = TypeScopeSymbol{var->typeTok, false, {}};
+            bool declared = stack.back().try_emplace(var->name, TypeScopeSymbol{var->typeTok, false, {}}).second;
+            if (!declared)
+                report(TypeChkError::ErroneousVarDecl, *var, "Variable '{0}' redefined in local scope", var->name);
+            if (declared != (var->ref.kind == SymbolRef::Local))
+                localRefs = false;
+            else if (declared)
+                bindLocal(var->ref, var->typeTok);
         }
         if (var->init)
         {
             auto exprType = getExprType(var->init);
             if (exprType != var->typeTok)
             {
-                errors.emplace_back(TypeChkError::ExpressionTypeMismatch, var->line, var->col, "Initializer for '" + var->name + "' type mismatch");
+                report(TypeChkError::ExpressionTypeMismatch, *var, "Initializer for '{0}' type mismatch", var->name);
             }
         }
     }
@@ -214,7 +345,7 @@ private:
             return false;
         if (dynamic_pointer_cast<ReturnStmt>(stmt))
         {
-            cout << "CONTAINS RETURN at line " << stmt->line << endl;
+            DBG("CONTAINS RETURN at line " << stmt->line);
             return true;
         }
         if (auto block = dynamic_pointer_cast<BlockStmt>(stmt))
@@ -237,16 +368,16 @@ private:
         functionDepth++;
         pushScope();
 
+        locals.clear();
+        localRefs = true;
         unordered_map<string, bool> paramNames;
         for (auto &pr : fn->params)
         {
-            if (stack.back().count(pr.second))
-                errors.emplace_back(TypeChkError::ErroneousVarDecl, fn->line, fn->col, "Parameter '" + pr.second + "' redefined in function '" + fn->name + "'");
-            else
-                stack.back()[pr.second] = TypeScopeSymbol{pr.first, false, {}};
-            if (paramNames.count(pr.second))
-                errors.emplace_back(TypeChkError::FnCallParamType, fn->line, fn->col, "Duplicate function parameter name: " + pr.second);
-            paramNames[pr.second] = true;
+            locals.push_back(TypeScopeSymbol{pr.first, false, {}});
+            if (!stack.back().try_emplace(pr.second, TypeScopeSymbol{pr.first, false, {}}).second)
+                report(TypeChkError::ErroneousVarDecl, *fn, "Parameter '{0}' redefined in function '{1}'", pr.second, fn->name);
+            if (!paramNames.emplace(pr.second, true).second)
+                report(TypeChkError::FnCallParamType, *fn, "Duplicate function parameter name: {0}", pr.second);
         }
 
         // Recursively look for a return statement anywhere in function's body
@@ -258,7 +389,9 @@ private:
             checkStmt(stmt, fn->returnType);
         }
         if (fn->returnType != TokenType::T_UNKNOWN && !foundReturn)
-            errors.emplace_back(TypeChkError::ReturnStmtNotFound, fn->line, fn->col, "Function '" + fn->name + "' missing return statement");
+            report(TypeChkError::ReturnStmtNotFound, *fn, "Function '{0}' missing return statement", fn->name);
+        locals.clear();
+        localRefs = false;
         popScope();
         functionDepth--;
     }
@@ -324,18 +457,18 @@ private:
         {
             if (!ret->expr)
             {
-                errors.emplace_back(TypeChkError::EmptyExpression, ret->line, ret->col, "Return statement missing expression");
+                report(TypeChkError::EmptyExpression, *ret, "Return statement missing expression");
             }
             else if (getExprType(ret->expr) != expectedReturnType)
             {
-                errors.emplace_back(TypeChkError::ErroneousReturnType, ret->line, ret->col, "Return type mismatch");
+                report(TypeChkError::ErroneousReturnType, *ret, "Return type mismatch");
             }
         }
         else if (auto ifStmt = dynamic_pointer_cast<IfStmt>(stmt))
         {
             auto condType = getExprType(ifStmt->cond);
             if (condType != TokenType::T_BOOL)
-                errors.emplace_back(TypeChkError::ExpectedBooleanExpression, ifStmt->line, ifStmt->col, "Condition of if is not boolean");
+                report(TypeChkError::ExpectedBooleanExpression, *ifStmt, "Condition of if is not boolean");
             checkStmt(ifStmt->thenStmt, expectedReturnType);
             if (ifStmt->elseStmt)
                 checkStmt(ifStmt->elseStmt, expectedReturnType);
@@ -345,7 +478,7 @@ private:
             loopDepth++;
             auto condType = getExprType(whileStmt->cond);
             if (condType != TokenType::T_BOOL)
-                errors.emplace_back(TypeChkError::NonBooleanCondStmt, whileStmt->line, whileStmt->col, "While condition not boolean");
+                report(TypeChkError::NonBooleanCondStmt, *whileStmt, "While condition not boolean");
             checkStmt(whileStmt->body, expectedReturnType);
             loopDepth--;
         }
@@ -355,7 +488,7 @@ private:
             checkStmt(doWhile->body, expectedReturnType);
             auto condType = getExprType(doWhile->cond);
             if (condType != TokenType::T_BOOL)
-                errors.emplace_back(TypeChkError::NonBooleanCondStmt, doWhile->line, doWhile->col, "Do-while condition not boolean");
+                report(TypeChkError::NonBooleanCondStmt, *doWhile, "Do-while condition not boolean");
             loopDepth--;
         }
         else if (auto forStmt = dynamic_pointer_cast<ForStmt>(stmt))
@@ -376,7 +509,7 @@ private:
             {
                 auto condType = getExprType(forStmt->cond);
                 if (condType != TokenType::T_BOOL)
-                    errors.emplace_back(TypeChkError::NonBooleanCondStmt, forStmt->line, forStmt->col, "For condition not boolean");
+                    report(TypeChkError::NonBooleanCondStmt, *forStmt, "For condition not boolean");
             }
             if (forStmt->post)
                 checkExpr(forStmt->post);
@@ -386,7 +519,7 @@ private:
         else if (auto brk = dynamic_pointer_cast<BreakStmt>(stmt))
         {
             if (loopDepth <= 0) // use your mechanism to track if we're inside a loop
-                errors.emplace_back(TypeChkError::ErroneousBreak, stmt->line, stmt->col, "break outside of loop");
+                report(TypeChkError::ErroneousBreak, *stmt, "break outside of loop");
         }
     }
 
@@ -394,22 +527,43 @@ private:
     {
         auto type = getExprType(expr);
         if (type == TokenType::T_UNKNOWN && expr)
-            errors.emplace_back(TypeChkError::EmptyExpression, expr->line, expr->col, "Expression could not be resolved");
+            report(TypeChkError::EmptyExpression, *expr, "Expression could not be resolved");
+    }
+
+    // Types `expr` and records the result on the node, unless it is shared.
+    TokenType getExprType(const shared_ptr<Expr> &expr)
+    {
+        TokenType t = inferType(expr);
+        if (expr && !expr->shared)
+            expr->type = valueTypeOf(t);
+        return t;
     }
 
-    TokenType getExprType(shared_ptr<Expr> expr)
+    TokenType inferType(const shared_ptr<Expr> &expr)
     {
         if (!expr)
             return TokenType::T_UNKNOWN;
         if (auto var = dynamic_pointer_cast<IdentifierExpr>(expr))
         {
-            auto sym = lookup(var->name);
+            auto sym = resolve(var->ref, var->name);
             return sym ? sym->typeTok : TokenType::T_UNKNOWN;
         }
         else if (auto lit = dynamic_pointer_cast<IntLiteral>(expr))
         {
             return TokenType::T_INT;
         }
+        else if (auto lit = dynamic_pointer_cast<FloatLiteral>(expr))
+        {
+            return TokenType::T_FLOAT;
+        }
+        else if (auto lit = dynamic_pointer_cast<StringLiteral>(expr))
+        {
+            return TokenType::T_STRING;
+        }
+        else if (auto lit = dynamic_pointer_cast<CharLiteral>(expr))
+        {
+            return TokenType::T_CHAR;
+        }
         else if (auto lit = dynamic_pointer_cast<BoolLiteral>(expr))
         {
             return TokenType::T_BOOL;
@@ -422,64 +576,71 @@ private:
             if (op == "+" || op == "-")
             {
                 if (!isNumericType(lt) || !isNumericType(rt))
-                    errors.emplace_back(TypeChkError::AttemptedAddOpOnNonNumeric, bin->line, bin->col, "Add/Sub on non-numeric types");
+                    report(TypeChkError::AttemptedAddOpOnNonNumeric, *bin, "Add/Sub on non-numeric types");
                 return lt == rt ? lt : TokenType::T_UNKNOWN;
             }
             if (op == "*" || op == "/")
             {
                 if (!isNumericType(lt) || !isNumericType(rt))
-                    errors.emplace_back(TypeChkError::AttemptedBitOpOnNonNumeric, bin->line, bin->col, "Mul/Div on non-numeric types");
+                    report(TypeChkError::AttemptedBitOpOnNonNumeric, *bin, "Mul/Div on non-numeric types");
                 return lt == rt ? lt : TokenType::T_UNKNOWN;
             }
             if (op == "&&" || op == "||")
             {
                 if (lt != TokenType::T_BOOL || rt != TokenType::T_BOOL)
-                    errors.emplace_back(TypeChkError::AttemptedBoolOpOnNonBools, bin->line, bin->col, "Boolean operations on non-bool types");
+                    report(TypeChkError::AttemptedBoolOpOnNonBools, *bin, "Boolean operations on non-bool types");
                 return TokenType::T_BOOL;
             }
             if (op == "&" || op == "|" || op == "^")
             {
                 if (!isNumericType(lt) || !isNumericType(rt))
-                    errors.emplace_back(TypeChkError::AttemptedBitOpOnNonNumeric, bin->line, bin->col, "Bitwise on non-numeric");
+                    report(TypeChkError::AttemptedBitOpOnNonNumeric, *bin, "Bitwise on non-numeric");
                 return lt == rt ? lt : TokenType::T_UNKNOWN;
             }
             if (op == "<<" || op == ">>")
             {
                 if (lt != TokenType::T_INT || rt != TokenType::T_INT)
-                    errors.emplace_back(TypeChkError::AttemptedShiftOnNonInt, bin->line, bin->col, "Shift operator on non-int");
+                    report(TypeChkError::AttemptedShiftOnNonInt, *bin, "Shift operator on non-int");
                 return TokenType::T_INT;
             }
             if (op == "==" || op == "!=" || op == "<" || op == "<=" || op == ">" || op == ">=")
             {
                 if (lt == TokenType::T_UNKNOWN || rt == TokenType::T_UNKNOWN)
-                    errors.emplace_back(TypeChkError::ExpressionTypeMismatch, bin->line, bin->col, "Comparison between unknown types");
+                    report(TypeChkError::ExpressionTypeMismatch, *bin, "Comparison between unknown types");
                 return TokenType::T_BOOL;
             }
             if (op == "**")
             {
                 if (!isNumericType(lt) || !isNumericType(rt))
-                    errors.emplace_back(TypeChkError::AttemptedExponentiationOfNonNumeric, bin->line, bin->col, "Exponentiation on non-numeric types");
+                    report(TypeChkError::AttemptedExponentiationOfNonNumeric, *bin, "Exponentiation on non-numeric types");
                 return lt == rt ? lt : TokenType::T_UNKNOWN;
             }
             if (op == "=")
             {
                 if (lt != rt)
-                    errors.emplace_back(TypeChkError::ExpressionTypeMismatch, bin->line, bin->col, "Assignment of different types");
+                    report(TypeChkError::ExpressionTypeMismatch, *bin, "Assignment of different types");
                 return lt;
             }
             return TokenType::T_UNKNOWN;
         }
         else if (auto call = dynamic_pointer_cast<CallExpr>(expr))
         {
-            auto sym = lookup(call->name);
+            if (call->name.empty())
+            {
+                // no function values: only a named function can be called
+                getExprType(call->callee);
+                report(TypeChkError::FnCallParamType, *call, "Called expression is not a function");
+                return TokenType::T_UNKNOWN;
+            }
+            auto sym = resolve(call->ref, call->name);
             if (!sym || !sym->isFunc)
             {
-                errors.emplace_back(TypeChkError::FnCallParamType, call->line, call->col, "Call to undefined function '" + call->name + "'");
+                report(TypeChkError::FnCallParamType, *call, "Call to undefined function '{0}'", call->name);
                 return TokenType::T_UNKNOWN;
             }
             if (call->args.size() != sym->paramTypes.size())
             {
-                errors.emplace_back(TypeChkError::FnCallParamCount, call->line, call->col, "Function '" + call->name + "' parameter count mismatch");
+                report(TypeChkError::FnCallParamCount, *call, "Function '{0}' parameter count mismatch", call->name);
             }
             else
             {
@@ -487,7 +648,7 @@ private:
                 {
                     auto argType = getExprType(call->args[i]);
                     if (argType != sym->paramTypes[i])
-                        errors.emplace_back(TypeChkError::FnCallParamType, call->line, call->col, "Function '" + call->name + "' param type mismatch for arg " + to_string(i));
+                        report(TypeChkError::FnCallParamType, *call, "Function '{0}' param type mismatch for arg {n}", call->name, {}, int32_t(i));
                 }
             }
             return sym->typeTok;
@@ -499,13 +660,13 @@ private:
             if (op == "!")
             {
                 if (subType != TokenType::T_BOOL)
-                    errors.emplace_back(TypeChkError::AttemptedBoolOpOnNonBools, unary->line, unary->col, "Logical NOT on non-bool type");
+                    report(TypeChkError::AttemptedBoolOpOnNonBools, *unary, "Logical NOT on non-bool type");
                 return TokenType::T_BOOL;
             }
             if (op == "-")
             {
                 if (!isNumericType(subType))
-                    errors.emplace_back(TypeChkError::AttemptedAddOpOnNonNumeric, unary->line, unary->col, "Unary minus on non-numeric type");
+                    report(TypeChkError::AttemptedAddOpOnNonNumeric, *unary, "Unary minus on non-numeric type");
                 return subType;
             }
             return TokenType::T_UNKNOWN;
@@ -529,6 +690,7 @@ private:
     }
 };
 
+#ifndef TYPE_CHECKER_NO_MAIN
 // -------------- File Reading Utility -----------------
 string readFile(const string &filename)
 {
@@ -574,24 +736,20 @@ int main()
         cout << "ABSTRACT SYNTAX TREE (AST):\n------------------------------------------------------------------------\n";
         program.print(cout);
         cout << "------------------------------------------------------------------------\n\n";
-        // Type checking
+        // Type checking; errors are written as they are found
         cout << "PHASE 3: TYPE CHECK ANALYSIS\n========================================================================\n";
+        cout << "TYPE CHECK ANALYSIS RESULTS:\n------------------------------------------------------------------------\n";
         TypeChecker checker;
+        checker.errors.sink = [](const DiagnosticEngine::Record &r, const string &message)
+        {
+            cout << errorToString(TypeChkError(r.code))
+                 << " at line " << r.line << ", col " << r.col << " : " << message << "\n";
+        };
         checker.check(program);
-        // Display results
-        cout << "TYPE CHECK ANALYSIS RESULTS:\n------------------------------------------------------------------------\n";
-        if (checker.errors.empty())
+        if (checker.errors.reported() == 0)
         {
             cout << "No type errors found!\n";
         }
-        else
-        {
-            for (const auto &err : checker.errors)
-            {
-                cout << errorToString(err.type)
-                     << " at line " << err.line << ", col " << err.col << " : " << err.detail << "\n";
-            }
-        }
     }
     catch (const exception &e)
     {
@@ -602,3 +760,5 @@ int main()
          << string(80, '=') << "\n";
     return 0;
 }
+#endif // TYPE_CHECKER_NO_MAIN
+#endif // TYPE_CHECKER_CPP
@@ -1,4 +1,6 @@
 // lexer_regex.cpp
+#ifndef REGEX_CODE_CPP
+#define REGEX_CODE_CPP
 #include <bits/stdc++.h>
 using namespace std;
 
@@ -683,3 +685,4 @@ fn int my_fn(int x, float y) {
     return 0;
 }
 #endif
+#endif // REGEX_CODE_CPP